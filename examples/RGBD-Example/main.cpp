@@ -6,41 +6,6 @@
 
 #include "DataLoader.h"
 
-void project_image(std::vector<Toucan::Point3D>& point_vector, const Image& image, const Image& image_depth) {
-	constexpr float fx_inv = 1.0 / 525.0;
-	constexpr float fy_inv = 1.0 / 525.0;
-	constexpr float cx = 319.5;
-	constexpr float cy = 239.5;
-	
-	constexpr float factor = 1.0f / 5000.0f;
-	
-	const uint8_t* image_ptr = reinterpret_cast<uint8_t*>(image.m_data);
-	const uint16_t* depth_image_ptr = reinterpret_cast<uint16_t*>(image_depth.m_data);
-	
-	const int image_width = image.m_width;
-	const int image_height = image.m_height;
-	
-	for (int image_v = 0; image_v < image_height; ++image_v) {
-		for (int image_u = 0; image_u < image_width; ++image_u) {
-			const uint16_t depth_value = depth_image_ptr[image_v * image_width + image_u];
-			
-			if (depth_value == 0) { continue; }
-			
-			const float r = static_cast<float>(image_ptr[image_v * image_width * 3 + image_u * 3 + 0]) / 255.0f;
-			const float g = static_cast<float>(image_ptr[image_v * image_width * 3 + image_u * 3 + 1]) / 255.0f;
-			const float b = static_cast<float>(image_ptr[image_v * image_width * 3 + image_u * 3 + 2]) / 255.0f;
-			
-			const float z = static_cast<float>(depth_value) * factor;
-			const float x = (static_cast<float>(image_u) - cx) * z * fx_inv;
-			const float y = (static_cast<float>(image_v) - cy) * z * fy_inv;
-			
-			point_vector.emplace_back(
-					Toucan::Point3D{Toucan::Vector3f(x, y, z), Toucan::Color(r, g, b), 0.5f, Toucan::PointShape::Circle}
-			);
-		}
-	}
-}
-
 int main() {
 	
 	std::string path = "dataset/rgbd_dataset_freiburg3_long_office_household";
@@ -51,8 +16,13 @@ int main() {
 	toucan_settings.resizeable = false;
 	Toucan::Initialize(toucan_settings);
 	
-	std::vector<Toucan::Point3D> depth_points;
-	depth_points.reserve(640 * 480);
+	Toucan::CameraIntrinsics intrinsics;
+	intrinsics.fx = 525.0f;
+	intrinsics.fy = 525.0f;
+	intrinsics.cx = 319.5f;
+	intrinsics.cy = 239.5f;
+	
+	constexpr float depth_scale = 1.0f / 5000.0f;
 	
 	std::vector<Toucan::LineVertex3D> pose_path;
 	std::vector<float> pos_x_plot;
@@ -92,8 +62,6 @@ int main() {
 		}
 		Toucan::EndFigure2D();
 		
-		project_image(depth_points, image, image_depth);
-		
 		auto gt_pose = data_loader.get_groundtruth();
 		
 		pose_path.emplace_back(Toucan::LineVertex3D{gt_pose.translation, Toucan::Color::Magenta()});
@@ -104,14 +72,14 @@ int main() {
 			Toucan::PushPose3D(gt_pose);
 			{ // The coordinate system of the camera
 				Toucan::ShowAxis3D("Axis");
-				Toucan::ShowPoints3D("Depth points", depth_points);
+				const Toucan::Image2D depth_image(image_depth.m_data, image_depth.m_width, image_depth.m_height, Toucan::ImageFormat::GRAY_U16);
+				const Toucan::Image2D color_image(image.m_data, image.m_width, image.m_height, Toucan::ImageFormat::RGB_U8);
+				Toucan::ShowDepthImage3D("Depth points", depth_image, color_image, intrinsics, depth_scale);
 			}
 			Toucan::PopPose3D();
 		}
 		Toucan::EndFigure3D();
 		
-		depth_points.clear();
-		
 		pos_x_plot.emplace_back(gt_pose.translation.x());
 		pos_y_plot.emplace_back(gt_pose.translation.y());
 		pos_z_plot.emplace_back(gt_pose.translation.z());
@@ -2,6 +2,7 @@
 
 #include <array>
 #include <optional>
+#include <string>
 #include <ostream>
 #include <iomanip>
 #include <cmath>
@@ -91,6 +92,9 @@ enum class ImageFormat : uint8_t {
 	RG_U8, RG_U16, RG_U32, RG_F32,
 	RGB_U8, RGB_U16, RGB_U32, RGB_F32,
 	BGR_U8, BGR_U16, BGR_U32, BGR_F32,
+	NV12, // 8-bit luma plane, followed by an interleaved 8-bit UV plane at half resolution in both directions.
+	YUYV, // 8-bit 4:2:2, two pixels are stored as Y0 U Y1 V. The width must be even.
+	BAYER_RGGB_U8, BAYER_BGGR_U8, BAYER_GRBG_U8, BAYER_GBRG_U8, // Raw sensor mosaic, named by the colors of the top left 2x2 block.
 	};
 
 inline constexpr size_t get_bytes_per_pixel(ImageFormat format) {
@@ -130,12 +134,47 @@ inline constexpr size_t get_bytes_per_pixel(ImageFormat format) {
 		case Toucan::ImageFormat::BGR_F32: {
 			return 3*sizeof(float);
 		}
+		case Toucan::ImageFormat::NV12: { // Only the luma plane, see `get_image_size_in_bytes`.
+			return 1*sizeof(uint8_t);
+		}
+		case Toucan::ImageFormat::YUYV: {
+			return 2*sizeof(uint8_t);
+		}
+		case Toucan::ImageFormat::BAYER_RGGB_U8:
+		case Toucan::ImageFormat::BAYER_BGGR_U8:
+		case Toucan::ImageFormat::BAYER_GRBG_U8:
+		case Toucan::ImageFormat::BAYER_GBRG_U8: {
+			return 1*sizeof(uint8_t);
+		}
 		default: {
 			throw std::runtime_error("ERROR! Not implemented");
 		}
 	}
 }
 
+inline constexpr size_t get_image_size_in_bytes(ImageFormat format, int width, int height) {
+	const size_t number_of_pixels = static_cast<size_t>(width)*static_cast<size_t>(height);
+	if (format == ImageFormat::NV12) { // The chroma plane has one UV pair per 2x2 block of pixels.
+		return number_of_pixels + 2*static_cast<size_t>((width + 1)/2)*static_cast<size_t>((height + 1)/2);
+	}
+	return get_bytes_per_pixel(format)*number_of_pixels;
+}
+
+// Camera formats that are converted to RGB in the image shader. They are only supported by `ShowImage2D`.
+inline constexpr bool is_camera_image_format(ImageFormat format) {
+	switch (format) {
+		case Toucan::ImageFormat::NV12:
+		case Toucan::ImageFormat::YUYV:
+		case Toucan::ImageFormat::BAYER_RGGB_U8:
+		case Toucan::ImageFormat::BAYER_BGGR_U8:
+		case Toucan::ImageFormat::BAYER_GRBG_U8:
+		case Toucan::ImageFormat::BAYER_GBRG_U8:
+			return true;
+		default:
+			return false;
+	}
+}
+
 struct Image2D {
 	constexpr Image2D() :
 	image_buffer_ptr{nullptr}, width{0}, height{0}, format{ImageFormat::GRAY_U8} { }
@@ -149,6 +188,14 @@ struct Image2D {
 	ImageFormat format;
 };
 
+// Pinhole camera intrinsics, in pixels.
+struct CameraIntrinsics {
+	float fx = 1.0f;
+	float fy = 1.0f;
+	float cx = 0.0f;
+	float cy = 0.0f;
+};
+
 enum class PointShape : uint8_t {Square = 0, Circle = 1, Diamond = 2, Cross = 3, Ring = 4};
 
 
@@ -179,6 +226,44 @@ struct Point3D {
 	PointShape shape;
 };
 
+// Batch transforms of point buffers, see `transform_points` in LinAlg.h. The Point2D and Point3D variants transform the positions in place.
+
+inline void transform_points(const RigidTransform3Df& rigid_transform, const Buffer<Vector3f>& points_buffer, Vector3f* result_ptr) {
+	transform_points(rigid_transform, points_buffer.data_ptr, points_buffer.number_of_elements, result_ptr);
+}
+
+inline void transform_points(const ScaledTransform3Df& scaled_transform, const Buffer<Vector3f>& points_buffer, Vector3f* result_ptr) {
+	transform_points(scaled_transform, points_buffer.data_ptr, points_buffer.number_of_elements, result_ptr);
+}
+
+inline void transform_points(const RigidTransform2Df& rigid_transform, const Buffer<Vector2f>& points_buffer, Vector2f* result_ptr) {
+	transform_points(rigid_transform, points_buffer.data_ptr, points_buffer.number_of_elements, result_ptr);
+}
+
+inline void transform_points(const ScaledTransform2Df& scaled_transform, const Buffer<Vector2f>& points_buffer, Vector2f* result_ptr) {
+	transform_points(scaled_transform, points_buffer.data_ptr, points_buffer.number_of_elements, result_ptr);
+}
+
+inline void transform_points(const RigidTransform3Df& rigid_transform, Point3D* points_ptr, size_t number_of_points) {
+	if (number_of_points == 0) { return; }
+	transform_points(rigid_transform, &points_ptr->position, number_of_points, &points_ptr->position, sizeof(Point3D));
+}
+
+inline void transform_points(const ScaledTransform3Df& scaled_transform, Point3D* points_ptr, size_t number_of_points) {
+	if (number_of_points == 0) { return; }
+	transform_points(scaled_transform, &points_ptr->position, number_of_points, &points_ptr->position, sizeof(Point3D));
+}
+
+inline void transform_points(const RigidTransform2Df& rigid_transform, Point2D* points_ptr, size_t number_of_points) {
+	if (number_of_points == 0) { return; }
+	transform_points(rigid_transform, &points_ptr->position, number_of_points, &points_ptr->position, sizeof(Point2D));
+}
+
+inline void transform_points(const ScaledTransform2Df& scaled_transform, Point2D* points_ptr, size_t number_of_points) {
+	if (number_of_points == 0) { return; }
+	transform_points(scaled_transform, &points_ptr->position, number_of_points, &points_ptr->position, sizeof(Point2D));
+}
+
 struct LineVertex3D {
 	LineVertex3D() :
 	position{Vector3f::Zero()}, color{Color::White()} { };
@@ -190,6 +275,25 @@ struct LineVertex3D {
 	Color color;
 };
 
+constexpr int text_3d_label_capacity = 32;
+
+// Text drawn facing the camera at a point, with a constant size on screen. Only ASCII text is supported, and text longer than `text_3d_label_capacity - 1` characters is cut off.
+struct Text3DLabel {
+	Text3DLabel() :
+	position{Vector3f::Zero()}, color{Color::White()}, text{} { }
+	
+	Text3DLabel(const Vector3f& position, const Color& color, const char* text_ptr) :
+	position{position}, color{color}, text{} {
+		for (int character_index = 0; character_index < text_3d_label_capacity - 1 and text_ptr[character_index] != '\0'; ++character_index) {
+			text[character_index] = text_ptr[character_index];
+		}
+	}
+	
+	Vector3f position;
+	Color color;
+	char text[text_3d_label_capacity]; // Null terminated
+};
+
 enum class PrimitiveType {Sphere = 0, Cube = 1, Cylinder = 2};
 
 struct Primitive3D {
@@ -250,6 +354,16 @@ struct ToucanSettings {
 	bool resizeable = true;
 	bool floating = false;
 	float max_frames_per_second = 60.0f;
+	std::string shader_cache_directory = ""; // Linked shader programs are stored here and reused on the next start. Empty to disable the cache.
+	std::string capture_file_path = ""; // All Begin*, End*, Push*, Pop*, Clear* and Show* calls are recorded to this file. Empty to disable recording.
+	// If set, no window is opened. The calls are passed through this POSIX shared memory object, e.g. "/toucan", to a viewer process running
+	// `Toucan::RunSharedMemoryViewer`, and the input functions always return false. Empty to render in this process.
+	std::string shared_memory_name = "";
+	size_t shared_memory_size = size_t(256) << 20u; // Calls are dropped when the viewer falls this many bytes behind.
+	// If not 0, no window is opened. The calls are streamed to a viewer connecting to this TCP port with `Toucan::RunNetworkViewer`, e.g. from
+	// another machine, and the input functions always return false. Frames are dropped while no viewer is connected, or when the connection is too slow.
+	uint16_t network_port = 0;
+	float network_position_precision = 0.001f; // Point positions are streamed rounded to a multiple of this.
 };
 
 enum class YAxisDirection {UP, DOWN};
@@ -289,16 +403,38 @@ struct ShowLinePlot2DSettings {
 	ScaledTransform2Df scaled_transform;
 	Color line_color = Color::White();
 	float line_width = 3.0f;
+	bool decimate = false; // Only draw the first, last, min and max point per pixel column. Requires points sorted by x, and no rotation.
 };
 
 struct ShowPoints2DSettings {
 	ScaledTransform2Df scaled_transform;
 };
 
+enum class Colormap : uint8_t { NONE, VIRIDIS, TURBO };
+
 struct ShowImage2DSettings {
 	unsigned int image_display_width = 0;
 	unsigned int image_display_height = 0;
 	ScaledTransform2Df scaled_transform;
+	
+	// Pixel values in [value_min, value_max] are mapped to [0, 1]. If both are zero, the full range of the integer formats is used, and [0, 1] for the floating point formats.
+	float value_min = 0.0f;
+	float value_max = 0.0f;
+	Colormap colormap = Colormap::NONE; // Only used for single channel images.
+};
+
+struct ShowTiledImage2DSettings {
+	unsigned int image_display_width = 0;
+	unsigned int image_display_height = 0;
+	ScaledTransform2Df scaled_transform;
+	
+	// Same as in ShowImage2DSettings.
+	float value_min = 0.0f;
+	float value_max = 0.0f;
+	Colormap colormap = Colormap::NONE;
+	
+	int tile_size = 512; // Width and height of the tiles in pixels. Clamped to GL_MAX_TEXTURE_SIZE.
+	size_t texture_budget = size_t(512) << 20u; // Bytes of tile textures to keep on the device. Tiles not needed for the current view are evicted beyond this.
 };
 
 struct ShowAxis3DSettings {
@@ -307,6 +443,8 @@ struct ShowAxis3DSettings {
 
 struct ShowPoints3DSettings {
 	ScaledTransform3Df scaled_transform;
+	bool level_of_detail = false; // Build an octree over the points in the background, and only draw the points needed for the current view.
+	int point_budget = 2'000'000; // Maximum number of points drawn per frame when `level_of_detail` is enabled.
 };
 
 enum class LineType { LINE_SEGMENTS, LINE_STRIP, LINE_LOOP };
@@ -317,6 +455,18 @@ struct ShowLines3DSettings {
 	float line_width = 1.0f;
 };
 
+struct ShowDepthImage3DSettings {
+	ScaledTransform3Df scaled_transform;
+	float point_size = 0.5f;
+	PointShape point_shape = PointShape::Circle;
+};
+
+struct ShowText3DSettings {
+	ScaledTransform3Df scaled_transform;
+	float text_size = 13.0f; // Height of a line of text, in pixels.
+	bool hide_overlapping = false; // Hide labels that overlap a label closer to the camera.
+};
+
 struct ShowPrimitives3DSettings {
 	ScaledTransform3Df scaled_transform;
 	Vector3f light_vector = Vector3f(1.0f, 1.25f, 1.5f).normalized();
@@ -344,4 +494,18 @@ struct ShowColorPickerSettings {
 
 };
 
+enum class FrameExportFormat { PNG, RAW }; // RAW frames are uncompressed RGBA, written as Netpbm PAM files.
+
+struct FrameExportSettings {
+	// Frames are written to this path, with "{index}" replaced by the frame number padded to six digits.
+	std::string file_path = "frame_{index}.png";
+	FrameExportFormat format = FrameExportFormat::PNG;
+	// If set, the frames are written as raw RGBA to the standard input of this shell command instead of to files, with "{width}" and "{height}"
+	// replaced by the size of the first frame, e.g. "ffmpeg -f rawvideo -pix_fmt rgba -s {width}x{height} -r 60 -i - video.mp4". Frames of another
+	// size are dropped.
+	std::string encoder_command = "";
+	unsigned int number_of_frames = 0; // The export stops after this many frames. 0 for no limit.
+	bool export_unchanged_frames = false; // Every drawn window frame is exported, not only the ones where the figure changed. For a constant frame rate.
+};
+
 } // namespace Toucan
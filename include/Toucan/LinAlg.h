@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <cmath>
 #include <cassert>
 #include <type_traits>
@@ -8,8 +9,44 @@
 #include <ios>
 #include <limits>
 
+// SIMD kernels for the float types used in hot loops: Matrix4f products, quaternion products and rotations, and through them rigid transform composition.
+// The kernels are compiled once in the library (src/linalg_simd.cpp), so the operators below are the same in every translation unit whatever
+// instruction set it is compiled for. Kernels are only used outside of constant evaluation, so the operators stay constexpr.
+#if defined(__has_builtin)
+	#if __has_builtin(__builtin_is_constant_evaluated)
+		#define TOUCAN_LINALG_HAS_IS_CONSTANT_EVALUATED
+	#endif
+#endif
+#if not defined(TOUCAN_LINALG_HAS_IS_CONSTANT_EVALUATED) and defined(__GNUC__) and not defined(__clang__) and __GNUC__ >= 9
+	#define TOUCAN_LINALG_HAS_IS_CONSTANT_EVALUATED
+#endif
+
+#if defined(TOUCAN_LINALG_HAS_IS_CONSTANT_EVALUATED)
+	#define TOUCAN_LINALG_SIMD
+#endif
+
 namespace Toucan {
 
+/***** SIMD kernels *****/
+
+namespace simd {
+
+// Each kernel returns false, without writing the result, if the library has no kernel for the operation, and the caller falls back to the generic
+// implementation. The kernels do the same operations in the same order as the generic implementations, so the results are the same.
+bool multiply_matrix4f(const float* lhs, const float* rhs, float* result); // Row major 4x4 matrices.
+bool multiply_matrix4f_vector4f(const float* matrix, const float* vector, float* result);
+bool multiply_quaternionf(const float* lhs, const float* rhs, float* result); // Quaternions as w, x, y, z.
+bool rotate_vector3f(const float* quaternion, const float* point, float* result);
+
+// Transforms the points by a row major 3x3 (or 2x2) matrix and a translation. Returns the number of points transformed, the caller transforms the rest.
+size_t transform_vector3f_array(const float* linear, const float* translation, const float* points, size_t number_of_points, float* result);
+size_t transform_vector2f_array(const float* linear, const float* translation, const float* points, size_t number_of_points, float* result);
+
+const char* get_instruction_set(); // "avx", "sse2", "neon" or "none".
+
+} // namespace simd
+
+
 /***** Matrix *****/
 
 template<typename scalar_t>
@@ -70,7 +107,7 @@ public:
 	
 	[[nodiscard]] scalar_t* data();
 	[[nodiscard]] const scalar_t* data() const;
-	
+
 private:
 	scalar_t m_data[rows * columns]; // Row major
 };
@@ -426,13 +463,33 @@ constexpr inline Matrix<scalar_t, rows, columns> operator+(const Matrix<scalar_t
 template<typename scalar_t, int rows, int common, int columns>
 constexpr inline Matrix<scalar_t, rows, columns> operator*(const Matrix<scalar_t, rows, common>& lhs, const Matrix<scalar_t, common, columns>& rhs) {
 	Matrix<scalar_t, rows, columns> result;
-	for (int row_index = 0; row_index < rows; ++row_index) {
-		for (int column_index = 0; column_index < columns; ++column_index) {
+#if defined(TOUCAN_LINALG_SIMD)
+	if constexpr (std::is_same_v<scalar_t, float> and rows == 4 and common == 4 and (columns == 4 or columns == 1)) {
+		if (not __builtin_is_constant_evaluated()) {
+			if constexpr (columns == 4) {
+				if (simd::multiply_matrix4f(lhs.data(), rhs.data(), result.data())) { return result; }
+			} else {
+				if (simd::multiply_matrix4f_vector4f(lhs.data(), rhs.data(), result.data())) { return result; }
+			}
+		}
+	}
+#endif
+	if constexpr (columns == 1) {
+		for (int row_index = 0; row_index < rows; ++row_index) {
 			scalar_t sum = scalar_t(0.0);
 			for (int common_index = 0; common_index < common; ++common_index) {
-				sum += lhs(row_index, common_index) * rhs(common_index, column_index);
+				sum += lhs(row_index, common_index) * rhs(common_index);
+			}
+			result(row_index) = sum;
+		}
+	} else { // Accumulate whole rows, so the inner loop is vectorized. The order of the sums is the same as for a dot product per element.
+		for (int row_index = 0; row_index < rows; ++row_index) {
+			for (int common_index = 0; common_index < common; ++common_index) {
+				const scalar_t lhs_value = lhs(row_index, common_index);
+				for (int column_index = 0; column_index < columns; ++column_index) {
+					result(row_index, column_index) += lhs_value * rhs(common_index, column_index);
+				}
 			}
-			result(row_index, column_index) = sum;
 		}
 	}
 	return result;
@@ -616,7 +673,7 @@ public:
 	
 	[[nodiscard]] scalar_t* data();
 	[[nodiscard]] const scalar_t* data() const;
-	
+
 private:
 	Vector<scalar_t, diagonal_size> m_diagonal;
 };
@@ -978,6 +1035,18 @@ constexpr inline Matrix4<scalar_t> Quaternion<scalar_t>::transformation_matrix()
 /*** Operator implementations ***/
 template<typename scalar_t>
 constexpr inline Quaternion<scalar_t> operator*(const Quaternion<scalar_t>& lhs, const Quaternion<scalar_t>& rhs) {
+#if defined(TOUCAN_LINALG_SIMD)
+	if constexpr (std::is_same_v<scalar_t, float>) {
+		if (not __builtin_is_constant_evaluated()) {
+			const float lhs_parameters[4] = {lhs.w, lhs.x, lhs.y, lhs.z};
+			const float rhs_parameters[4] = {rhs.w, rhs.x, rhs.y, rhs.z};
+			float result[4] = {};
+			if (simd::multiply_quaternionf(lhs_parameters, rhs_parameters, result)) {
+				return Quaternion<scalar_t>(result[0], result[1], result[2], result[3]);
+			}
+		}
+	}
+#endif
 	return Quaternion<scalar_t>(
 			lhs.w*rhs.w - lhs.x*rhs.x - lhs.y*rhs.y - lhs.z*rhs.z,
 			lhs.w*rhs.x + lhs.x*rhs.w + lhs.y*rhs.z - lhs.z*rhs.y,
@@ -988,6 +1057,15 @@ constexpr inline Quaternion<scalar_t> operator*(const Quaternion<scalar_t>& lhs,
 
 template<typename scalar_t>
 constexpr inline Vector3<scalar_t> operator*(const Quaternion<scalar_t>& orientation, const Vector3<scalar_t>& point) {
+#if defined(TOUCAN_LINALG_SIMD)
+	if constexpr (std::is_same_v<scalar_t, float>) {
+		if (not __builtin_is_constant_evaluated()) {
+			const float quaternion[4] = {orientation.w, orientation.x, orientation.y, orientation.z};
+			Vector3<scalar_t> result;
+			if (simd::rotate_vector3f(quaternion, point.data(), result.data())) { return result; }
+		}
+	}
+#endif
 	Vector3<scalar_t> u(orientation.x, orientation.y, orientation.z);
 	const scalar_t& s = orientation.w;
 	return scalar_t(2)*u.dot_product(point)*u + (s*s - u.dot_product(u))*point + scalar_t(2)*s*u.cross_product(point);
@@ -1274,7 +1352,7 @@ constexpr inline RigidTransform3D<scalar_t> operator*(const RigidTransform3D<sca
 }
 
 template<typename scalar_t>
-constexpr inline RigidTransform3D<scalar_t> operator*(const RigidTransform3D<scalar_t>& rigid_transform, const Vector3<scalar_t>& point) {
+constexpr inline Vector3<scalar_t> operator*(const RigidTransform3D<scalar_t>& rigid_transform, const Vector3<scalar_t>& point) {
 	return rigid_transform.orientation * point + rigid_transform.translation;
 }
 
@@ -1375,4 +1453,82 @@ constexpr inline Vector3<scalar_t> operator*(const ScaledTransform3D<scalar_t>&
 using ScaledTransform3Df = ScaledTransform3D<float>;
 using ScaledTransform3Dd = ScaledTransform3D<double>;
 
+/***** Batch transforms *****/
+
+// Transform arrays of points, converting the transform to a matrix once instead of applying the quaternion or angle to every point.
+// `result_ptr` may equal `points_ptr` to transform in place. `stride` is the distance in bytes between consecutive points in both arrays, so the
+// positions inside arrays of larger structs can be transformed. Contiguous float points are transformed with the SIMD kernels when available.
+// The points are independent, so large arrays can be split into ranges that are transformed on separate threads.
+
+template<typename scalar_t>
+inline void transform_points(const Matrix3<scalar_t>& linear, const Vector3<scalar_t>& translation, const Vector3<scalar_t>* points_ptr, size_t number_of_points, Vector3<scalar_t>* result_ptr, size_t stride = sizeof(Vector3<scalar_t>)) {
+	size_t point_index = 0;
+	if constexpr (std::is_same_v<scalar_t, float>) {
+		static_assert(sizeof(Vector3<float>) == 3*sizeof(float), "Vector3f must be tightly packed to be transformed by the SIMD kernels.");
+		if (stride == sizeof(Vector3<float>)) {
+			point_index = simd::transform_vector3f_array(linear.data(), translation.data(), reinterpret_cast<const float*>(points_ptr), number_of_points, reinterpret_cast<float*>(result_ptr));
+		}
+	}
+	const auto* points_bytes_ptr = reinterpret_cast<const unsigned char*>(points_ptr);
+	auto* result_bytes_ptr = reinterpret_cast<unsigned char*>(result_ptr);
+	for (; point_index < number_of_points; ++point_index) {
+		const Vector3<scalar_t> point = *reinterpret_cast<const Vector3<scalar_t>*>(points_bytes_ptr + point_index*stride);
+		auto& result = *reinterpret_cast<Vector3<scalar_t>*>(result_bytes_ptr + point_index*stride);
+		result.x() = linear(0, 0)*point.x() + linear(0, 1)*point.y() + linear(0, 2)*point.z() + translation.x();
+		result.y() = linear(1, 0)*point.x() + linear(1, 1)*point.y() + linear(1, 2)*point.z() + translation.y();
+		result.z() = linear(2, 0)*point.x() + linear(2, 1)*point.y() + linear(2, 2)*point.z() + translation.z();
+	}
+}
+
+template<typename scalar_t>
+inline void transform_points(const Matrix2<scalar_t>& linear, const Vector2<scalar_t>& translation, const Vector2<scalar_t>* points_ptr, size_t number_of_points, Vector2<scalar_t>* result_ptr, size_t stride = sizeof(Vector2<scalar_t>)) {
+	size_t point_index = 0;
+	if constexpr (std::is_same_v<scalar_t, float>) {
+		static_assert(sizeof(Vector2<float>) == 2*sizeof(float), "Vector2f must be tightly packed to be transformed by the SIMD kernels.");
+		if (stride == sizeof(Vector2<float>)) {
+			point_index = simd::transform_vector2f_array(linear.data(), translation.data(), reinterpret_cast<const float*>(points_ptr), number_of_points, reinterpret_cast<float*>(result_ptr));
+		}
+	}
+	const auto* points_bytes_ptr = reinterpret_cast<const unsigned char*>(points_ptr);
+	auto* result_bytes_ptr = reinterpret_cast<unsigned char*>(result_ptr);
+	for (; point_index < number_of_points; ++point_index) {
+		const Vector2<scalar_t> point = *reinterpret_cast<const Vector2<scalar_t>*>(points_bytes_ptr + point_index*stride);
+		auto& result = *reinterpret_cast<Vector2<scalar_t>*>(result_bytes_ptr + point_index*stride);
+		result.x() = linear(0, 0)*point.x() + linear(0, 1)*point.y() + translation.x();
+		result.y() = linear(1, 0)*point.x() + linear(1, 1)*point.y() + translation.y();
+	}
+}
+
+template<typename scalar_t>
+inline void transform_points(const RigidTransform3D<scalar_t>& rigid_transform, const Vector3<scalar_t>* points_ptr, size_t number_of_points, Vector3<scalar_t>* result_ptr, size_t stride = sizeof(Vector3<scalar_t>)) {
+	transform_points(rigid_transform.orientation.rotation_matrix(), rigid_transform.translation, points_ptr, number_of_points, result_ptr, stride);
+}
+
+template<typename scalar_t>
+inline void transform_points(const ScaledTransform3D<scalar_t>& scaled_transform, const Vector3<scalar_t>* points_ptr, size_t number_of_points, Vector3<scalar_t>* result_ptr, size_t stride = sizeof(Vector3<scalar_t>)) {
+	Matrix3<scalar_t> linear = scaled_transform.orientation.rotation_matrix();
+	for (int row_index = 0; row_index < 3; ++row_index) {
+		for (int column_index = 0; column_index < 3; ++column_index) {
+			linear(row_index, column_index) *= scaled_transform.scale(column_index);
+		}
+	}
+	transform_points(linear, scaled_transform.translation, points_ptr, number_of_points, result_ptr, stride);
+}
+
+template<typename scalar_t>
+inline void transform_points(const RigidTransform2D<scalar_t>& rigid_transform, const Vector2<scalar_t>* points_ptr, size_t number_of_points, Vector2<scalar_t>* result_ptr, size_t stride = sizeof(Vector2<scalar_t>)) {
+	transform_points(create_2d_rotation_matrix(rigid_transform.rotation), rigid_transform.translation, points_ptr, number_of_points, result_ptr, stride);
+}
+
+template<typename scalar_t>
+inline void transform_points(const ScaledTransform2D<scalar_t>& scaled_transform, const Vector2<scalar_t>* points_ptr, size_t number_of_points, Vector2<scalar_t>* result_ptr, size_t stride = sizeof(Vector2<scalar_t>)) {
+	Matrix2<scalar_t> linear = create_2d_rotation_matrix(scaled_transform.rotation);
+	for (int row_index = 0; row_index < 2; ++row_index) {
+		for (int column_index = 0; column_index < 2; ++column_index) {
+			linear(row_index, column_index) *= scaled_transform.scale(column_index);
+		}
+	}
+	transform_points(linear, scaled_transform.translation, points_ptr, number_of_points, result_ptr, stride);
+}
+
 }
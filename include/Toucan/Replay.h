@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Toucan/DataTypes.h"
+
+namespace Toucan {
+
+// Replays a capture recorded with `ToucanSettings::capture_file_path`, by calling the recorded Begin*, Push*, Show* and End* functions again.
+// The file is memory mapped, and element buffers and images are passed to the Show* functions as pointers into the mapping, so replaying a large
+// capture does not read it into memory. Toucan must be initialized before any calls are replayed.
+//
+// Elements can not be removed from a figure, so after seeking backwards any element first shown after the new position stays visible.
+class CaptureReplay {
+public:
+	// Maps the file and builds the seek index. Throws if the file can not be read or is not a capture file.
+	// A capture cut short by a crash is replayed up to the end of its last complete frame.
+	explicit CaptureReplay(const std::string& file_path);
+	~CaptureReplay();
+	
+	CaptureReplay(const CaptureReplay&) = delete;
+	CaptureReplay& operator=(const CaptureReplay&) = delete;
+	
+	// A frame is the calls up to an End* call that leaves no figure or input window active, i.e. one iteration of the recording program.
+	// The replay always stops between frames, so the calling thread can show its own elements in between.
+	
+	// Replays all frames that ended at or before `timestamp_ns`, in nanoseconds since the start of the capture. Returns false once the end is reached.
+	bool replay_until(int64_t timestamp_ns);
+	
+	// Replays the next frame. Returns false once the end is reached.
+	bool replay_next_frame();
+	
+	// Restores all elements to their state after the last frame that ended at or before `timestamp_ns`. Seeking backwards, or far forwards,
+	// replays the last call of each element at the nearest checkpoint before the timestamp, followed by the frames from the checkpoint on.
+	void seek(int64_t timestamp_ns);
+	
+	[[nodiscard]] int64_t get_current_timestamp() const { return seek_points[current_seek_point_index].timestamp_ns; } // End of the last replayed frame.
+	[[nodiscard]] int64_t get_next_timestamp() const; // End of the next frame to replay, or the duration at the end.
+	[[nodiscard]] int64_t get_duration() const { return seek_points.back().timestamp_ns; }
+	[[nodiscard]] int64_t get_start_time() const { return start_time_ns; } // System clock time of the start of the capture, in nanoseconds since the Unix epoch.
+	[[nodiscard]] size_t get_number_of_frames() const { return seek_points.size() - 1; }
+	[[nodiscard]] bool is_at_end() const { return current_seek_point_index + 1 == seek_points.size(); }
+
+private:
+	// The end of a frame, the first seek point is the start of the capture.
+	struct SeekPoint {
+		int64_t timestamp_ns;
+		size_t offset;
+	};
+	
+	struct CheckpointElement {
+		size_t record_offset;
+		size_t container_index; // Into `Checkpoint::container_record_offsets`
+		RigidTransform2Df pose_2d;
+		RigidTransform3Df pose_3d;
+	};
+	
+	// The last call of every element before a seek point, with the pose it was shown with.
+	struct Checkpoint {
+		size_t seek_point_index;
+		std::vector<size_t> container_record_offsets; // Last Begin* call of each figure and input window, for their settings.
+		std::vector<CheckpointElement> elements;
+	};
+	
+	void build_index();
+	void replay_frames(size_t seek_point_index); // Replays the frames from the current seek point up to `seek_point_index`.
+	void replay_checkpoint(const Checkpoint& checkpoint);
+	
+	const uint8_t* mapping_ptr = nullptr;
+	size_t mapping_size = 0;
+	
+	int64_t start_time_ns = 0;
+	
+	std::vector<SeekPoint> seek_points;
+	size_t current_seek_point_index = 0;
+	std::vector<Checkpoint> checkpoints;
+};
+
+} // namespace Toucan
@@ -16,6 +16,15 @@ bool IsWindowOpen();
 
 void SleepUntilWindowClosed();
 
+// Shows the calls of the process initialized with `ToucanSettings::shared_memory_name` set to `shared_memory_name`, until the window is closed.
+// Initializes Toucan with `settings` before, and destroys it after.
+void RunSharedMemoryViewer(const std::string& shared_memory_name, const ToucanSettings& settings = {});
+
+// Shows the calls streamed by the process initialized with `ToucanSettings::network_port` set to `port` on `host`, until the window is closed.
+// Initializes Toucan with `settings` before, and destroys it after. The last frame stays visible if the connection is lost.
+// Throws if the stream is corrupt, after destroying Toucan.
+void RunNetworkViewer(const std::string& host, uint16_t port, const ToucanSettings& settings = {});
+
 // ***** Figure 2D *****
 void BeginFigure2D(const std::string& name, const Figure2DSettings& settings = {});
 void EndFigure2D();
@@ -28,6 +37,21 @@ void ClearPose2D();
 void ShowLinePlot2D(const std::string& name, const Toucan::Buffer<Toucan::Vector2f>& line_buffer, int draw_layer = 0, const ShowLinePlot2DSettings& settings = {});
 void ShowPoints2D(const std::string& name, const Toucan::Buffer<Toucan::Point2D>& points_buffer, int draw_layer = 0, const ShowPoints2DSettings& settings = {});
 void ShowImage2D(const std::string& name, const Image2D& image, int draw_layer, const ShowImage2DSettings& settings = {});
+// For images larger than GL_MAX_TEXTURE_SIZE, or too large to keep on the device. Only the tiles in view are uploaded, at the resolution of the view.
+void ShowTiledImage2D(const std::string& name, const Image2D& image, int draw_layer, const ShowTiledImage2DSettings& settings = {});
+
+// ***** Frame export *****
+// Exports the framebuffer of the Figure2D or Figure3D named `figure_name`: its current image, and then every time the figure is redrawn.
+// The frames are read back asynchronously and encoded on worker threads. Frames are dropped rather than slowing down the window.
+// The frame export functions can not be called while a figure or input window is active, between its `Begin*` and `End*` calls.
+void StartFrameExport(const std::string& figure_name, const FrameExportSettings& settings = {});
+
+// Waits until the exported frames are written and the encoder command has exited. Returns the number of frames written. Also called after an
+// export with `FrameExportSettings::number_of_frames` set, before the figure can be exported again. Throws if a frame could not be written.
+size_t StopFrameExport(const std::string& figure_name);
+
+// Writes the current image of the figure to a PNG file, and waits until it is written.
+void SaveScreenshot(const std::string& figure_name, const std::string& file_path);
 
 // Helper functions
 template <size_t N>
@@ -55,6 +79,10 @@ void ShowAxis3D(const std::string& name, const ShowAxis3DSettings& settings = {}
 void ShowPoints3D(const std::string& name, const Toucan::Buffer<Toucan::Point3D>& points_buffer, const ShowPoints3DSettings& settings = {});
 void ShowLines3D(const std::string& name, const Toucan::Buffer<Toucan::LineVertex3D>& lines_buffer, const ShowLines3DSettings& settings = {});
 void ShowPrimitives3D(const std::string& name, const Toucan::Buffer<Toucan::Primitive3D>& primitives_buffer, const ShowPrimitives3DSettings& settings = {});
+void ShowText3D(const std::string& name, const Toucan::Buffer<Toucan::Text3DLabel>& labels_buffer, const ShowText3DSettings& settings = {});
+// Draws a point for every pixel with a depth measurement, unprojected with the intrinsics on the device. `depth_scale` converts the depth pixel values to distance along the optical axis.
+// The depth image must have a single channel, and pixels with depth zero are skipped. The color image is sampled at the same relative position, and may have a different resolution.
+void ShowDepthImage3D(const std::string& name, const Image2D& depth_image, const Image2D& color_image, const CameraIntrinsics& intrinsics, float depth_scale, const ShowDepthImage3DSettings& settings = {});
 
 // ***** Input *****
 void BeginInputWindow(const std::string& name, const InputSettings& settings = {});
@@ -156,4 +184,16 @@ inline void ShowPrimitives3D(const std::string& name, const std::vector<Toucan::
 	Toucan::Buffer<Toucan::Primitive3D> buffer = {primitives.data(), primitives.size()};
 	ShowPrimitives3D(name, buffer, settings);
 }
+
+template <size_t N>
+inline void ShowText3D(const std::string& name, const std::array<Toucan::Text3DLabel, N>& labels, const ShowText3DSettings& settings = {}) {
+	Toucan::Buffer<Toucan::Text3DLabel> buffer = {labels.data(), labels.size()};
+	ShowText3D(name, buffer, settings);
+}
+
+template <typename Allocator>
+inline void ShowText3D(const std::string& name, const std::vector<Toucan::Text3DLabel, Allocator>& labels, const ShowText3DSettings& settings = {}) {
+	Toucan::Buffer<Toucan::Text3DLabel> buffer = {labels.data(), labels.size()};
+	ShowText3D(name, buffer, settings);
+}
 } // namespace Toucan
@@ -10,6 +10,7 @@
 #include <cmath>
 #include <algorithm>
 #include <cstring>
+#include <memory>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -21,6 +22,7 @@
 #include "render.h"
 #include "Utils.h"
 #include "util/tick_number.h"
+#include "util/data_bounds.h"
 #include "gl/projection.h"
 
 #include <imgui.h>
@@ -37,6 +39,7 @@ Toucan::ToucanContext* toucan_context_ptr = nullptr;
 void render_loop(Toucan::ToucanSettings);
 static void glfw_error_callback(int error, const char* description);
 static void glfw_window_close_callback(GLFWwindow* window);
+void destroy_element_builds(Toucan::ToucanContext& context);
 
 // Validation macros
 #define validate_initialized(function_name) \
@@ -60,6 +63,17 @@ if (toucan_context_ptr->current_input_window == nullptr) { throw std::runtime_er
 #define validate_inactive_input_window(function_name) \
 if (toucan_context_ptr->current_input_window != nullptr) { throw std::runtime_error("Toucan error! 'Toucan::"#function_name"' was called while another InputWindow was active. Did you forget to call 'Toucan::EndInputWindow'?"); }
 
+// Records the call if `ToucanSettings::capture_file_path` was set. Calls that carry element data are `droppable`.
+// Also passes the call to the viewer process, if `ToucanSettings::shared_memory_name` was set, and to the remote viewer if `ToucanSettings::network_port` was set.
+#define record_call(record_type, droppable, ...) \
+if (toucan_context_ptr->capture_recorder_ptr != nullptr) { toucan_context_ptr->capture_recorder_ptr->record(Toucan::CaptureRecordType::record_type, {__VA_ARGS__}, droppable); } \
+if (toucan_context_ptr->shared_memory_writer_ptr != nullptr) { toucan_context_ptr->shared_memory_writer_ptr->write(Toucan::CaptureRecordType::record_type, {__VA_ARGS__}, droppable); } \
+if (toucan_context_ptr->network_writer_ptr != nullptr) { toucan_context_ptr->network_writer_ptr->write(Toucan::CaptureRecordType::record_type, {__VA_ARGS__}); }
+
+// Element data is only copied by the process that renders it. Figures and input windows are still tracked, to validate the calls.
+#define return_if_shown_by_viewer(...) \
+if (toucan_context_ptr->shared_memory_writer_ptr != nullptr or toucan_context_ptr->network_writer_ptr != nullptr) { return __VA_ARGS__; }
+
 Toucan::Element2D& get_or_create_element_2d(Toucan::Figure2D& figure, const std::string& name, int draw_layer, Toucan::ElementType2D type) {
 	// Does the Element2D object with that name already exist?
 	Toucan::Element2D* current_element_ptr = nullptr;
@@ -85,6 +99,15 @@ Toucan::Element2D& get_or_create_element_2d(Toucan::Figure2D& figure, const std:
 		new_element_2d.draw_layer = draw_layer;
 		new_element_2d.type = type;
 		
+		if (type == Toucan::ElementType2D::LinePlot2D) {
+			new_element_2d.line_plot_2d_metadata.decimation_ptr = nullptr;
+		} else if (type == Toucan::ElementType2D::Image2D) {
+			new_element_2d.image_2d_metadata.texture = 0;
+			new_element_2d.image_2d_metadata.chroma_texture = 0;
+		} else if (type == Toucan::ElementType2D::TiledImage2D) {
+			new_element_2d.tiled_image_2d_metadata.tiled_image_ptr = nullptr;
+		}
+		
 		auto insertion_iterator = figure.elements.insert(element_iterator, std::move(new_element_2d));
 		current_element_ptr = &(*insertion_iterator);
 	}
@@ -110,6 +133,26 @@ Toucan::Element3D& get_or_create_element_3d(Toucan::Figure3D& figure, const std:
 		new_element_3d.name = name;
 		new_element_3d.type = type;
 		
+		if (type == Toucan::ElementType3D::Point3D) {
+			new_element_3d.point_3d_metadata.chunk_bounds_ptr = nullptr;
+			new_element_3d.point_3d_metadata.number_of_chunks = 0;
+			new_element_3d.point_3d_metadata.octree_ptr = nullptr;
+		}
+		
+		if (type == Toucan::ElementType3D::DepthImage3D) {
+			new_element_3d.depth_image_3d_metadata.vao = 0;
+			new_element_3d.depth_image_3d_metadata.depth_texture = 0;
+			new_element_3d.depth_image_3d_metadata.color_texture = 0;
+		}
+		
+		if (type == Toucan::ElementType3D::Text3D) {
+			new_element_3d.text_3d_metadata.vao = 0;
+			new_element_3d.text_3d_metadata.glyph_vbo = 0;
+			new_element_3d.text_3d_metadata.visibility_vbo = 0;
+			new_element_3d.text_3d_metadata.labels_ptr = nullptr;
+			new_element_3d.text_3d_metadata.layout_ptr = nullptr;
+		}
+		
 		auto& inserted_element = figure.elements.emplace_back(new_element_3d);
 		current_element_ptr = &inserted_element;
 	}
@@ -143,7 +186,21 @@ Toucan::ElementInput& get_or_create_element_input(Toucan::InputWindow& input_win
 
 void Toucan::Initialize(Toucan::ToucanSettings settings) {
 	if (toucan_context_ptr != nullptr) { throw std::runtime_error("Toucan error! 'Toucan::Initialize' was called when Toucan already was initialized. Did you call 'Toucan::Initialize' multiple times?"); }
-	toucan_context_ptr = new ToucanContext;
+	// Created first, so a capture file, shared memory object or port that can not be created leaves Toucan uninitialized.
+	std::unique_ptr<SharedMemoryWriter> shared_memory_writer = settings.shared_memory_name.empty() ? nullptr : std::make_unique<SharedMemoryWriter>(settings.shared_memory_name, settings.shared_memory_size);
+	std::unique_ptr<CaptureRecorder> capture_recorder = settings.capture_file_path.empty() ? nullptr : std::make_unique<CaptureRecorder>(settings.capture_file_path);
+	auto context = std::make_unique<ToucanContext>();
+	std::unique_ptr<NetworkWriter> network_writer = settings.network_port == 0 ? nullptr : std::make_unique<NetworkWriter>(settings.network_port, settings.network_position_precision, context->thread_pool);
+	
+	toucan_context_ptr = context.release();
+	toucan_context_ptr->capture_recorder_ptr = capture_recorder.release();
+	toucan_context_ptr->shared_memory_writer_ptr = shared_memory_writer.release();
+	toucan_context_ptr->network_writer_ptr = network_writer.release();
+	
+	if (toucan_context_ptr->shared_memory_writer_ptr != nullptr or toucan_context_ptr->network_writer_ptr != nullptr) {
+		return; // Rendered by the viewer.
+	}
+	
 	toucan_context_ptr->render_thread = std::thread(render_loop, settings);
 	
 	std::unique_lock lock(toucan_context_ptr->initialized_mutex);
@@ -153,18 +210,48 @@ void Toucan::Initialize(Toucan::ToucanSettings settings) {
 void Toucan::Destroy() {
 	validate_initialized(Destroy)
 	toucan_context_ptr->should_render = false;
-	toucan_context_ptr->render_thread.join();
+	if (toucan_context_ptr->render_thread.joinable()) {
+		toucan_context_ptr->render_thread.join();
+	}
+	destroy_element_builds(*toucan_context_ptr);
+	delete toucan_context_ptr->capture_recorder_ptr;
+	delete toucan_context_ptr->shared_memory_writer_ptr;
+	delete toucan_context_ptr->network_writer_ptr; // Uses the thread pool of the context.
+	// Frame exporters that were not stopped also use the thread pool, which is destroyed before the figures.
+	for (auto& figure_2d : toucan_context_ptr->figures_2d) { figure_2d.frame_exporter.reset(); }
+	for (auto& figure_3d : toucan_context_ptr->figures_3d) { figure_3d.frame_exporter.reset(); }
 	delete toucan_context_ptr;
+	toucan_context_ptr = nullptr;
 }
 
 bool Toucan::IsWindowOpen() {
 	validate_initialized(IsWindowOpen)
+	
+	if (toucan_context_ptr->shared_memory_writer_ptr != nullptr) {
+		return toucan_context_ptr->shared_memory_writer_ptr->is_viewer_window_open();
+	}
+	
+	if (toucan_context_ptr->network_writer_ptr != nullptr) {
+		return true; // Remote viewers come and go, the producer keeps running.
+	}
+	
 	return toucan_context_ptr->window_open;
 }
 
 void Toucan::SleepUntilWindowClosed() {
 	validate_initialized(SleepUntilWindowClosed)
 	
+	if (toucan_context_ptr->shared_memory_writer_ptr != nullptr) {
+		while (toucan_context_ptr->shared_memory_writer_ptr->is_viewer_window_open()) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		}
+		return;
+	}
+	
+	if (toucan_context_ptr->network_writer_ptr != nullptr) {
+		return; // There is no window to wait for.
+	}
+	
 	if(not toucan_context_ptr->window_open) {
 		return;
 	}
@@ -173,11 +260,52 @@ void Toucan::SleepUntilWindowClosed() {
 	toucan_context_ptr->window_close_cv.wait(lock);
 }
 
+void Toucan::RunSharedMemoryViewer(const std::string& shared_memory_name, const ToucanSettings& settings) {
+	if (not settings.shared_memory_name.empty()) { throw std::runtime_error("Toucan error! 'Toucan::RunSharedMemoryViewer' was called with 'ToucanSettings::shared_memory_name' set. The viewer renders the calls itself."); }
+	
+	SharedMemoryReader shared_memory_reader(shared_memory_name);
+	
+	Initialize(settings);
+	
+	// The records are replayed as they arrive, so the render thread sees the same sequence of calls as in the producer process.
+	while (IsWindowOpen()) {
+		if (shared_memory_reader.replay_written_records() == 0) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+	
+	shared_memory_reader.end_active_containers();
+	Destroy();
+}
+
+void Toucan::RunNetworkViewer(const std::string& host, uint16_t port, const ToucanSettings& settings) {
+	if (settings.network_port != 0) { throw std::runtime_error("Toucan error! 'Toucan::RunNetworkViewer' was called with 'ToucanSettings::network_port' set. The viewer renders the calls itself."); }
+	
+	NetworkReader network_reader(host, port);
+	
+	Initialize(settings);
+	
+	// Frames are replayed whole, so no figure is left active when the window is closed.
+	try {
+		while (IsWindowOpen()) {
+			network_reader.replay_next_frame(std::chrono::milliseconds(10));
+		}
+	} catch (...) {
+		// A figure left active would keep the render thread waiting for it.
+		network_reader.end_active_containers();
+		Destroy();
+		throw;
+	}
+	
+	Destroy();
+}
+
 
 void Toucan::BeginFigure2D(const std::string& name, const Figure2DSettings& settings) {
 	validate_initialized(BeginFigure2D)
 	auto& toucan_context = *toucan_context_ptr;
 	validate_inactive_figure2d(BeginFigure2D)
+	record_call(BeginFigure2D, false, name, settings)
 	
 	Toucan::Figure2D* figure_2d_ptr = nullptr;
 	for (auto& figure_2d : toucan_context.figures_2d) { // Does the Figure2D already exists?
@@ -206,6 +334,7 @@ void Toucan::EndFigure2D() {
 	validate_initialized(EndFigure2D)
 	auto& toucan_context = *toucan_context_ptr;
 	validate_active_figure2d(EndFigure2D)
+	record_call(EndFigure2D, false)
 	
 	auto& figure_2d = *toucan_context.current_figure_2d;
 	figure_2d.pose_stack.clear();
@@ -218,6 +347,7 @@ void Toucan::PushPose2D(const Toucan::RigidTransform2Df& pose) {
 	validate_initialized(PushPose2D)
 	auto& context = *toucan_context_ptr;
 	validate_active_figure2d(PushPose2D)
+	record_call(PushPose2D, false, pose)
 	auto& current_figure = *context.current_figure_2d;
 	
 	const auto& parent_pose = current_figure.pose_stack.back();
@@ -231,6 +361,7 @@ void Toucan::PopPose2D() {
 	auto& current_figure = *context.current_figure_2d;
 	
 	if (current_figure.pose_stack.size() <= 1) { throw std::runtime_error("Toucan error! 'Toucan::PopPose2D' was called without a matching call to `Toucan::PushPose2D`."); }
+	record_call(PopPose2D, false)
 	
 	current_figure.pose_stack.pop_back();
 }
@@ -242,6 +373,7 @@ void Toucan::ClearPose2D() {
 	auto& current_figure = *context.current_figure_2d;
 	
 	if (current_figure.pose_stack.size() <= 1) { throw std::runtime_error("Toucan error! 'Toucan::ClearPose2D' was called without any matching call to `Toucan::PushPose2D`."); }
+	record_call(ClearPose2D, false)
 	
 	current_figure.pose_stack.clear();
 	current_figure.pose_stack.emplace_back(); // Add identity pose back
@@ -251,6 +383,8 @@ void Toucan::ShowLinePlot2D(const std::string& name, const Toucan::Buffer<Toucan
 	validate_initialized(PopPose2D)
 	auto& context = *toucan_context_ptr;
 	validate_active_figure2d(PopPose2D)
+	record_call(ShowLinePlot2D, true, name, line_buffer, draw_layer, settings)
+	return_if_shown_by_viewer()
 	auto& current_figure = *context.current_figure_2d;
 	
 	auto& current_element = get_or_create_element_2d(current_figure, name, draw_layer, Toucan::ElementType2D::LinePlot2D);
@@ -276,6 +410,8 @@ void Toucan::ShowPoints2D(const std::string& name, const Buffer <Point2D>& point
 	validate_initialized(ShowPoints2D)
 	auto& context = *toucan_context_ptr;
 	validate_active_figure2d(ShowPoints2D)
+	record_call(ShowPoints2D, true, name, points_buffer, draw_layer, settings)
+	return_if_shown_by_viewer()
 	auto& current_figure = *context.current_figure_2d;
 	
 	auto& current_element = get_or_create_element_2d(current_figure, name, draw_layer, Toucan::ElementType2D::Point2D);
@@ -305,6 +441,10 @@ void Toucan::ShowImage2D(const std::string& name, const Image2D& image, int draw
 	auto& current_figure = *context.current_figure_2d;
 	
 	assert(image.width > 0 and image.height > 0 and image.image_buffer_ptr != nullptr);
+	assert(image.format != ImageFormat::YUYV or image.width % 2 == 0);
+	
+	record_call(ShowImage2D, true, name, image.width, image.height, image.format, CaptureField(image.image_buffer_ptr, get_image_size_in_bytes(image.format, image.width, image.height)), draw_layer, settings)
+	return_if_shown_by_viewer()
 	
 	auto& current_element = get_or_create_element_2d(current_figure, name, draw_layer, Toucan::ElementType2D::Image2D);
 	
@@ -316,9 +456,7 @@ void Toucan::ShowImage2D(const std::string& name, const Image2D& image, int draw
 		current_element.data_buffer_ptr = nullptr;
 	}
 	
-	size_t bytes_per_pixel = get_bytes_per_pixel(image.format);
-	
-	const size_t data_buffer_size = bytes_per_pixel*image.width*image.height;
+	const size_t data_buffer_size = get_image_size_in_bytes(image.format, image.width, image.height);
 	
 	current_element.data_buffer_ptr = std::malloc(data_buffer_size);
 	std::memcpy(current_element.data_buffer_ptr, image.image_buffer_ptr, data_buffer_size);
@@ -330,10 +468,148 @@ void Toucan::ShowImage2D(const std::string& name, const Image2D& image, int draw
 	current_element.image_2d_metadata.settings = settings;
 }
 
+void Toucan::ShowTiledImage2D(const std::string& name, const Image2D& image, int draw_layer, const ShowTiledImage2DSettings& settings) {
+	validate_initialized(ShowTiledImage2D)
+	auto& context = *toucan_context_ptr;
+	validate_active_figure2d(ShowTiledImage2D)
+	auto& current_figure = *context.current_figure_2d;
+	
+	assert(image.width > 0 and image.height > 0 and image.image_buffer_ptr != nullptr);
+	assert(settings.tile_size > 0);
+	
+	if (is_camera_image_format(image.format)) {
+		throw std::runtime_error("Toucan error! ShowTiledImage2D does not support NV12, YUYV or Bayer images.");
+	}
+	
+	record_call(ShowTiledImage2D, true, name, image.width, image.height, image.format, CaptureField(image.image_buffer_ptr, get_bytes_per_pixel(image.format)*image.width*image.height), draw_layer, settings)
+	return_if_shown_by_viewer()
+	
+	auto& current_element = get_or_create_element_2d(current_figure, name, draw_layer, Toucan::ElementType2D::TiledImage2D);
+	
+	current_element.pose = current_figure.pose_stack.back();
+	
+	// Drop any existing draw data that has not yet been sent to the GPU
+	if (current_element.data_buffer_ptr != nullptr) {
+		std::free(current_element.data_buffer_ptr);
+		current_element.data_buffer_ptr = nullptr;
+	}
+	
+	const size_t data_buffer_size = get_bytes_per_pixel(image.format)*image.width*image.height;
+	
+	// The render thread hands this buffer over to the tiled image as its full resolution level.
+	current_element.data_buffer_ptr = std::malloc(data_buffer_size);
+	std::memcpy(current_element.data_buffer_ptr, image.image_buffer_ptr, data_buffer_size);
+	
+	current_element.tiled_image_2d_metadata.width = image.width;
+	current_element.tiled_image_2d_metadata.height = image.height;
+	current_element.tiled_image_2d_metadata.format = image.format;
+	current_element.tiled_image_2d_metadata.settings = settings;
+}
+
+// Calls `function` with the frame exporter of the Figure2D or Figure3D named `figure_name`, while the figure is locked. Returns false if there is no such figure.
+template<typename Function>
+bool with_frame_exporter(const std::string& figure_name, Function function) {
+	for (auto& figure_2d : toucan_context_ptr->figures_2d) {
+		if (figure_2d.name == figure_name) {
+			std::lock_guard lock(figure_2d.mutex);
+			function(figure_2d.frame_exporter);
+			return true;
+		}
+	}
+	
+	for (auto& figure_3d : toucan_context_ptr->figures_3d) {
+		if (figure_3d.name == figure_name) {
+			std::lock_guard lock(figure_3d.mutex);
+			function(figure_3d.frame_exporter);
+			return true;
+		}
+	}
+	
+	return false;
+}
+
+// Waits until the frame exporter of the figure is finished, and removes it from the figure.
+size_t finish_frame_export(const std::string& figure_name, bool stop) {
+	Toucan::FrameExporter* frame_exporter_ptr = nullptr;
+	with_frame_exporter(figure_name, [&](std::unique_ptr<Toucan::FrameExporter>& frame_exporter) {
+		frame_exporter_ptr = frame_exporter.get();
+		if (frame_exporter_ptr != nullptr and stop) {
+			frame_exporter_ptr->request_stop();
+		}
+	});
+	
+	if (frame_exporter_ptr == nullptr) { throw std::runtime_error("Toucan error! 'Toucan::StopFrameExport' was called for a figure that is not exported. Did you forget to call 'Toucan::StartFrameExport'?"); }
+	
+	// The exporter stays in the figure until the render thread has released it.
+	const auto remove_frame_exporter = [&]() {
+		with_frame_exporter(figure_name, [](std::unique_ptr<Toucan::FrameExporter>& frame_exporter) { frame_exporter.reset(); });
+		--toucan_context_ptr->number_of_frame_exports;
+	};
+	
+	size_t number_of_written_frames = 0;
+	try {
+		number_of_written_frames = frame_exporter_ptr->finish();
+	} catch (const std::runtime_error&) {
+		remove_frame_exporter();
+		throw;
+	}
+	remove_frame_exporter();
+	
+	return number_of_written_frames;
+}
+
+void Toucan::StartFrameExport(const std::string& figure_name, const FrameExportSettings& settings) {
+	validate_initialized(StartFrameExport)
+	// The figures stay locked until they end, and the render thread must lock them to export their frames.
+	validate_inactive_figure2d(StartFrameExport)
+	validate_inactive_figure3d(StartFrameExport)
+	validate_inactive_input_window(StartFrameExport)
+	if (toucan_context_ptr->shared_memory_writer_ptr != nullptr or toucan_context_ptr->network_writer_ptr != nullptr) { throw std::runtime_error("Toucan error! 'Toucan::StartFrameExport' was called in a process where the figures are rendered by a viewer. Export the frames from the viewer instead."); }
+	
+	bool already_exported = false;
+	bool window_closed = false;
+	const bool figure_exists = with_frame_exporter(figure_name, [&](std::unique_ptr<Toucan::FrameExporter>& frame_exporter) {
+		already_exported = frame_exporter != nullptr;
+		window_closed = toucan_context_ptr->frame_exports_closed;
+		if (not already_exported and not window_closed) {
+			frame_exporter = std::make_unique<Toucan::FrameExporter>(settings, toucan_context_ptr->thread_pool);
+			++toucan_context_ptr->number_of_frame_exports;
+		}
+	});
+	
+	if (not figure_exists) { throw std::runtime_error("Toucan error! 'Toucan::StartFrameExport' was called with the name of a figure that does not exist: '" + figure_name + "'."); }
+	if (already_exported) { throw std::runtime_error("Toucan error! 'Toucan::StartFrameExport' was called for a figure that already is exported. Did you forget to call 'Toucan::StopFrameExport'?"); }
+	if (window_closed) { throw std::runtime_error("Toucan error! 'Toucan::StartFrameExport' was called after the window was closed."); }
+}
+
+size_t Toucan::StopFrameExport(const std::string& figure_name) {
+	validate_initialized(StopFrameExport)
+	validate_inactive_figure2d(StopFrameExport)
+	validate_inactive_figure3d(StopFrameExport)
+	validate_inactive_input_window(StopFrameExport)
+	return finish_frame_export(figure_name, true);
+}
+
+void Toucan::SaveScreenshot(const std::string& figure_name, const std::string& file_path) {
+	validate_initialized(SaveScreenshot)
+	validate_inactive_figure2d(SaveScreenshot)
+	validate_inactive_figure3d(SaveScreenshot)
+	validate_inactive_input_window(SaveScreenshot)
+	
+	FrameExportSettings settings;
+	settings.file_path = file_path;
+	settings.number_of_frames = 1;
+	StartFrameExport(figure_name, settings);
+	
+	// The exporter is released by the render thread after the first frame.
+	if (finish_frame_export(figure_name, false) == 0) { throw std::runtime_error("Toucan error! 'Toucan::SaveScreenshot' could not save the screenshot, the window was closed before the figure was drawn."); }
+}
+
 void Toucan::BeginFigure3D(const std::string& name, const Toucan::Figure3DSettings& settings) {
 	validate_initialized(BeginFigure3D)
 	auto& toucan_context = * toucan_context_ptr;
 	validate_inactive_figure3d(BeginFigure3D)
+	record_call(BeginFigure3D, false, name, settings)
 	
 	Toucan::Figure3D* figure_3d_ptr = nullptr;
 	for (auto& figure_3d : toucan_context.figures_3d) { // Does the Figure2D already exists?
@@ -353,6 +629,7 @@ void Toucan::BeginFigure3D(const std::string& name, const Toucan::Figure3DSettin
 		grid_element.data_buffer_ptr = reinterpret_cast<void*>(1); // Use this to signify new data
 		grid_element.grid_3d_metadata.spacing = 1.0;
 		grid_element.grid_3d_metadata.lines = 20;
+		grid_element.grid_3d_metadata.line_vertices_ptr = nullptr;
 		
 		figure_3d.elements.emplace_back(grid_element);
 		
@@ -373,6 +650,7 @@ void Toucan::EndFigure3D() {
 	validate_initialized(EndFigure3D)
 	auto& toucan_context = *toucan_context_ptr;
 	validate_active_figure3d(EndFigure3D)
+	record_call(EndFigure3D, false)
 	auto& figure_3d = *toucan_context.current_figure_3d;
 	
 	figure_3d.pose_stack.clear();
@@ -385,6 +663,7 @@ void Toucan::PushPose3D(const Toucan::RigidTransform3Df& pose) {
 	validate_initialized(PushPose3D)
 	auto& context = *toucan_context_ptr;
 	validate_active_figure3d(PushPose3D)
+	record_call(PushPose3D, false, pose)
 	auto& current_figure = *context.current_figure_3d;
 	
 	const auto& parent_pose = current_figure.pose_stack.back();
@@ -398,6 +677,7 @@ void Toucan::PopPose3D() {
 	auto& current_figure = *context.current_figure_3d;
 	
 	if (current_figure.pose_stack.size() <= 1) { throw std::runtime_error("Toucan error! 'Toucan::PopPose3D' was called without a matching call to `Toucan::PushPose3D`."); }
+	record_call(PopPose3D, false)
 	
 	current_figure.pose_stack.pop_back();
 }
@@ -409,6 +689,7 @@ void Toucan::ClearPose3D() {
 	auto& current_figure = *context.current_figure_3d;
 	
 	if (current_figure.pose_stack.size() <= 1) { throw std::runtime_error("Toucan error! 'Toucan::ClearPose3D' was called without any matching call to `Toucan::PushPose3D`."); }
+	record_call(ClearPose3D, false)
 	
 	current_figure.pose_stack.clear();
 	current_figure.pose_stack.emplace_back(); // Add identity pose back
@@ -418,6 +699,8 @@ void Toucan::ShowAxis3D(const std::string& name, const ShowAxis3DSettings& setti
 	validate_initialized(ShowAxis3D)
 	auto& context = *toucan_context_ptr;
 	validate_active_figure3d(ShowAxis3D)
+	record_call(ShowAxis3D, true, name, settings)
+	return_if_shown_by_viewer()
 	auto& current_figure = *context.current_figure_3d;
 	
 	auto& current_element = get_or_create_element_3d(current_figure, name, Toucan::ElementType3D::Axis3D);
@@ -432,6 +715,8 @@ void Toucan::ShowPoints3D(const std::string& name, const Toucan::Buffer<Toucan::
 	validate_initialized(ShowPoints3D)
 	auto& context = *toucan_context_ptr;
 	validate_active_figure3d(ShowPoints3D)
+	record_call(ShowPoints3D, true, name, points_buffer, settings)
+	return_if_shown_by_viewer()
 	auto& current_figure = *context.current_figure_3d;
 	
 	auto& current_element = get_or_create_element_3d(current_figure, name, Toucan::ElementType3D::Point3D);
@@ -458,6 +743,8 @@ void Toucan::ShowLines3D(const std::string& name, const Toucan::Buffer<Toucan::L
 	validate_initialized(ShowLines3D)
 	auto& context = *toucan_context_ptr;
 	validate_active_figure3d(ShowLines3D)
+	record_call(ShowLines3D, true, name, lines_buffer, settings)
+	return_if_shown_by_viewer()
 	auto& current_figure = *context.current_figure_3d;
 	
 	auto& current_element = get_or_create_element_3d(current_figure, name, Toucan::ElementType3D::Line3D);
@@ -483,6 +770,8 @@ void Toucan::ShowPrimitives3D(const std::string& name, const Toucan::Buffer<Touc
 	validate_initialized(ShowPrimitives3D)
 	auto& context = *toucan_context_ptr;
 	validate_active_figure3d(ShowPrimitives3D)
+	record_call(ShowPrimitives3D, true, name, primitives_buffer, settings)
+	return_if_shown_by_viewer()
 	auto& current_figure = *context.current_figure_3d;
 	
 	auto& current_element = get_or_create_element_3d(current_figure, name, Toucan::ElementType3D::Primitive3D);
@@ -504,10 +793,94 @@ void Toucan::ShowPrimitives3D(const std::string& name, const Toucan::Buffer<Touc
 	current_element.primitive_3d_metadata.settings = settings;
 }
 
+void Toucan::ShowText3D(const std::string& name, const Toucan::Buffer<Toucan::Text3DLabel>& labels_buffer, const ShowText3DSettings& settings) {
+	validate_initialized(ShowText3D)
+	auto& context = *toucan_context_ptr;
+	validate_active_figure3d(ShowText3D)
+	record_call(ShowText3D, true, name, labels_buffer, settings)
+	return_if_shown_by_viewer()
+	auto& current_figure = *context.current_figure_3d;
+	
+	auto& current_element = get_or_create_element_3d(current_figure, name, Toucan::ElementType3D::Text3D);
+	
+	current_element.pose = current_figure.pose_stack.back();
+	
+	// Drop any existing draw data that has not yet been sent to the GPU
+	if (current_element.data_buffer_ptr != nullptr) {
+		std::free(current_element.data_buffer_ptr); // TODO(Matias): Check if this happens often. Could be a problem.
+		current_element.data_buffer_ptr = nullptr;
+	}
+	
+	const size_t data_buffer_size = sizeof(Toucan::Text3DLabel)*labels_buffer.number_of_elements;
+	
+	current_element.data_buffer_ptr = std::malloc(data_buffer_size);
+	std::memcpy(current_element.data_buffer_ptr, labels_buffer.data_ptr, data_buffer_size);
+	
+	current_element.text_3d_metadata.number_of_labels = labels_buffer.number_of_elements;
+	current_element.text_3d_metadata.settings = settings;
+}
+
+void Toucan::ShowDepthImage3D(const std::string& name, const Image2D& depth_image, const Image2D& color_image, const CameraIntrinsics& intrinsics, float depth_scale, const ShowDepthImage3DSettings& settings) {
+	validate_initialized(ShowDepthImage3D)
+	auto& context = *toucan_context_ptr;
+	validate_active_figure3d(ShowDepthImage3D)
+	auto& current_figure = *context.current_figure_3d;
+	
+	assert(depth_image.width > 0 and depth_image.height > 0 and depth_image.image_buffer_ptr != nullptr);
+	assert(color_image.width > 0 and color_image.height > 0 and color_image.image_buffer_ptr != nullptr);
+	
+	if (depth_image.format != ImageFormat::GRAY_U8 and depth_image.format != ImageFormat::GRAY_U16 and depth_image.format != ImageFormat::GRAY_S16) {
+		throw std::runtime_error("Toucan error! The depth image of ShowDepthImage3D must be a single channel image.");
+	}
+	if (color_image.format == ImageFormat::RG_U32 or color_image.format == ImageFormat::RGB_U32 or color_image.format == ImageFormat::BGR_U32) {
+		throw std::runtime_error("Toucan error! The color image of ShowDepthImage3D can not have integer pixels.");
+	}
+	if (is_camera_image_format(color_image.format)) {
+		throw std::runtime_error("Toucan error! ShowDepthImage3D does not support NV12, YUYV or Bayer color images.");
+	}
+	
+	record_call(ShowDepthImage3D, true,
+		name,
+		depth_image.width, depth_image.height, depth_image.format, CaptureField(depth_image.image_buffer_ptr, get_bytes_per_pixel(depth_image.format)*depth_image.width*depth_image.height),
+		color_image.width, color_image.height, color_image.format, CaptureField(color_image.image_buffer_ptr, get_bytes_per_pixel(color_image.format)*color_image.width*color_image.height),
+		intrinsics, depth_scale, settings)
+	return_if_shown_by_viewer()
+	
+	auto& current_element = get_or_create_element_3d(current_figure, name, Toucan::ElementType3D::DepthImage3D);
+	
+	current_element.pose = current_figure.pose_stack.back();
+	
+	// Drop any existing draw data that has not yet been sent to the GPU
+	if (current_element.data_buffer_ptr != nullptr) {
+		std::free(current_element.data_buffer_ptr); // TODO(Matias): Check if this happens often. Could be a problem.
+		current_element.data_buffer_ptr = nullptr;
+	}
+	
+	// The depth pixels are followed by the color pixels in the same buffer.
+	const size_t depth_buffer_size = get_bytes_per_pixel(depth_image.format)*depth_image.width*depth_image.height;
+	const size_t color_buffer_size = get_bytes_per_pixel(color_image.format)*color_image.width*color_image.height;
+	
+	current_element.data_buffer_ptr = std::malloc(depth_buffer_size + color_buffer_size);
+	std::memcpy(current_element.data_buffer_ptr, depth_image.image_buffer_ptr, depth_buffer_size);
+	std::memcpy(reinterpret_cast<uint8_t*>(current_element.data_buffer_ptr) + depth_buffer_size, color_image.image_buffer_ptr, color_buffer_size);
+	
+	auto& depth_image_3d_metadata = current_element.depth_image_3d_metadata;
+	depth_image_3d_metadata.depth_width = depth_image.width;
+	depth_image_3d_metadata.depth_height = depth_image.height;
+	depth_image_3d_metadata.depth_format = depth_image.format;
+	depth_image_3d_metadata.color_width = color_image.width;
+	depth_image_3d_metadata.color_height = color_image.height;
+	depth_image_3d_metadata.color_format = color_image.format;
+	depth_image_3d_metadata.intrinsics = intrinsics;
+	depth_image_3d_metadata.depth_scale = depth_scale;
+	depth_image_3d_metadata.settings = settings;
+}
+
 void Toucan::BeginInputWindow(const std::string& name, const InputSettings& settings) {
 	validate_initialized(BeginInputWindow)
 	auto& toucan_context = * toucan_context_ptr;
 	validate_inactive_input_window(BeginFigure3D)
+	record_call(BeginInputWindow, false, name, settings)
 	
 	Toucan::InputWindow* input_window_ptr = nullptr;
 	for (auto& input_window : toucan_context.input_windows) { // Does the InputWindow already exists
@@ -533,6 +906,7 @@ void Toucan::EndInputWindow() {
 	validate_initialized(BeginInputWindow)
 	auto& toucan_context = * toucan_context_ptr;
 	validate_active_input_window(BeginInputWindow)
+	record_call(EndInputWindow, false)
 	
 	toucan_context.current_input_window->mutex.unlock();
 	toucan_context.current_input_window = nullptr;
@@ -542,6 +916,8 @@ bool Toucan::ShowButton(const std::string& name, const ShowButtonSettings& setti
 	validate_initialized(ShowButton)
 	auto& toucan_context = * toucan_context_ptr;
 	validate_active_input_window(ShowButton)
+	record_call(ShowButton, true, name, settings)
+	return_if_shown_by_viewer(false)
 	auto& current_input_window = *toucan_context.current_input_window;
 	
 	auto& current_element = get_or_create_element_input(current_input_window, name, Toucan::ElementInputType::BUTTON);
@@ -559,6 +935,8 @@ bool Toucan::ShowCheckbox(const std::string& name, bool& value, const ShowCheckb
 	validate_initialized(ShowSliderFloat)
 	auto &toucan_context = *toucan_context_ptr;
 	validate_active_input_window(ShowSliderFloat)
+	record_call(ShowCheckbox, true, name, value, settings)
+	return_if_shown_by_viewer(false)
 	auto &current_input_window = *toucan_context.current_input_window;
 	
 	auto &current_element = get_or_create_element_input(current_input_window, name, Toucan::ElementInputType::CHECKBOX);
@@ -578,6 +956,8 @@ bool Toucan::ShowSliderFloat(const std::string& name, float& value, const ShowSl
 	validate_initialized(ShowSliderFloat)
 	auto& toucan_context = * toucan_context_ptr;
 	validate_active_input_window(ShowSliderFloat)
+	record_call(ShowSliderFloat, true, name, value, settings)
+	return_if_shown_by_viewer(false)
 	auto& current_input_window = *toucan_context.current_input_window;
 	
 	auto& current_element = get_or_create_element_input(current_input_window, name, Toucan::ElementInputType::SLIDER_FLOAT);
@@ -597,6 +977,8 @@ bool Toucan::ShowSliderFloat2(const std::string& name, Vector2f& value, const Sh
 	validate_initialized(ShowSliderFloat)
 	auto& toucan_context = * toucan_context_ptr;
 	validate_active_input_window(ShowSliderFloat)
+	record_call(ShowSliderFloat2, true, name, value, settings)
+	return_if_shown_by_viewer(false)
 	auto& current_input_window = *toucan_context.current_input_window;
 	
 	auto& current_element = get_or_create_element_input(current_input_window, name, Toucan::ElementInputType::SLIDER_FLOAT2);
@@ -616,6 +998,8 @@ bool Toucan::ShowSliderFloat3(const std::string& name, Vector3f& value, const Sh
 	validate_initialized(ShowSliderFloat)
 	auto& toucan_context = * toucan_context_ptr;
 	validate_active_input_window(ShowSliderFloat)
+	record_call(ShowSliderFloat3, true, name, value, settings)
+	return_if_shown_by_viewer(false)
 	auto& current_input_window = *toucan_context.current_input_window;
 	
 	auto& current_element = get_or_create_element_input(current_input_window, name, Toucan::ElementInputType::SLIDER_FLOAT3);
@@ -635,6 +1019,8 @@ bool Toucan::ShowSliderFloat4(const std::string& name, Vector4f& value, const Sh
 	validate_initialized(ShowSliderFloat)
 	auto& toucan_context = * toucan_context_ptr;
 	validate_active_input_window(ShowSliderFloat)
+	record_call(ShowSliderFloat4, true, name, value, settings)
+	return_if_shown_by_viewer(false)
 	auto& current_input_window = *toucan_context.current_input_window;
 	
 	auto& current_element = get_or_create_element_input(current_input_window, name, Toucan::ElementInputType::SLIDER_FLOAT4);
@@ -654,6 +1040,8 @@ bool Toucan::ShowSliderInt(const std::string& name, int& value, const ShowSlider
 	validate_initialized(ShowSliderFloat)
 	auto& toucan_context = * toucan_context_ptr;
 	validate_active_input_window(ShowSliderFloat)
+	record_call(ShowSliderInt, true, name, value, settings)
+	return_if_shown_by_viewer(false)
 	auto& current_input_window = *toucan_context.current_input_window;
 	
 	auto& current_element = get_or_create_element_input(current_input_window, name, Toucan::ElementInputType::SLIDER_INT);
@@ -673,6 +1061,8 @@ bool Toucan::ShowSliderInt2(const std::string& name, Vector2i& value, const Show
 	validate_initialized(ShowSliderFloat)
 	auto& toucan_context = * toucan_context_ptr;
 	validate_active_input_window(ShowSliderFloat)
+	record_call(ShowSliderInt2, true, name, value, settings)
+	return_if_shown_by_viewer(false)
 	auto& current_input_window = *toucan_context.current_input_window;
 	
 	auto& current_element = get_or_create_element_input(current_input_window, name, Toucan::ElementInputType::SLIDER_INT2);
@@ -692,6 +1082,8 @@ bool Toucan::ShowSliderInt3(const std::string& name, Vector3i& value, const Show
 	validate_initialized(ShowSliderFloat)
 	auto& toucan_context = * toucan_context_ptr;
 	validate_active_input_window(ShowSliderFloat)
+	record_call(ShowSliderInt3, true, name, value, settings)
+	return_if_shown_by_viewer(false)
 	auto& current_input_window = *toucan_context.current_input_window;
 	
 	auto& current_element = get_or_create_element_input(current_input_window, name, Toucan::ElementInputType::SLIDER_INT3);
@@ -711,6 +1103,8 @@ bool Toucan::ShowSliderInt4(const std::string& name, Vector4i& value, const Show
 	validate_initialized(ShowSliderFloat)
 	auto& toucan_context = * toucan_context_ptr;
 	validate_active_input_window(ShowSliderFloat)
+	record_call(ShowSliderInt4, true, name, value, settings)
+	return_if_shown_by_viewer(false)
 	auto& current_input_window = *toucan_context.current_input_window;
 	
 	auto& current_element = get_or_create_element_input(current_input_window, name, Toucan::ElementInputType::SLIDER_INT4);
@@ -730,6 +1124,8 @@ bool Toucan::ShowColorPicker(const std::string& name, Color& value, const ShowCo
 	validate_initialized(ShowSliderFloat)
 	auto& toucan_context = * toucan_context_ptr;
 	validate_active_input_window(ShowSliderFloat)
+	record_call(ShowColorPicker, true, name, value, settings)
+	return_if_shown_by_viewer(false)
 	auto& current_input_window = *toucan_context.current_input_window;
 	
 	auto& current_element = get_or_create_element_input(current_input_window, name, Toucan::ElementInputType::COLOR_PICKER);
@@ -745,99 +1141,106 @@ bool Toucan::ShowColorPicker(const std::string& name, Color& value, const ShowCo
 	}
 }
 
-Toucan::Rectangle get_lineplot_2d_data_bounds(const Toucan::Element2D& element_2d, const Toucan::RigidTransform2Df& local_transform) {
-	assert(element_2d.type == Toucan::ElementType2D::LinePlot2D);
-	
-	const Toucan::ScaledTransform2Df& data_transform = element_2d.line_plot_2d_metadata.settings.scaled_transform;
-	auto* point_2d_data_ptr = reinterpret_cast<Toucan::Vector2f*>(element_2d.data_buffer_ptr);
-	
-	auto min_x =  std::numeric_limits<float>::infinity();
-	auto max_x = -std::numeric_limits<float>::infinity();
-	auto min_y =  std::numeric_limits<float>::infinity();
-	auto max_y = -std::numeric_limits<float>::infinity();
-	
-	for (int point_2d_data_index = 0; point_2d_data_index < element_2d.line_plot_2d_metadata.number_of_points; ++point_2d_data_index) {
-		const Toucan::Vector2f local_point = point_2d_data_ptr[point_2d_data_index];
-		const Toucan::Vector2f global_point = local_transform * (data_transform * local_point);
-		const auto& x = global_point.x();
-		const auto& y = global_point.y();
-		
-		min_x = std::min(min_x, x);
-		max_x = std::max(max_x, x);
-		min_y = std::min(min_y, y);
-		max_y = std::max(max_y, y);
+// Bounds of the element data before the pose and data transform is applied. Only needs to be recomputed when there is new data.
+Toucan::Rectangle compute_element_2d_data_bounds(const Toucan::Element2D& element_2d, Toucan::ThreadPool& thread_pool) {
+	switch (element_2d.type) {
+		case Toucan::ElementType2D::LinePlot2D: {
+			return Toucan::compute_data_bounds(reinterpret_cast<const Toucan::Vector2f*>(element_2d.data_buffer_ptr), element_2d.line_plot_2d_metadata.number_of_points, thread_pool);
+		}
+		case Toucan::ElementType2D::Point2D: {
+			return Toucan::compute_data_bounds(reinterpret_cast<const Toucan::Point2D*>(element_2d.data_buffer_ptr), element_2d.point_2d_metadata.number_of_points, thread_pool);
+		}
+		case Toucan::ElementType2D::Image2D: {
+			unsigned int image_draw_width = element_2d.image_2d_metadata.settings.image_display_width;
+			if (image_draw_width == 0) { image_draw_width = element_2d.image_2d_metadata.width; }
+			unsigned int image_draw_height = element_2d.image_2d_metadata.settings.image_display_height;
+			if (image_draw_height == 0) { image_draw_height = element_2d.image_2d_metadata.height; }
+			
+			return Toucan::Rectangle(Toucan::Vector2f::Zero(), Toucan::Vector2f(static_cast<float>(image_draw_width), static_cast<float>(image_draw_height)));
+		}
+		case Toucan::ElementType2D::TiledImage2D: {
+			const auto& tiled_image_2d_metadata = element_2d.tiled_image_2d_metadata;
+			const unsigned int image_draw_width = tiled_image_2d_metadata.settings.image_display_width != 0 ? tiled_image_2d_metadata.settings.image_display_width : tiled_image_2d_metadata.width;
+			const unsigned int image_draw_height = tiled_image_2d_metadata.settings.image_display_height != 0 ? tiled_image_2d_metadata.settings.image_display_height : tiled_image_2d_metadata.height;
+			
+			return Toucan::Rectangle(Toucan::Vector2f::Zero(), Toucan::Vector2f(static_cast<float>(image_draw_width), static_cast<float>(image_draw_height)));
+		}
 	}
 	
-	assert(min_x <= max_x and min_y <= max_y);
-	assert(not std::isinf(min_x) and not std::isinf(max_x) and not std::isinf(min_y) and not std::isinf(max_y));
-	
-	return Toucan::Rectangle(Toucan::Vector2f(min_x, min_y), Toucan::Vector2f(max_x, max_y));
+	return Toucan::Rectangle();
 }
 
-Toucan::Rectangle get_point_2d_data_bounds(const Toucan::Element2D& element_2d, const Toucan::RigidTransform2Df& local_transform) {
-	assert(element_2d.type == Toucan::ElementType2D::Point2D);
-	
-	const Toucan::ScaledTransform2Df& data_transform = element_2d.point_2d_metadata.settings.scaled_transform;
-	auto* point_2d_data_ptr = reinterpret_cast<Toucan::Point2D*>(element_2d.data_buffer_ptr);
-	
-	auto min_x =  std::numeric_limits<float>::infinity();
-	auto max_x = -std::numeric_limits<float>::infinity();
-	auto min_y =  std::numeric_limits<float>::infinity();
-	auto max_y = -std::numeric_limits<float>::infinity();
-	
-	for (int point_2d_data_index = 0; point_2d_data_index < element_2d.point_2d_metadata.number_of_points; ++point_2d_data_index) {
-		const Toucan::Vector2f local_point = point_2d_data_ptr[point_2d_data_index].position;
-		const Toucan::Vector2f global_point = local_transform * (data_transform * local_point);
-		const auto& x = global_point.x();
-		const auto& y = global_point.y();
-		
-		min_x = std::min(min_x, x);
-		max_x = std::max(max_x, x);
-		min_y = std::min(min_y, y);
-		max_y = std::max(max_y, y);
+// Bounds of the element in the figure, from the transformed corners of the cached data bounds.
+Toucan::Rectangle get_element_2d_figure_bounds(const Toucan::Element2D& element_2d) {
+	const Toucan::RigidTransform2Df& local_transform = element_2d.pose;
+	
+	switch (element_2d.type) {
+		case Toucan::ElementType2D::LinePlot2D: {
+			const Toucan::ScaledTransform2Df& data_transform = element_2d.line_plot_2d_metadata.settings.scaled_transform;
+			return Toucan::get_transformed_bounds(element_2d.data_bounds_cache, [&](const Toucan::Vector2f& point) { return local_transform * (data_transform * point); });
+		}
+		case Toucan::ElementType2D::Point2D: {
+			const Toucan::ScaledTransform2Df& data_transform = element_2d.point_2d_metadata.settings.scaled_transform;
+			return Toucan::get_transformed_bounds(element_2d.data_bounds_cache, [&](const Toucan::Vector2f& point) { return local_transform * (data_transform * point); });
+		}
+		case Toucan::ElementType2D::Image2D: {
+			return Toucan::get_transformed_bounds(element_2d.data_bounds_cache, [&](const Toucan::Vector2f& point) { return local_transform * point; });
+		}
+		case Toucan::ElementType2D::TiledImage2D: {
+			const Toucan::ScaledTransform2Df& data_transform = element_2d.tiled_image_2d_metadata.settings.scaled_transform;
+			return Toucan::get_transformed_bounds(element_2d.data_bounds_cache, [&](const Toucan::Vector2f& point) { return local_transform * (data_transform * point); });
+		}
 	}
 	
-	assert(min_x <= max_x and min_y <= max_y);
-	assert(not std::isinf(min_x) and not std::isinf(max_x) and not std::isinf(min_y) and not std::isinf(max_y));
-	
-	return Toucan::Rectangle(Toucan::Vector2f(min_x, min_y), Toucan::Vector2f(max_x, max_y));
+	return element_2d.data_bounds_cache;
 }
 
-Toucan::Rectangle get_image_2d_data_bounds(const Toucan::Element2D& element_2d, const Toucan::RigidTransform2Df& local_transform) {
-	assert(element_2d.type == Toucan::ElementType2D::Image2D);
-	
-	unsigned int image_draw_width = element_2d.image_2d_metadata.settings.image_display_width;
-	if (image_draw_width == 0) { image_draw_width = element_2d.image_2d_metadata.width; }
-	unsigned int image_draw_height = element_2d.image_2d_metadata.settings.image_display_height;
-	if (image_draw_height == 0) { image_draw_height = element_2d.image_2d_metadata.height; }
-	
-	const std::array<Toucan::Vector2f, 4> image_corners = {
-			local_transform * Toucan::Vector2f(0.0f, 0.0f),
-			local_transform * Toucan::Vector2f(static_cast<float>(image_draw_width), 0.0f),
-			local_transform * Toucan::Vector2f(0.0f, static_cast<float>(image_draw_height)),
-			local_transform * Toucan::Vector2f(static_cast<float>(image_draw_width), static_cast<float>(image_draw_height))
-	};
-	
-	auto min_x =  std::numeric_limits<float>::infinity();
-	auto max_x = -std::numeric_limits<float>::infinity();
-	auto min_y =  std::numeric_limits<float>::infinity();
-	auto max_y = -std::numeric_limits<float>::infinity();
-	
-	
-	for (const auto& image_corner : image_corners) {
-		const auto& x = image_corner.x();
-		const auto& y = image_corner.y();
-		
-		min_x = std::min(min_x, x);
-		max_x = std::max(max_x, x);
-		min_y = std::min(min_y, y);
-		max_y = std::max(max_y, y);
+// Elements with new data are bounded in parallel on the thread pool, and large elements are split further inside `compute_data_bounds`.
+void update_element_2d_data_bounds(Toucan::Figure2D& figure_2d, Toucan::ThreadPool& thread_pool) {
+	std::vector<Toucan::Element2D*> updated_elements;
+	for (auto& element_2d : figure_2d.elements) {
+		if (element_2d.data_buffer_ptr != nullptr) {
+			updated_elements.emplace_back(&element_2d);
+		}
 	}
 	
-	assert(min_x <= max_x and min_y <= max_y);
-	assert(not std::isinf(min_x) and not std::isinf(max_x) and not std::isinf(min_y) and not std::isinf(max_y));
+	thread_pool.parallel_for(0, static_cast<int>(updated_elements.size()), 1, [&](int element_begin, int element_end) {
+		for (int element_index = element_begin; element_index < element_end; ++element_index) {
+			updated_elements[element_index]->data_bounds_cache = compute_element_2d_data_bounds(*updated_elements[element_index], thread_pool);
+		}
+	});
+}
+
+// Cancels the octree, pyramid and tiled image builds still queued or running on the thread pool, which otherwise are completed when the
+// pool is destroyed, and releases the labels and layouts kept by the Text3D elements. The GL objects of the elements were deleted
+// together with the GL context.
+void destroy_element_builds(Toucan::ToucanContext& context) {
+	for (auto& figure_2d : context.figures_2d) {
+		for (auto& element_2d : figure_2d.elements) {
+			if (element_2d.type == Toucan::ElementType2D::LinePlot2D and element_2d.line_plot_2d_metadata.decimation_ptr != nullptr) {
+				Toucan::destroy_line_plot_decimation(element_2d.line_plot_2d_metadata.decimation_ptr);
+				element_2d.line_plot_2d_metadata.decimation_ptr = nullptr;
+			} else if (element_2d.type == Toucan::ElementType2D::TiledImage2D and element_2d.tiled_image_2d_metadata.tiled_image_ptr != nullptr) {
+				element_2d.tiled_image_2d_metadata.tiled_image_ptr->resident_tiles.clear();
+				Toucan::destroy_tiled_image(element_2d.tiled_image_2d_metadata.tiled_image_ptr);
+				element_2d.tiled_image_2d_metadata.tiled_image_ptr = nullptr;
+			}
+		}
+	}
 	
-	return Toucan::Rectangle(Toucan::Vector2f(min_x, min_y), Toucan::Vector2f(max_x, max_y));
+	for (auto& figure_3d : context.figures_3d) {
+		for (auto& element_3d : figure_3d.elements) {
+			if (element_3d.type == Toucan::ElementType3D::Point3D and element_3d.point_3d_metadata.octree_ptr != nullptr) {
+				Toucan::destroy_point_octree(element_3d.point_3d_metadata.octree_ptr);
+				element_3d.point_3d_metadata.octree_ptr = nullptr;
+			} else if (element_3d.type == Toucan::ElementType3D::Text3D) {
+				delete element_3d.text_3d_metadata.layout_ptr;
+				element_3d.text_3d_metadata.layout_ptr = nullptr;
+				std::free(element_3d.text_3d_metadata.labels_ptr);
+				element_3d.text_3d_metadata.labels_ptr = nullptr;
+			}
+		}
+	}
 }
 
 void update_figure_2d_view_data(Toucan::Figure2D& figure_2d) {
@@ -849,29 +1252,8 @@ void update_figure_2d_view_data(Toucan::Figure2D& figure_2d) {
 	std::vector<Toucan::Rectangle> data_bounds_vec;
 	data_bounds_vec.reserve(figure_2d.elements.size());
 	
-	for (auto& element_2d : figure_2d.elements) {
-		
-		if (element_2d.data_buffer_ptr == nullptr) { // Use view from cache
-			data_bounds_vec.emplace_back(element_2d.data_bounds_cache);
-		} else { // Compute updated view
-			const Toucan::RigidTransform2Df& local_transform = element_2d.pose;
-			
-			Toucan::Rectangle data_bounds;
-			
-			switch (element_2d.type) {
-				case Toucan::ElementType2D::LinePlot2D: {
-					data_bounds = get_lineplot_2d_data_bounds(element_2d, local_transform);
-				} break;
-				case Toucan::ElementType2D::Point2D: {
-					data_bounds = get_point_2d_data_bounds(element_2d, local_transform);
-				} break;
-				case Toucan::ElementType2D::Image2D: {
-					data_bounds = get_image_2d_data_bounds(element_2d, local_transform);
-				} break;
-			}
-			element_2d.data_bounds_cache = data_bounds;
-			data_bounds_vec.emplace_back(data_bounds);
-		}
+	for (const auto& element_2d : figure_2d.elements) {
+		data_bounds_vec.emplace_back(get_element_2d_figure_bounds(element_2d));
 	}
 	
 	Toucan::Rectangle figure_data_bounds = data_bounds_vec.front();
@@ -947,11 +1329,17 @@ void render_loop(Toucan::ToucanSettings settings) {
 	
 	toucan_context_ptr->initialized_cv.notify_all();
 	
+	// Compile all shader programs up front, while the caller is still producing its first data.
+	enable_parallel_shader_compile(reinterpret_cast<GLProcLoader>(glfwGetProcAddress));
+	initialize_shader_program_cache(&toucan_context_ptr->asset_context.shader_program_cache, settings.shader_cache_directory, reinterpret_cast<GLProcLoader>(glfwGetProcAddress));
+	warm_up_shader_programs(&toucan_context_ptr->asset_context);
+	
 	auto& imgui_style = ImGui::GetStyle();
 	imgui_style.WindowMinSize = ImVec2(200.0f, 200.0f);
 	
 	while (toucan_context_ptr->should_render and not glfwWindowShouldClose(toucan_context_ptr->window_ptr)) {
 		const auto frame_start = std::chrono::steady_clock::now();
+		++toucan_context_ptr->number_of_started_frames;
 		
 		glfwPollEvents();
 		
@@ -1112,6 +1500,20 @@ void render_loop(Toucan::ToucanSettings settings) {
 					figure_2d.user_changed_view = true;
 					view_changed_this_frame = true;
 				}
+
+#ifdef TOUCAN_BENCHMARK_HOOKS
+				if (figure_2d.pan_per_frame.x() != 0.0f or figure_2d.pan_per_frame.y() != 0.0f) {
+					const float delta_x = figure_2d.pan_per_frame.x() * figure_2d.view.width();
+					const float delta_y = figure_2d.pan_per_frame.y() * figure_2d.view.height();
+					
+					figure_2d.view.min.x() += delta_x;
+					figure_2d.view.max.x() += delta_x;
+					figure_2d.view.min.y() += delta_y;
+					figure_2d.view.max.y() += delta_y;
+					figure_2d.user_changed_view = true;
+					view_changed_this_frame = true;
+				}
+#endif
 				
 				if (plot_hovered and ImGui::IsMouseClicked(ImGuiMouseButton_Right)) {
 					ImGui::OpenPopup("popup");
@@ -1134,12 +1536,13 @@ void render_loop(Toucan::ToucanSettings settings) {
 				const bool framebuffer_was_updated = Toucan::update_framebuffer_2d(figure_2d, figure_draw_size);
 				const bool elements_has_new_data = std::any_of(
 						figure_2d.elements.cbegin(), figure_2d.elements.cend(),
-						[](const Toucan::Element2D& element) { return element.data_buffer_ptr != nullptr; }
+						[](const Toucan::Element2D& element) { return Toucan::element_2d_has_pending_update(element); }
 				);
 				
 				// Draw figure
 				if (view_changed_this_frame or framebuffer_was_updated or elements_has_new_data) {
 					if(toucan_context_ptr->rdoc_api) toucan_context_ptr->rdoc_api->StartFrameCapture(nullptr, nullptr);
+					if (figure_2d.frame_exporter != nullptr) { figure_2d.frame_exporter->mark_redrawn(); }
 					glBindFramebuffer(GL_FRAMEBUFFER, figure_2d.framebuffer);
 					glViewport(0, 0, figure_2d.framebuffer_size.x(), figure_2d.framebuffer_size.y());
 					
@@ -1147,6 +1550,7 @@ void render_loop(Toucan::ToucanSettings settings) {
 					glDisable(GL_DEPTH_TEST);
 					glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // NOLINT
 					
+					update_element_2d_data_bounds(figure_2d, toucan_context_ptr->thread_pool);
 					if (not figure_2d.user_changed_view) {
 						update_figure_2d_view_data(figure_2d);
 					}
@@ -1154,7 +1558,7 @@ void render_loop(Toucan::ToucanSettings settings) {
 					const Toucan::Matrix4f view_matrix = create_2d_view_matrix(figure_2d.view, figure_2d.settings.y_axis_direction);
 					for (auto& element : figure_2d.elements) {
 						const auto& model_to_world = element.pose.transformation_matrix_3d();
-						Toucan::draw_element_2d(element, model_to_world, view_matrix, toucan_context_ptr);
+						Toucan::draw_element_2d(element, model_to_world, view_matrix, figure_2d.view, figure_2d.framebuffer_size, toucan_context_ptr);
 					}
 					
 					glCheckError();
@@ -1170,20 +1574,17 @@ void render_loop(Toucan::ToucanSettings settings) {
 				
 				assert(x_axis_from_value < x_axis_to_value);
 				const int number_of_x_ticks = std::max(static_cast<int>(std::floor(axis_x_rect.GetWidth()/min_label_distance)), 2);
-				const auto [x_tick_values, x_tick_strings] = get_axis_ticks(x_axis_from_value, x_axis_to_value, number_of_x_ticks);
-				const auto x_ticks_position = Toucan::data_to_pixel(x_tick_values, x_axis_from_value, x_axis_to_value, axis_x_min.x, axis_x_max.x);
+				update_axis_ticks(figure_2d.x_axis_ticks, x_axis_from_value, x_axis_to_value, axis_x_min.x, axis_x_max.x, number_of_x_ticks);
 				
 				const auto y_axis_from_value = figure_2d.view.min.y();
 				const auto y_axis_to_value = figure_2d.view.max.y();
 				
 				assert(y_axis_from_value < y_axis_to_value);
 				const int number_of_y_ticks = std::max(static_cast<int>(std::floor(axis_y_rect.GetHeight()/min_label_distance)), 2);
-				const auto [y_ticks_values, y_tick_strings] = get_axis_ticks(y_axis_from_value, y_axis_to_value, number_of_y_ticks);
-				std::vector<float> y_ticks_positions;
 				if (figure_2d.settings.y_axis_direction == Toucan::YAxisDirection::UP) {
-					y_ticks_positions = Toucan::data_to_pixel(y_ticks_values, y_axis_from_value, y_axis_to_value, axis_y_max.y, axis_y_min.y);
+					update_axis_ticks(figure_2d.y_axis_ticks, y_axis_from_value, y_axis_to_value, axis_y_max.y, axis_y_min.y, number_of_y_ticks);
 				} else {
-					y_ticks_positions = Toucan::data_to_pixel(y_ticks_values, y_axis_from_value, y_axis_to_value, axis_y_min.y, axis_y_max.y);
+					update_axis_ticks(figure_2d.y_axis_ticks, y_axis_from_value, y_axis_to_value, axis_y_min.y, axis_y_max.y, number_of_y_ticks);
 				}
 				
 				// Background
@@ -1195,14 +1596,13 @@ void render_loop(Toucan::ToucanSettings settings) {
 				window_draw_list->AddRect(axis_x_min, axis_x_max, ImGui::GetColorU32(style.Colors[ImGuiCol_Border]));
 				window_draw_list->PushClipRect(axis_x_min, axis_x_max);
 				
-				for (size_t x_tick_index = 0; x_tick_index < x_tick_strings.size(); ++x_tick_index) {
-					const auto x_tick_string = x_tick_strings.at(x_tick_index);
-					const auto x_tick_position = std::round(x_ticks_position.at(x_tick_index));
+				for (const auto& x_tick : figure_2d.x_axis_ticks.ticks) {
+					const auto x_tick_position = std::round(x_tick.position);
 					
 					window_draw_list->AddLine(ImVec2(x_tick_position, axis_x_min.y), ImVec2(x_tick_position, axis_x_min.y + tick_width), ImGui::GetColorU32(ImVec4(1.0f, 1.0f, 1.0f, 1.0f)), 1.0f);
 					
-					const ImVec2 text_size = ImGui::CalcTextSize(x_tick_string.c_str());
-					window_draw_list->AddText(ImVec2(static_cast<float>(x_tick_position) - 0.5f * text_size.x, axis_x_min.y + 0.5f * axis_x_size), ImGui::GetColorU32(ImVec4(1.0f, 1.0f, 1.0f, 1.0f)), x_tick_string.c_str());
+					const ImVec2 text_size = ImGui::CalcTextSize(x_tick.label);
+					window_draw_list->AddText(ImVec2(static_cast<float>(x_tick_position) - 0.5f * text_size.x, axis_x_min.y + 0.5f * axis_x_size), ImGui::GetColorU32(ImVec4(1.0f, 1.0f, 1.0f, 1.0f)), x_tick.label);
 				}
 				window_draw_list->PopClipRect();
 				
@@ -1210,14 +1610,13 @@ void render_loop(Toucan::ToucanSettings settings) {
 				window_draw_list->AddRect(axis_y_min, axis_y_max, ImGui::GetColorU32(style.Colors[ImGuiCol_Border]));
 				window_draw_list->PushClipRect(axis_y_min, axis_y_max);
 				
-				for (size_t y_tick_index = 0; y_tick_index < y_tick_strings.size(); ++y_tick_index) {
-					const auto y_tick_string = y_tick_strings.at(y_tick_index);
-					const auto y_tick_position = std::round(y_ticks_positions.at(y_tick_index));
+				for (const auto& y_tick : figure_2d.y_axis_ticks.ticks) {
+					const auto y_tick_position = std::round(y_tick.position);
 					
 					window_draw_list->AddLine(ImVec2(axis_y_max.x - tick_width, y_tick_position), ImVec2(axis_y_max.x, y_tick_position), ImGui::GetColorU32(ImVec4(1.0f, 1.0f, 1.0f, 1.0f)), 1.0f);
-					const ImVec2 text_size = ImGui::CalcTextSize(y_tick_string.c_str());
+					const ImVec2 text_size = ImGui::CalcTextSize(y_tick.label);
 					const auto axis_y_width = axis_y_max.x - axis_y_min.x;
-					window_draw_list->AddText(ImVec2(axis_y_min.x + axis_y_width - (tick_width + text_size.x + 3.0f), y_tick_position - 0.5f * text_size.y), ImGui::GetColorU32(ImVec4(1.0f, 1.0f, 1.0f, 1.0f)), y_tick_string.c_str());
+					window_draw_list->AddText(ImVec2(axis_y_min.x + axis_y_width - (tick_width + text_size.x + 3.0f), y_tick_position - 0.5f * text_size.y), ImGui::GetColorU32(ImVec4(1.0f, 1.0f, 1.0f, 1.0f)), y_tick.label);
 				}
 				
 				window_draw_list->PopClipRect();
@@ -1225,12 +1624,12 @@ void render_loop(Toucan::ToucanSettings settings) {
 				// Plot
 				window_draw_list->PushClipRect(plot_min, plot_max);
 				
-				for (size_t x_tick_index = 0; x_tick_index < x_tick_strings.size(); ++x_tick_index) {
-					const auto x_tick_position = std::round(x_ticks_position.at(x_tick_index));
+				for (const auto& x_tick : figure_2d.x_axis_ticks.ticks) {
+					const auto x_tick_position = std::round(x_tick.position);
 					window_draw_list->AddLine(ImVec2(x_tick_position, plot_min.y), ImVec2(x_tick_position, plot_max.y), ImGui::GetColorU32(ImVec4(0.25f, 0.25f, 0.25f, 1.0f)), 1.0f);
 				}
-				for (size_t y_tick_index = 0; y_tick_index < y_tick_strings.size(); ++y_tick_index) {
-					const auto y_tick_position = std::round(y_ticks_positions.at(y_tick_index));
+				for (const auto& y_tick : figure_2d.y_axis_ticks.ticks) {
+					const auto y_tick_position = std::round(y_tick.position);
 					window_draw_list->AddLine(ImVec2(plot_min.x, y_tick_position), ImVec2(plot_max.x, y_tick_position), ImGui::GetColorU32(ImVec4(0.25f, 0.25f, 0.25f, 1.0f)), 1.0f);
 				}
 				window_draw_list->AddImage(reinterpret_cast<void*>(figure_2d.framebuffer_color_texture), plot_min, plot_max);
@@ -1299,16 +1698,24 @@ void render_loop(Toucan::ToucanSettings settings) {
 					figure_3d.camera.change_distance(-0.25f*io.MouseWheel);
 					view_was_changed = true;
 				}
+
+#ifdef TOUCAN_BENCHMARK_HOOKS
+				if (figure_3d.orbit_per_frame.x() != 0.0f or figure_3d.orbit_per_frame.y() != 0.0f) {
+					figure_3d.camera.orbit(figure_3d.orbit_per_frame);
+					view_was_changed = true;
+				}
+#endif
 				
 				// ***** Drawing *****
 				const bool framebuffer_was_updated = Toucan::update_framebuffer_3d(figure_3d, figure_draw_size);
 				const bool elements_has_new_data = std::any_of(
 						figure_3d.elements.cbegin(), figure_3d.elements.cend(),
-						[](const Toucan::Element3D& element) { return element.data_buffer_ptr != nullptr; }
+						[](const Toucan::Element3D& element) { return Toucan::element_3d_has_pending_update(element); }
 				);
 				
 				if (view_was_changed or framebuffer_was_updated or elements_has_new_data) {
 					if(toucan_context_ptr->rdoc_api) toucan_context_ptr->rdoc_api->StartFrameCapture(nullptr, nullptr);
+					if (figure_3d.frame_exporter != nullptr) { figure_3d.frame_exporter->mark_redrawn(); }
 					glBindFramebuffer(GL_FRAMEBUFFER, figure_3d.framebuffer);
 					glViewport(0, 0, figure_3d.framebuffer_size.x(), figure_3d.framebuffer_size.y());
 					
@@ -1324,9 +1731,13 @@ void render_loop(Toucan::ToucanSettings settings) {
 					const auto far_clip = figure_3d.settings.far_clip;
 					const Toucan::Matrix4f projection_matrix = create_3d_projection_matrix<float>(near_clip, far_clip, 1024, figure_draw_size);
 					
+					const Toucan::Matrix4f world_to_clip_matrix = projection_matrix * world_to_camera_matrix;
+					
+					Toucan::prepare_elements_3d(figure_3d, toucan_context_ptr->thread_pool);
 					for (auto& element : figure_3d.elements) {
 						const auto model_to_world_matrix = element.pose.transformation_matrix();
-						Toucan::draw_element_3d(element, model_to_world_matrix, orientation_and_handedness_matrix, world_to_camera_matrix, projection_matrix, toucan_context_ptr);
+						if (not Toucan::is_element_3d_in_view(element, model_to_world_matrix, orientation_and_handedness_matrix, world_to_clip_matrix)) { continue; }
+						Toucan::draw_element_3d(element, model_to_world_matrix, orientation_and_handedness_matrix, world_to_camera_matrix, projection_matrix, figure_3d.framebuffer_size, toucan_context_ptr);
 					}
 					glCheckError();
 					if (figure_3d.settings.show_axis_gizmo) {
@@ -1449,10 +1860,27 @@ void render_loop(Toucan::ToucanSettings settings) {
 			ImGui::End();
 		}
 		
+		// Exported figures are read back even when their window is collapsed or hidden, their framebuffers keep the last image.
+		if (toucan_context_ptr->number_of_frame_exports > 0) {
+			for (auto& figure_2d : toucan_context_ptr->figures_2d) {
+				std::lock_guard lock(figure_2d.mutex);
+				if (figure_2d.frame_exporter != nullptr) {
+					figure_2d.frame_exporter->update(figure_2d.framebuffer, figure_2d.framebuffer_size);
+				}
+			}
+			for (auto& figure_3d : toucan_context_ptr->figures_3d) {
+				std::lock_guard lock(figure_3d.mutex);
+				if (figure_3d.frame_exporter != nullptr) {
+					figure_3d.frame_exporter->update(figure_3d.framebuffer, figure_3d.framebuffer_size);
+				}
+			}
+		}
+		
 		ImGui::Render();
 		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 		
 		glfwSwapBuffers(toucan_context_ptr->window_ptr);
+		++toucan_context_ptr->number_of_presented_frames;
 		
 		const auto frame_end = std::chrono::steady_clock::now();
 		const auto current_frame_duration = frame_end - frame_start;
@@ -1465,6 +1893,17 @@ void render_loop(Toucan::ToucanSettings settings) {
 		}
 	}
 	
+	// The pixel buffers of the frame exporters are deleted while the GL context exists. Exports started after this fail.
+	toucan_context_ptr->frame_exports_closed = true;
+	for (auto& figure_2d : toucan_context_ptr->figures_2d) {
+		std::lock_guard lock(figure_2d.mutex);
+		if (figure_2d.frame_exporter != nullptr) { figure_2d.frame_exporter->release(); }
+	}
+	for (auto& figure_3d : toucan_context_ptr->figures_3d) {
+		std::lock_guard lock(figure_3d.mutex);
+		if (figure_3d.frame_exporter != nullptr) { figure_3d.frame_exporter->release(); }
+	}
+	
 	ImGui::DestroyContext();
 	glfwTerminate();
 	
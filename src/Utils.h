@@ -97,23 +97,6 @@ inline Toucan::Matrix4f create_2d_view_matrix(const Rectangle& draw_view, YAxisD
 	
 }
 
-inline std::vector<float> data_to_pixel(const std::vector<float>& data_coords,
-                                         float data_from_value, float data_to_value, float pixel_from_value, float pixel_to_value) {
-	std::vector<float> pixel_coords;
-	pixel_coords.reserve(data_coords.size());
-	
-	const float data_width = data_to_value - data_from_value;
-	const float pixel_width = pixel_to_value - pixel_from_value;
-	
-	for (auto data_coord : data_coords) {
-		float normalized_coord = (data_coord - data_from_value)/data_width;
-		float pixel_coord = pixel_width*normalized_coord + pixel_from_value;
-		pixel_coords.emplace_back(pixel_coord);
-	}
-	
-	return pixel_coords;
-}
-
 template<typename T>
 constexpr inline
 T remap(T x, T x0, T x1, T y0, T y1) {
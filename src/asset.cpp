@@ -1,6 +1,12 @@
 #include "asset.h"
 
+#include <iterator>
+
+#include <glad/glad.h>
+#include <imgui.h>
+
 #include "gl/shader.h"
+#include "util/colormap.h"
 
 #include "shaders/shader_lineplot2d.h"
 #include "shaders/shader_point2d.h"
@@ -9,10 +15,46 @@
 #include "shaders/shader_line3d.h"
 #include "shaders/shader_point3d.h"
 #include "shaders/shader_mesh3d.h"
+#include "shaders/shader_text3d.h"
+
+void warm_up_shader_programs(AssetContext* context) {
+	struct ShaderProgramSources {
+		unsigned int* program_ptr;
+		const char* vertex_source;
+		const char* fragment_source;
+	};
+	
+	const ShaderProgramSources shader_programs[] = {
+		{&context->lineplot_2d_shader, lineplot_2d_vs, lineplot_2d_fs},
+		{&context->point_2d_shader, point_2d_vs, point_2d_fs},
+		{&context->image_2d_shader, image_2d_vs, image_2d_fs},
+		{&context->image_2d_uint_shader, image_2d_vs, image_2d_uint_fs},
+		{&context->point_3d_shader, point_3d_vs, point_3d_fs},
+		{&context->depth_image_3d_shader, depth_image_3d_vs, point_3d_fs},
+		{&context->line_3d_shader, line_3d_vs, line_3d_fs},
+		{&context->mesh_3d_shader, mesh_3d_vs, mesh_3d_fs},
+		{&context->text_3d_shader, text_3d_vs, text_3d_fs},
+	};
+	constexpr size_t number_of_shader_programs = std::size(shader_programs);
+	
+	// Submit every program before checking any of them, checking a program waits for its compilation to finish.
+	PendingShaderProgram pending_programs[number_of_shader_programs] = {};
+	for (size_t program_index = 0; program_index < number_of_shader_programs; ++program_index) {
+		const ShaderProgramSources& sources = shader_programs[program_index];
+		if (*sources.program_ptr != 0) { continue; }
+		pending_programs[program_index] = begin_shader_program(&context->shader_program_cache, sources.vertex_source, sources.fragment_source);
+	}
+	
+	for (size_t program_index = 0; program_index < number_of_shader_programs; ++program_index) {
+		if (pending_programs[program_index].program == 0) { continue; }
+		*shader_programs[program_index].program_ptr = finish_shader_program(&context->shader_program_cache, pending_programs[program_index]);
+		assert(*shader_programs[program_index].program_ptr != 0);
+	}
+}
 
 unsigned int get_lineplot_2d_shader(AssetContext* context) {
 	if (context->lineplot_2d_shader != 0) { return context->lineplot_2d_shader; }
-	context->lineplot_2d_shader = create_shader_program(lineplot_2d_vs, lineplot_2d_fs);
+	context->lineplot_2d_shader = create_shader_program(&context->shader_program_cache, lineplot_2d_vs, lineplot_2d_fs);
 	
 	assert(context->lineplot_2d_shader != 0);
 	return context->lineplot_2d_shader;
@@ -20,7 +62,7 @@ unsigned int get_lineplot_2d_shader(AssetContext* context) {
 
 unsigned int get_point_2d_shader(AssetContext* context) {
 	if (context->point_2d_shader != 0) { return context->point_2d_shader; }
-	context->point_2d_shader = create_shader_program(point_2d_vs, point_2d_fs);
+	context->point_2d_shader = create_shader_program(&context->shader_program_cache, point_2d_vs, point_2d_fs);
 	
 	assert(context->point_2d_shader != 0);
 	return context->point_2d_shader;
@@ -28,24 +70,40 @@ unsigned int get_point_2d_shader(AssetContext* context) {
 
 unsigned int get_image_2d_shader(AssetContext* context) {
 	if (context->image_2d_shader != 0) { return context->image_2d_shader; }
-	context->image_2d_shader = create_shader_program(image_2d_vs, image_2d_rgb_fs);
+	context->image_2d_shader = create_shader_program(&context->shader_program_cache, image_2d_vs, image_2d_fs);
 	
 	assert(context->image_2d_shader != 0);
 	return context->image_2d_shader;
 }
 
+unsigned int get_image_2d_uint_shader(AssetContext* context) {
+	if (context->image_2d_uint_shader != 0) { return context->image_2d_uint_shader; }
+	context->image_2d_uint_shader = create_shader_program(&context->shader_program_cache, image_2d_vs, image_2d_uint_fs);
+	
+	assert(context->image_2d_uint_shader != 0);
+	return context->image_2d_uint_shader;
+}
+
 
 unsigned int get_point_3d_shader(AssetContext* context) {
 	if (context->point_3d_shader != 0) { return context->point_3d_shader; }
-	context->point_3d_shader = create_shader_program(point_3d_vs, point_3d_fs);
+	context->point_3d_shader = create_shader_program(&context->shader_program_cache, point_3d_vs, point_3d_fs);
 	
 	assert(context->point_3d_shader != 0);
 	return context->point_3d_shader;
 }
 
+unsigned int get_depth_image_3d_shader(AssetContext* context) {
+	if (context->depth_image_3d_shader != 0) { return context->depth_image_3d_shader; }
+	context->depth_image_3d_shader = create_shader_program(&context->shader_program_cache, depth_image_3d_vs, point_3d_fs);
+	
+	assert(context->depth_image_3d_shader != 0);
+	return context->depth_image_3d_shader;
+}
+
 unsigned int get_line_3d_shader(AssetContext* context) {
 	if (context->line_3d_shader != 0) { return context->line_3d_shader; }
-	context->line_3d_shader = create_shader_program(line_3d_vs, line_3d_fs);
+	context->line_3d_shader = create_shader_program(&context->shader_program_cache, line_3d_vs, line_3d_fs);
 	
 	assert(context->line_3d_shader != 0);
 	return context->line_3d_shader;
@@ -53,12 +111,20 @@ unsigned int get_line_3d_shader(AssetContext* context) {
 
 unsigned int get_mesh_3d_shader(AssetContext* context) {
 	if (context->mesh_3d_shader != 0) { return context->mesh_3d_shader; }
-	context->mesh_3d_shader = create_shader_program(mesh_3d_vs, mesh_3d_fs);
+	context->mesh_3d_shader = create_shader_program(&context->shader_program_cache, mesh_3d_vs, mesh_3d_fs);
 	
 	assert(context->mesh_3d_shader != 0);
 	return context->mesh_3d_shader;
 }
 
+unsigned int get_text_3d_shader(AssetContext* context) {
+	if (context->text_3d_shader != 0) { return context->text_3d_shader; }
+	context->text_3d_shader = create_shader_program(&context->shader_program_cache, text_3d_vs, text_3d_fs);
+	
+	assert(context->text_3d_shader != 0);
+	return context->text_3d_shader;
+}
+
 const GeometryHandles* get_axis_handles_ptr(AssetContext* context) {
 	if (context->origin_axis_handles.vao != 0) { return &context->origin_axis_handles; }
 	
@@ -94,3 +160,76 @@ const IndexedGeometryHandles* get_cylinder_handles_ptr(AssetContext* context) {
 	return &context->cylinder_geometry_handles;
 }
 
+
+unsigned int get_colormap_texture(AssetContext* context, Toucan::Colormap colormap) {
+	unsigned int* texture_ptr = nullptr;
+	switch (colormap) {
+		case Toucan::Colormap::NONE: {
+			return 0;
+		}
+		case Toucan::Colormap::VIRIDIS: {
+			texture_ptr = &context->viridis_colormap_texture;
+		} break;
+		case Toucan::Colormap::TURBO: {
+			texture_ptr = &context->turbo_colormap_texture;
+		} break;
+	}
+	
+	if (*texture_ptr != 0) { return *texture_ptr; }
+	
+	const auto lut = Toucan::generate_colormap_lut(colormap);
+	
+	glGenTextures(1, texture_ptr);
+	glBindTexture(GL_TEXTURE_1D, *texture_ptr);
+	glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage1D(GL_TEXTURE_1D, 0, GL_RGB8, Toucan::colormap_lut_size, 0, GL_RGB, GL_UNSIGNED_BYTE, lut.data());
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glBindTexture(GL_TEXTURE_1D, 0);
+	
+	assert(*texture_ptr != 0);
+	return *texture_ptr;
+}
+
+const Toucan::GlyphAtlas* get_glyph_atlas_ptr(AssetContext* context) {
+	if (context->glyph_atlas.texture != 0) { return &context->glyph_atlas; }
+	
+	ImFontAtlas* font_atlas = ImGui::GetIO().Fonts;
+	unsigned char* pixels_ptr = nullptr;
+	int width = 0;
+	int height = 0;
+	font_atlas->GetTexDataAsAlpha8(&pixels_ptr, &width, &height);
+	
+	const ImFont* font = font_atlas->Fonts[0];
+	context->glyph_atlas.font_size = font->FontSize;
+	for (size_t character = 0; character < context->glyph_atlas.glyphs.size(); ++character) {
+		const ImFontGlyph* font_glyph = font->FindGlyphNoFallback(static_cast<ImWchar>(character)); // Characters missing from the font are not drawn.
+		Toucan::Glyph& glyph = context->glyph_atlas.glyphs[character];
+		if (font_glyph == nullptr) {
+			glyph = {Toucan::Vector2f::Zero(), Toucan::Vector2f::Zero(), Toucan::Vector2f::Zero(), Toucan::Vector2f::Zero(), 0.0f};
+			continue;
+		}
+		
+		glyph.position_min = Toucan::Vector2f(font_glyph->X0, font_glyph->Y0);
+		glyph.position_max = Toucan::Vector2f(font_glyph->X1, font_glyph->Y1);
+		glyph.uv_min = Toucan::Vector2f(font_glyph->U0, font_glyph->V0);
+		glyph.uv_max = Toucan::Vector2f(font_glyph->U1, font_glyph->V1);
+		glyph.advance = font_glyph->AdvanceX;
+	}
+	
+	glGenTextures(1, &context->glyph_atlas.texture);
+	glBindTexture(GL_TEXTURE_2D, context->glyph_atlas.texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, pixels_ptr);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	
+	assert(context->glyph_atlas.texture != 0);
+	return &context->glyph_atlas;
+}
@@ -1,33 +1,57 @@
 #pragma once
 
 #include "gl/geometry.h"
+#include "gl/shader.h"
+#include "util/text_3d.h"
 
 struct AssetContext {
+	ShaderProgramCache shader_program_cache = {};
+	
 	unsigned int lineplot_2d_shader = 0;
 	unsigned int point_2d_shader = 0;
 	unsigned int image_2d_shader = 0;
+	unsigned int image_2d_uint_shader = 0;
 	
 	unsigned int point_3d_shader = 0;
+	unsigned int depth_image_3d_shader = 0;
 	unsigned int line_3d_shader = 0;
 	unsigned int mesh_3d_shader = 0;
+	unsigned int text_3d_shader = 0;
 	
 	GeometryHandles origin_axis_handles = {};
 	IndexedGeometryHandles quad_geometry_handles = {};
 	IndexedGeometryHandles sphere_geometry_handles = {};
 	IndexedGeometryHandles cube_geometry_handles = {};
 	IndexedGeometryHandles cylinder_geometry_handles = {};
+	
+	unsigned int viridis_colormap_texture = 0;
+	unsigned int turbo_colormap_texture = 0;
+	
+	Toucan::GlyphAtlas glyph_atlas = {};
 };
 
+// Compiles all shader programs that have not been created yet, so elements do not stall the first frame they are drawn in.
+void warm_up_shader_programs(AssetContext* context);
+
 unsigned int get_lineplot_2d_shader(AssetContext* context);
 unsigned int get_point_2d_shader(AssetContext* context);
 unsigned int get_image_2d_shader(AssetContext* context);
+unsigned int get_image_2d_uint_shader(AssetContext* context);
 
 unsigned int get_point_3d_shader(AssetContext* context);
+unsigned int get_depth_image_3d_shader(AssetContext* context);
 unsigned int get_line_3d_shader(AssetContext* context);
 unsigned int get_mesh_3d_shader(AssetContext* context);
+unsigned int get_text_3d_shader(AssetContext* context);
 
 const GeometryHandles* get_axis_handles_ptr(AssetContext* context);
 const IndexedGeometryHandles* get_quad_handles_ptr(AssetContext* context);
 const IndexedGeometryHandles* get_sphere_handles_ptr(AssetContext* context);
 const IndexedGeometryHandles* get_cube_handles_ptr(AssetContext* context);
 const IndexedGeometryHandles* get_cylinder_handles_ptr(AssetContext* context);
+
+// 1D lookup texture of the colormap. Returns 0 for `Colormap::NONE`.
+unsigned int get_colormap_texture(AssetContext* context, Toucan::Colormap colormap);
+
+// Glyphs of the default ImGui font, uploaded to a texture of their own.
+const Toucan::GlyphAtlas* get_glyph_atlas_ptr(AssetContext* context);
@@ -1,13 +1,134 @@
 #include "shader.h"
 
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
 #include <glad/glad.h>
+#include <unistd.h>
 
-unsigned int compile_shader(const char* shader_source, uint32_t type) {
-	unsigned int shader = glCreateShader(type);
+#include "util/GLDebug.h"
+
+namespace {
+
+// Not part of the OpenGL 3.3 core profile, so they are not defined by glad.
+constexpr GLenum gl_program_binary_retrievable_hint = 0x8257;
+constexpr GLenum gl_program_binary_length = 0x8741;
+constexpr GLenum gl_num_program_binary_formats = 0x87FE;
+
+typedef void (APIENTRYP GetProgramBinaryProc)(GLuint program, GLsizei buffer_size, GLsizei* length, GLenum* binary_format, void* binary);
+typedef void (APIENTRYP ProgramBinaryProc)(GLuint program, GLenum binary_format, const void* binary, GLsizei length);
+typedef void (APIENTRYP ProgramParameteriProc)(GLuint program, GLenum name, GLint value);
+typedef void (APIENTRYP MaxShaderCompilerThreadsProc)(GLuint count);
+
+constexpr uint32_t program_binary_file_magic = 0x43505354; // "TSPC"
+
+struct ProgramBinaryFileHeader {
+	uint32_t magic;
+	uint32_t binary_format;
+	uint64_t source_hash;
+};
+
+uint64_t hash_string(const char* string, uint64_t hash = 14695981039346656037ull) {
+	// FNV-1a, stable between runs unlike std::hash.
+	for (const char* c = string; *c != '\0'; ++c) {
+		hash ^= static_cast<unsigned char>(*c);
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+uint64_t hash_shader_sources(const char* vertex_source, const char* fragment_source) {
+	uint64_t hash = hash_string(vertex_source);
+	hash ^= 0xFF; // Separator, so moving code between the stages changes the hash.
+	hash *= 1099511628211ull;
+	return hash_string(fragment_source, hash);
+}
+
+std::string to_hex_string(uint64_t value) {
+	char hex[17];
+	std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(value));
+	return std::string(hex);
+}
+
+bool has_extension(const char* extension_name) {
+	int number_of_extensions = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &number_of_extensions);
+	for (int extension_index = 0; extension_index < number_of_extensions; ++extension_index) {
+		const auto* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(extension_index)));
+		if (name != nullptr and std::strcmp(name, extension_name) == 0) { return true; }
+	}
+	return false;
+}
+
+std::filesystem::path get_program_binary_path(const ShaderProgramCache* cache, uint64_t source_hash) {
+	return std::filesystem::path(cache->directory) / (to_hex_string(source_hash) + ".bin");
+}
+
+// Returns 0 if there is no usable binary in the cache, e.g. because the driver was updated without changing its version string.
+unsigned int load_program_binary(const ShaderProgramCache* cache, uint64_t source_hash) {
+	std::ifstream file(get_program_binary_path(cache, source_hash), std::ios::binary);
+	if (not file) { return 0; }
 	
-	glShaderSource(shader, 1, &shader_source, nullptr);
-	glCompileShader(shader);
+	ProgramBinaryFileHeader header = {};
+	if (not file.read(reinterpret_cast<char*>(&header), sizeof(header)) or header.magic != program_binary_file_magic or header.source_hash != source_hash) { return 0; }
+	
+	const std::vector<char> binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	if (binary.empty()) { return 0; }
+	
+	const auto program_binary = reinterpret_cast<ProgramBinaryProc>(cache->program_binary_ptr);
+	const unsigned int program = glCreateProgram();
+	program_binary(program, header.binary_format, binary.data(), static_cast<GLsizei>(binary.size()));
+	
+	int success = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (not success) {
+		glDeleteProgram(program);
+		return 0;
+	}
+	
+	return program;
+}
+
+// Failing to write the cache is not an error, the program is just compiled again on the next start.
+void store_program_binary(const ShaderProgramCache* cache, unsigned int program, uint64_t source_hash) {
+	int binary_length = 0;
+	glGetProgramiv(program, gl_program_binary_length, &binary_length);
+	if (binary_length <= 0) { return; }
+	
+	std::vector<char> binary(static_cast<size_t>(binary_length));
+	ProgramBinaryFileHeader header = {program_binary_file_magic, 0, source_hash};
+	const auto get_program_binary = reinterpret_cast<GetProgramBinaryProc>(cache->get_program_binary_ptr);
+	GLenum binary_format = 0;
+	get_program_binary(program, binary_length, &binary_length, &binary_format, binary.data());
+	header.binary_format = binary_format;
 	
+	// Write to a temporary file and rename it, so other processes never read a partially written binary.
+	const std::filesystem::path path = get_program_binary_path(cache, source_hash);
+	std::filesystem::path temporary_path = path;
+	temporary_path += ".tmp" + std::to_string(getpid());
+	{
+		std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+		if (not file) { return; }
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(binary.data(), binary_length);
+		if (not file) {
+			file.close();
+			std::error_code error;
+			std::filesystem::remove(temporary_path, error);
+			return;
+		}
+	}
+	
+	std::error_code error;
+	std::filesystem::rename(temporary_path, path, error);
+	if (error) { std::filesystem::remove(temporary_path, error); }
+}
+
+void check_shader_compile_status(unsigned int shader) {
 	int success = 0;
 	glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
 	if(!success){
@@ -18,20 +139,9 @@ unsigned int compile_shader(const char* shader_source, uint32_t type) {
 		ss << "ERROR! Shader compilation failed: " << info_log;
 		throw std::runtime_error(ss.str());
 	}
-	
-	return shader;
 }
 
-unsigned int create_shader_program(const char* vertex_source, const char* fragment_source) {
-	auto vertex_shader = compile_shader(vertex_source, GL_VERTEX_SHADER);
-	auto fragment_shader = compile_shader(fragment_source, GL_FRAGMENT_SHADER);
-	
-	auto program = glCreateProgram();
-	glAttachShader(program, vertex_shader);
-	glAttachShader(program, fragment_shader);
-	glLinkProgram(program);
-	
-	
+void check_program_link_status(unsigned int program) {
 	int success = 0;
 	glGetProgramiv(program, GL_LINK_STATUS, &success);
 	if(!success){
@@ -42,14 +152,129 @@ unsigned int create_shader_program(const char* vertex_source, const char* fragme
 		ss << "Shader program linking failed: " << info_log;
 		throw std::runtime_error(ss.str());
 	}
+}
+
+} // namespace
+
+void initialize_shader_program_cache(ShaderProgramCache* cache, const std::string& cache_directory, GLProcLoader load_proc) {
+	*cache = ShaderProgramCache();
+	if (cache_directory.empty()) { return; }
 	
-	glDetachShader(program, vertex_shader);
-	glDetachShader(program, fragment_shader);
+	int major_version = 0;
+	int minor_version = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &major_version);
+	glGetIntegerv(GL_MINOR_VERSION, &minor_version);
+	const bool core_program_binary = major_version > 4 or (major_version == 4 and minor_version >= 1);
+	if (not core_program_binary and not has_extension("GL_ARB_get_program_binary")) { return; }
 	
-	glDeleteShader(vertex_shader);
-	glDeleteShader(fragment_shader);
+	int number_of_binary_formats = 0;
+	glGetIntegerv(gl_num_program_binary_formats, &number_of_binary_formats);
+	if (number_of_binary_formats <= 0) { return; }
 	
-	return program;
+	cache->get_program_binary_ptr = load_proc("glGetProgramBinary");
+	cache->program_binary_ptr = load_proc("glProgramBinary");
+	cache->program_parameteri_ptr = load_proc("glProgramParameteri");
+	if (cache->get_program_binary_ptr == nullptr or cache->program_binary_ptr == nullptr or cache->program_parameteri_ptr == nullptr) { return; }
+	
+	// Binaries are only valid for the driver that created them.
+	uint64_t driver_hash = 14695981039346656037ull;
+	for (const GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION}) {
+		const auto* value = reinterpret_cast<const char*>(glGetString(name));
+		driver_hash = hash_string(value != nullptr ? value : "", driver_hash);
+	}
+	
+	const std::filesystem::path directory = std::filesystem::path(cache_directory) / to_hex_string(driver_hash);
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+	if (error) { return; }
+	
+	cache->directory = directory.string();
+}
+
+bool enable_parallel_shader_compile(GLProcLoader load_proc) {
+	void* max_shader_compiler_threads_ptr = nullptr;
+	if (has_extension("GL_KHR_parallel_shader_compile")) {
+		max_shader_compiler_threads_ptr = load_proc("glMaxShaderCompilerThreadsKHR");
+	} else if (has_extension("GL_ARB_parallel_shader_compile")) {
+		max_shader_compiler_threads_ptr = load_proc("glMaxShaderCompilerThreadsARB");
+	}
+	if (max_shader_compiler_threads_ptr == nullptr) { return false; }
+	
+	// 0xFFFFFFFF lets the driver pick the number of threads.
+	reinterpret_cast<MaxShaderCompilerThreadsProc>(max_shader_compiler_threads_ptr)(0xFFFFFFFFu);
+	glCheckError();
+	return true;
+}
+
+unsigned int compile_shader(const char* shader_source, uint32_t type) {
+	unsigned int shader = glCreateShader(type);
+	
+	glShaderSource(shader, 1, &shader_source, nullptr);
+	glCompileShader(shader);
+	
+	check_shader_compile_status(shader);
+	
+	return shader;
+}
+
+PendingShaderProgram begin_shader_program(const ShaderProgramCache* cache, const char* vertex_source, const char* fragment_source) {
+	const bool use_cache = cache != nullptr and not cache->directory.empty();
+	
+	PendingShaderProgram pending_program = {};
+	pending_program.source_hash = hash_shader_sources(vertex_source, fragment_source);
+	
+	if (use_cache) {
+		pending_program.program = load_program_binary(cache, pending_program.source_hash);
+		if (pending_program.program != 0) { return pending_program; }
+	}
+	
+	// Compile without checking the status, that is done in `finish_shader_program`.
+	pending_program.vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+	glShaderSource(pending_program.vertex_shader, 1, &vertex_source, nullptr);
+	glCompileShader(pending_program.vertex_shader);
+	
+	pending_program.fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+	glShaderSource(pending_program.fragment_shader, 1, &fragment_source, nullptr);
+	glCompileShader(pending_program.fragment_shader);
+	
+	pending_program.program = glCreateProgram();
+	if (use_cache) {
+		reinterpret_cast<ProgramParameteriProc>(cache->program_parameteri_ptr)(pending_program.program, gl_program_binary_retrievable_hint, GL_TRUE);
+	}
+	glAttachShader(pending_program.program, pending_program.vertex_shader);
+	glAttachShader(pending_program.program, pending_program.fragment_shader);
+	glLinkProgram(pending_program.program);
+	
+	return pending_program;
+}
+
+unsigned int finish_shader_program(const ShaderProgramCache* cache, const PendingShaderProgram& pending_program) {
+	if (pending_program.vertex_shader == 0) { return pending_program.program; } // Loaded from the cache, and already checked.
+	
+	check_shader_compile_status(pending_program.vertex_shader);
+	check_shader_compile_status(pending_program.fragment_shader);
+	check_program_link_status(pending_program.program);
+	
+	glDetachShader(pending_program.program, pending_program.vertex_shader);
+	glDetachShader(pending_program.program, pending_program.fragment_shader);
+	
+	glDeleteShader(pending_program.vertex_shader);
+	glDeleteShader(pending_program.fragment_shader);
+	
+	if (cache != nullptr and not cache->directory.empty()) {
+		store_program_binary(cache, pending_program.program, pending_program.source_hash);
+	}
+	
+	return pending_program.program;
+}
+
+unsigned int create_shader_program(const ShaderProgramCache* cache, const char* vertex_source, const char* fragment_source) {
+	return finish_shader_program(cache, begin_shader_program(cache, vertex_source, fragment_source));
+}
+
+unsigned int create_shader_program(const char* vertex_source, const char* fragment_source) {
+	const ShaderProgramCache* no_cache = nullptr;
+	return create_shader_program(no_cache, vertex_source, fragment_source);
 }
 
 unsigned int create_shader_program(const char* vertex_source, const char* geometry_source, const char* fragment_source) {
@@ -105,12 +330,24 @@ void set_shader_uniform(unsigned int shader, const std::string& name, const Touc
 	glUniform2f(location, static_cast<float>(value.x()), static_cast<float>(value.y()));
 }
 
+void set_shader_uniform(unsigned int shader, const std::string& name, const Toucan::Vector2i& value) {
+	auto location = glGetUniformLocation(shader, name.c_str());
+	assert(location != -1);
+	glUniform2i(location, value.x(), value.y());
+}
+
 void set_shader_uniform(unsigned int shader, const std::string& name, const Toucan::Vector3f& value) {
 	auto location = glGetUniformLocation(shader, name.c_str());
 	assert(location != -1);
 	glUniform3f(location, static_cast<float>(value.x()), static_cast<float>(value.y()), static_cast<float>(value.z()));
 }
 
+void set_shader_uniform(unsigned int shader, const std::string& name, const Toucan::Vector4f& value) {
+	auto location = glGetUniformLocation(shader, name.c_str());
+	assert(location != -1);
+	glUniform4f(location, static_cast<float>(value(0)), static_cast<float>(value(1)), static_cast<float>(value(2)), static_cast<float>(value(3)));
+}
+
 void set_shader_uniform(unsigned int shader, const std::string& name, const Toucan::Color& value) {
 	auto location = glGetUniformLocation(shader, name.c_str());
 	assert(location != -1);
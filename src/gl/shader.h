@@ -5,14 +5,47 @@
 
 #include "Toucan/DataTypes.h"
 
+// On-disk cache of linked program binaries (GL_ARB_get_program_binary). Binaries are stored in a subdirectory per driver, named by a hash of the shader sources.
+struct ShaderProgramCache {
+	std::string directory; // Empty if the cache is disabled or the driver can not retrieve program binaries.
+	
+	// Entry points that are not part of the OpenGL 3.3 core profile, loaded in `initialize_shader_program_cache`.
+	void* get_program_binary_ptr = nullptr;
+	void* program_binary_ptr = nullptr;
+	void* program_parameteri_ptr = nullptr;
+};
+
+// A program that has been submitted to the driver but not checked yet. Checking the status of a shader or program waits for it to finish compiling,
+// so submitting all programs before checking any of them lets drivers with background compiler threads compile them in parallel.
+struct PendingShaderProgram {
+	unsigned int program = 0;
+	unsigned int vertex_shader = 0; // 0 if the program was loaded from the cache.
+	unsigned int fragment_shader = 0;
+	uint64_t source_hash = 0;
+};
+
+using GLProcLoader = void* (*)(const char* name);
+
+// Enables the program binary cache in `cache_directory`. The cache stays disabled if the directory is empty or the driver does not support program binaries.
+void initialize_shader_program_cache(ShaderProgramCache* cache, const std::string& cache_directory, GLProcLoader load_proc);
+
+// Lets the driver use as many compiler threads as it likes (GL_KHR_parallel_shader_compile). Returns false if the extension is not available.
+bool enable_parallel_shader_compile(GLProcLoader load_proc);
+
 unsigned int compile_shader(const char* shader_source, uint32_t type);
 
+PendingShaderProgram begin_shader_program(const ShaderProgramCache* cache, const char* vertex_source, const char* fragment_source);
+unsigned int finish_shader_program(const ShaderProgramCache* cache, const PendingShaderProgram& pending_program);
+
+unsigned int create_shader_program(const ShaderProgramCache* cache, const char* vertex_source, const char* fragment_source);
 unsigned int create_shader_program(const char* vertex_source, const char* fragment_source);
 unsigned int create_shader_program(const char* vertex_source, const char* geometry_source, const char* fragment_source);
 
 void set_shader_uniform(unsigned int shader, const std::string& name, int value);
 void set_shader_uniform(unsigned int shader, const std::string& name, float value);
 void set_shader_uniform(unsigned int shader, const std::string& name, const Toucan::Vector2f& value);
+void set_shader_uniform(unsigned int shader, const std::string& name, const Toucan::Vector2i& value);
 void set_shader_uniform(unsigned int shader, const std::string& name, const Toucan::Vector3f& value);
+void set_shader_uniform(unsigned int shader, const std::string& name, const Toucan::Vector4f& value);
 void set_shader_uniform(unsigned int shader, const std::string& name, const Toucan::Color& value);
 void set_shader_uniform(unsigned int shader, const std::string& name, const Toucan::Matrix4f& value);
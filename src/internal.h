@@ -6,6 +6,7 @@
 #include <atomic>
 #include <thread>
 #include <condition_variable>
+#include <memory>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -14,10 +15,21 @@
 #include "Toucan/DataTypes.h"
 
 #include "asset.h"
+#include "util/frustum.h"
+#include "util/point_octree.h"
+#include "util/line_decimation.h"
+#include "util/thread_pool.h"
+#include "util/tiled_image.h"
+#include "util/tick_number.h"
+#include "util/text_3d.h"
+#include "util/capture.h"
+#include "util/shared_memory.h"
+#include "util/network.h"
+#include "util/frame_export.h"
 
 namespace Toucan {
 
-enum class ElementType2D { LinePlot2D, Point2D, Image2D };
+enum class ElementType2D { LinePlot2D, Point2D, Image2D, TiledImage2D };
 
 struct LinePlot2DMetadata {
 	unsigned int vao;
@@ -25,6 +37,8 @@ struct LinePlot2DMetadata {
 	
 	int number_of_points;
 	
+	LinePlotDecimation* decimation_ptr; // Non-null if the line is decimated to the resolution of the view.
+	
 	ShowLinePlot2DSettings settings;
 };
 
@@ -39,6 +53,7 @@ struct Point2DMetadata{
 
 struct Image2DMetadata {
 	unsigned int texture;
+	unsigned int chroma_texture; // UV plane of NV12 images.
 	
 	int width;
 	int height;
@@ -47,19 +62,30 @@ struct Image2DMetadata {
 	ShowImage2DSettings settings;
 };
 
+struct TiledImage2DMetadata {
+	int width;
+	int height;
+	ImageFormat format;
+	
+	TiledImage* tiled_image_ptr;
+	
+	ShowTiledImage2DSettings settings;
+};
+
 struct Element2D {
 	std::string name;
 	RigidTransform2Df pose;
 	ElementType2D type = {};
 	int draw_layer = 0;
 	
-	Rectangle data_bounds_cache;
+	Rectangle data_bounds_cache; // Bounds of the data before the pose and data transform is applied. Computed when there is new data.
 	
 	void* data_buffer_ptr = nullptr; // non-null if new data should be uploaded to device
 	union {
 		LinePlot2DMetadata line_plot_2d_metadata;
 		Point2DMetadata point_2d_metadata;
 		Image2DMetadata image_2d_metadata;
+		TiledImage2DMetadata tiled_image_2d_metadata;
 	};
 };
 
@@ -78,9 +104,17 @@ struct Figure2D {
 	unsigned int framebuffer = 0;
 	unsigned int framebuffer_color_texture = 0;
 	Vector2i framebuffer_size = Vector2i(128, 128);
+	std::unique_ptr<FrameExporter> frame_exporter; // Non-null while the figure is exported.
+	
+	AxisTicks x_axis_ticks;
+	AxisTicks y_axis_ticks;
+	
+#ifdef TOUCAN_BENCHMARK_HOOKS
+	Vector2f pan_per_frame = Vector2f::Zero(); // Fraction of the view the view is moved every frame. Used to benchmark redrawing the figure.
+#endif
 };
 
-enum class ElementType3D { Grid3D, Axis3D, Point3D, Line3D, Primitive3D };
+enum class ElementType3D { Grid3D, Axis3D, Point3D, Line3D, Primitive3D, DepthImage3D, Text3D };
 
 struct Grid3DMetadata {
 	unsigned int vao_major;
@@ -91,6 +125,9 @@ struct Grid3DMetadata {
 	unsigned int number_of_minor_vertices;
 	unsigned int number_of_major_vertices;
 	
+	// Major line vertices followed by the minor line vertices, generated in `prepare_elements_3d`. Freed once uploaded.
+	LineVertex3D* line_vertices_ptr;
+	
 	float spacing;
 	int lines;
 };
@@ -99,12 +136,20 @@ struct Axis3DMetadata {
 	ShowAxis3DSettings settings;
 };
 
+constexpr int point_3d_chunk_size = 1 << 16;
+
 struct Point3DMetadata {
 	unsigned int vao;
 	unsigned int vbo;
 	
 	int number_of_points;
 	
+	// Bounds of contiguous chunks of `point_3d_chunk_size` points, used to cull parts of large point clouds.
+	BoundingBox3D* chunk_bounds_ptr;
+	int number_of_chunks;
+	
+	PointOctree* octree_ptr; // Non-null if the points are drawn with level of detail.
+	
 	ShowPoints3DSettings settings;
 };
 
@@ -124,11 +169,45 @@ struct Primitive3DMetadata {
 	ShowPrimitives3DSettings settings;
 };
 
+struct DepthImage3DMetadata {
+	unsigned int vao; // Empty, the points are generated in the vertex shader.
+	unsigned int depth_texture;
+	unsigned int color_texture;
+	
+	int depth_width;
+	int depth_height;
+	ImageFormat depth_format;
+	
+	int color_width;
+	int color_height;
+	ImageFormat color_format;
+	
+	CameraIntrinsics intrinsics;
+	float depth_scale;
+	
+	ShowDepthImage3DSettings settings;
+};
+
+struct Text3DMetadata {
+	unsigned int vao;
+	unsigned int glyph_vbo;
+	unsigned int visibility_vbo;
+	
+	Text3DLabel* labels_ptr;
+	int number_of_labels;
+	
+	Text3DLayout* layout_ptr;
+	
+	ShowText3DSettings settings;
+};
+
 struct Element3D {
 	std::string name;
 	RigidTransform3Df pose;
 	ElementType3D type = {};
 	
+	BoundingBox3D data_bounds_cache; // In the element's local data space. Computed when new data is uploaded.
+	
 	void* data_buffer_ptr = nullptr; // non-null if new data should be uploaded to device
 	union {
 		Grid3DMetadata grid_3d_metadata;
@@ -136,6 +215,8 @@ struct Element3D {
 		Point3DMetadata point_3d_metadata;
 		Line3DMetadata line_3d_metadata;
 		Primitive3DMetadata primitive_3d_metadata;
+		DepthImage3DMetadata depth_image_3d_metadata;
+		Text3DMetadata text_3d_metadata;
 	};
 };
 
@@ -150,11 +231,15 @@ struct Figure3D {
 	std::vector<RigidTransform3Df> pose_stack;
 	
 	bool dragging = false;
+#ifdef TOUCAN_BENCHMARK_HOOKS
+	Vector2f orbit_per_frame = Vector2f::Zero(); // Orbited every frame, as if dragged by the mouse. Used to benchmark redrawing the figure.
+#endif
 	
 	unsigned int framebuffer = 0;
 	unsigned int framebuffer_color_texture = 0;
 	unsigned int framebuffer_depth_texture = 0;
 	Vector2i framebuffer_size = Vector2i(128, 128);
+	std::unique_ptr<FrameExporter> frame_exporter; // Non-null while the figure is exported.
 };
 
 enum class ElementInputType {
@@ -270,6 +355,10 @@ struct ToucanContext {
 	GLFWwindow* window_ptr = nullptr;
 	RENDERDOC_API_1_4_1* rdoc_api = nullptr;
 	
+	// Frames started and presented by the render thread. Any data submitted before a frame started is visible once that frame is presented.
+	std::atomic_uint64_t number_of_started_frames = 0;
+	std::atomic_uint64_t number_of_presented_frames = 0;
+	
 	std::list<Toucan::Figure2D> figures_2d;
 	Toucan::Figure2D* current_figure_2d = nullptr;
 	
@@ -280,6 +369,15 @@ struct ToucanContext {
 	Toucan::InputWindow* current_input_window = nullptr;
 	
 	AssetContext asset_context = {};
+	
+	ThreadPool thread_pool; // CPU preprocessing of element data, so the render thread mostly issues GL calls.
+	
+	std::atomic_int number_of_frame_exports = 0; // The render thread only looks for frame exporters in the figures while this is non-zero.
+	std::atomic_bool frame_exports_closed = false; // Set by the render thread before it releases the frame exporters of the figures, when the window closes.
+	
+	CaptureRecorder* capture_recorder_ptr = nullptr; // Non-null if the API calls are recorded.
+	SharedMemoryWriter* shared_memory_writer_ptr = nullptr; // Non-null if the API calls are shown by a viewer process instead of the render thread.
+	NetworkWriter* network_writer_ptr = nullptr; // Non-null if the API calls are streamed to a remote viewer instead of the render thread.
 };
 
 } // namespace Toucan
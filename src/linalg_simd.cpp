@@ -0,0 +1,290 @@
+#include <Toucan/LinAlg.h>
+
+// The kernels are compiled once, into the library, so the inline LinAlg operators are the same in every translation unit whatever instruction set it
+// is compiled for. SSE2 and NEON are selected when the library is built, and AVX at runtime. Define TOUCAN_LINALG_NO_SIMD when building the library
+// to always use the generic implementations.
+#if not defined(TOUCAN_LINALG_NO_SIMD)
+	#if defined(__SSE2__) and defined(__GNUC__)
+		#include <immintrin.h>
+		#define TOUCAN_LINALG_SSE
+	#elif defined(__ARM_NEON)
+		#include <arm_neon.h>
+		#define TOUCAN_LINALG_NEON
+	#endif
+#endif
+
+#if defined(TOUCAN_LINALG_SSE)
+
+namespace {
+
+// Two rows of the result at the time, with the rows of `rhs` repeated in both 128 bit lanes.
+__attribute__((target("avx")))
+void multiply_matrix4f_avx(const float* lhs, const float* rhs, float* result) {
+	const __m128 rhs_row_0 = _mm_loadu_ps(rhs + 0);
+	const __m128 rhs_row_1 = _mm_loadu_ps(rhs + 4);
+	const __m128 rhs_row_2 = _mm_loadu_ps(rhs + 8);
+	const __m128 rhs_row_3 = _mm_loadu_ps(rhs + 12);
+	const __m256 rhs_rows_0 = _mm256_insertf128_ps(_mm256_castps128_ps256(rhs_row_0), rhs_row_0, 1);
+	const __m256 rhs_rows_1 = _mm256_insertf128_ps(_mm256_castps128_ps256(rhs_row_1), rhs_row_1, 1);
+	const __m256 rhs_rows_2 = _mm256_insertf128_ps(_mm256_castps128_ps256(rhs_row_2), rhs_row_2, 1);
+	const __m256 rhs_rows_3 = _mm256_insertf128_ps(_mm256_castps128_ps256(rhs_row_3), rhs_row_3, 1);
+	
+	for (int row_index = 0; row_index < 4; row_index += 2) {
+		const __m256 lhs_rows = _mm256_loadu_ps(lhs + 4*row_index);
+		__m256 sum = _mm256_mul_ps(_mm256_shuffle_ps(lhs_rows, lhs_rows, 0x00), rhs_rows_0);
+		sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_shuffle_ps(lhs_rows, lhs_rows, 0x55), rhs_rows_1));
+		sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_shuffle_ps(lhs_rows, lhs_rows, 0xAA), rhs_rows_2));
+		sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_shuffle_ps(lhs_rows, lhs_rows, 0xFF), rhs_rows_3));
+		_mm256_storeu_ps(result + 4*row_index, sum);
+	}
+}
+
+void multiply_matrix4f_sse(const float* lhs, const float* rhs, float* result) {
+	const __m128 rhs_row_0 = _mm_loadu_ps(rhs + 0);
+	const __m128 rhs_row_1 = _mm_loadu_ps(rhs + 4);
+	const __m128 rhs_row_2 = _mm_loadu_ps(rhs + 8);
+	const __m128 rhs_row_3 = _mm_loadu_ps(rhs + 12);
+	
+	for (int row_index = 0; row_index < 4; ++row_index) {
+		const __m128 lhs_row = _mm_loadu_ps(lhs + 4*row_index);
+		__m128 sum = _mm_mul_ps(_mm_shuffle_ps(lhs_row, lhs_row, 0x00), rhs_row_0);
+		sum = _mm_add_ps(sum, _mm_mul_ps(_mm_shuffle_ps(lhs_row, lhs_row, 0x55), rhs_row_1));
+		sum = _mm_add_ps(sum, _mm_mul_ps(_mm_shuffle_ps(lhs_row, lhs_row, 0xAA), rhs_row_2));
+		sum = _mm_add_ps(sum, _mm_mul_ps(_mm_shuffle_ps(lhs_row, lhs_row, 0xFF), rhs_row_3));
+		_mm_storeu_ps(result + 4*row_index, sum);
+	}
+}
+
+bool cpu_supports_avx() {
+	static const bool supports_avx = __builtin_cpu_supports("avx");
+	return supports_avx;
+}
+
+} // namespace
+
+#endif
+
+#if defined(TOUCAN_LINALG_SSE) or defined(TOUCAN_LINALG_NEON)
+
+bool Toucan::simd::multiply_matrix4f(const float* lhs, const float* rhs, float* result) {
+#if defined(TOUCAN_LINALG_SSE)
+	if (cpu_supports_avx()) {
+		multiply_matrix4f_avx(lhs, rhs, result);
+	} else {
+		multiply_matrix4f_sse(lhs, rhs, result);
+	}
+#else
+	const float32x4_t rhs_row_0 = vld1q_f32(rhs + 0);
+	const float32x4_t rhs_row_1 = vld1q_f32(rhs + 4);
+	const float32x4_t rhs_row_2 = vld1q_f32(rhs + 8);
+	const float32x4_t rhs_row_3 = vld1q_f32(rhs + 12);
+	
+	for (int row_index = 0; row_index < 4; ++row_index) {
+		const float* lhs_row = lhs + 4*row_index;
+		float32x4_t sum = vmulq_n_f32(rhs_row_0, lhs_row[0]);
+		sum = vaddq_f32(sum, vmulq_n_f32(rhs_row_1, lhs_row[1]));
+		sum = vaddq_f32(sum, vmulq_n_f32(rhs_row_2, lhs_row[2]));
+		sum = vaddq_f32(sum, vmulq_n_f32(rhs_row_3, lhs_row[3]));
+		vst1q_f32(result + 4*row_index, sum);
+	}
+#endif
+	return true;
+}
+
+// Computed as a sum of the matrix columns.
+bool Toucan::simd::multiply_matrix4f_vector4f(const float* matrix, const float* vector, float* result) {
+#if defined(TOUCAN_LINALG_SSE)
+	__m128 column_0 = _mm_loadu_ps(matrix + 0);
+	__m128 column_1 = _mm_loadu_ps(matrix + 4);
+	__m128 column_2 = _mm_loadu_ps(matrix + 8);
+	__m128 column_3 = _mm_loadu_ps(matrix + 12);
+	_MM_TRANSPOSE4_PS(column_0, column_1, column_2, column_3);
+	
+	const __m128 v = _mm_loadu_ps(vector);
+	__m128 sum = _mm_mul_ps(column_0, _mm_shuffle_ps(v, v, 0x00));
+	sum = _mm_add_ps(sum, _mm_mul_ps(column_1, _mm_shuffle_ps(v, v, 0x55)));
+	sum = _mm_add_ps(sum, _mm_mul_ps(column_2, _mm_shuffle_ps(v, v, 0xAA)));
+	sum = _mm_add_ps(sum, _mm_mul_ps(column_3, _mm_shuffle_ps(v, v, 0xFF)));
+	_mm_storeu_ps(result, sum);
+#else
+	const float32x4x4_t columns = vld4q_f32(matrix); // De-interleaving the rows gives the columns.
+	float32x4_t sum = vmulq_n_f32(columns.val[0], vector[0]);
+	sum = vaddq_f32(sum, vmulq_n_f32(columns.val[1], vector[1]));
+	sum = vaddq_f32(sum, vmulq_n_f32(columns.val[2], vector[2]));
+	sum = vaddq_f32(sum, vmulq_n_f32(columns.val[3], vector[3]));
+	vst1q_f32(result, sum);
+#endif
+	return true;
+}
+
+// The product is the sum of `rhs`, with permuted and negated components, scaled by each component of `lhs`.
+bool Toucan::simd::multiply_quaternionf(const float* lhs, const float* rhs, float* result) {
+#if defined(TOUCAN_LINALG_SSE)
+	const __m128 l = _mm_loadu_ps(lhs);
+	const __m128 r = _mm_loadu_ps(rhs);
+	
+	const __m128 r_xwzy = _mm_xor_ps(_mm_shuffle_ps(r, r, _MM_SHUFFLE(2, 3, 0, 1)), _mm_set_ps(0.0f, -0.0f, 0.0f, -0.0f));
+	const __m128 r_yzwx = _mm_xor_ps(_mm_shuffle_ps(r, r, _MM_SHUFFLE(1, 0, 3, 2)), _mm_set_ps(-0.0f, 0.0f, 0.0f, -0.0f));
+	const __m128 r_zyxw = _mm_xor_ps(_mm_shuffle_ps(r, r, _MM_SHUFFLE(0, 1, 2, 3)), _mm_set_ps(0.0f, 0.0f, -0.0f, -0.0f));
+	
+	__m128 sum = _mm_mul_ps(_mm_shuffle_ps(l, l, 0x00), r);
+	sum = _mm_add_ps(sum, _mm_mul_ps(_mm_shuffle_ps(l, l, 0x55), r_xwzy));
+	sum = _mm_add_ps(sum, _mm_mul_ps(_mm_shuffle_ps(l, l, 0xAA), r_yzwx));
+	sum = _mm_add_ps(sum, _mm_mul_ps(_mm_shuffle_ps(l, l, 0xFF), r_zyxw));
+	_mm_storeu_ps(result, sum);
+#else
+	constexpr float r_xwzy_signs[4] = {-1.0f, 1.0f, -1.0f, 1.0f};
+	constexpr float r_yzwx_signs[4] = {-1.0f, 1.0f, 1.0f, -1.0f};
+	constexpr float r_zyxw_signs[4] = {-1.0f, -1.0f, 1.0f, 1.0f};
+	
+	const float32x4_t r = vld1q_f32(rhs);
+	const float32x4_t r_yzwx_unsigned = vextq_f32(r, r, 2);
+	const float32x4_t r_xwzy = vmulq_f32(vrev64q_f32(r), vld1q_f32(r_xwzy_signs));
+	const float32x4_t r_yzwx = vmulq_f32(r_yzwx_unsigned, vld1q_f32(r_yzwx_signs));
+	const float32x4_t r_zyxw = vmulq_f32(vrev64q_f32(r_yzwx_unsigned), vld1q_f32(r_zyxw_signs));
+	
+	float32x4_t sum = vmulq_n_f32(r, lhs[0]);
+	sum = vaddq_f32(sum, vmulq_n_f32(r_xwzy, lhs[1]));
+	sum = vaddq_f32(sum, vmulq_n_f32(r_yzwx, lhs[2]));
+	sum = vaddq_f32(sum, vmulq_n_f32(r_zyxw, lhs[3]));
+	vst1q_f32(result, sum);
+#endif
+	return true;
+}
+
+// As 2*(u.p)*u + (w*w - u.u)*p + 2*w*(u x p), with u = (x, y, z). There is no NEON kernel yet.
+bool Toucan::simd::rotate_vector3f(const float* quaternion, const float* point, float* result) {
+#if defined(TOUCAN_LINALG_SSE)
+	const __m128 u = _mm_set_ps(0.0f, quaternion[3], quaternion[2], quaternion[1]);
+	const __m128 p = _mm_set_ps(0.0f, point[2], point[1], point[0]);
+	const float w = quaternion[0];
+	
+	const auto dot_product = [](__m128 a, __m128 b) {
+		const __m128 products = _mm_mul_ps(a, b);
+		const __m128 sum = _mm_add_ps(_mm_add_ps(products, _mm_shuffle_ps(products, products, 0x55)), _mm_shuffle_ps(products, products, 0xAA));
+		return _mm_shuffle_ps(sum, sum, 0x00);
+	};
+	
+	const __m128 u_yzx = _mm_shuffle_ps(u, u, _MM_SHUFFLE(3, 0, 2, 1));
+	const __m128 u_zxy = _mm_shuffle_ps(u, u, _MM_SHUFFLE(3, 1, 0, 2));
+	const __m128 p_yzx = _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 0, 2, 1));
+	const __m128 p_zxy = _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 1, 0, 2));
+	const __m128 cross_product = _mm_sub_ps(_mm_mul_ps(u_yzx, p_zxy), _mm_mul_ps(u_zxy, p_yzx));
+	
+	const __m128 parallel = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(2.0f), dot_product(u, p)), u);
+	const __m128 scaled = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(w*w), dot_product(u, u)), p);
+	const __m128 perpendicular = _mm_mul_ps(_mm_set1_ps(2.0f*w), cross_product);
+	
+	float sum[4];
+	_mm_storeu_ps(sum, _mm_add_ps(_mm_add_ps(parallel, scaled), perpendicular));
+	result[0] = sum[0];
+	result[1] = sum[1];
+	result[2] = sum[2];
+	return true;
+#else
+	static_cast<void>(quaternion);
+	static_cast<void>(point);
+	static_cast<void>(result);
+	return false;
+#endif
+}
+
+// Processes whole blocks of 4 points, which are de-interleaved into x, y and z registers.
+size_t Toucan::simd::transform_vector3f_array(const float* linear, const float* translation, const float* points, size_t number_of_points, float* result) {
+	const size_t number_of_blocks = number_of_points / 4;
+#if defined(TOUCAN_LINALG_SSE)
+	__m128 l[9];
+	for (int element_index = 0; element_index < 9; ++element_index) {
+		l[element_index] = _mm_set1_ps(linear[element_index]);
+	}
+	const __m128 t_x = _mm_set1_ps(translation[0]);
+	const __m128 t_y = _mm_set1_ps(translation[1]);
+	const __m128 t_z = _mm_set1_ps(translation[2]);
+	
+	for (size_t block_index = 0; block_index < number_of_blocks; ++block_index) {
+		const __m128 a = _mm_loadu_ps(points + 12*block_index + 0); // x0 y0 z0 x1
+		const __m128 b = _mm_loadu_ps(points + 12*block_index + 4); // y1 z1 x2 y2
+		const __m128 c = _mm_loadu_ps(points + 12*block_index + 8); // z2 x3 y3 z3
+		
+		const __m128 x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+		const __m128 y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+		const __m128 z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), c, _MM_SHUFFLE(3, 0, 2, 0));
+		
+		const __m128 r_x = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(l[0], x), _mm_mul_ps(l[1], y)), _mm_mul_ps(l[2], z)), t_x);
+		const __m128 r_y = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(l[3], x), _mm_mul_ps(l[4], y)), _mm_mul_ps(l[5], z)), t_y);
+		const __m128 r_z = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(l[6], x), _mm_mul_ps(l[7], y)), _mm_mul_ps(l[8], z)), t_z);
+		
+		const __m128 r_a = _mm_shuffle_ps(_mm_shuffle_ps(r_x, r_y, 0x00), _mm_shuffle_ps(r_z, r_x, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+		const __m128 r_b = _mm_shuffle_ps(_mm_shuffle_ps(r_y, r_z, 0x55), _mm_shuffle_ps(r_x, r_y, 0xAA), _MM_SHUFFLE(2, 0, 2, 0));
+		const __m128 r_c = _mm_shuffle_ps(_mm_shuffle_ps(r_z, r_x, _MM_SHUFFLE(3, 3, 2, 2)), _mm_shuffle_ps(r_y, r_z, 0xFF), _MM_SHUFFLE(2, 0, 2, 0));
+		_mm_storeu_ps(result + 12*block_index + 0, r_a);
+		_mm_storeu_ps(result + 12*block_index + 4, r_b);
+		_mm_storeu_ps(result + 12*block_index + 8, r_c);
+	}
+#else
+	for (size_t block_index = 0; block_index < number_of_blocks; ++block_index) {
+		const float32x4x3_t p = vld3q_f32(points + 12*block_index);
+		
+		float32x4x3_t r;
+		for (int row_index = 0; row_index < 3; ++row_index) {
+			float32x4_t sum = vmulq_n_f32(p.val[0], linear[3*row_index + 0]);
+			sum = vaddq_f32(sum, vmulq_n_f32(p.val[1], linear[3*row_index + 1]));
+			sum = vaddq_f32(sum, vmulq_n_f32(p.val[2], linear[3*row_index + 2]));
+			r.val[row_index] = vaddq_f32(sum, vdupq_n_f32(translation[row_index]));
+		}
+		vst3q_f32(result + 12*block_index, r);
+	}
+#endif
+	return 4*number_of_blocks;
+}
+
+// Processes whole blocks of 4 points.
+size_t Toucan::simd::transform_vector2f_array(const float* linear, const float* translation, const float* points, size_t number_of_points, float* result) {
+	const size_t number_of_blocks = number_of_points / 4;
+#if defined(TOUCAN_LINALG_SSE)
+	// Two interleaved points per register, so the matrix columns and the translation are repeated twice.
+	const __m128 column_0 = _mm_set_ps(linear[2], linear[0], linear[2], linear[0]);
+	const __m128 column_1 = _mm_set_ps(linear[3], linear[1], linear[3], linear[1]);
+	const __m128 t = _mm_set_ps(translation[1], translation[0], translation[1], translation[0]);
+	
+	for (size_t block_index = 0; block_index < 2*number_of_blocks; ++block_index) {
+		const __m128 p = _mm_loadu_ps(points + 4*block_index); // x0 y0 x1 y1
+		const __m128 x = _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 0, 0));
+		const __m128 y = _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 1, 1));
+		_mm_storeu_ps(result + 4*block_index, _mm_add_ps(_mm_add_ps(_mm_mul_ps(column_0, x), _mm_mul_ps(column_1, y)), t));
+	}
+#else
+	for (size_t block_index = 0; block_index < number_of_blocks; ++block_index) {
+		const float32x4x2_t p = vld2q_f32(points + 8*block_index);
+		
+		float32x4x2_t r;
+		for (int row_index = 0; row_index < 2; ++row_index) {
+			float32x4_t sum = vmulq_n_f32(p.val[0], linear[2*row_index + 0]);
+			sum = vaddq_f32(sum, vmulq_n_f32(p.val[1], linear[2*row_index + 1]));
+			r.val[row_index] = vaddq_f32(sum, vdupq_n_f32(translation[row_index]));
+		}
+		vst2q_f32(result + 8*block_index, r);
+	}
+#endif
+	return 4*number_of_blocks;
+}
+
+const char* Toucan::simd::get_instruction_set() {
+#if defined(TOUCAN_LINALG_SSE)
+	return cpu_supports_avx() ? "avx" : "sse2";
+#else
+	return "neon";
+#endif
+}
+
+#else // Built without SIMD kernels, the operators use their generic implementations.
+
+bool Toucan::simd::multiply_matrix4f(const float*, const float*, float*) { return false; }
+bool Toucan::simd::multiply_matrix4f_vector4f(const float*, const float*, float*) { return false; }
+bool Toucan::simd::multiply_quaternionf(const float*, const float*, float*) { return false; }
+bool Toucan::simd::rotate_vector3f(const float*, const float*, float*) { return false; }
+size_t Toucan::simd::transform_vector3f_array(const float*, const float*, const float*, size_t, float*) { return 0; }
+size_t Toucan::simd::transform_vector2f_array(const float*, const float*, const float*, size_t, float*) { return 0; }
+const char* Toucan::simd::get_instruction_set() { return "none"; }
+
+#endif
@@ -3,10 +3,18 @@
 #include <numeric>
 #include <cmath>
 #include <cassert>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <stdexcept>
+#include <limits>
 
 #include <iostream>
 
 #include "util/GLDebug.h"
+#include "util/data_bounds.h"
 #include "Utils.h"
 
 #include "asset.h"
@@ -64,7 +72,396 @@ bool Toucan::update_framebuffer_2d(Figure2D& figure_2d, Toucan::Vector2i size) {
 	}
 }
 
-void Toucan::draw_element_2d(Element2D& element_2d, const Matrix4f& model_to_world_matrix, const Matrix4f& world_to_camera_matrix, ToucanContext* context) {
+bool Toucan::element_2d_has_pending_update(const Element2D& element_2d) {
+	if (element_2d.data_buffer_ptr != nullptr) { return true; }
+	
+	if (element_2d.type == ElementType2D::TiledImage2D and element_2d.tiled_image_2d_metadata.tiled_image_ptr != nullptr) {
+		const TiledImage& tiled_image = *element_2d.tiled_image_2d_metadata.tiled_image_ptr;
+		return tiled_image.has_missing_tiles or tiled_image.number_of_levels_ready != tiled_image.number_of_levels_drawn;
+	}
+	
+	if (element_2d.type == ElementType2D::LinePlot2D and element_2d.line_plot_2d_metadata.decimation_ptr != nullptr) {
+		const auto& future = element_2d.line_plot_2d_metadata.decimation_ptr->future;
+		return future.valid() and future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+	}
+	
+	return false;
+}
+
+void upload_line_plot_2d_decimation(Toucan::LinePlot2DMetadata& line_plot_2d_metadata, const std::vector<Toucan::Vector2f>& decimated_points) {
+	auto& decimation = *line_plot_2d_metadata.decimation_ptr;
+	
+	glBindBuffer(GL_ARRAY_BUFFER, line_plot_2d_metadata.vbo);
+	glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(Toucan::Vector2f) * decimated_points.size()), decimated_points.data(), GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glCheckError();
+	
+	decimation.has_result = true;
+	decimation.x_min = decimation.requested_x_min;
+	decimation.x_max = decimation.requested_x_max;
+	decimation.number_of_columns = decimation.requested_number_of_columns;
+	decimation.number_of_vertices = static_cast<int>(decimated_points.size());
+}
+
+// Uploads any finished decimation, and decimates again if the current one does not match the view. Returns the number of vertices to draw.
+int update_line_plot_2d_decimation(Toucan::Element2D& element_2d, const Toucan::Rectangle& view, const Toucan::Vector2i& framebuffer_size, Toucan::ThreadPool& thread_pool) {
+	auto& line_plot_2d_metadata = element_2d.line_plot_2d_metadata;
+	auto& decimation = *line_plot_2d_metadata.decimation_ptr;
+	
+	if (decimation.future.valid() and decimation.future.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+		upload_line_plot_2d_decimation(line_plot_2d_metadata, decimation.future.get());
+	}
+	
+	if (not decimation.pyramid_ready and decimation.pyramid_future.valid() and decimation.pyramid_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+		decimation.pyramid_future.get();
+		decimation.pyramid_ready = true;
+	}
+	
+	// The view in the data space of the line. There is no rotation, so x maps linearly between the spaces.
+	const auto& scaled_transform = line_plot_2d_metadata.settings.scaled_transform;
+	const float x_offset = element_2d.pose.translation.x() + scaled_transform.translation.x();
+	const float x_scale = scaled_transform.scale.x();
+	float view_x_min = (view.min.x() - x_offset) / x_scale;
+	float view_x_max = (view.max.x() - x_offset) / x_scale;
+	if (view_x_min > view_x_max) { std::swap(view_x_min, view_x_max); }
+	
+	const int view_columns = std::max(framebuffer_size.x(), 1);
+	const float column_width = (view_x_max - view_x_min) / static_cast<float>(view_columns);
+	
+	const bool result_matches_view = decimation.has_result and decimation.x_min <= view_x_min and view_x_max <= decimation.x_max and
+			std::abs((decimation.x_max - decimation.x_min) / static_cast<float>(decimation.number_of_columns) - column_width) <= 0.01f*column_width;
+	
+	if (not result_matches_view and not decimation.future.valid() and column_width > 0.0f) {
+		// The columns are aligned to multiples of the column width, so panning does not shift the column boundaries.
+		if (decimation.pyramid_ready) { // Cheap enough to decimate exactly the view, right away
+			decimation.requested_x_min = std::floor(view_x_min / column_width) * column_width;
+			decimation.requested_number_of_columns = view_columns + 1;
+			decimation.requested_x_max = decimation.requested_x_min + static_cast<float>(decimation.requested_number_of_columns) * column_width;
+			
+			upload_line_plot_2d_decimation(line_plot_2d_metadata, Toucan::compute_m4_decimation(
+					decimation.points_ptr, decimation.number_of_points, decimation.pyramid,
+					decimation.requested_x_min, decimation.requested_x_max, decimation.requested_number_of_columns)
+			);
+		} else { // Also decimate one view width to each side in the background, so the result can be reused while panning.
+			decimation.requested_x_min = std::floor((view_x_min - (view_x_max - view_x_min)) / column_width) * column_width;
+			decimation.requested_number_of_columns = 3*view_columns + 1;
+			decimation.requested_x_max = decimation.requested_x_min + static_cast<float>(decimation.requested_number_of_columns) * column_width;
+			
+			decimation.future = thread_pool.submit(
+					[points_ptr = decimation.points_ptr, number_of_points = decimation.number_of_points,
+					 x_min = decimation.requested_x_min, x_max = decimation.requested_x_max, number_of_columns = decimation.requested_number_of_columns]() {
+						return Toucan::compute_m4_decimation(points_ptr, number_of_points, x_min, x_max, number_of_columns);
+					}
+			);
+		}
+	}
+	
+	// Until the first decimation is done, the device buffer holds all the points.
+	return decimation.has_result ? decimation.number_of_vertices : line_plot_2d_metadata.number_of_points;
+}
+
+// Decoding done in `image_2d_fs`, must match its `encoding` uniform.
+enum class ImageEncoding : int { NONE = 0, NV12 = 1, YUYV = 2, BAYER = 3 };
+
+// How an image format is stored on the device. Pixels are uploaded as they are, and converted for display in the image shaders.
+struct ImageTextureFormat {
+	GLint internal_format;
+	GLenum pixel_format;
+	GLenum pixel_type;
+	
+	int number_of_channels;
+	bool is_integer; // Sampled with an usampler2D, and can only be filtered with GL_NEAREST.
+	bool swap_red_blue;
+	
+	float value_scale; // From the sampled value to the pixel value.
+	float default_value_min;
+	float default_value_max;
+	
+	ImageEncoding encoding = ImageEncoding::NONE;
+	Toucan::Vector2i bayer_red_pixel = Toucan::Vector2i::Zero();
+};
+
+ImageTextureFormat get_image_texture_format(Toucan::ImageFormat format) {
+	constexpr float u8_max = std::numeric_limits<uint8_t>::max();
+	constexpr float u16_max = std::numeric_limits<uint16_t>::max();
+	constexpr float s16_min = std::numeric_limits<int16_t>::min();
+	constexpr float s16_max = std::numeric_limits<int16_t>::max();
+	constexpr float u32_max = static_cast<float>(std::numeric_limits<uint32_t>::max());
+	
+	switch (format) {
+		case Toucan::ImageFormat::GRAY_U8: return {GL_R8, GL_RED, GL_UNSIGNED_BYTE, 1, false, false, u8_max, 0.0f, u8_max};
+		case Toucan::ImageFormat::GRAY_U16: return {GL_R16, GL_RED, GL_UNSIGNED_SHORT, 1, false, false, u16_max, 0.0f, u16_max};
+		case Toucan::ImageFormat::GRAY_S16: return {GL_R16_SNORM, GL_RED, GL_SHORT, 1, false, false, s16_max, s16_min, s16_max};
+		case Toucan::ImageFormat::RG_U8: return {GL_RG8, GL_RG, GL_UNSIGNED_BYTE, 2, false, false, u8_max, 0.0f, u8_max};
+		case Toucan::ImageFormat::RG_U16: return {GL_RG16, GL_RG, GL_UNSIGNED_SHORT, 2, false, false, u16_max, 0.0f, u16_max};
+		case Toucan::ImageFormat::RG_U32: return {GL_RG32UI, GL_RG_INTEGER, GL_UNSIGNED_INT, 2, true, false, 1.0f, 0.0f, u32_max};
+		case Toucan::ImageFormat::RG_F32: return {GL_RG32F, GL_RG, GL_FLOAT, 2, false, false, 1.0f, 0.0f, 1.0f};
+		case Toucan::ImageFormat::RGB_U8: return {GL_RGB8, GL_RGB, GL_UNSIGNED_BYTE, 3, false, false, u8_max, 0.0f, u8_max};
+		case Toucan::ImageFormat::RGB_U16: return {GL_RGB16, GL_RGB, GL_UNSIGNED_SHORT, 3, false, false, u16_max, 0.0f, u16_max};
+		case Toucan::ImageFormat::RGB_U32: return {GL_RGB32UI, GL_RGB_INTEGER, GL_UNSIGNED_INT, 3, true, false, 1.0f, 0.0f, u32_max};
+		case Toucan::ImageFormat::RGB_F32: return {GL_RGB32F, GL_RGB, GL_FLOAT, 3, false, false, 1.0f, 0.0f, 1.0f};
+		case Toucan::ImageFormat::BGR_U8: return {GL_RGB8, GL_RGB, GL_UNSIGNED_BYTE, 3, false, true, u8_max, 0.0f, u8_max};
+		case Toucan::ImageFormat::BGR_U16: return {GL_RGB16, GL_RGB, GL_UNSIGNED_SHORT, 3, false, true, u16_max, 0.0f, u16_max};
+		case Toucan::ImageFormat::BGR_U32: return {GL_RGB32UI, GL_RGB_INTEGER, GL_UNSIGNED_INT, 3, true, true, 1.0f, 0.0f, u32_max};
+		case Toucan::ImageFormat::BGR_F32: return {GL_RGB32F, GL_RGB, GL_FLOAT, 3, false, true, 1.0f, 0.0f, 1.0f};
+		// The luma plane of NV12 images, the chroma plane is uploaded to its own RG8 texture.
+		case Toucan::ImageFormat::NV12: return {GL_R8, GL_RED, GL_UNSIGNED_BYTE, 3, false, false, u8_max, 0.0f, u8_max, ImageEncoding::NV12};
+		// One RGBA texel per two pixels.
+		case Toucan::ImageFormat::YUYV: return {GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 3, false, false, u8_max, 0.0f, u8_max, ImageEncoding::YUYV};
+		case Toucan::ImageFormat::BAYER_RGGB_U8: return {GL_R8, GL_RED, GL_UNSIGNED_BYTE, 3, false, false, u8_max, 0.0f, u8_max, ImageEncoding::BAYER, Toucan::Vector2i(0, 0)};
+		case Toucan::ImageFormat::BAYER_BGGR_U8: return {GL_R8, GL_RED, GL_UNSIGNED_BYTE, 3, false, false, u8_max, 0.0f, u8_max, ImageEncoding::BAYER, Toucan::Vector2i(1, 1)};
+		case Toucan::ImageFormat::BAYER_GRBG_U8: return {GL_R8, GL_RED, GL_UNSIGNED_BYTE, 3, false, false, u8_max, 0.0f, u8_max, ImageEncoding::BAYER, Toucan::Vector2i(1, 0)};
+		case Toucan::ImageFormat::BAYER_GBRG_U8: return {GL_R8, GL_RED, GL_UNSIGNED_BYTE, 3, false, false, u8_max, 0.0f, u8_max, ImageEncoding::BAYER, Toucan::Vector2i(0, 1)};
+	}
+	
+	throw std::runtime_error("Toucan error! Unknown image format.");
+}
+
+// Uses the image shader matching the texture format, and sets up the conversion to display colors. The image texture must be bound to texture unit 0, and the chroma texture of NV12 images to texture unit 2.
+unsigned int use_image_2d_shader(AssetContext* asset_context, const ImageTextureFormat& texture_format, float value_min, float value_max, Toucan::Colormap colormap) {
+	const unsigned int image_2d_shader = texture_format.is_integer ? get_image_2d_uint_shader(asset_context) : get_image_2d_shader(asset_context);
+	glUseProgram(image_2d_shader);
+	
+	if (value_min == 0.0f and value_max == 0.0f) {
+		value_min = texture_format.default_value_min;
+		value_max = texture_format.default_value_max;
+	}
+	
+	set_shader_uniform(image_2d_shader, "image", 0);
+	set_shader_uniform(image_2d_shader, "colormap", 1);
+	set_shader_uniform(image_2d_shader, "number_of_channels", texture_format.number_of_channels);
+	set_shader_uniform(image_2d_shader, "swap_red_blue", texture_format.swap_red_blue ? 1 : 0);
+	set_shader_uniform(image_2d_shader, "use_colormap", colormap != Toucan::Colormap::NONE ? 1 : 0);
+	set_shader_uniform(image_2d_shader, "value_scale", texture_format.value_scale);
+	set_shader_uniform(image_2d_shader, "value_min", value_min);
+	set_shader_uniform(image_2d_shader, "value_max", value_max);
+	if (not texture_format.is_integer) {
+		set_shader_uniform(image_2d_shader, "chroma", 2);
+		set_shader_uniform(image_2d_shader, "encoding", static_cast<int>(texture_format.encoding));
+		set_shader_uniform(image_2d_shader, "bayer_red_pixel", texture_format.bayer_red_pixel);
+	}
+	
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_1D, get_colormap_texture(asset_context, colormap));
+	glActiveTexture(GL_TEXTURE0);
+	
+	return image_2d_shader;
+}
+
+// Upper limit on the number of tiles uploaded per frame, so panning over a large image stays interactive. Missing tiles are drawn from a coarser level until they are uploaded.
+constexpr int tiled_image_max_tile_uploads_per_frame = 8;
+
+int get_max_texture_size() {
+	static const int max_texture_size = []() {
+		GLint value = 0;
+		glGetIntegerv(GL_MAX_TEXTURE_SIZE, &value);
+		return static_cast<int>(value);
+	}();
+	return max_texture_size;
+}
+
+void delete_tiled_image_tiles(Toucan::TiledImage& tiled_image) {
+	for (auto& [tile_key, tile] : tiled_image.resident_tiles) {
+		glDeleteTextures(1, &tile.texture);
+	}
+	tiled_image.resident_tiles.clear();
+	tiled_image.resident_size_in_bytes = 0;
+}
+
+// Area covered by the tile, in the unit square the image is drawn on.
+Toucan::Rectangle get_tiled_image_tile_rectangle(const Toucan::TiledImage& tiled_image, int level_index, int tile_x, int tile_y) {
+	const Toucan::TiledImageLevel& level = tiled_image.levels[level_index];
+	const int x_begin = tile_x * tiled_image.tile_size;
+	const int y_begin = tile_y * tiled_image.tile_size;
+	const int x_end = std::min(x_begin + tiled_image.tile_size, level.width);
+	const int y_end = std::min(y_begin + tiled_image.tile_size, level.height);
+	
+	return Toucan::Rectangle(
+			Toucan::Vector2f(static_cast<float>(x_begin) / static_cast<float>(level.width), static_cast<float>(y_begin) / static_cast<float>(level.height)),
+			Toucan::Vector2f(static_cast<float>(x_end) / static_cast<float>(level.width), static_cast<float>(y_end) / static_cast<float>(level.height))
+	);
+}
+
+void upload_tiled_image_tile(Toucan::TiledImage& tiled_image, int level_index, int tile_x, int tile_y) {
+	const Toucan::TiledImageLevel& level = tiled_image.levels[level_index];
+	const int x_begin = tile_x * tiled_image.tile_size;
+	const int y_begin = tile_y * tiled_image.tile_size;
+	const int tile_width = std::min(tiled_image.tile_size, level.width - x_begin);
+	const int tile_height = std::min(tiled_image.tile_size, level.height - y_begin);
+	
+	Toucan::TiledImageTile tile;
+	glGenTextures(1, &tile.texture);
+	glBindTexture(GL_TEXTURE_2D, tile.texture);
+	
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	
+	// Integer textures can not be filtered, so they also do not get mipmaps.
+	const ImageTextureFormat texture_format = get_image_texture_format(tiled_image.format);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texture_format.is_integer ? GL_NEAREST : GL_LINEAR_MIPMAP_LINEAR);
+	
+	// Read the tile directly out of the level, without copying it to a separate buffer.
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, level.width);
+	glPixelStorei(GL_UNPACK_SKIP_PIXELS, x_begin);
+	glPixelStorei(GL_UNPACK_SKIP_ROWS, y_begin);
+	glTexImage2D(GL_TEXTURE_2D, 0, texture_format.internal_format, tile_width, tile_height, 0, texture_format.pixel_format, texture_format.pixel_type, level.pixels_ptr);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+	glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+	
+	if (not texture_format.is_integer) {
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glCheckError();
+	
+	// Textures are stored in the format of the image, with a third more for the mipmaps.
+	tile.size_in_bytes = 4 * Toucan::get_bytes_per_pixel(tiled_image.format) * tile_width * tile_height / 3;
+	tile.last_used_frame = tiled_image.frame_index;
+	
+	tiled_image.resident_size_in_bytes += tile.size_in_bytes;
+	tiled_image.resident_tiles.emplace(Toucan::get_tiled_image_tile_key(level_index, tile_x, tile_y), tile);
+}
+
+// Evicts the least recently used tiles not drawn this frame, until the resident tiles fit in the budget.
+void evict_tiled_image_tiles(Toucan::TiledImage& tiled_image, size_t texture_budget) {
+	if (tiled_image.resident_size_in_bytes <= texture_budget) { return; }
+	
+	std::vector<std::pair<uint64_t, uint64_t>> eviction_candidates; // (last used frame, tile key)
+	for (const auto& [tile_key, tile] : tiled_image.resident_tiles) {
+		if (tile.last_used_frame != tiled_image.frame_index) {
+			eviction_candidates.emplace_back(tile.last_used_frame, tile_key);
+		}
+	}
+	std::sort(eviction_candidates.begin(), eviction_candidates.end());
+	
+	for (const auto& [last_used_frame, tile_key] : eviction_candidates) {
+		if (tiled_image.resident_size_in_bytes <= texture_budget) { break; }
+		
+		auto tile_iterator = tiled_image.resident_tiles.find(tile_key);
+		glDeleteTextures(1, &tile_iterator->second.texture);
+		tiled_image.resident_size_in_bytes -= tile_iterator->second.size_in_bytes;
+		tiled_image.resident_tiles.erase(tile_iterator);
+	}
+}
+
+void draw_tiled_image_2d(Toucan::Element2D& element_2d, const Toucan::Matrix4f& model_to_world_matrix, const Toucan::Matrix4f& world_to_camera_matrix, const Toucan::Rectangle& view, const Toucan::Vector2i& framebuffer_size, Toucan::ToucanContext* context) {
+	using namespace Toucan;
+	
+	auto& tiled_image_2d_metadata = element_2d.tiled_image_2d_metadata;
+	TiledImage& tiled_image = *tiled_image_2d_metadata.tiled_image_ptr;
+	++tiled_image.frame_index;
+	
+	const unsigned int image_draw_width = tiled_image_2d_metadata.settings.image_display_width != 0 ? tiled_image_2d_metadata.settings.image_display_width : tiled_image_2d_metadata.width;
+	const unsigned int image_draw_height = tiled_image_2d_metadata.settings.image_display_height != 0 ? tiled_image_2d_metadata.settings.image_display_height : tiled_image_2d_metadata.height;
+	const Matrix4f image_size_matrix = ScaledTransform2Df(0.0f, Vector2f::Zero(), Vector2f(static_cast<float>(image_draw_width), static_cast<float>(image_draw_height))).transformation_matrix_3d();
+	const Matrix4f model_matrix = model_to_world_matrix * tiled_image_2d_metadata.settings.scaled_transform.transformation_matrix_3d() * image_size_matrix;
+	
+	const auto unit_to_world = [&model_matrix](const Vector2f& point) {
+		const Vector4f world_point = model_matrix * Vector4f(point.x(), point.y(), 0.0f, 1.0f);
+		return Vector2f(world_point.x(), world_point.y());
+	};
+	
+	// Pick the level where one texel is about one pixel on screen.
+	const float image_world_width = Vector2f(model_matrix(0, 0), model_matrix(1, 0)).norm();
+	const float image_world_height = Vector2f(model_matrix(0, 1), model_matrix(1, 1)).norm();
+	const float texels_per_pixel = std::max(
+			(view.width() / static_cast<float>(framebuffer_size.x())) / (image_world_width / static_cast<float>(tiled_image_2d_metadata.width)),
+			(view.height() / static_cast<float>(framebuffer_size.y())) / (image_world_height / static_cast<float>(tiled_image_2d_metadata.height))
+	);
+	
+	const int number_of_levels_ready = tiled_image.number_of_levels_ready;
+	const int coarsest_level_index = static_cast<int>(tiled_image.levels.size()) - 1;
+	int level_index = texels_per_pixel > 1.0f ? static_cast<int>(std::floor(std::log2(texels_per_pixel))) : 0;
+	level_index = std::clamp(level_index, 0, number_of_levels_ready - 1);
+	
+	// The coarsest level is a single tile, kept resident as the fallback for tiles that are not uploaded yet.
+	std::vector<uint64_t> fallback_tile_keys;
+	if (number_of_levels_ready == coarsest_level_index + 1 and level_index != coarsest_level_index) {
+		const uint64_t coarsest_tile_key = get_tiled_image_tile_key(coarsest_level_index, 0, 0);
+		if (tiled_image.resident_tiles.count(coarsest_tile_key) == 0) {
+			upload_tiled_image_tile(tiled_image, coarsest_level_index, 0, 0);
+		}
+		fallback_tile_keys.emplace_back(coarsest_tile_key);
+	}
+	
+	// Find the tiles of the level in view, uploading the missing ones.
+	std::vector<uint64_t> tile_keys;
+	int number_of_uploads = 0;
+	tiled_image.has_missing_tiles = false;
+	const TiledImageLevel& level = tiled_image.levels[level_index];
+	for (int tile_y = 0; tile_y < level.number_of_tiles_y; ++tile_y) {
+		for (int tile_x = 0; tile_x < level.number_of_tiles_x; ++tile_x) {
+			const Rectangle tile_bounds = get_transformed_bounds(get_tiled_image_tile_rectangle(tiled_image, level_index, tile_x, tile_y), unit_to_world);
+			const bool tile_in_view = tile_bounds.max.x() >= view.min.x() and tile_bounds.min.x() <= view.max.x() and tile_bounds.max.y() >= view.min.y() and tile_bounds.min.y() <= view.max.y();
+			if (not tile_in_view) { continue; }
+			
+			const uint64_t tile_key = get_tiled_image_tile_key(level_index, tile_x, tile_y);
+			if (tiled_image.resident_tiles.count(tile_key) == 0) {
+				if (number_of_uploads == tiled_image_max_tile_uploads_per_frame) {
+					tiled_image.has_missing_tiles = true;
+					
+					// Draw the closest resident coarser tile covering it instead.
+					for (int ancestor_level_index = level_index + 1; ancestor_level_index < coarsest_level_index; ++ancestor_level_index) {
+						const int level_offset = ancestor_level_index - level_index;
+						const uint64_t ancestor_tile_key = get_tiled_image_tile_key(ancestor_level_index, tile_x >> level_offset, tile_y >> level_offset);
+						if (tiled_image.resident_tiles.count(ancestor_tile_key) != 0) {
+							fallback_tile_keys.emplace_back(ancestor_tile_key);
+							break;
+						}
+					}
+					continue;
+				}
+				
+				upload_tiled_image_tile(tiled_image, level_index, tile_x, tile_y);
+				++number_of_uploads;
+			}
+			tile_keys.emplace_back(tile_key);
+		}
+	}
+	
+	// Draw the fallback tiles first, coarsest first, so the finer tiles end up on top.
+	std::sort(fallback_tile_keys.begin(), fallback_tile_keys.end(), std::greater<>());
+	fallback_tile_keys.erase(std::unique(fallback_tile_keys.begin(), fallback_tile_keys.end()), fallback_tile_keys.end());
+	tile_keys.insert(tile_keys.begin(), fallback_tile_keys.cbegin(), fallback_tile_keys.cend());
+	
+	const auto& settings = tiled_image_2d_metadata.settings;
+	const unsigned int image_2d_shader = use_image_2d_shader(&context->asset_context, get_image_texture_format(tiled_image.format), settings.value_min, settings.value_max, settings.colormap);
+	set_shader_uniform(image_2d_shader, "view", world_to_camera_matrix);
+	
+	const IndexedGeometryHandles* geometry_handles_ptr = get_quad_handles_ptr(&context->asset_context);
+	glBindVertexArray(geometry_handles_ptr->vao);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, geometry_handles_ptr->ebo);
+	glActiveTexture(GL_TEXTURE0);
+	
+	for (const uint64_t tile_key : tile_keys) {
+		TiledImageTile& tile = tiled_image.resident_tiles.at(tile_key);
+		tile.last_used_frame = tiled_image.frame_index;
+		
+		const int tile_level_index = static_cast<int>(tile_key >> 48u);
+		const int tile_y = static_cast<int>((tile_key >> 24u) & 0xFFFFFFu);
+		const int tile_x = static_cast<int>(tile_key & 0xFFFFFFu);
+		const Rectangle tile_rectangle = get_tiled_image_tile_rectangle(tiled_image, tile_level_index, tile_x, tile_y);
+		const Matrix4f tile_matrix = ScaledTransform2Df(0.0f, tile_rectangle.min, Vector2f(tile_rectangle.width(), tile_rectangle.height())).transformation_matrix_3d();
+		set_shader_uniform(image_2d_shader, "model", model_matrix * tile_matrix);
+		
+		glBindTexture(GL_TEXTURE_2D, tile.texture);
+		glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+	}
+	
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+	glCheckError();
+	
+	evict_tiled_image_tiles(tiled_image, tiled_image_2d_metadata.settings.texture_budget);
+	tiled_image.number_of_levels_drawn = number_of_levels_ready;
+}
+
+void Toucan::draw_element_2d(Element2D& element_2d, const Matrix4f& model_to_world_matrix, const Matrix4f& world_to_camera_matrix, const Rectangle& view, const Vector2i& framebuffer_size, ToucanContext* context) {
 	
 	switch (element_2d.type) {
 		case ElementType2D::LinePlot2D: {
@@ -86,7 +483,23 @@ void Toucan::draw_element_2d(Element2D& element_2d, const Matrix4f& model_to_wor
 				glBindBuffer(GL_ARRAY_BUFFER, 0);
 				glBindVertexArray(0);
 				
-				std::free(element_2d.data_buffer_ptr);
+				auto& line_plot_2d_metadata = element_2d.line_plot_2d_metadata;
+				if (line_plot_2d_metadata.decimation_ptr != nullptr) {
+					destroy_line_plot_decimation(line_plot_2d_metadata.decimation_ptr);
+					line_plot_2d_metadata.decimation_ptr = nullptr;
+				}
+				
+				auto* points_ptr = reinterpret_cast<Vector2f*>(element_2d.data_buffer_ptr);
+				const auto& scaled_transform = line_plot_2d_metadata.settings.scaled_transform;
+				const bool can_decimate =
+						line_plot_2d_metadata.settings.decimate and element_2d.pose.rotation == 0.0f and scaled_transform.rotation == 0.0f and scaled_transform.scale.x() != 0.0f and
+						is_sorted_by_x(points_ptr, line_plot_2d_metadata.number_of_points);
+				
+				if (can_decimate) { // The decimation keeps the points to decimate again when the view changes.
+					line_plot_2d_metadata.decimation_ptr = create_line_plot_decimation(points_ptr, line_plot_2d_metadata.number_of_points, context->thread_pool);
+				} else {
+					std::free(element_2d.data_buffer_ptr);
+				}
 				element_2d.data_buffer_ptr = nullptr;
 				
 				glCheckError();
@@ -94,6 +507,11 @@ void Toucan::draw_element_2d(Element2D& element_2d, const Matrix4f& model_to_wor
 			
 			if (element_2d.line_plot_2d_metadata.number_of_points == 0) { return; }
 			
+			int number_of_vertices = element_2d.line_plot_2d_metadata.number_of_points;
+			if (element_2d.line_plot_2d_metadata.decimation_ptr != nullptr) {
+				number_of_vertices = update_line_plot_2d_decimation(element_2d, view, framebuffer_size, context->thread_pool);
+			}
+			
 			unsigned int lineplot_2d_shader = get_lineplot_2d_shader(&context->asset_context);
 			glUseProgram(lineplot_2d_shader);
 			set_shader_uniform(lineplot_2d_shader, "line_color", element_2d.line_plot_2d_metadata.settings.line_color);
@@ -108,7 +526,7 @@ void Toucan::draw_element_2d(Element2D& element_2d, const Matrix4f& model_to_wor
 			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 			
 			glBindVertexArray(element_2d.line_plot_2d_metadata.vao);
-			glDrawArrays(GL_LINE_STRIP, 0, element_2d.line_plot_2d_metadata.number_of_points);
+			glDrawArrays(GL_LINE_STRIP, 0, number_of_vertices);
 			
 			glDisable(GL_BLEND);
 			glDisable(GL_LINE_SMOOTH);
@@ -194,50 +612,39 @@ void Toucan::draw_element_2d(Element2D& element_2d, const Matrix4f& model_to_wor
 				glActiveTexture(GL_TEXTURE0);
 				glBindTexture(GL_TEXTURE_2D, element_2d.image_2d_metadata.texture);
 				
-				switch (element_2d.image_2d_metadata.format) {
-					case ImageFormat::RG_U8: {
-						glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, static_cast<int>(element_2d.image_2d_metadata.width), static_cast<int>(element_2d.image_2d_metadata.height), 0, GL_RG, GL_UNSIGNED_BYTE, element_2d.data_buffer_ptr);
-					} break;
-					case ImageFormat::RG_U16: {
-						glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, static_cast<int>(element_2d.image_2d_metadata.width), static_cast<int>(element_2d.image_2d_metadata.height), 0, GL_RG, GL_UNSIGNED_SHORT, element_2d.data_buffer_ptr);
-					} break;
-					case ImageFormat::RG_U32: {
-						glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, static_cast<int>(element_2d.image_2d_metadata.width), static_cast<int>(element_2d.image_2d_metadata.height), 0, GL_RG, GL_UNSIGNED_INT, element_2d.data_buffer_ptr);
-					} break;
-					case ImageFormat::RG_F32: {
-						glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, static_cast<int>(element_2d.image_2d_metadata.width), static_cast<int>(element_2d.image_2d_metadata.height), 0, GL_RG, GL_FLOAT, element_2d.data_buffer_ptr);
-					} break;
-					case ImageFormat::RGB_U8: {
-						glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, static_cast<int>(element_2d.image_2d_metadata.width), static_cast<int>(element_2d.image_2d_metadata.height), 0, GL_RGB, GL_UNSIGNED_BYTE, element_2d.data_buffer_ptr);
-					} break;
-					case ImageFormat::RGB_U16: {
-						glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, static_cast<int>(element_2d.image_2d_metadata.width), static_cast<int>(element_2d.image_2d_metadata.height), 0, GL_RGB, GL_UNSIGNED_SHORT, element_2d.data_buffer_ptr);
-					} break;
-					case ImageFormat::RGB_U32: {
-						glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, static_cast<int>(element_2d.image_2d_metadata.width), static_cast<int>(element_2d.image_2d_metadata.height), 0, GL_RGB, GL_UNSIGNED_INT, element_2d.data_buffer_ptr);
-					} break;
-					case ImageFormat::RGB_F32: {
-						glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, static_cast<int>(element_2d.image_2d_metadata.width), static_cast<int>(element_2d.image_2d_metadata.height), 0, GL_RGB, GL_FLOAT, element_2d.data_buffer_ptr);
-					} break;
-					case ImageFormat::BGR_U8: {
-						glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, static_cast<int>(element_2d.image_2d_metadata.width), static_cast<int>(element_2d.image_2d_metadata.height), 0, GL_BGR, GL_UNSIGNED_BYTE, element_2d.data_buffer_ptr);
-					} break;
-					case ImageFormat::BGR_U16: {
-						glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, static_cast<int>(element_2d.image_2d_metadata.width), static_cast<int>(element_2d.image_2d_metadata.height), 0, GL_BGR, GL_UNSIGNED_SHORT, element_2d.data_buffer_ptr);
-					} break;
-					case ImageFormat::BGR_U32: {
-						glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, static_cast<int>(element_2d.image_2d_metadata.width), static_cast<int>(element_2d.image_2d_metadata.height), 0, GL_BGR, GL_UNSIGNED_INT, element_2d.data_buffer_ptr);
-					} break;
-					case ImageFormat::BGR_F32: {
-						glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, static_cast<int>(element_2d.image_2d_metadata.width), static_cast<int>(element_2d.image_2d_metadata.height), 0, GL_BGR, GL_FLOAT, element_2d.data_buffer_ptr);
-					} break;
-					case ImageFormat::GRAY_U16: {
-						glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-						glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_RED);
-						glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
-						glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, static_cast<int>(element_2d.image_2d_metadata.width), static_cast<int>(element_2d.image_2d_metadata.height), 0, GL_RED, GL_UNSIGNED_SHORT, element_2d.data_buffer_ptr);
-					} break;
+				auto& image_2d_metadata = element_2d.image_2d_metadata;
+				const ImageTextureFormat texture_format = get_image_texture_format(image_2d_metadata.format);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texture_format.is_integer ? GL_NEAREST : GL_LINEAR);
+				
+				const int texture_width = texture_format.encoding == ImageEncoding::YUYV ? image_2d_metadata.width / 2 : image_2d_metadata.width;
+				
+				glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+				glTexImage2D(
+						GL_TEXTURE_2D, 0, texture_format.internal_format, texture_width, image_2d_metadata.height, 0,
+						texture_format.pixel_format, texture_format.pixel_type, element_2d.data_buffer_ptr
+				);
+				
+				if (texture_format.encoding == ImageEncoding::NV12) {
+					if (image_2d_metadata.chroma_texture == 0) {
+						glGenTextures(1, &image_2d_metadata.chroma_texture);
+						glBindTexture(GL_TEXTURE_2D, image_2d_metadata.chroma_texture);
+						
+						glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+						glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+						
+						glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+						glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+					}
+					
+					// The interleaved UV plane follows the luma plane.
+					const void* chroma_pixels_ptr = reinterpret_cast<const uint8_t*>(element_2d.data_buffer_ptr) + image_2d_metadata.width * image_2d_metadata.height;
+					glBindTexture(GL_TEXTURE_2D, image_2d_metadata.chroma_texture);
+					glTexImage2D(
+							GL_TEXTURE_2D, 0, GL_RG8, (image_2d_metadata.width + 1) / 2, (image_2d_metadata.height + 1) / 2, 0,
+							GL_RG, GL_UNSIGNED_BYTE, chroma_pixels_ptr
+					);
 				}
+				glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 				
 				glBindTexture(GL_TEXTURE_2D, 0);
 				
@@ -253,8 +660,10 @@ void Toucan::draw_element_2d(Element2D& element_2d, const Matrix4f& model_to_wor
 			if (image_draw_height == 0) { image_draw_height = element_2d.image_2d_metadata.height; }
 			
 			
-			unsigned int image_2d_shader = get_image_2d_shader(&context->asset_context);
-			glUseProgram(image_2d_shader);
+			const auto& settings = element_2d.image_2d_metadata.settings;
+			const unsigned int image_2d_shader = use_image_2d_shader(
+					&context->asset_context, get_image_texture_format(element_2d.image_2d_metadata.format), settings.value_min, settings.value_max, settings.colormap
+			);
 			
 			const Matrix4f image_size_matrix = ScaledTransform2Df(0.0f, Vector2f::Zero(), Vector2f(static_cast<float>(image_draw_width), static_cast<float>(image_draw_height))).transformation_matrix_3d();
 			
@@ -266,6 +675,11 @@ void Toucan::draw_element_2d(Element2D& element_2d, const Matrix4f& model_to_wor
 			glBindVertexArray(geometry_handles_ptr->vao);
 			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, geometry_handles_ptr->ebo);
 			
+			if (element_2d.image_2d_metadata.chroma_texture != 0) {
+				glActiveTexture(GL_TEXTURE2);
+				glBindTexture(GL_TEXTURE_2D, element_2d.image_2d_metadata.chroma_texture);
+			}
+			
 			glActiveTexture(GL_TEXTURE0);
 			glBindTexture(GL_TEXTURE_2D, element_2d.image_2d_metadata.texture);
 			glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
@@ -275,6 +689,24 @@ void Toucan::draw_element_2d(Element2D& element_2d, const Matrix4f& model_to_wor
 			
 			glCheckError();
 		} break;
+		case Toucan::ElementType2D::TiledImage2D: {
+			auto& tiled_image_2d_metadata = element_2d.tiled_image_2d_metadata;
+			
+			if (element_2d.data_buffer_ptr != nullptr) { // New image, replace the tiled image and all of its tiles
+				if (tiled_image_2d_metadata.tiled_image_ptr != nullptr) {
+					delete_tiled_image_tiles(*tiled_image_2d_metadata.tiled_image_ptr);
+					destroy_tiled_image(tiled_image_2d_metadata.tiled_image_ptr);
+				}
+				
+				const int tile_size = std::min(tiled_image_2d_metadata.settings.tile_size, get_max_texture_size());
+				tiled_image_2d_metadata.tiled_image_ptr = create_tiled_image(
+						element_2d.data_buffer_ptr, tiled_image_2d_metadata.width, tiled_image_2d_metadata.height, tiled_image_2d_metadata.format, tile_size, context->thread_pool
+				);
+				element_2d.data_buffer_ptr = nullptr;
+			}
+			
+			draw_tiled_image_2d(element_2d, model_to_world_matrix, world_to_camera_matrix, view, framebuffer_size, context);
+		} break;
 	}
 }
 
@@ -291,9 +723,247 @@ bool Toucan::update_framebuffer_3d(Figure3D& figure_3d, Toucan::Vector2i size) {
 	}
 }
 
+float get_primitive_3d_bounding_radius(const Toucan::Primitive3D& primitive) {
+	// All primitive meshes fit inside the unit cube centered at the origin, i.e. a sphere with radius sqrt(3)/2.
+	constexpr float unit_bounding_radius = 0.8660254f;
+	const auto& scale = primitive.scaled_transform.scale;
+	return unit_bounding_radius * std::max({std::abs(scale.x()), std::abs(scale.y()), std::abs(scale.z())});
+}
+
+// Generates the vertices of the grid lines. Major lines, including the lines through the origin, come first.
+void generate_grid_3d_line_vertices(Toucan::Grid3DMetadata& grid_3d_metadata) {
+	const auto line_extent = grid_3d_metadata.lines;
+	const auto spacing = grid_3d_metadata.spacing;
+	const auto line_extent_position = line_extent * spacing;
+	const auto number_of_lines = 1 + 2*line_extent;
+	
+	std::vector<Toucan::LineVertex3D> line_vertices_major;
+	line_vertices_major.reserve(4*number_of_lines);
+	
+	std::vector<Toucan::LineVertex3D> line_vertices_minor;
+	line_vertices_minor.reserve(4*number_of_lines);
+	
+	// TODO(Matias): Define these colors with a setting
+	const Toucan::Color line_color_origin(0.8, 0.8, 0.8);
+	const Toucan::Color line_color_major(0.4, 0.4, 0.4);
+	const Toucan::Color line_color_minor(0.3, 0.3, 0.3);
+	
+	for (int line_index = -line_extent; line_index <= line_extent; ++line_index) {
+		const bool is_major_line = line_index % 5 == 0;
+		const Toucan::Color& line_color = line_index == 0 ? line_color_origin : (is_major_line ? line_color_major : line_color_minor);
+		auto& line_vertices = is_major_line ? line_vertices_major : line_vertices_minor;
+		
+		// X-axis
+		line_vertices.emplace_back(Toucan::Vector3f(spacing*line_index, -line_extent_position, 0.0f), line_color);
+		line_vertices.emplace_back(Toucan::Vector3f(spacing*line_index, line_extent_position, 0.0f), line_color);
+		
+		// Y-axis
+		line_vertices.emplace_back(Toucan::Vector3f(-line_extent_position, spacing*line_index, 0.0f), line_color);
+		line_vertices.emplace_back(Toucan::Vector3f(line_extent_position, spacing*line_index, 0.0f), line_color);
+	}
+	
+	std::free(grid_3d_metadata.line_vertices_ptr);
+	grid_3d_metadata.line_vertices_ptr = reinterpret_cast<Toucan::LineVertex3D*>(std::malloc(sizeof(Toucan::LineVertex3D) * (line_vertices_major.size() + line_vertices_minor.size())));
+	std::copy(line_vertices_major.cbegin(), line_vertices_major.cend(), grid_3d_metadata.line_vertices_ptr);
+	std::copy(line_vertices_minor.cbegin(), line_vertices_minor.cend(), grid_3d_metadata.line_vertices_ptr + line_vertices_major.size());
+	grid_3d_metadata.number_of_major_vertices = static_cast<unsigned int>(line_vertices_major.size());
+	grid_3d_metadata.number_of_minor_vertices = static_cast<unsigned int>(line_vertices_minor.size());
+}
+
+// Range (min, max) of the depth pixel values with a measurement, i.e. the positive values. The range is empty if there are none.
+template <typename DepthType>
+Toucan::Vector2f compute_depth_image_range(const DepthType* depth_ptr, int width, int height, Toucan::ThreadPool& thread_pool) {
+	constexpr int rows_per_range = 64;
+	const Toucan::Vector2f empty_range(std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest());
+	std::vector<Toucan::Vector2f> row_ranges(static_cast<size_t>((height + rows_per_range - 1) / rows_per_range), empty_range);
+	
+	thread_pool.parallel_for(0, height, rows_per_range, [&](int row_begin, int row_end) {
+		Toucan::Vector2f range = empty_range;
+		for (int pixel_index = row_begin*width; pixel_index < row_end*width; ++pixel_index) {
+			if (depth_ptr[pixel_index] <= 0) { continue; }
+			const float value = static_cast<float>(depth_ptr[pixel_index]);
+			range.x() = std::min(range.x(), value);
+			range.y() = std::max(range.y(), value);
+		}
+		row_ranges[static_cast<size_t>(row_begin / rows_per_range)] = range;
+	});
+	
+	Toucan::Vector2f range = empty_range;
+	for (const auto& row_range : row_ranges) {
+		range.x() = std::min(range.x(), row_range.x());
+		range.y() = std::max(range.y(), row_range.y());
+	}
+	return range;
+}
+
+// CPU work for new element data that does not need the GL context. Large point and line buffers are split over the thread pool in chunks of `point_3d_chunk_size`.
+void prepare_element_3d(Toucan::Element3D& element_3d, Toucan::ThreadPool& thread_pool) {
+	using namespace Toucan;
+	
+	switch (element_3d.type) {
+		case ElementType3D::Grid3D: {
+			auto& grid_3d_metadata = element_3d.grid_3d_metadata;
+			generate_grid_3d_line_vertices(grid_3d_metadata);
+			
+			const float line_extent_position = static_cast<float>(grid_3d_metadata.lines) * grid_3d_metadata.spacing;
+			element_3d.data_bounds_cache = BoundingBox3D();
+			element_3d.data_bounds_cache.extend(Vector3f(-line_extent_position, -line_extent_position, 0.0f));
+			element_3d.data_bounds_cache.extend(Vector3f(line_extent_position, line_extent_position, 0.0f));
+		} break;
+		case ElementType3D::Axis3D: {
+			// The data buffer only signals changed settings, there is nothing to prepare.
+		} break;
+		case ElementType3D::Point3D: {
+			auto& point_3d_metadata = element_3d.point_3d_metadata;
+			const int number_of_chunks = (point_3d_metadata.number_of_points + point_3d_chunk_size - 1) / point_3d_chunk_size;
+			if (number_of_chunks != point_3d_metadata.number_of_chunks) {
+				std::free(point_3d_metadata.chunk_bounds_ptr);
+				point_3d_metadata.chunk_bounds_ptr = reinterpret_cast<BoundingBox3D*>(std::malloc(sizeof(BoundingBox3D) * number_of_chunks));
+				point_3d_metadata.number_of_chunks = number_of_chunks;
+			}
+			
+			const auto* points_ptr = reinterpret_cast<const Point3D*>(element_3d.data_buffer_ptr);
+			thread_pool.parallel_for(0, number_of_chunks, 1, [&](int chunk_begin_index, int chunk_end_index) {
+				for (int chunk_index = chunk_begin_index; chunk_index < chunk_end_index; ++chunk_index) {
+					const int chunk_begin = chunk_index * point_3d_chunk_size;
+					const int chunk_end = std::min(chunk_begin + point_3d_chunk_size, point_3d_metadata.number_of_points);
+					point_3d_metadata.chunk_bounds_ptr[chunk_index] = compute_bounding_box(points_ptr + chunk_begin, chunk_end - chunk_begin);
+				}
+			});
+			
+			element_3d.data_bounds_cache = BoundingBox3D();
+			for (int chunk_index = 0; chunk_index < number_of_chunks; ++chunk_index) {
+				element_3d.data_bounds_cache.extend(point_3d_metadata.chunk_bounds_ptr[chunk_index]);
+			}
+		} break;
+		case ElementType3D::Line3D: {
+			const int number_of_line_vertices = element_3d.line_3d_metadata.number_of_line_vertices;
+			const int number_of_chunks = (number_of_line_vertices + point_3d_chunk_size - 1) / point_3d_chunk_size;
+			std::vector<BoundingBox3D> chunk_bounds(static_cast<size_t>(number_of_chunks));
+			
+			const auto* line_vertices_ptr = reinterpret_cast<const LineVertex3D*>(element_3d.data_buffer_ptr);
+			thread_pool.parallel_for(0, number_of_line_vertices, point_3d_chunk_size, [&](int vertex_begin, int vertex_end) {
+				chunk_bounds[static_cast<size_t>(vertex_begin / point_3d_chunk_size)] = compute_bounding_box(line_vertices_ptr + vertex_begin, vertex_end - vertex_begin);
+			});
+			
+			element_3d.data_bounds_cache = BoundingBox3D();
+			for (const auto& bounds : chunk_bounds) {
+				element_3d.data_bounds_cache.extend(bounds);
+			}
+		} break;
+		case ElementType3D::Primitive3D: {
+			const auto* primitives_ptr = reinterpret_cast<const Primitive3D*>(element_3d.data_buffer_ptr);
+			element_3d.data_bounds_cache = BoundingBox3D();
+			for (int primitive_index = 0; primitive_index < element_3d.primitive_3d_metadata.number_of_primitives; ++primitive_index) {
+				const Primitive3D& primitive = primitives_ptr[primitive_index];
+				const float radius = get_primitive_3d_bounding_radius(primitive);
+				element_3d.data_bounds_cache.extend(primitive.scaled_transform.translation + (-radius)*Vector3f::Ones());
+				element_3d.data_bounds_cache.extend(primitive.scaled_transform.translation + radius*Vector3f::Ones());
+			}
+		} break;
+		case ElementType3D::DepthImage3D: {
+			const auto& depth_image_3d_metadata = element_3d.depth_image_3d_metadata;
+			const int width = depth_image_3d_metadata.depth_width;
+			const int height = depth_image_3d_metadata.depth_height;
+			
+			Vector2f depth_range(1.0f, 0.0f); // Empty until computed
+			switch (depth_image_3d_metadata.depth_format) {
+				case ImageFormat::GRAY_U8: { depth_range = compute_depth_image_range(reinterpret_cast<const uint8_t*>(element_3d.data_buffer_ptr), width, height, thread_pool); } break;
+				case ImageFormat::GRAY_U16: { depth_range = compute_depth_image_range(reinterpret_cast<const uint16_t*>(element_3d.data_buffer_ptr), width, height, thread_pool); } break;
+				case ImageFormat::GRAY_S16: { depth_range = compute_depth_image_range(reinterpret_cast<const int16_t*>(element_3d.data_buffer_ptr), width, height, thread_pool); } break;
+				default: assert(false); break; // Checked in ShowDepthImage3D
+			}
+			
+			// The points are inside the frustum spanned by the image corners, between the nearest and farthest depth.
+			element_3d.data_bounds_cache = BoundingBox3D();
+			if (depth_range.x() > depth_range.y()) { break; }
+			
+			const CameraIntrinsics& intrinsics = depth_image_3d_metadata.intrinsics;
+			for (const float depth_value : {depth_range.x(), depth_range.y()}) {
+				const float depth = depth_value * depth_image_3d_metadata.depth_scale;
+				for (const float u : {0.0f, static_cast<float>(width - 1)}) {
+					for (const float v : {0.0f, static_cast<float>(height - 1)}) {
+						element_3d.data_bounds_cache.extend(Vector3f((u - intrinsics.cx) * depth / intrinsics.fx, (v - intrinsics.cy) * depth / intrinsics.fy, depth));
+					}
+				}
+			}
+		} break;
+		case ElementType3D::Text3D: {
+			// Only the label positions, the text itself has a constant size on screen.
+			const auto* labels_ptr = reinterpret_cast<const Text3DLabel*>(element_3d.data_buffer_ptr);
+			element_3d.data_bounds_cache = BoundingBox3D();
+			for (int label_index = 0; label_index < element_3d.text_3d_metadata.number_of_labels; ++label_index) {
+				element_3d.data_bounds_cache.extend(labels_ptr[label_index].position);
+			}
+		} break;
+	}
+}
+
+void Toucan::prepare_elements_3d(Figure3D& figure_3d, ThreadPool& thread_pool) {
+	std::vector<Element3D*> updated_elements;
+	for (auto& element_3d : figure_3d.elements) {
+		if (element_3d.data_buffer_ptr != nullptr) {
+			updated_elements.emplace_back(&element_3d);
+		}
+	}
+	
+	thread_pool.parallel_for(0, static_cast<int>(updated_elements.size()), 1, [&](int element_begin, int element_end) {
+		for (int element_index = element_begin; element_index < element_end; ++element_index) {
+			prepare_element_3d(*updated_elements[element_index], thread_pool);
+		}
+	});
+}
+
+bool Toucan::element_3d_has_pending_update(const Element3D& element_3d) {
+	if (element_3d.data_buffer_ptr != nullptr) { return true; }
+	
+	if (element_3d.type == ElementType3D::Point3D and element_3d.point_3d_metadata.octree_ptr != nullptr) {
+		const PointOctree& octree = *element_3d.point_3d_metadata.octree_ptr;
+		return octree.build_finished and not octree.uploaded;
+	}
+	
+	return false;
+}
+
+bool Toucan::is_element_3d_in_view(const Element3D& element_3d, const Matrix4f& model_to_world_matrix, const Matrix4f& orientation_and_handedness_matrix, const Matrix4f& world_to_clip_matrix) {
+	if (element_3d_has_pending_update(element_3d)) { return true; } // New data must always be uploaded, and the bounds are not known until then.
+	
+	Matrix4f data_to_world_matrix;
+	BoundingBox3D data_bounds = element_3d.data_bounds_cache;
+	
+	switch (element_3d.type) {
+		case ElementType3D::Grid3D: {
+			data_to_world_matrix = model_to_world_matrix;
+		} break;
+		case ElementType3D::Axis3D: {
+			const float size = element_3d.axis_3d_metadata.settings.size;
+			data_to_world_matrix = model_to_world_matrix * orientation_and_handedness_matrix * ScaledTransform3Df(Quaternionf::Identity(), Vector3f::Zero(), Vector3f::Ones()*size).transformation_matrix();
+			data_bounds = BoundingBox3D();
+			data_bounds.extend(Vector3f::Zero());
+			data_bounds.extend(Vector3f::Ones());
+		} break;
+		case ElementType3D::Point3D: {
+			data_to_world_matrix = model_to_world_matrix * orientation_and_handedness_matrix * element_3d.point_3d_metadata.settings.scaled_transform.transformation_matrix();
+		} break;
+		case ElementType3D::Line3D: {
+			data_to_world_matrix = model_to_world_matrix * orientation_and_handedness_matrix * element_3d.line_3d_metadata.settings.scaled_transform.transformation_matrix();
+		} break;
+		case ElementType3D::Primitive3D: {
+			data_to_world_matrix = model_to_world_matrix * orientation_and_handedness_matrix;
+		} break;
+		case ElementType3D::DepthImage3D: {
+			data_to_world_matrix = model_to_world_matrix * orientation_and_handedness_matrix * element_3d.depth_image_3d_metadata.settings.scaled_transform.transformation_matrix();
+		} break;
+		case ElementType3D::Text3D: {
+			data_to_world_matrix = model_to_world_matrix * orientation_and_handedness_matrix * element_3d.text_3d_metadata.settings.scaled_transform.transformation_matrix();
+		} break;
+	}
+	
+	return frustum_intersects_box(extract_frustum(world_to_clip_matrix * data_to_world_matrix), data_bounds);
+}
 
 void Toucan::draw_element_3d(Toucan::Element3D& element_3d, const Matrix4f& model_to_world_matrix, const Matrix4f& orientation_and_handedness_matrix, const Matrix4f& world_to_camera_matrix, const Matrix4f& projection_matrix,
-                             Toucan::ToucanContext* context) {
+                             const Toucan::Vector2i& framebuffer_size, Toucan::ToucanContext* context) {
 	switch (element_3d.type) {
 		case Toucan::ElementType3D::Grid3D: {
 			
@@ -304,50 +974,9 @@ void Toucan::draw_element_3d(Toucan::Element3D& element_3d, const Matrix4f& mode
 			if (element_3d.grid_3d_metadata.vbo_minor == 0) { glGenBuffers(1, &element_3d.grid_3d_metadata.vbo_minor); glCheckError(); }
 			
 			if (element_3d.data_buffer_ptr != nullptr) { // Do we need to create the grid points again
-				const auto line_extent = element_3d.grid_3d_metadata.lines;
-				const auto spacing = element_3d.grid_3d_metadata.spacing;
-				const auto line_extent_position = line_extent * spacing;
-				const auto number_of_lines = 1 + 2*line_extent;
-				const auto number_of_vertices = 2*number_of_lines;
-				
-				std::vector<LineVertex3D> line_vertices_major;
-				line_vertices_major.reserve(number_of_vertices);
-				
-				std::vector<LineVertex3D> line_vertices_minor;
-				line_vertices_minor.reserve(number_of_vertices);
-				
-				// TODO(Matias): Define these colors with a setting
-				const Color line_color_origin(0.8, 0.8, 0.8);
-				const Color line_color_major(0.4, 0.4, 0.4);
-				const Color line_color_minor(0.3, 0.3, 0.3);
-				
-				for (int line_index = -line_extent; line_index <= line_extent; ++line_index) {
-					if (line_index == 0) { // Special case for lines crossing the origin
-						// X-axis
-						line_vertices_major.emplace_back(Vector3f(spacing*line_index, -line_extent_position, 0.0f), line_color_origin);
-						line_vertices_major.emplace_back(Vector3f(spacing*line_index, line_extent_position, 0.0f), line_color_origin);
-						
-						// Y-axis
-						line_vertices_major.emplace_back(Vector3f(-line_extent_position, spacing*line_index, 0.0f), line_color_origin);
-						line_vertices_major.emplace_back(Vector3f(line_extent_position, spacing*line_index, 0.0f), line_color_origin);
-					} else if (line_index % 5 == 0) { // Major lines
-						// X-axis
-						line_vertices_major.emplace_back(Vector3f(spacing*line_index, -line_extent_position, 0.0f), line_color_major);
-						line_vertices_major.emplace_back(Vector3f(spacing*line_index, line_extent_position, 0.0f), line_color_major);
-						
-						// Y-axis
-						line_vertices_major.emplace_back(Vector3f(-line_extent_position, spacing*line_index, 0.0f), line_color_major);
-						line_vertices_major.emplace_back(Vector3f(line_extent_position, spacing*line_index, 0.0f), line_color_major);
-					} else { // Minor lines
-						// X-axis
-						line_vertices_minor.emplace_back(Vector3f(spacing*line_index, -line_extent_position, 0.0f), line_color_minor);
-						line_vertices_minor.emplace_back(Vector3f(spacing*line_index, line_extent_position, 0.0f), line_color_minor);
-						
-						// Y-axis
-						line_vertices_minor.emplace_back(Vector3f(-line_extent_position, spacing*line_index, 0.0f), line_color_minor);
-						line_vertices_minor.emplace_back(Vector3f(line_extent_position, spacing*line_index, 0.0f), line_color_minor);
-					}
-				}
+				auto& grid_3d_metadata = element_3d.grid_3d_metadata;
+				const LineVertex3D* line_vertices_major_ptr = grid_3d_metadata.line_vertices_ptr;
+				const LineVertex3D* line_vertices_minor_ptr = grid_3d_metadata.line_vertices_ptr + grid_3d_metadata.number_of_major_vertices;
 				
 				constexpr auto position_location = 0;
 				constexpr auto color_location = 1;
@@ -356,8 +985,7 @@ void Toucan::draw_element_3d(Toucan::Element3D& element_3d, const Matrix4f& mode
 				glBindVertexArray(element_3d.grid_3d_metadata.vao_minor);
 				
 				glBindBuffer(GL_ARRAY_BUFFER, element_3d.grid_3d_metadata.vbo_minor);
-				glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(LineVertex3D) * line_vertices_minor.size()), line_vertices_minor.data(), GL_STATIC_DRAW);
-				element_3d.grid_3d_metadata.number_of_minor_vertices = line_vertices_minor.size();
+				glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(LineVertex3D) * grid_3d_metadata.number_of_minor_vertices), line_vertices_minor_ptr, GL_STATIC_DRAW);
 				
 				// Position
 				glVertexAttribPointer(position_location, 3, GL_FLOAT, GL_FALSE, sizeof(LineVertex3D), reinterpret_cast<void*>(offset_of(&LineVertex3D::position)));
@@ -373,9 +1001,7 @@ void Toucan::draw_element_3d(Toucan::Element3D& element_3d, const Matrix4f& mode
 				glBindVertexArray(element_3d.grid_3d_metadata.vao_major);
 				
 				glBindBuffer(GL_ARRAY_BUFFER, element_3d.grid_3d_metadata.vbo_major);
-				glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(LineVertex3D) * line_vertices_major.size()), line_vertices_major.data(), GL_STATIC_DRAW);
-				element_3d.grid_3d_metadata.number_of_major_vertices = line_vertices_major.size();
-				
+				glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(LineVertex3D) * grid_3d_metadata.number_of_major_vertices), line_vertices_major_ptr, GL_STATIC_DRAW);
 				
 				// Position
 				glVertexAttribPointer(position_location, 3, GL_FLOAT, GL_FALSE, sizeof(LineVertex3D), reinterpret_cast<void*>(offset_of(&LineVertex3D::position)));
@@ -390,6 +1016,9 @@ void Toucan::draw_element_3d(Toucan::Element3D& element_3d, const Matrix4f& mode
 				glBindBuffer(GL_ARRAY_BUFFER, 0);
 				glBindVertexArray(0);
 				
+				std::free(grid_3d_metadata.line_vertices_ptr);
+				grid_3d_metadata.line_vertices_ptr = nullptr;
+				
 				// The pointer was just used to indicate change in settings, and did not actually point to any actual data.
 				// Therefore, there is no need to free anything here.
 				element_3d.data_buffer_ptr = nullptr;
@@ -469,10 +1098,35 @@ void Toucan::draw_element_3d(Toucan::Element3D& element_3d, const Matrix4f& mode
 				glVertexAttribIPointer(shape_location, 1, GL_UNSIGNED_BYTE, sizeof(Point3D), reinterpret_cast<void*>(offset_of(&Point3D::shape)));
 				glEnableVertexAttribArray(shape_location);
 				
-				std::free(element_3d.data_buffer_ptr);
+				auto& point_3d_metadata = element_3d.point_3d_metadata;
+				
+				// Any octree over the old points is now stale
+				if (point_3d_metadata.octree_ptr != nullptr) {
+					destroy_point_octree(point_3d_metadata.octree_ptr);
+					point_3d_metadata.octree_ptr = nullptr;
+				}
+				
+				if (point_3d_metadata.settings.level_of_detail) {
+					// The octree takes ownership of the data buffer. All points are drawn until it is built.
+					point_3d_metadata.octree_ptr = create_point_octree(reinterpret_cast<Point3D*>(element_3d.data_buffer_ptr), point_3d_metadata.number_of_points, context->thread_pool);
+				} else {
+					std::free(element_3d.data_buffer_ptr);
+				}
 				element_3d.data_buffer_ptr = nullptr;
 			}
 			
+			// Replace the points on the device with the octree ordered points once the octree is built.
+			PointOctree* octree_ptr = element_3d.point_3d_metadata.octree_ptr;
+			if (octree_ptr != nullptr and octree_ptr->build_finished and not octree_ptr->uploaded) {
+				glBindBuffer(GL_ARRAY_BUFFER, element_3d.point_3d_metadata.vbo);
+				glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(sizeof(Point3D) * octree_ptr->number_of_points), octree_ptr->points_ptr);
+				glBindBuffer(GL_ARRAY_BUFFER, 0);
+				
+				std::free(octree_ptr->points_ptr);
+				octree_ptr->points_ptr = nullptr;
+				octree_ptr->uploaded = true;
+			}
+			
 			unsigned int point_3d_shader = get_point_3d_shader(&context->asset_context);
 			glUseProgram(point_3d_shader);
 			
@@ -484,7 +1138,28 @@ void Toucan::draw_element_3d(Toucan::Element3D& element_3d, const Matrix4f& mode
 			
 			glBindVertexArray(element_3d.point_3d_metadata.vao);
 			glEnable(GL_PROGRAM_POINT_SIZE);
-			glDrawArrays(GL_POINTS, 0, element_3d.point_3d_metadata.number_of_points);
+			
+			if (octree_ptr != nullptr and octree_ptr->uploaded) {
+				select_point_octree_nodes(*octree_ptr, world_to_camera_matrix * model_matrix, projection_matrix, framebuffer_size, element_3d.point_3d_metadata.settings.point_budget);
+				glMultiDrawArrays(GL_POINTS, octree_ptr->selected_firsts.data(), octree_ptr->selected_counts.data(), static_cast<GLsizei>(octree_ptr->selected_firsts.size()));
+			} else {
+				// Only draw the chunks that are inside the view frustum, merging neighbouring visible chunks into a single draw call.
+				const Frustum frustum = extract_frustum(projection_matrix * world_to_camera_matrix * model_matrix);
+				const auto& point_3d_metadata = element_3d.point_3d_metadata;
+				int visible_run_begin = -1;
+				for (int chunk_index = 0; chunk_index <= point_3d_metadata.number_of_chunks; ++chunk_index) {
+					const bool chunk_visible = chunk_index < point_3d_metadata.number_of_chunks and frustum_intersects_box(frustum, point_3d_metadata.chunk_bounds_ptr[chunk_index]);
+					
+					if (chunk_visible and visible_run_begin < 0) {
+						visible_run_begin = chunk_index;
+					} else if (not chunk_visible and visible_run_begin >= 0) {
+						const int first_point = visible_run_begin * point_3d_chunk_size;
+						const int end_point = std::min(chunk_index * point_3d_chunk_size, point_3d_metadata.number_of_points);
+						glDrawArrays(GL_POINTS, first_point, end_point - first_point);
+						visible_run_begin = -1;
+					}
+				}
+			}
 			glBindVertexArray(0);
 			
 			glCheckError();
@@ -560,9 +1235,20 @@ void Toucan::draw_element_3d(Toucan::Element3D& element_3d, const Matrix4f& mode
 			set_shader_uniform(mesh_3d_shader, "projection", projection_matrix);
 			set_shader_uniform(mesh_3d_shader, "light_vector", element_3d.primitive_3d_metadata.settings.light_vector);
 			
+			// The primitives are placed in the oriented data space, but their geometry is not reoriented. The parts of the model matrix that are the
+			// same for all primitives are computed once, so each primitive only costs two matrix products.
+			const Toucan::Matrix4f data_to_world_matrix = model_to_world_matrix * orientation_and_handedness_matrix;
+			const Toucan::Matrix4f orientation_and_handedness_matrix_inverse = orientation_and_handedness_matrix.transpose();
+			
+			const Frustum frustum = extract_frustum(projection_matrix * world_to_camera_matrix * data_to_world_matrix);
+			
 			for (int primitive_index = 0; primitive_index < element_3d.primitive_3d_metadata.number_of_primitives; ++primitive_index) {
 				const Primitive3D& primitive = element_3d.primitive_3d_metadata.vertex_data_ptr[primitive_index];
 				
+				if (not frustum_intersects_sphere(frustum, primitive.scaled_transform.translation, get_primitive_3d_bounding_radius(primitive))) {
+					continue;
+				}
+				
 				const IndexedGeometryHandles* geometry_handles_ptr = nullptr;
 				
 				switch (primitive.type) {
@@ -571,7 +1257,7 @@ void Toucan::draw_element_3d(Toucan::Element3D& element_3d, const Matrix4f& mode
 					case PrimitiveType::Cylinder: { geometry_handles_ptr = get_cylinder_handles_ptr(&context->asset_context); } break;
 				}
 				
-				const Toucan::Matrix4f model_matrix = model_to_world_matrix * orientation_and_handedness_matrix * primitive.scaled_transform.transformation_matrix() * orientation_and_handedness_matrix.transpose();
+				const Toucan::Matrix4f model_matrix = data_to_world_matrix * primitive.scaled_transform.transformation_matrix() * orientation_and_handedness_matrix_inverse;
 				set_shader_uniform(mesh_3d_shader, "model", model_matrix);
 				set_shader_uniform(mesh_3d_shader, "color", primitive.color);
 				
@@ -583,6 +1269,178 @@ void Toucan::draw_element_3d(Toucan::Element3D& element_3d, const Matrix4f& mode
 			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 			glBindVertexArray(0);
 			
+			glCheckError();
+		} break;
+		case Toucan::ElementType3D::DepthImage3D: {
+			auto& depth_image_3d_metadata = element_3d.depth_image_3d_metadata;
+			
+			if (depth_image_3d_metadata.vao == 0) { glGenVertexArrays(1, &depth_image_3d_metadata.vao); glCheckError(); }
+			
+			const ImageTextureFormat depth_texture_format = get_image_texture_format(depth_image_3d_metadata.depth_format);
+			const ImageTextureFormat color_texture_format = get_image_texture_format(depth_image_3d_metadata.color_format);
+			
+			if (element_3d.data_buffer_ptr != nullptr) {
+				// Create the textures if they do not already exist
+				for (unsigned int* texture_ptr : {&depth_image_3d_metadata.depth_texture, &depth_image_3d_metadata.color_texture}) {
+					if (*texture_ptr != 0) { continue; }
+					
+					glGenTextures(1, texture_ptr);
+					glBindTexture(GL_TEXTURE_2D, *texture_ptr);
+					
+					glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+					glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+					
+					glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+					glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+					glBindTexture(GL_TEXTURE_2D, 0);
+					
+					glCheckError();
+				}
+				
+				const void* depth_pixels_ptr = element_3d.data_buffer_ptr;
+				const void* color_pixels_ptr = reinterpret_cast<const uint8_t*>(element_3d.data_buffer_ptr) +
+						get_bytes_per_pixel(depth_image_3d_metadata.depth_format) * depth_image_3d_metadata.depth_width * depth_image_3d_metadata.depth_height;
+				
+				glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+				
+				glBindTexture(GL_TEXTURE_2D, depth_image_3d_metadata.depth_texture);
+				glTexImage2D(
+						GL_TEXTURE_2D, 0, depth_texture_format.internal_format, depth_image_3d_metadata.depth_width, depth_image_3d_metadata.depth_height, 0,
+						depth_texture_format.pixel_format, depth_texture_format.pixel_type, depth_pixels_ptr
+				);
+				
+				glBindTexture(GL_TEXTURE_2D, depth_image_3d_metadata.color_texture);
+				glTexImage2D(
+						GL_TEXTURE_2D, 0, color_texture_format.internal_format, depth_image_3d_metadata.color_width, depth_image_3d_metadata.color_height, 0,
+						color_texture_format.pixel_format, color_texture_format.pixel_type, color_pixels_ptr
+				);
+				
+				glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+				glBindTexture(GL_TEXTURE_2D, 0);
+				
+				glCheckError();
+				
+				std::free(element_3d.data_buffer_ptr);
+				element_3d.data_buffer_ptr = nullptr;
+			}
+			
+			const unsigned int depth_image_3d_shader = get_depth_image_3d_shader(&context->asset_context);
+			glUseProgram(depth_image_3d_shader);
+			
+			const auto& intrinsics = depth_image_3d_metadata.intrinsics;
+			const auto& settings = depth_image_3d_metadata.settings;
+			set_shader_uniform(depth_image_3d_shader, "depth_image", 0);
+			set_shader_uniform(depth_image_3d_shader, "color_image", 1);
+			set_shader_uniform(depth_image_3d_shader, "intrinsics", Vector4f(intrinsics.fx, intrinsics.fy, intrinsics.cx, intrinsics.cy));
+			set_shader_uniform(depth_image_3d_shader, "depth_scale", depth_texture_format.value_scale * depth_image_3d_metadata.depth_scale);
+			set_shader_uniform(depth_image_3d_shader, "number_of_color_channels", color_texture_format.number_of_channels);
+			set_shader_uniform(depth_image_3d_shader, "swap_red_blue", color_texture_format.swap_red_blue ? 1 : 0);
+			set_shader_uniform(depth_image_3d_shader, "size", settings.point_size);
+			set_shader_uniform(depth_image_3d_shader, "shape", static_cast<int>(settings.point_shape));
+			
+			// TODO(Matias): Use uniform buffer object to set the matrix once for all objects that are rendered
+			const Toucan::Matrix4f model_matrix = model_to_world_matrix * orientation_and_handedness_matrix * settings.scaled_transform.transformation_matrix();
+			set_shader_uniform(depth_image_3d_shader, "model", model_matrix);
+			set_shader_uniform(depth_image_3d_shader, "view", world_to_camera_matrix);
+			set_shader_uniform(depth_image_3d_shader, "projection", projection_matrix);
+			
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, depth_image_3d_metadata.depth_texture);
+			glActiveTexture(GL_TEXTURE1);
+			glBindTexture(GL_TEXTURE_2D, depth_image_3d_metadata.color_texture);
+			glActiveTexture(GL_TEXTURE0);
+			
+			glBindVertexArray(depth_image_3d_metadata.vao);
+			glEnable(GL_PROGRAM_POINT_SIZE);
+			glDrawArrays(GL_POINTS, 0, depth_image_3d_metadata.depth_width * depth_image_3d_metadata.depth_height);
+			glBindVertexArray(0);
+			
+			glBindTexture(GL_TEXTURE_2D, 0);
+			
+			glCheckError();
+		} break;
+		case Toucan::ElementType3D::Text3D: {
+			auto& text_3d_metadata = element_3d.text_3d_metadata;
+			
+			if (text_3d_metadata.vao == 0) { glGenVertexArrays(1, &text_3d_metadata.vao); glCheckError(); }
+			if (text_3d_metadata.glyph_vbo == 0) { glGenBuffers(1, &text_3d_metadata.glyph_vbo); glCheckError(); }
+			if (text_3d_metadata.visibility_vbo == 0) { glGenBuffers(1, &text_3d_metadata.visibility_vbo); glCheckError(); }
+			if (text_3d_metadata.layout_ptr == nullptr) { text_3d_metadata.layout_ptr = new Text3DLayout(); }
+			
+			const GlyphAtlas* glyph_atlas_ptr = get_glyph_atlas_ptr(&context->asset_context);
+			Text3DLayout& layout = *text_3d_metadata.layout_ptr;
+			
+			if (element_3d.data_buffer_ptr != nullptr) {
+				// Keep the labels, their positions are needed to hide overlapping labels.
+				std::free(text_3d_metadata.labels_ptr);
+				text_3d_metadata.labels_ptr = reinterpret_cast<Text3DLabel*>(element_3d.data_buffer_ptr);
+				element_3d.data_buffer_ptr = nullptr;
+				
+				layout_text_3d_labels(text_3d_metadata.labels_ptr, text_3d_metadata.number_of_labels, *glyph_atlas_ptr, layout);
+				
+				glBindVertexArray(text_3d_metadata.vao);
+				glBindBuffer(GL_ARRAY_BUFFER, text_3d_metadata.glyph_vbo);
+				glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(GlyphInstance) * layout.glyph_instances.size()), layout.glyph_instances.data(), GL_STATIC_DRAW);
+				
+				const auto set_glyph_attribute = [](unsigned int location, int size, size_t offset) {
+					glVertexAttribPointer(location, size, GL_FLOAT, GL_FALSE, sizeof(GlyphInstance), reinterpret_cast<void*>(offset));
+					glVertexAttribDivisor(location, 1);
+					glEnableVertexAttribArray(location);
+				};
+				set_glyph_attribute(0, 3, offset_of(&GlyphInstance::anchor));
+				set_glyph_attribute(1, 3, offset_of(&GlyphInstance::color));
+				set_glyph_attribute(2, 2, offset_of(&GlyphInstance::offset_min));
+				set_glyph_attribute(3, 2, offset_of(&GlyphInstance::offset_max));
+				set_glyph_attribute(4, 2, offset_of(&GlyphInstance::uv_min));
+				set_glyph_attribute(5, 2, offset_of(&GlyphInstance::uv_max));
+				
+				// Visibility
+				constexpr auto visibility_location = 6;
+				glBindBuffer(GL_ARRAY_BUFFER, text_3d_metadata.visibility_vbo);
+				glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(layout.glyph_visibility.size()), layout.glyph_visibility.data(), GL_DYNAMIC_DRAW);
+				glVertexAttribPointer(visibility_location, 1, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(uint8_t), nullptr);
+				glVertexAttribDivisor(visibility_location, 1);
+				glEnableVertexAttribArray(visibility_location);
+				
+				glBindBuffer(GL_ARRAY_BUFFER, 0);
+				glBindVertexArray(0);
+				
+				glCheckError();
+			}
+			
+			const auto& settings = text_3d_metadata.settings;
+			const float pixels_per_font_pixel = settings.text_size / glyph_atlas_ptr->font_size;
+			const Toucan::Matrix4f model_matrix = model_to_world_matrix * orientation_and_handedness_matrix * settings.scaled_transform.transformation_matrix();
+			
+			if (settings.hide_overlapping and not layout.glyph_instances.empty()) {
+				hide_overlapping_text_3d_labels(text_3d_metadata.labels_ptr, layout, projection_matrix * world_to_camera_matrix * model_matrix, framebuffer_size, pixels_per_font_pixel);
+				
+				glBindBuffer(GL_ARRAY_BUFFER, text_3d_metadata.visibility_vbo);
+				glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(layout.glyph_visibility.size()), layout.glyph_visibility.data());
+				glBindBuffer(GL_ARRAY_BUFFER, 0);
+			}
+			
+			const unsigned int text_3d_shader = get_text_3d_shader(&context->asset_context);
+			glUseProgram(text_3d_shader);
+			
+			// TODO(Matias): Use uniform buffer object to set the matrix once for all objects that are rendered
+			set_shader_uniform(text_3d_shader, "model", model_matrix);
+			set_shader_uniform(text_3d_shader, "view", world_to_camera_matrix);
+			set_shader_uniform(text_3d_shader, "projection", projection_matrix);
+			set_shader_uniform(text_3d_shader, "viewport_size", Vector2f(static_cast<float>(framebuffer_size.x()), static_cast<float>(framebuffer_size.y())));
+			set_shader_uniform(text_3d_shader, "pixels_per_font_pixel", pixels_per_font_pixel);
+			set_shader_uniform(text_3d_shader, "glyph_atlas", 0);
+			
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, glyph_atlas_ptr->texture);
+			
+			// All labels in a single draw call, one instance per glyph.
+			glBindVertexArray(text_3d_metadata.vao);
+			glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(layout.glyph_instances.size()));
+			glBindVertexArray(0);
+			
+			glBindTexture(GL_TEXTURE_2D, 0);
+			
 			glCheckError();
 		} break;
 	}
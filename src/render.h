@@ -5,11 +5,16 @@
 namespace Toucan {
 
 bool update_framebuffer_2d(Figure2D& figure_2d, Toucan::Vector2i size);
-void draw_element_2d(Element2D& element_2d, const Matrix4f& model_to_world_matrix, const Matrix4f& world_to_camera_matrix, ToucanContext* context);
+bool element_2d_has_pending_update(const Element2D& element_2d);
+void draw_element_2d(Element2D& element_2d, const Matrix4f& model_to_world_matrix, const Matrix4f& world_to_camera_matrix, const Rectangle& view, const Vector2i& framebuffer_size, ToucanContext* context);
 
 bool update_framebuffer_3d(Figure3D& figure_3d, Toucan::Vector2i size);
+bool element_3d_has_pending_update(const Toucan::Element3D& element_3d);
+// Computes bounds and vertices for the elements with new data on the thread pool. Must be called before the elements are drawn.
+void prepare_elements_3d(Figure3D& figure_3d, ThreadPool& thread_pool);
+bool is_element_3d_in_view(const Toucan::Element3D& element_3d, const Matrix4f& model_to_world_matrix, const Matrix4f& orientation_and_handedness_matrix, const Matrix4f& world_to_clip_matrix);
 void draw_element_3d(Toucan::Element3D& element_3d, const Matrix4f& model_to_world_matrix, const Matrix4f& orientation_and_handedness_matrix, const Matrix4f& world_to_camera_matrix, const Matrix4f& projection_matrix,
-                     Toucan::ToucanContext* context);
+                     const Toucan::Vector2i& framebuffer_size, Toucan::ToucanContext* context);
 
 void draw_axis_gizmo_3d(const Toucan::RigidTransform3Df& camera_transform, const Toucan::Vector2i& framebuffer_size, const Toucan::Matrix4f& orientation_and_handedness_matrix, Toucan::ToucanContext* context);
 
@@ -0,0 +1,518 @@
+#include <Toucan/Replay.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <Toucan/Toucan.h>
+
+#include "util/capture.h"
+
+namespace {
+
+// A checkpoint is stored once this many bytes of records have passed since the last one, which bounds the number of bytes replayed by a seek.
+constexpr size_t checkpoint_interval_bytes = size_t(64) << 20u;
+
+size_t get_unpadded_image_size_in_bytes(Toucan::ImageFormat format, int width, int height) {
+	return Toucan::get_bytes_per_pixel(format)*width*height;
+}
+
+Toucan::CaptureRecordHeader read_record_header(const uint8_t* mapping_ptr, size_t offset) {
+	Toucan::CaptureRecordHeader record_header;
+	std::memcpy(&record_header, mapping_ptr + offset, sizeof(record_header));
+	return record_header;
+}
+
+// Figures and input windows are identified by their kind and name, elements by the key of their container and their name.
+enum class ContainerKind : char { Figure2D = '2', Figure3D = '3', InputWindow = 'I' };
+
+std::string get_container_key(ContainerKind kind, const std::string& name) {
+	std::string key(1, static_cast<char>(kind));
+	key += name;
+	return key;
+}
+
+} // namespace
+
+Toucan::CaptureReplay::CaptureReplay(const std::string& file_path) {
+	const int file_descriptor = open(file_path.c_str(), O_RDONLY);
+	if (file_descriptor == -1) {
+		throw std::runtime_error("Toucan error! Could not open the capture file '" + file_path + "'.");
+	}
+	
+	struct stat file_stat = {};
+	if (fstat(file_descriptor, &file_stat) != 0 or static_cast<size_t>(file_stat.st_size) < sizeof(CaptureFileHeader)) {
+		close(file_descriptor);
+		throw std::runtime_error("Toucan error! '" + file_path + "' is not a Toucan capture file.");
+	}
+	
+	mapping_size = static_cast<size_t>(file_stat.st_size);
+	void* mapping = mmap(nullptr, mapping_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+	close(file_descriptor); // The mapping keeps the file open.
+	if (mapping == MAP_FAILED) {
+		throw std::runtime_error("Toucan error! Could not map the capture file '" + file_path + "'.");
+	}
+	mapping_ptr = static_cast<const uint8_t*>(mapping);
+	
+	CaptureFileHeader file_header;
+	std::memcpy(&file_header, mapping_ptr, sizeof(file_header));
+	if (std::memcmp(file_header.magic, capture_file_magic, sizeof(capture_file_magic)) != 0 or
+	    file_header.version != capture_file_version or
+	    file_header.record_header_size != sizeof(CaptureRecordHeader)) {
+		munmap(mapping, mapping_size);
+		throw std::runtime_error("Toucan error! '" + file_path + "' is not a Toucan capture file, or was recorded by an incompatible version of Toucan.");
+	}
+	start_time_ns = file_header.start_time_ns;
+	
+	try {
+		build_index();
+	} catch (...) {
+		munmap(mapping, mapping_size);
+		throw;
+	}
+}
+
+Toucan::CaptureReplay::~CaptureReplay() {
+	munmap(const_cast<uint8_t*>(mapping_ptr), mapping_size);
+}
+
+bool Toucan::CaptureReplay::replay_until(int64_t timestamp_ns) {
+	size_t seek_point_index = current_seek_point_index;
+	while (seek_point_index + 1 < seek_points.size() and seek_points[seek_point_index + 1].timestamp_ns <= timestamp_ns) {
+		++seek_point_index;
+	}
+	
+	replay_frames(seek_point_index);
+	return not is_at_end();
+}
+
+bool Toucan::CaptureReplay::replay_next_frame() {
+	if (not is_at_end()) {
+		replay_frames(current_seek_point_index + 1);
+	}
+	return not is_at_end();
+}
+
+void Toucan::CaptureReplay::seek(int64_t timestamp_ns) {
+	const auto seek_point_it = std::upper_bound(seek_points.begin(), seek_points.end(), timestamp_ns, [](int64_t value, const SeekPoint& seek_point){
+		return value < seek_point.timestamp_ns;
+	});
+	const size_t seek_point_index = seek_point_it == seek_points.begin() ? 0 : static_cast<size_t>(seek_point_it - seek_points.begin()) - 1;
+	
+	const auto checkpoint_it = std::upper_bound(checkpoints.begin(), checkpoints.end(), seek_point_index, [](size_t index, const Checkpoint& checkpoint){
+		return index < checkpoint.seek_point_index;
+	});
+	assert(checkpoint_it != checkpoints.begin()); // There is always a checkpoint at the start of the capture.
+	const Checkpoint& checkpoint = *(checkpoint_it - 1);
+	
+	// Replaying forwards is cheaper, as long as there is no checkpoint in between.
+	if (seek_point_index < current_seek_point_index or current_seek_point_index < checkpoint.seek_point_index) {
+		replay_checkpoint(checkpoint);
+		current_seek_point_index = checkpoint.seek_point_index;
+	}
+	
+	replay_frames(seek_point_index);
+}
+
+int64_t Toucan::CaptureReplay::get_next_timestamp() const {
+	return is_at_end() ? get_duration() : seek_points[current_seek_point_index + 1].timestamp_ns;
+}
+
+void Toucan::CaptureReplay::build_index() {
+	const size_t begin_offset = sizeof(CaptureFileHeader);
+	seek_points.push_back({0, begin_offset});
+	checkpoints.emplace_back().seek_point_index = 0;
+	
+	// The state of the recording program, tracked the same way as in `Toucan.cpp`.
+	std::unordered_map<std::string, size_t> container_indices;
+	std::vector<size_t> container_record_offsets;
+	std::unordered_map<std::string, size_t> element_indices;
+	std::vector<CheckpointElement> elements;
+	
+	std::string current_figure_2d_key, current_figure_3d_key, current_input_window_key;
+	size_t current_figure_2d_index = 0, current_figure_3d_index = 0, current_input_window_index = 0;
+	bool figure_2d_active = false, figure_3d_active = false, input_window_active = false;
+	std::vector<RigidTransform2Df> pose_stack_2d;
+	std::vector<RigidTransform3Df> pose_stack_3d;
+	
+	const auto begin_container = [&](ContainerKind kind, const std::string& name, size_t record_offset, std::string& current_key, size_t& current_index) {
+		current_key = get_container_key(kind, name);
+		const auto [container_it, inserted] = container_indices.try_emplace(current_key, container_record_offsets.size());
+		if (inserted) {
+			container_record_offsets.push_back(record_offset);
+		} else {
+			container_record_offsets[container_it->second] = record_offset;
+		}
+		current_index = container_it->second;
+	};
+	
+	const auto show_element = [&](const std::string& container_key, size_t container_index, const std::string& name, size_t record_offset) -> CheckpointElement& {
+		std::string element_key = container_key;
+		element_key += '\0';
+		element_key += name;
+		
+		const auto [element_it, inserted] = element_indices.try_emplace(std::move(element_key), elements.size());
+		if (inserted) {
+			elements.emplace_back();
+		}
+		
+		CheckpointElement& element = elements[element_it->second];
+		element.record_offset = record_offset;
+		element.container_index = container_index;
+		return element;
+	};
+	
+	size_t checkpoint_offset = begin_offset;
+	size_t offset = begin_offset;
+	while (mapping_size - offset >= sizeof(CaptureRecordHeader)) {
+		const CaptureRecordHeader record_header = read_record_header(mapping_ptr, offset);
+		const size_t payload_offset = offset + sizeof(CaptureRecordHeader);
+		if (record_header.payload_size > mapping_size - payload_offset) {
+			break; // The last record was cut short.
+		}
+		const size_t next_offset = payload_offset + record_header.payload_size;
+		
+		CaptureRecordReader reader(mapping_ptr + payload_offset, record_header.payload_size);
+		bool frame_ended = false;
+		
+		switch (static_cast<CaptureRecordType>(record_header.type)) {
+			case CaptureRecordType::BeginFigure2D: {
+				begin_container(ContainerKind::Figure2D, reader.read_string(), offset, current_figure_2d_key, current_figure_2d_index);
+				figure_2d_active = true;
+				pose_stack_2d.assign(1, RigidTransform2Df::Identity());
+			} break;
+			case CaptureRecordType::EndFigure2D: {
+				figure_2d_active = false;
+				frame_ended = true;
+			} break;
+			case CaptureRecordType::PushPose2D: {
+				if (pose_stack_2d.empty()) { throw std::runtime_error("Toucan error! The capture file is corrupt."); }
+				const auto pose = reader.read_value<RigidTransform2Df>();
+				pose_stack_2d.push_back(pose_stack_2d.back() * pose);
+			} break;
+			case CaptureRecordType::PopPose2D: {
+				if (pose_stack_2d.size() <= 1) { throw std::runtime_error("Toucan error! The capture file is corrupt."); }
+				pose_stack_2d.pop_back();
+			} break;
+			case CaptureRecordType::ClearPose2D: {
+				pose_stack_2d.assign(1, RigidTransform2Df::Identity());
+			} break;
+			case CaptureRecordType::ShowLinePlot2D:
+			case CaptureRecordType::ShowPoints2D:
+			case CaptureRecordType::ShowImage2D:
+			case CaptureRecordType::ShowTiledImage2D: {
+				if (not figure_2d_active) { throw std::runtime_error("Toucan error! The capture file is corrupt."); }
+				show_element(current_figure_2d_key, current_figure_2d_index, reader.read_string(), offset).pose_2d = pose_stack_2d.back();
+			} break;
+			case CaptureRecordType::BeginFigure3D: {
+				begin_container(ContainerKind::Figure3D, reader.read_string(), offset, current_figure_3d_key, current_figure_3d_index);
+				figure_3d_active = true;
+				pose_stack_3d.assign(1, RigidTransform3Df::Identity());
+			} break;
+			case CaptureRecordType::EndFigure3D: {
+				figure_3d_active = false;
+				frame_ended = true;
+			} break;
+			case CaptureRecordType::PushPose3D: {
+				if (pose_stack_3d.empty()) { throw std::runtime_error("Toucan error! The capture file is corrupt."); }
+				const auto pose = reader.read_value<RigidTransform3Df>();
+				pose_stack_3d.push_back(pose_stack_3d.back() * pose);
+			} break;
+			case CaptureRecordType::PopPose3D: {
+				if (pose_stack_3d.size() <= 1) { throw std::runtime_error("Toucan error! The capture file is corrupt."); }
+				pose_stack_3d.pop_back();
+			} break;
+			case CaptureRecordType::ClearPose3D: {
+				pose_stack_3d.assign(1, RigidTransform3Df::Identity());
+			} break;
+			case CaptureRecordType::ShowAxis3D:
+			case CaptureRecordType::ShowPoints3D:
+			case CaptureRecordType::ShowLines3D:
+			case CaptureRecordType::ShowPrimitives3D:
+			case CaptureRecordType::ShowText3D:
+			case CaptureRecordType::ShowDepthImage3D: {
+				if (not figure_3d_active) { throw std::runtime_error("Toucan error! The capture file is corrupt."); }
+				show_element(current_figure_3d_key, current_figure_3d_index, reader.read_string(), offset).pose_3d = pose_stack_3d.back();
+			} break;
+			case CaptureRecordType::BeginInputWindow: {
+				begin_container(ContainerKind::InputWindow, reader.read_string(), offset, current_input_window_key, current_input_window_index);
+				input_window_active = true;
+			} break;
+			case CaptureRecordType::EndInputWindow: {
+				input_window_active = false;
+				frame_ended = true;
+			} break;
+			case CaptureRecordType::ShowButton:
+			case CaptureRecordType::ShowCheckbox:
+			case CaptureRecordType::ShowSliderFloat:
+			case CaptureRecordType::ShowSliderFloat2:
+			case CaptureRecordType::ShowSliderFloat3:
+			case CaptureRecordType::ShowSliderFloat4:
+			case CaptureRecordType::ShowSliderInt:
+			case CaptureRecordType::ShowSliderInt2:
+			case CaptureRecordType::ShowSliderInt3:
+			case CaptureRecordType::ShowSliderInt4:
+			case CaptureRecordType::ShowColorPicker: {
+				if (not input_window_active) { throw std::runtime_error("Toucan error! The capture file is corrupt."); }
+				show_element(current_input_window_key, current_input_window_index, reader.read_string(), offset);
+			} break;
+			default: break; // Recorded by a later version of Toucan, skipped when replayed.
+		}
+		
+		offset = next_offset;
+		
+		if (frame_ended and not figure_2d_active and not figure_3d_active and not input_window_active) {
+			seek_points.push_back({record_header.timestamp_ns, offset});
+			
+			if (offset - checkpoint_offset >= checkpoint_interval_bytes) {
+				Checkpoint& checkpoint = checkpoints.emplace_back();
+				checkpoint.seek_point_index = seek_points.size() - 1;
+				checkpoint.container_record_offsets = container_record_offsets;
+				checkpoint.elements = elements;
+				
+				// Replayed one container at a time.
+				std::stable_sort(checkpoint.elements.begin(), checkpoint.elements.end(), [](const CheckpointElement& a, const CheckpointElement& b){
+					return a.container_index < b.container_index;
+				});
+				
+				checkpoint_offset = offset;
+			}
+		}
+	}
+}
+
+void Toucan::replay_capture_record(const uint8_t* record_ptr) {
+	const CaptureRecordHeader record_header = read_record_header(record_ptr, 0);
+	CaptureRecordReader reader(record_ptr + sizeof(CaptureRecordHeader), record_header.payload_size);
+	
+	// The fields are read into variables first, as the evaluation order of function arguments is unspecified.
+	switch (static_cast<CaptureRecordType>(record_header.type)) {
+		case CaptureRecordType::BeginFigure2D: {
+			const auto name = reader.read_string();
+			const auto settings = reader.read_value<Figure2DSettings>();
+			BeginFigure2D(name, settings);
+		} break;
+		case CaptureRecordType::EndFigure2D: {
+			EndFigure2D();
+		} break;
+		case CaptureRecordType::PushPose2D: {
+			PushPose2D(reader.read_value<RigidTransform2Df>());
+		} break;
+		case CaptureRecordType::PopPose2D: {
+			PopPose2D();
+		} break;
+		case CaptureRecordType::ClearPose2D: {
+			ClearPose2D();
+		} break;
+		case CaptureRecordType::ShowLinePlot2D: {
+			const auto name = reader.read_string();
+			const auto line_buffer = reader.read_buffer<Vector2f>();
+			const auto draw_layer = reader.read_value<int>();
+			const auto settings = reader.read_value<ShowLinePlot2DSettings>();
+			ShowLinePlot2D(name, line_buffer, draw_layer, settings);
+		} break;
+		case CaptureRecordType::ShowPoints2D: {
+			const auto name = reader.read_string();
+			const auto points_buffer = reader.read_buffer<Point2D>();
+			const auto draw_layer = reader.read_value<int>();
+			const auto settings = reader.read_value<ShowPoints2DSettings>();
+			ShowPoints2D(name, points_buffer, draw_layer, settings);
+		} break;
+		case CaptureRecordType::ShowImage2D: {
+			const auto name = reader.read_string();
+			const auto image = reader.read_image(get_image_size_in_bytes);
+			const auto draw_layer = reader.read_value<int>();
+			const auto settings = reader.read_value<ShowImage2DSettings>();
+			ShowImage2D(name, image, draw_layer, settings);
+		} break;
+		case CaptureRecordType::ShowTiledImage2D: {
+			const auto name = reader.read_string();
+			const auto image = reader.read_image(get_unpadded_image_size_in_bytes);
+			const auto draw_layer = reader.read_value<int>();
+			const auto settings = reader.read_value<ShowTiledImage2DSettings>();
+			ShowTiledImage2D(name, image, draw_layer, settings);
+		} break;
+		case CaptureRecordType::BeginFigure3D: {
+			const auto name = reader.read_string();
+			const auto settings = reader.read_value<Figure3DSettings>();
+			BeginFigure3D(name, settings);
+		} break;
+		case CaptureRecordType::EndFigure3D: {
+			EndFigure3D();
+		} break;
+		case CaptureRecordType::PushPose3D: {
+			PushPose3D(reader.read_value<RigidTransform3Df>());
+		} break;
+		case CaptureRecordType::PopPose3D: {
+			PopPose3D();
+		} break;
+		case CaptureRecordType::ClearPose3D: {
+			ClearPose3D();
+		} break;
+		case CaptureRecordType::ShowAxis3D: {
+			const auto name = reader.read_string();
+			const auto settings = reader.read_value<ShowAxis3DSettings>();
+			ShowAxis3D(name, settings);
+		} break;
+		case CaptureRecordType::ShowPoints3D: {
+			const auto name = reader.read_string();
+			const auto points_buffer = reader.read_buffer<Point3D>();
+			const auto settings = reader.read_value<ShowPoints3DSettings>();
+			ShowPoints3D(name, points_buffer, settings);
+		} break;
+		case CaptureRecordType::ShowLines3D: {
+			const auto name = reader.read_string();
+			const auto lines_buffer = reader.read_buffer<LineVertex3D>();
+			const auto settings = reader.read_value<ShowLines3DSettings>();
+			ShowLines3D(name, lines_buffer, settings);
+		} break;
+		case CaptureRecordType::ShowPrimitives3D: {
+			const auto name = reader.read_string();
+			const auto primitives_buffer = reader.read_buffer<Primitive3D>();
+			const auto settings = reader.read_value<ShowPrimitives3DSettings>();
+			ShowPrimitives3D(name, primitives_buffer, settings);
+		} break;
+		case CaptureRecordType::ShowText3D: {
+			const auto name = reader.read_string();
+			const auto labels_buffer = reader.read_buffer<Text3DLabel>();
+			const auto settings = reader.read_value<ShowText3DSettings>();
+			ShowText3D(name, labels_buffer, settings);
+		} break;
+		case CaptureRecordType::ShowDepthImage3D: {
+			const auto name = reader.read_string();
+			const auto depth_image = reader.read_image(get_unpadded_image_size_in_bytes);
+			const auto color_image = reader.read_image(get_unpadded_image_size_in_bytes);
+			const auto intrinsics = reader.read_value<CameraIntrinsics>();
+			const auto depth_scale = reader.read_value<float>();
+			const auto settings = reader.read_value<ShowDepthImage3DSettings>();
+			ShowDepthImage3D(name, depth_image, color_image, intrinsics, depth_scale, settings);
+		} break;
+		case CaptureRecordType::BeginInputWindow: {
+			const auto name = reader.read_string();
+			const auto settings = reader.read_value<InputSettings>();
+			BeginInputWindow(name, settings);
+		} break;
+		case CaptureRecordType::EndInputWindow: {
+			EndInputWindow();
+		} break;
+		case CaptureRecordType::ShowButton: {
+			const auto name = reader.read_string();
+			const auto settings = reader.read_value<ShowButtonSettings>();
+			ShowButton(name, settings);
+		} break;
+		case CaptureRecordType::ShowCheckbox: {
+			const auto name = reader.read_string();
+			auto value = reader.read_value<bool>();
+			const auto settings = reader.read_value<ShowCheckboxSettings>();
+			ShowCheckbox(name, value, settings);
+		} break;
+		case CaptureRecordType::ShowSliderFloat: {
+			const auto name = reader.read_string();
+			auto value = reader.read_value<float>();
+			const auto settings = reader.read_value<ShowSliderFloatSettings>();
+			ShowSliderFloat(name, value, settings);
+		} break;
+		case CaptureRecordType::ShowSliderFloat2: {
+			const auto name = reader.read_string();
+			auto value = reader.read_value<Vector2f>();
+			const auto settings = reader.read_value<ShowSliderFloatSettings>();
+			ShowSliderFloat2(name, value, settings);
+		} break;
+		case CaptureRecordType::ShowSliderFloat3: {
+			const auto name = reader.read_string();
+			auto value = reader.read_value<Vector3f>();
+			const auto settings = reader.read_value<ShowSliderFloatSettings>();
+			ShowSliderFloat3(name, value, settings);
+		} break;
+		case CaptureRecordType::ShowSliderFloat4: {
+			const auto name = reader.read_string();
+			auto value = reader.read_value<Vector4f>();
+			const auto settings = reader.read_value<ShowSliderFloatSettings>();
+			ShowSliderFloat4(name, value, settings);
+		} break;
+		case CaptureRecordType::ShowSliderInt: {
+			const auto name = reader.read_string();
+			auto value = reader.read_value<int>();
+			const auto settings = reader.read_value<ShowSliderIntSettings>();
+			ShowSliderInt(name, value, settings);
+		} break;
+		case CaptureRecordType::ShowSliderInt2: {
+			const auto name = reader.read_string();
+			auto value = reader.read_value<Vector2i>();
+			const auto settings = reader.read_value<ShowSliderIntSettings>();
+			ShowSliderInt2(name, value, settings);
+		} break;
+		case CaptureRecordType::ShowSliderInt3: {
+			const auto name = reader.read_string();
+			auto value = reader.read_value<Vector3i>();
+			const auto settings = reader.read_value<ShowSliderIntSettings>();
+			ShowSliderInt3(name, value, settings);
+		} break;
+		case CaptureRecordType::ShowSliderInt4: {
+			const auto name = reader.read_string();
+			auto value = reader.read_value<Vector4i>();
+			const auto settings = reader.read_value<ShowSliderIntSettings>();
+			ShowSliderInt4(name, value, settings);
+		} break;
+		case CaptureRecordType::ShowColorPicker: {
+			const auto name = reader.read_string();
+			auto value = reader.read_value<Color>();
+			const auto settings = reader.read_value<ShowColorPickerSettings>();
+			ShowColorPicker(name, value, settings);
+		} break;
+		default: break;
+	}
+}
+
+void Toucan::CaptureReplay::replay_frames(size_t seek_point_index) {
+	assert(seek_point_index >= current_seek_point_index and seek_point_index < seek_points.size());
+	
+	const size_t end_offset = seek_points[seek_point_index].offset;
+	for (size_t offset = seek_points[current_seek_point_index].offset; offset < end_offset;) {
+		replay_capture_record(mapping_ptr + offset);
+		offset += sizeof(CaptureRecordHeader) + read_record_header(mapping_ptr, offset).payload_size;
+	}
+	
+	current_seek_point_index = seek_point_index;
+}
+
+void Toucan::CaptureReplay::replay_checkpoint(const Checkpoint& checkpoint) {
+	for (auto element_it = checkpoint.elements.begin(); element_it != checkpoint.elements.end();) {
+		const size_t container_index = element_it->container_index;
+		const size_t container_record_offset = checkpoint.container_record_offsets[container_index];
+		const auto container_type = static_cast<CaptureRecordType>(read_record_header(mapping_ptr, container_record_offset).type);
+		
+		replay_capture_record(mapping_ptr + container_record_offset);
+		for (; element_it != checkpoint.elements.end() and element_it->container_index == container_index; ++element_it) {
+			// Shown with the pose the element was last shown with, on top of the identity pose set by the Begin* call.
+			if (container_type == CaptureRecordType::BeginFigure2D) {
+				PushPose2D(element_it->pose_2d);
+			} else if (container_type == CaptureRecordType::BeginFigure3D) {
+				PushPose3D(element_it->pose_3d);
+			}
+			
+			replay_capture_record(mapping_ptr + element_it->record_offset);
+			
+			if (container_type == CaptureRecordType::BeginFigure2D) {
+				PopPose2D();
+			} else if (container_type == CaptureRecordType::BeginFigure3D) {
+				PopPose3D();
+			}
+		}
+		
+		if (container_type == CaptureRecordType::BeginFigure2D) {
+			EndFigure2D();
+		} else if (container_type == CaptureRecordType::BeginFigure3D) {
+			EndFigure3D();
+		} else {
+			EndInputWindow();
+		}
+	}
+}
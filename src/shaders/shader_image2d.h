@@ -13,36 +13,134 @@ uniform mat4 view;
 
 void main() {
 	uv_coordinate = uv;
-
+	
 	gl_Position = view * model * vec4(position, 1.0);
 }
 )GLSL";
 
-const auto image_2d_rgb_fs = R"GLSL(
+// Images are uploaded in their own format. Normalized and floating point textures are sampled with this shader.
+// Camera formats are decoded to RGB here: NV12 from a luma and a chroma texture, YUYV from an RGBA texture with one texel per two pixels, and Bayer mosaics with bilinear demosaicing.
+const auto image_2d_fs = R"GLSL(
 #version 330 core
 
 in vec2 uv_coordinate;
 
 uniform sampler2D image;
+uniform sampler2D chroma; // UV plane of NV12 images
+uniform sampler1D colormap;
+
+uniform int number_of_channels;
+uniform bool swap_red_blue;
+uniform bool use_colormap;
+uniform float value_scale; // Sampled value to pixel value, e.g. 255 for 8-bit normalized textures.
+uniform float value_min;
+uniform float value_max;
+
+// 0: None, 1: NV12, 2: YUYV, 3: Bayer
+uniform int encoding;
+uniform ivec2 bayer_red_pixel; // Position of the red pixel in the top left 2x2 block.
 
 out vec4 fragment_color;
 
+// BT.601 limited range, as used by most cameras.
+vec3 yuv_to_rgb(float y, vec2 uv) {
+	float luma = 1.164 * (y - 16.0/255.0);
+	vec2 chroma = uv - 0.5;
+	return clamp(vec3(
+		luma + 1.596*chroma.y,
+		luma - 0.392*chroma.x - 0.813*chroma.y,
+		luma + 2.017*chroma.x
+	), 0.0, 1.0);
+}
+
+float bayer_value(ivec2 pixel, ivec2 image_size) {
+	// Reflect by two pixels at the border to stay on the same color.
+	pixel.x = pixel.x < 0 ? pixel.x + 2 : (pixel.x >= image_size.x ? pixel.x - 2 : pixel.x);
+	pixel.y = pixel.y < 0 ? pixel.y + 2 : (pixel.y >= image_size.y ? pixel.y - 2 : pixel.y);
+	return texelFetch(image, pixel, 0).r;
+}
+
+vec3 demosaic(ivec2 pixel, ivec2 image_size) {
+	float center = bayer_value(pixel, image_size);
+	float horizontal = 0.5*(bayer_value(pixel + ivec2(-1, 0), image_size) + bayer_value(pixel + ivec2(1, 0), image_size));
+	float vertical = 0.5*(bayer_value(pixel + ivec2(0, -1), image_size) + bayer_value(pixel + ivec2(0, 1), image_size));
+	float cross = 0.5*(horizontal + vertical);
+	float diagonal = 0.25*(
+		bayer_value(pixel + ivec2(-1, -1), image_size) + bayer_value(pixel + ivec2(1, -1), image_size) +
+		bayer_value(pixel + ivec2(-1, 1), image_size) + bayer_value(pixel + ivec2(1, 1), image_size)
+	);
+	
+	ivec2 parity = (pixel + bayer_red_pixel) % 2; // (0, 0) on red pixels, (1, 1) on blue pixels
+	if (parity.x == 0 && parity.y == 0) {
+		return vec3(center, cross, diagonal);
+	} else if (parity.x == 1 && parity.y == 1) {
+		return vec3(diagonal, cross, center);
+	} else if (parity.y == 0) { // Green pixel on a red row
+		return vec3(horizontal, center, vertical);
+	} else { // Green pixel on a blue row
+		return vec3(vertical, center, horizontal);
+	}
+}
+
+vec3 sample_image() {
+	if (encoding == 0) {
+		return texture(image, uv_coordinate).rgb;
+	}
+	
+	ivec2 image_size = textureSize(image, 0);
+	if (encoding == 2) { image_size.x *= 2; }
+	ivec2 pixel = min(ivec2(uv_coordinate * vec2(image_size)), image_size - 1);
+	
+	if (encoding == 1) {
+		return yuv_to_rgb(texelFetch(image, pixel, 0).r, texelFetch(chroma, pixel / 2, 0).rg);
+	} else if (encoding == 2) {
+		vec4 yuyv = texelFetch(image, ivec2(pixel.x / 2, pixel.y), 0);
+		return yuv_to_rgb((pixel.x % 2 == 0) ? yuyv.r : yuyv.b, yuyv.ga);
+	} else {
+		return demosaic(pixel, image_size);
+	}
+}
+
 void main() {
-	fragment_color = vec4(texture(image, uv_coordinate).rgb, 1.0);
+	vec3 value = clamp((value_scale*sample_image() - value_min) / (value_max - value_min), 0.0, 1.0);
+	
+	if (number_of_channels == 1) {
+		fragment_color = vec4(use_colormap ? texture(colormap, value.r).rgb : value.rrr, 1.0);
+	} else if (number_of_channels == 2) {
+		fragment_color = vec4(value.rg, 0.0, 1.0);
+	} else {
+		fragment_color = vec4(swap_red_blue ? value.bgr : value.rgb, 1.0);
+	}
 }
 )GLSL";
 
-const auto image_2d_r_monochrome_fs = R"GLSL(
+// Same as above for unsigned integer textures, which can not be sampled as normalized values.
+const auto image_2d_uint_fs = R"GLSL(
 #version 330 core
 
 in vec2 uv_coordinate;
 
-uniform sampler2D image;
+uniform usampler2D image;
+uniform sampler1D colormap;
+
+uniform int number_of_channels;
+uniform bool swap_red_blue;
+uniform bool use_colormap;
+uniform float value_scale;
+uniform float value_min;
+uniform float value_max;
 
 out vec4 fragment_color;
 
 void main() {
-	fragment_color = vec4(texture(image, uv_coordinate).rrr, 1.0);
+	vec3 value = clamp((value_scale*vec3(texture(image, uv_coordinate).rgb) - value_min) / (value_max - value_min), 0.0, 1.0);
+	
+	if (number_of_channels == 1) {
+		fragment_color = vec4(use_colormap ? texture(colormap, value.r).rgb : value.rrr, 1.0);
+	} else if (number_of_channels == 2) {
+		fragment_color = vec4(value.rg, 0.0, 1.0);
+	} else {
+		fragment_color = vec4(swap_red_blue ? value.bgr : value.rgb, 1.0);
+	}
 }
 )GLSL";
-
@@ -22,7 +22,7 @@ void main() {
 	vec4 view_position = view * model * vec4(position, 1.0);
 	
 	gl_PointSize = 10*size/view_position.z;
-
+	
 	gl_Position = projection * view_position;
 }
 
@@ -74,3 +74,61 @@ void main() {
 }
 
 )GLSL";
+
+// Generates one point per depth pixel from `gl_VertexID`, so no vertex buffer is needed. Uses `point_3d_fs`.
+const auto depth_image_3d_vs = R"GLSL(
+#version 330 core
+
+out vec3 point_color;
+flat out int point_shape;
+
+uniform sampler2D depth_image;
+uniform sampler2D color_image;
+
+uniform vec4 intrinsics; // (fx, fy, cx, cy)
+uniform float depth_scale;
+uniform int number_of_color_channels;
+uniform int swap_red_blue;
+uniform float size;
+uniform int shape;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main() {
+	ivec2 image_size = textureSize(depth_image, 0);
+	ivec2 pixel = ivec2(gl_VertexID % image_size.x, gl_VertexID / image_size.x);
+	
+	float depth = texelFetch(depth_image, pixel, 0).r * depth_scale;
+	if (depth <= 0.0) { // No measurement, place the point outside of the clip volume.
+		gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+		gl_PointSize = 1.0;
+		return;
+	}
+	
+	vec3 position = vec3(
+		(float(pixel.x) - intrinsics.z) * depth / intrinsics.x,
+		(float(pixel.y) - intrinsics.w) * depth / intrinsics.y,
+		depth
+	);
+	
+	// The color image is sampled at the same relative position, so it may have a different resolution than the depth image.
+	vec3 color = texture(color_image, (vec2(pixel) + 0.5) / vec2(image_size)).rgb;
+	if (number_of_color_channels < 3) {
+		color = color.rrr;
+	} else if (swap_red_blue != 0) {
+		color = color.bgr;
+	}
+	
+	point_color = color;
+	point_shape = shape;
+	
+	vec4 view_position = view * model * vec4(position, 1.0);
+	
+	gl_PointSize = 10*size/view_position.z;
+	
+	gl_Position = projection * view_position;
+}
+
+)GLSL";
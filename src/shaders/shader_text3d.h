@@ -0,0 +1,65 @@
+#pragma once
+
+// One instance per glyph. The quad corners come from `gl_VertexID`, and are offset from the projected label position in pixels so the text has a constant size on screen.
+const auto text_3d_vs = R"GLSL(
+#version 330 core
+
+layout (location = 0) in vec3 anchor;
+layout (location = 1) in vec3 color;
+layout (location = 2) in vec2 offset_min;
+layout (location = 3) in vec2 offset_max;
+layout (location = 4) in vec2 uv_min;
+layout (location = 5) in vec2 uv_max;
+layout (location = 6) in float visible;
+
+out vec3 glyph_color;
+out vec2 glyph_uv;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+uniform vec2 viewport_size;
+uniform float pixels_per_font_pixel;
+
+void main() {
+	vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+	
+	glyph_color = color;
+	glyph_uv = mix(uv_min, uv_max, corner);
+	
+	vec4 clip_position = projection * view * model * vec4(anchor, 1.0);
+	if (visible == 0.0 || clip_position.w <= 0.0) { // Hidden, place the glyph outside of the clip volume.
+		gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+		return;
+	}
+	
+	// Snap to whole pixels to keep the glyphs sharp.
+	vec2 anchor_pixel = floor((0.5 * clip_position.xy / clip_position.w + 0.5) * viewport_size + 0.5);
+	vec2 pixel = anchor_pixel + floor(mix(offset_min, offset_max, corner) * pixels_per_font_pixel + 0.5);
+	clip_position.xy = (2.0 * pixel / viewport_size - 1.0) * clip_position.w;
+	
+	gl_Position = clip_position;
+}
+
+)GLSL";
+
+const auto text_3d_fs = R"GLSL(
+#version 330 core
+
+in vec3 glyph_color;
+in vec2 glyph_uv;
+
+uniform sampler2D glyph_atlas;
+
+out vec4 frag_color;
+
+void main() {
+	if (texture(glyph_atlas, glyph_uv).r < 0.5) {
+		discard;
+	}
+	
+	frag_color = vec4(glyph_color, 1.0);
+}
+
+)GLSL";
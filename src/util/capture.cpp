@@ -0,0 +1,205 @@
+#include "capture.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+namespace {
+
+constexpr size_t max_number_of_free_chunks = 4;
+
+std::atomic_uint64_t next_recorder_id = 1;
+
+// The recorder, if any, that has assigned the current thread its index.
+thread_local uint64_t current_recorder_id = 0;
+thread_local uint16_t current_thread_index = 0;
+
+} // namespace
+
+size_t Toucan::get_capture_payload_size(std::initializer_list<CaptureField> fields) {
+	size_t payload_size = 0;
+	for (const CaptureField& field : fields) {
+		payload_size += field.get_padded_size();
+	}
+	return payload_size;
+}
+
+void Toucan::write_capture_record(uint8_t* record_ptr, const CaptureRecordHeader& record_header, std::initializer_list<CaptureField> fields) {
+	uint8_t* write_ptr = record_ptr;
+	std::memcpy(write_ptr, &record_header, sizeof(record_header));
+	write_ptr += sizeof(record_header);
+	
+	for (const CaptureField& field : fields) {
+		if (field.size_prefixed) {
+			const uint64_t field_size = field.size;
+			std::memcpy(write_ptr, &field_size, sizeof(field_size));
+			write_ptr += sizeof(field_size);
+		}
+		
+		if (field.size > 0) {
+			std::memcpy(write_ptr, field.data_ptr, field.size);
+		}
+		
+		// Zero the padding, so no stale memory ends up in the file.
+		const size_t padded_size = get_capture_padded_size(field.size);
+		std::memset(write_ptr + field.size, 0, padded_size - field.size);
+		write_ptr += padded_size;
+	}
+	
+	assert(write_ptr == record_ptr + sizeof(record_header) + record_header.payload_size);
+}
+
+Toucan::CaptureContainerCall Toucan::get_capture_container_call(uint16_t type) {
+	switch (static_cast<CaptureRecordType>(type)) {
+		case CaptureRecordType::BeginFigure2D: return {capture_figure_2d_bit, true, false};
+		case CaptureRecordType::EndFigure2D: return {capture_figure_2d_bit, false, true};
+		case CaptureRecordType::BeginFigure3D: return {capture_figure_3d_bit, true, false};
+		case CaptureRecordType::EndFigure3D: return {capture_figure_3d_bit, false, true};
+		case CaptureRecordType::BeginInputWindow: return {capture_input_window_bit, true, false};
+		case CaptureRecordType::EndInputWindow: return {capture_input_window_bit, false, true};
+		default: return {};
+	}
+}
+
+Toucan::CaptureRecorder::CaptureRecorder(const std::string& file_path) :
+recorder_id{next_recorder_id++} {
+	file_ptr = std::fopen(file_path.c_str(), "wb");
+	if (file_ptr == nullptr) {
+		throw std::runtime_error("Toucan error! Could not create the capture file '" + file_path + "'.");
+	}
+	
+	// The writer thread only writes whole chunks, buffering them again would only add a copy.
+	std::setvbuf(file_ptr, nullptr, _IONBF, 0);
+	
+	CaptureFileHeader file_header = {};
+	std::memcpy(file_header.magic, capture_file_magic, sizeof(capture_file_magic));
+	file_header.version = capture_file_version;
+	file_header.record_header_size = sizeof(CaptureRecordHeader);
+	file_header.start_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	start_time = std::chrono::steady_clock::now();
+	
+	if (std::fwrite(&file_header, sizeof(file_header), 1, file_ptr) != 1) {
+		std::fclose(file_ptr);
+		throw std::runtime_error("Toucan error! Could not write to the capture file '" + file_path + "'.");
+	}
+	
+	writer_thread = std::thread(&CaptureRecorder::writer_loop, this);
+}
+
+Toucan::CaptureRecorder::~CaptureRecorder() {
+	{
+		std::lock_guard lock(mutex);
+		stop = true;
+	}
+	writer_cv.notify_one();
+	writer_thread.join();
+	
+	std::fclose(file_ptr);
+	
+	std::free(current_chunk.data_ptr);
+	for (Chunk& chunk : free_chunks) {
+		std::free(chunk.data_ptr);
+	}
+}
+
+void Toucan::CaptureRecorder::record(CaptureRecordType type, std::initializer_list<CaptureField> fields, bool droppable) {
+	const size_t payload_size = get_capture_payload_size(fields);
+	const size_t record_size = sizeof(CaptureRecordHeader) + payload_size;
+	
+	std::lock_guard lock(mutex);
+	
+	if (current_recorder_id != recorder_id) {
+		current_recorder_id = recorder_id;
+		current_thread_index = number_of_threads++;
+	}
+	
+	if (droppable and number_of_queued_bytes + record_size > capture_max_queued_bytes) {
+		++number_of_dropped_records;
+		return;
+	}
+	
+	if (current_chunk.capacity - current_chunk.size < record_size) {
+		if (current_chunk.size > 0) {
+			queued_chunks.push_back(current_chunk);
+			writer_cv.notify_one();
+		} else if (current_chunk.data_ptr != nullptr) {
+			free_chunks.push_back(current_chunk);
+		}
+		current_chunk = allocate_chunk(record_size);
+	}
+	
+	// The timestamp is taken while holding the lock, so the timestamps in the file are in order.
+	CaptureRecordHeader record_header = {};
+	record_header.type = static_cast<uint16_t>(type);
+	record_header.thread_index = current_thread_index;
+	record_header.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time).count();
+	record_header.payload_size = payload_size;
+	write_capture_record(current_chunk.data_ptr + current_chunk.size, record_header, fields);
+	
+	current_chunk.size += record_size;
+	number_of_queued_bytes += record_size;
+}
+
+Toucan::CaptureRecorder::Chunk Toucan::CaptureRecorder::allocate_chunk(size_t minimum_capacity) {
+	if (minimum_capacity <= capture_chunk_size and not free_chunks.empty()) {
+		Chunk chunk = free_chunks.back();
+		free_chunks.pop_back();
+		chunk.size = 0;
+		return chunk;
+	}
+	
+	Chunk chunk;
+	chunk.capacity = std::max(minimum_capacity, capture_chunk_size);
+	chunk.data_ptr = static_cast<uint8_t*>(std::malloc(chunk.capacity));
+	if (chunk.data_ptr == nullptr) {
+		throw std::bad_alloc();
+	}
+	return chunk;
+}
+
+void Toucan::CaptureRecorder::writer_loop() {
+	std::vector<Chunk> chunks_to_write;
+	
+	std::unique_lock lock(mutex);
+	while (true) {
+		writer_cv.wait_for(lock, capture_flush_interval, [this]{ return stop or not queued_chunks.empty(); });
+		
+		// Nothing filled up a chunk, either the flush interval passed or the recorder is stopping. Write the partially filled chunk.
+		if (queued_chunks.empty() and current_chunk.size > 0) {
+			queued_chunks.push_back(current_chunk);
+			current_chunk = Chunk();
+		}
+		
+		const bool stopping = stop;
+		chunks_to_write.swap(queued_chunks);
+		
+		lock.unlock();
+		
+		// After a failed write the rest of the capture is discarded, a gap in the middle of the file would make it unreadable.
+		for (const Chunk& chunk : chunks_to_write) {
+			if (not write_failed and std::fwrite(chunk.data_ptr, 1, chunk.size, file_ptr) != chunk.size) {
+				write_failed = true;
+			}
+		}
+		
+		lock.lock();
+		
+		for (Chunk& chunk : chunks_to_write) {
+			number_of_queued_bytes -= chunk.size;
+			if (chunk.capacity == capture_chunk_size and free_chunks.size() < max_number_of_free_chunks) {
+				chunk.size = 0;
+				free_chunks.push_back(chunk);
+			} else {
+				std::free(chunk.data_ptr);
+			}
+		}
+		chunks_to_write.clear();
+		
+		if (stopping and queued_chunks.empty() and current_chunk.size == 0) {
+			break;
+		}
+	}
+}
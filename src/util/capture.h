@@ -0,0 +1,215 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <Toucan/DataTypes.h>
+
+namespace Toucan {
+
+// Capture files start with a CaptureFileHeader, followed by records. Each record is a CaptureRecordHeader followed by `payload_size` bytes of fields.
+// A field is either a value stored verbatim, or a byte count (uint64_t) followed by that many bytes. Every field is padded to a multiple of
+// `capture_alignment` bytes, so the buffers in a mapped capture file can be used in place. Values are stored in the byte order of the recording machine.
+// The file is append only, so a capture cut short by a crash is still readable up to the last complete record.
+
+constexpr char capture_file_magic[8] = {'T', 'O', 'U', 'C', 'A', 'N', 'C', 'P'};
+constexpr uint32_t capture_file_version = 1;
+constexpr size_t capture_alignment = 8;
+
+constexpr size_t capture_chunk_size = size_t(4) << 20u; // Records are collected in chunks of this size, larger records get a chunk of their own.
+constexpr size_t capture_max_queued_bytes = size_t(256) << 20u;
+constexpr auto capture_flush_interval = std::chrono::milliseconds(100); // Partially filled chunks are written after this long.
+
+struct CaptureFileHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t record_header_size;
+	int64_t start_time_ns; // System clock time of the first record timestamp, in nanoseconds since the Unix epoch.
+};
+
+// The values are part of the file format. New record types are only added at the end.
+enum class CaptureRecordType : uint16_t {
+	BeginFigure2D = 1, EndFigure2D, PushPose2D, PopPose2D, ClearPose2D,
+	ShowLinePlot2D, ShowPoints2D, ShowImage2D, ShowTiledImage2D,
+	BeginFigure3D, EndFigure3D, PushPose3D, PopPose3D, ClearPose3D,
+	ShowAxis3D, ShowPoints3D, ShowLines3D, ShowPrimitives3D, ShowText3D, ShowDepthImage3D,
+	BeginInputWindow, EndInputWindow,
+	ShowButton, ShowCheckbox, ShowSliderFloat, ShowSliderFloat2, ShowSliderFloat3, ShowSliderFloat4,
+	ShowSliderInt, ShowSliderInt2, ShowSliderInt3, ShowSliderInt4, ShowColorPicker,
+};
+
+struct CaptureRecordHeader {
+	uint16_t type; // CaptureRecordType
+	uint16_t thread_index; // Order in which the calling threads made their first recorded call, so calls from different threads can be told apart.
+	uint32_t reserved;
+	int64_t timestamp_ns; // Steady clock time since the recorder was created.
+	uint64_t payload_size;
+};
+
+static_assert(sizeof(CaptureFileHeader) % capture_alignment == 0);
+static_assert(sizeof(CaptureRecordHeader) % capture_alignment == 0);
+
+constexpr size_t get_capture_padded_size(size_t size) { return (size + capture_alignment - 1) & ~(capture_alignment - 1); }
+
+// A field of a record. Values, strings and element buffers are converted implicitly, so the arguments of a call can be passed as they are.
+struct CaptureField {
+	template<typename T>
+	CaptureField(const T& value) :
+	data_ptr{&value}, size{sizeof(T)}, size_prefixed{false} {
+		static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be stored verbatim in a capture.");
+	}
+	
+	CaptureField(const std::string& string) :
+	data_ptr{string.data()}, size{string.size()}, size_prefixed{true} { }
+	
+	template<typename T>
+	CaptureField(const Buffer<T>& buffer) :
+	data_ptr{buffer.data_ptr}, size{sizeof(T)*buffer.number_of_elements}, size_prefixed{true} { }
+	
+	CaptureField(const void* data_ptr, size_t size) :
+	data_ptr{data_ptr}, size{size}, size_prefixed{true} { }
+	
+	[[nodiscard]] size_t get_padded_size() const { return (size_prefixed ? sizeof(uint64_t) : 0) + get_capture_padded_size(size); }
+	
+	const void* data_ptr;
+	size_t size;
+	bool size_prefixed;
+};
+
+size_t get_capture_payload_size(std::initializer_list<CaptureField> fields);
+
+// Writes a record header followed by the fields, `get_capture_payload_size` bytes after the header, zeroing the padding.
+void write_capture_record(uint8_t* record_ptr, const CaptureRecordHeader& record_header, std::initializer_list<CaptureField> fields);
+
+// Figures and input windows are containers, a frame ends when an End* call leaves no container active.
+constexpr uint8_t capture_figure_2d_bit = 1u << 0u;
+constexpr uint8_t capture_figure_3d_bit = 1u << 1u;
+constexpr uint8_t capture_input_window_bit = 1u << 2u;
+
+struct CaptureContainerCall {
+	uint8_t container_bit = 0; // Zero if the record does not begin or end a container.
+	bool begin = false;
+	bool end = false;
+};
+
+CaptureContainerCall get_capture_container_call(uint16_t type);
+
+// Calls the API function recorded in the record at `record_ptr`. Buffers and images are passed as pointers into the record. Defined in `replay.cpp`.
+void replay_capture_record(const uint8_t* record_ptr);
+
+// Reads the fields of a record in the order they were written. Strings are copied, buffers and images point into the record.
+class CaptureRecordReader {
+public:
+	CaptureRecordReader(const uint8_t* payload_ptr, size_t payload_size) :
+	read_ptr{payload_ptr}, end_ptr{payload_ptr + payload_size} { }
+	
+	template<typename T>
+	T read_value() {
+		static_assert(std::is_trivially_copyable_v<T>);
+		T value;
+		std::memcpy(&value, read(sizeof(T)), sizeof(T));
+		return value;
+	}
+	
+	std::string read_string() {
+		const size_t size = read_size();
+		return std::string(reinterpret_cast<const char*>(read(size)), size);
+	}
+	
+	template<typename T>
+	Buffer<T> read_buffer() {
+		static_assert(alignof(T) <= capture_alignment, "Buffers in a capture are only aligned to `capture_alignment` bytes.");
+		const size_t size = read_size();
+		if (size % sizeof(T) != 0) { throw std::runtime_error("Toucan error! A capture record is corrupt."); }
+		return Buffer<T>(reinterpret_cast<const T*>(read(size)), size/sizeof(T));
+	}
+	
+	// Reads the image fields written by `ShowImage2D` and the other image functions, and checks that the pixels have the expected size.
+	template<typename SizeFunction>
+	Image2D read_image(SizeFunction get_size_in_bytes) {
+		const int width = read_value<int>();
+		const int height = read_value<int>();
+		const auto format = read_value<ImageFormat>();
+		const size_t size = read_size();
+		if (width <= 0 or height <= 0 or size != get_size_in_bytes(format, width, height)) { throw std::runtime_error("Toucan error! A capture record is corrupt."); }
+		
+		// The Show* functions only read the pixels, records are never written through the image.
+		return Image2D(const_cast<uint8_t*>(read(size)), width, height, format);
+	}
+
+private:
+	size_t read_size() {
+		return read_value<uint64_t>();
+	}
+	
+	const uint8_t* read(size_t size) {
+		const size_t padded_size = get_capture_padded_size(size);
+		if (padded_size < size or padded_size > static_cast<size_t>(end_ptr - read_ptr)) { throw std::runtime_error("Toucan error! A capture record is corrupt."); }
+		
+		const uint8_t* field_ptr = read_ptr;
+		read_ptr += padded_size;
+		return field_ptr;
+	}
+	
+	const uint8_t* read_ptr;
+	const uint8_t* end_ptr;
+};
+
+// Records calls to a capture file. The calling thread only copies the record into a chunk of memory, the chunks are written by a background thread.
+// If the writer falls more than `capture_max_queued_bytes` behind, records with element data are dropped rather than blocking the caller. Records
+// that begin, end or change the structure of a figure are always kept, so the capture stays consistent.
+class CaptureRecorder {
+public:
+	// Throws if the file can not be created.
+	explicit CaptureRecorder(const std::string& file_path);
+	~CaptureRecorder(); // Writes all recorded calls before returning.
+	
+	CaptureRecorder(const CaptureRecorder&) = delete;
+	CaptureRecorder& operator=(const CaptureRecorder&) = delete;
+	
+	// `droppable` records may be dropped when the writer falls behind.
+	void record(CaptureRecordType type, std::initializer_list<CaptureField> fields, bool droppable);
+	
+	[[nodiscard]] uint64_t get_number_of_dropped_records() const { return number_of_dropped_records; }
+
+private:
+	struct Chunk {
+		uint8_t* data_ptr = nullptr;
+		size_t capacity = 0;
+		size_t size = 0;
+	};
+	
+	Chunk allocate_chunk(size_t minimum_capacity);
+	void writer_loop();
+	
+	const uint64_t recorder_id; // Unique for every recorder created by the process, so the calling threads can cache their thread index.
+	std::FILE* file_ptr = nullptr;
+	std::chrono::steady_clock::time_point start_time;
+	
+	std::atomic_uint64_t number_of_dropped_records = 0;
+	std::atomic_bool write_failed = false;
+	
+	std::mutex mutex; // Guards the members below.
+	Chunk current_chunk;
+	std::vector<Chunk> queued_chunks;
+	std::vector<Chunk> free_chunks;
+	size_t number_of_queued_bytes = 0; // Recorded but not yet written, including the current chunk.
+	uint16_t number_of_threads = 0;
+	bool stop = false;
+	std::condition_variable writer_cv;
+	
+	std::thread writer_thread;
+};
+
+} // namespace Toucan
@@ -0,0 +1,87 @@
+#include "colormap.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Polynomial fit of matplotlib's viridis, degree 6.
+Toucan::Color evaluate_viridis(float t) {
+	constexpr float c[7][3] = {
+			{0.2777273272234177f, 0.005407344544966578f, 0.3340998053353061f},
+			{0.1050930431085774f, 1.404613529898575f, 1.384590162594685f},
+			{-0.3308618287255563f, 0.214847559468213f, 0.09509516302823659f},
+			{-4.634230498983486f, -5.799100973351585f, -19.33244095627987f},
+			{6.228269936347081f, 14.17993336680509f, 56.69055260068105f},
+			{4.776384997670288f, -13.74514537774601f, -65.35303263337234f},
+			{-5.435455855934631f, 4.645852612178535f, 26.3124352495832f}
+	};
+	
+	float rgb[3];
+	for (int channel = 0; channel < 3; ++channel) {
+		float value = c[6][channel];
+		for (int coefficient_index = 5; coefficient_index >= 0; --coefficient_index) {
+			value = value*t + c[coefficient_index][channel];
+		}
+		rgb[channel] = value;
+	}
+	
+	return Toucan::Color(rgb[0], rgb[1], rgb[2]);
+}
+
+// Polynomial approximation of Google's Turbo, degree 5.
+Toucan::Color evaluate_turbo(float t) {
+	constexpr float c[6][3] = {
+			{0.13572138f, 0.09140261f, 0.10667330f},
+			{4.61539260f, 2.19418839f, 12.64194608f},
+			{-42.66032258f, 4.84296658f, -60.58204836f},
+			{132.13108234f, -14.18503333f, 110.36276771f},
+			{-152.94239396f, 4.27729857f, -89.90310912f},
+			{59.28637943f, 2.82956604f, 27.34824973f}
+	};
+	
+	float rgb[3];
+	for (int channel = 0; channel < 3; ++channel) {
+		float value = c[5][channel];
+		for (int coefficient_index = 4; coefficient_index >= 0; --coefficient_index) {
+			value = value*t + c[coefficient_index][channel];
+		}
+		rgb[channel] = value;
+	}
+	
+	return Toucan::Color(rgb[0], rgb[1], rgb[2]);
+}
+
+} // namespace
+
+Toucan::Color Toucan::evaluate_colormap(Colormap colormap, float value) {
+	const float t = std::clamp(value, 0.0f, 1.0f);
+	
+	Color color;
+	switch (colormap) {
+		case Colormap::NONE: {
+			color = Color(t, t, t);
+		} break;
+		case Colormap::VIRIDIS: {
+			color = evaluate_viridis(t);
+		} break;
+		case Colormap::TURBO: {
+			color = evaluate_turbo(t);
+		} break;
+	}
+	
+	return Color(std::clamp(color.r, 0.0f, 1.0f), std::clamp(color.g, 0.0f, 1.0f), std::clamp(color.b, 0.0f, 1.0f));
+}
+
+std::array<uint8_t, 3*Toucan::colormap_lut_size> Toucan::generate_colormap_lut(Colormap colormap) {
+	std::array<uint8_t, 3*colormap_lut_size> lut = {};
+	
+	for (int entry_index = 0; entry_index < colormap_lut_size; ++entry_index) {
+		const Color color = evaluate_colormap(colormap, static_cast<float>(entry_index) / static_cast<float>(colormap_lut_size - 1));
+		lut[3*entry_index + 0] = static_cast<uint8_t>(std::lround(255.0f*color.r));
+		lut[3*entry_index + 1] = static_cast<uint8_t>(std::lround(255.0f*color.g));
+		lut[3*entry_index + 2] = static_cast<uint8_t>(std::lround(255.0f*color.b));
+	}
+	
+	return lut;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include <Toucan/DataTypes.h>
+
+namespace Toucan {
+
+constexpr int colormap_lut_size = 256;
+
+// RGB entries for `colormap_lut_size` values evenly spaced over [0, 1], uploaded as a 1D texture for the image shaders.
+std::array<uint8_t, 3*colormap_lut_size> generate_colormap_lut(Colormap colormap);
+
+// Color of the colormap for a value in [0, 1].
+Color evaluate_colormap(Colormap colormap, float value);
+
+} // namespace Toucan
@@ -0,0 +1,232 @@
+#include "data_bounds.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#if defined(__SSE2__) && defined(__GNUC__)
+#define TOUCAN_DATA_BOUNDS_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+struct BoundsAccumulator {
+	float min_x = std::numeric_limits<float>::infinity();
+	float min_y = std::numeric_limits<float>::infinity();
+	float max_x = -std::numeric_limits<float>::infinity();
+	float max_y = -std::numeric_limits<float>::infinity();
+	
+	inline void extend(float x, float y) {
+		// Written so NaN values are ignored, matching the SIMD versions.
+		min_x = x < min_x ? x : min_x;
+		min_y = y < min_y ? y : min_y;
+		max_x = x > max_x ? x : max_x;
+		max_y = y > max_y ? y : max_y;
+	}
+	
+	inline void extend(const BoundsAccumulator& other) {
+		min_x = std::min(min_x, other.min_x);
+		min_y = std::min(min_y, other.min_y);
+		max_x = std::max(max_x, other.max_x);
+		max_y = std::max(max_y, other.max_y);
+	}
+	
+	[[nodiscard]] Toucan::Rectangle to_rectangle() const {
+		if (min_x > max_x or min_y > max_y) { // No (valid) points
+			return Toucan::Rectangle(Toucan::Vector2f::Zero(), Toucan::Vector2f::Zero());
+		}
+		return Toucan::Rectangle(Toucan::Vector2f(min_x, min_y), Toucan::Vector2f(max_x, max_y));
+	}
+};
+
+#ifdef TOUCAN_DATA_BOUNDS_X86
+
+// `min`/`max` hold interleaved (x, y) pairs, reduce them into the accumulator.
+inline void reduce_sse(__m128 min, __m128 max, BoundsAccumulator& bounds) {
+	min = _mm_min_ps(min, _mm_movehl_ps(min, min));
+	max = _mm_max_ps(max, _mm_movehl_ps(max, max));
+	
+	alignas(16) float min_values[4];
+	alignas(16) float max_values[4];
+	_mm_store_ps(min_values, min);
+	_mm_store_ps(max_values, max);
+	
+	// Merged component wise, since lanes that only saw NaN values are still at +/- infinity.
+	BoundsAccumulator block_bounds;
+	block_bounds.min_x = min_values[0];
+	block_bounds.min_y = min_values[1];
+	block_bounds.max_x = max_values[0];
+	block_bounds.max_y = max_values[1];
+	bounds.extend(block_bounds);
+}
+
+// Processes whole blocks of 8 points, returns the number of points processed.
+__attribute__((target("avx")))
+int compute_bounds_avx(const Toucan::Vector2f* points_ptr, int number_of_points, BoundsAccumulator& bounds) {
+	const auto* values_ptr = reinterpret_cast<const float*>(points_ptr);
+	const int number_of_blocks = number_of_points / 8;
+	if (number_of_blocks == 0) { return 0; }
+	
+	__m256 min_0 = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+	__m256 min_1 = min_0;
+	__m256 max_0 = _mm256_set1_ps(-std::numeric_limits<float>::infinity());
+	__m256 max_1 = max_0;
+	
+	for (int block_index = 0; block_index < number_of_blocks; ++block_index) {
+		const __m256 values_0 = _mm256_loadu_ps(values_ptr + 16*block_index);
+		const __m256 values_1 = _mm256_loadu_ps(values_ptr + 16*block_index + 8);
+		
+		// The new values are the first operand so NaN values are dropped.
+		min_0 = _mm256_min_ps(values_0, min_0);
+		min_1 = _mm256_min_ps(values_1, min_1);
+		max_0 = _mm256_max_ps(values_0, max_0);
+		max_1 = _mm256_max_ps(values_1, max_1);
+	}
+	
+	const __m256 min = _mm256_min_ps(min_0, min_1);
+	const __m256 max = _mm256_max_ps(max_0, max_1);
+	reduce_sse(
+			_mm_min_ps(_mm256_castps256_ps128(min), _mm256_extractf128_ps(min, 1)),
+			_mm_max_ps(_mm256_castps256_ps128(max), _mm256_extractf128_ps(max, 1)),
+			bounds
+	);
+	
+	return 8*number_of_blocks;
+}
+
+// Processes whole blocks of 4 points, returns the number of points processed.
+int compute_bounds_sse(const Toucan::Vector2f* points_ptr, int number_of_points, BoundsAccumulator& bounds) {
+	const auto* values_ptr = reinterpret_cast<const float*>(points_ptr);
+	const int number_of_blocks = number_of_points / 4;
+	if (number_of_blocks == 0) { return 0; }
+	
+	__m128 min_0 = _mm_set1_ps(std::numeric_limits<float>::infinity());
+	__m128 min_1 = min_0;
+	__m128 max_0 = _mm_set1_ps(-std::numeric_limits<float>::infinity());
+	__m128 max_1 = max_0;
+	
+	for (int block_index = 0; block_index < number_of_blocks; ++block_index) {
+		const __m128 values_0 = _mm_loadu_ps(values_ptr + 8*block_index);
+		const __m128 values_1 = _mm_loadu_ps(values_ptr + 8*block_index + 4);
+		
+		min_0 = _mm_min_ps(values_0, min_0);
+		min_1 = _mm_min_ps(values_1, min_1);
+		max_0 = _mm_max_ps(values_0, max_0);
+		max_1 = _mm_max_ps(values_1, max_1);
+	}
+	
+	reduce_sse(_mm_min_ps(min_0, min_1), _mm_max_ps(max_0, max_1), bounds);
+	
+	return 4*number_of_blocks;
+}
+
+// The positions are strided, so load two positions into one register at a time. Processes whole blocks of 4 points.
+int compute_bounds_sse(const Toucan::Point2D* points_ptr, int number_of_points, BoundsAccumulator& bounds) {
+	const int number_of_blocks = number_of_points / 4;
+	if (number_of_blocks == 0) { return 0; }
+	
+	__m128 min_0 = _mm_set1_ps(std::numeric_limits<float>::infinity());
+	__m128 min_1 = min_0;
+	__m128 max_0 = _mm_set1_ps(-std::numeric_limits<float>::infinity());
+	__m128 max_1 = max_0;
+	
+	const auto load_positions = [](const Toucan::Point2D& point_a, const Toucan::Point2D& point_b) {
+		const __m128 low = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(&point_a.position));
+		return _mm_loadh_pi(low, reinterpret_cast<const __m64*>(&point_b.position));
+	};
+	
+	for (int block_index = 0; block_index < number_of_blocks; ++block_index) {
+		const Toucan::Point2D* block_ptr = points_ptr + 4*block_index;
+		const __m128 values_0 = load_positions(block_ptr[0], block_ptr[1]);
+		const __m128 values_1 = load_positions(block_ptr[2], block_ptr[3]);
+		
+		min_0 = _mm_min_ps(values_0, min_0);
+		min_1 = _mm_min_ps(values_1, min_1);
+		max_0 = _mm_max_ps(values_0, max_0);
+		max_1 = _mm_max_ps(values_1, max_1);
+	}
+	
+	reduce_sse(_mm_min_ps(min_0, min_1), _mm_max_ps(max_0, max_1), bounds);
+	
+	return 4*number_of_blocks;
+}
+
+bool cpu_supports_avx() {
+	static const bool supports_avx = __builtin_cpu_supports("avx");
+	return supports_avx;
+}
+
+#endif
+
+} // namespace
+
+namespace {
+
+void accumulate_data_bounds(const Toucan::Vector2f* points_ptr, int number_of_points, BoundsAccumulator& bounds) {
+	int point_index = 0;
+
+#ifdef TOUCAN_DATA_BOUNDS_X86
+	if (cpu_supports_avx()) {
+		point_index += compute_bounds_avx(points_ptr, number_of_points, bounds);
+	}
+	point_index += compute_bounds_sse(points_ptr + point_index, number_of_points - point_index, bounds);
+#endif
+	
+	for (; point_index < number_of_points; ++point_index) {
+		bounds.extend(points_ptr[point_index].x(), points_ptr[point_index].y());
+	}
+}
+
+void accumulate_data_bounds(const Toucan::Point2D* points_ptr, int number_of_points, BoundsAccumulator& bounds) {
+	int point_index = 0;
+
+#ifdef TOUCAN_DATA_BOUNDS_X86
+	point_index += compute_bounds_sse(points_ptr, number_of_points, bounds);
+#endif
+	
+	for (; point_index < number_of_points; ++point_index) {
+		bounds.extend(points_ptr[point_index].position.x(), points_ptr[point_index].position.y());
+	}
+}
+
+// Splits the points into ranges that are bounded in parallel, and merges the results.
+// The accumulators are merged rather than the rectangles, so ranges with only NaN points do not add the origin.
+template<typename PointType>
+Toucan::Rectangle compute_data_bounds_parallel(const PointType* points_ptr, int number_of_points, Toucan::ThreadPool& thread_pool) {
+	const int number_of_ranges = (number_of_points + Toucan::data_bounds_parallel_grain_size - 1) / Toucan::data_bounds_parallel_grain_size;
+	std::vector<BoundsAccumulator> range_bounds(static_cast<size_t>(number_of_ranges));
+	
+	thread_pool.parallel_for(0, number_of_points, Toucan::data_bounds_parallel_grain_size, [&](int range_begin, int range_end) {
+		accumulate_data_bounds(points_ptr + range_begin, range_end - range_begin, range_bounds[static_cast<size_t>(range_begin / Toucan::data_bounds_parallel_grain_size)]);
+	});
+	
+	BoundsAccumulator bounds;
+	for (const auto& range_bound : range_bounds) {
+		bounds.extend(range_bound);
+	}
+	
+	return bounds.to_rectangle();
+}
+
+} // namespace
+
+Toucan::Rectangle Toucan::compute_data_bounds(const Vector2f* points_ptr, int number_of_points) {
+	BoundsAccumulator bounds;
+	accumulate_data_bounds(points_ptr, number_of_points, bounds);
+	return bounds.to_rectangle();
+}
+
+Toucan::Rectangle Toucan::compute_data_bounds(const Point2D* points_ptr, int number_of_points) {
+	BoundsAccumulator bounds;
+	accumulate_data_bounds(points_ptr, number_of_points, bounds);
+	return bounds.to_rectangle();
+}
+
+Toucan::Rectangle Toucan::compute_data_bounds(const Vector2f* points_ptr, int number_of_points, ThreadPool& thread_pool) {
+	return compute_data_bounds_parallel(points_ptr, number_of_points, thread_pool);
+}
+
+Toucan::Rectangle Toucan::compute_data_bounds(const Point2D* points_ptr, int number_of_points, ThreadPool& thread_pool) {
+	return compute_data_bounds_parallel(points_ptr, number_of_points, thread_pool);
+}
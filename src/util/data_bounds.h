@@ -0,0 +1,42 @@
+#pragma once
+
+#include <algorithm>
+
+#include <Toucan/LinAlg.h>
+#include <Toucan/DataTypes.h>
+
+#include "thread_pool.h"
+
+namespace Toucan {
+
+// Axis aligned bounds of the points, using SSE/AVX when available. NaN coordinates are ignored.
+// Returns an empty rectangle at the origin if there are no points.
+Rectangle compute_data_bounds(const Vector2f* points_ptr, int number_of_points);
+Rectangle compute_data_bounds(const Point2D* points_ptr, int number_of_points);
+
+constexpr int data_bounds_parallel_grain_size = 1 << 18;
+
+// Same as above, but splits the points into ranges of `data_bounds_parallel_grain_size` points that are bounded on the thread pool.
+Rectangle compute_data_bounds(const Vector2f* points_ptr, int number_of_points, ThreadPool& thread_pool);
+Rectangle compute_data_bounds(const Point2D* points_ptr, int number_of_points, ThreadPool& thread_pool);
+
+// Bounds of the rectangle after transforming its four corners.
+template<typename Transform>
+Rectangle get_transformed_bounds(const Rectangle& rectangle, const Transform& transform) {
+	const Vector2f corners[4] = {
+			transform(rectangle.min),
+			transform(Vector2f(rectangle.max.x(), rectangle.min.y())),
+			transform(Vector2f(rectangle.min.x(), rectangle.max.y())),
+			transform(rectangle.max)
+	};
+	
+	Rectangle bounds(corners[0], corners[0]);
+	for (const auto& corner : corners) {
+		bounds.min = Vector2f(std::min(bounds.min.x(), corner.x()), std::min(bounds.min.y(), corner.y()));
+		bounds.max = Vector2f(std::max(bounds.max.x(), corner.x()), std::max(bounds.max.y(), corner.y()));
+	}
+	
+	return bounds;
+}
+
+} // namespace Toucan
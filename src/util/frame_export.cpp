@@ -0,0 +1,335 @@
+#include "frame_export.h"
+
+#include <cassert>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <stdexcept>
+
+#include <pthread.h>
+
+#include "png.h"
+
+namespace {
+
+constexpr size_t max_queued_frames = 8;
+constexpr GLuint64 fence_wait_timeout_ns = 100'000'000;
+
+std::string replace_all(std::string text, const std::string& pattern, const std::string& replacement) {
+	for (size_t index = text.find(pattern); index != std::string::npos; index = text.find(pattern, index + replacement.size())) {
+		text.replace(index, pattern.size(), replacement);
+	}
+	return text;
+}
+
+std::string get_padded_frame_index(size_t frame_index) {
+	std::string index_string = std::to_string(frame_index);
+	if (index_string.size() < 6) {
+		index_string.insert(0, 6 - index_string.size(), '0');
+	}
+	return index_string;
+}
+
+size_t get_size_in_bytes(const Toucan::Vector2i& size) {
+	return 4*static_cast<size_t>(size.x())*static_cast<size_t>(size.y());
+}
+
+// Framebuffers are stored bottom row first, the rows are written from the top.
+bool write_rows_flipped(std::FILE* file_ptr, const std::vector<uint8_t>& pixels, const Toucan::Vector2i& size) {
+	const size_t row_size = 4*static_cast<size_t>(size.x());
+	for (int row_index = size.y() - 1; row_index >= 0; --row_index) {
+		if (std::fwrite(pixels.data() + row_size*static_cast<size_t>(row_index), 1, row_size, file_ptr) != row_size) {
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace
+
+Toucan::FrameExporter::FrameExporter(const FrameExportSettings& settings, ThreadPool& thread_pool) :
+settings{settings}, thread_pool{thread_pool} {
+	if (not settings.encoder_command.empty()) {
+		encoder_thread = std::thread(&FrameExporter::encoder_loop, this);
+	}
+}
+
+Toucan::FrameExporter::~FrameExporter() {
+	try {
+		finish();
+	} catch (const std::runtime_error&) {
+		// Only `StopFrameExport` reports write errors, an export that is not stopped is finished quietly when Toucan is destroyed.
+	}
+}
+
+void Toucan::FrameExporter::update(unsigned int framebuffer, const Vector2i& framebuffer_size) {
+	{
+		std::lock_guard lock(mutex);
+		if (released) { return; }
+	}
+	
+	collect_pixel_buffers(false);
+	
+	// The frames in flight are collected over the next window frames, so stopping does not wait for the GPU either.
+	const bool all_frames_read = settings.number_of_frames != 0 and number_of_read_frames >= settings.number_of_frames;
+	if (stop_requested or all_frames_read) {
+		if (number_of_pending_pixel_buffers == 0) {
+			release();
+		}
+		return;
+	}
+	
+	// The first frame is the current image of the figure.
+	const bool new_frame = number_of_read_frames == 0 or redrawn or settings.export_unchanged_frames;
+	redrawn = false;
+	if (not new_frame or framebuffer == 0) {
+		return;
+	}
+	
+	if (number_of_pending_pixel_buffers == pixel_buffers.size() or number_of_queued_frames + number_of_pending_pixel_buffers >= max_queued_frames) {
+		return; // Dropped
+	}
+	
+	read_framebuffer(framebuffer, framebuffer_size);
+}
+
+void Toucan::FrameExporter::release() {
+	{
+		std::lock_guard lock(mutex);
+		if (released) { return; }
+	}
+	
+	collect_pixel_buffers(true);
+	
+	for (auto& pixel_buffer : pixel_buffers) {
+		if (pixel_buffer.fence != nullptr) {
+			glDeleteSync(pixel_buffer.fence);
+			pixel_buffer.fence = nullptr;
+		}
+		glDeleteBuffers(1, &pixel_buffer.pixel_buffer);
+		pixel_buffer.pixel_buffer = 0;
+	}
+	number_of_pending_pixel_buffers = 0;
+	
+	{
+		std::lock_guard lock(mutex);
+		released = true;
+	}
+	cv.notify_all();
+}
+
+size_t Toucan::FrameExporter::finish() {
+	{
+		std::unique_lock lock(mutex);
+		cv.wait(lock, [this]() { return released; });
+		encoder_stop = true;
+	}
+	cv.notify_all();
+	
+	if (encoder_thread.joinable()) {
+		encoder_thread.join();
+	}
+	
+	std::unique_lock lock(mutex);
+	cv.wait(lock, [this]() { return number_of_queued_frames == 0; });
+	
+	if (not finished) {
+		finished = true;
+		if (not error_message.empty()) {
+			throw std::runtime_error(error_message);
+		}
+	}
+	return number_of_written_frames;
+}
+
+void Toucan::FrameExporter::read_framebuffer(unsigned int framebuffer, const Vector2i& framebuffer_size) {
+	PixelBuffer& pixel_buffer = pixel_buffers[(oldest_pixel_buffer_index + number_of_pending_pixel_buffers) % pixel_buffers.size()];
+	const size_t size_in_bytes = get_size_in_bytes(framebuffer_size);
+	
+	if (pixel_buffer.pixel_buffer == 0) {
+		glGenBuffers(1, &pixel_buffer.pixel_buffer);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, pixel_buffer.pixel_buffer);
+	if (pixel_buffer.capacity < size_in_bytes) {
+		glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(size_in_bytes), nullptr, GL_STREAM_READ);
+		pixel_buffer.capacity = size_in_bytes;
+	}
+	
+	// With a pixel pack buffer bound, the pixels are copied on the GPU and glReadPixels returns immediately.
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	glReadPixels(0, 0, framebuffer_size.x(), framebuffer_size.y(), GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	pixel_buffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	
+	pixel_buffer.size = framebuffer_size;
+	pixel_buffer.frame_index = number_of_read_frames++;
+	++number_of_pending_pixel_buffers;
+}
+
+void Toucan::FrameExporter::collect_pixel_buffers(bool wait) {
+	while (number_of_pending_pixel_buffers > 0) {
+		PixelBuffer& pixel_buffer = pixel_buffers[oldest_pixel_buffer_index];
+		
+		GLenum wait_result = glClientWaitSync(pixel_buffer.fence, 0, 0);
+		while (wait and wait_result == GL_TIMEOUT_EXPIRED) {
+			wait_result = glClientWaitSync(pixel_buffer.fence, GL_SYNC_FLUSH_COMMANDS_BIT, fence_wait_timeout_ns);
+		}
+		if (wait_result == GL_TIMEOUT_EXPIRED) {
+			return; // The frames arrive in order, so the later ones are not done either.
+		}
+		
+		glDeleteSync(pixel_buffer.fence);
+		pixel_buffer.fence = nullptr;
+		oldest_pixel_buffer_index = (oldest_pixel_buffer_index + 1) % pixel_buffers.size();
+		--number_of_pending_pixel_buffers;
+		
+		if (wait_result == GL_WAIT_FAILED) {
+			continue; // Dropped
+		}
+		
+		const size_t size_in_bytes = get_size_in_bytes(pixel_buffer.size);
+		std::vector<uint8_t> pixels;
+		{
+			std::lock_guard lock(mutex);
+			if (not free_pixels.empty()) {
+				pixels = std::move(free_pixels.back());
+				free_pixels.pop_back();
+			}
+		}
+		pixels.resize(size_in_bytes);
+		
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, pixel_buffer.pixel_buffer);
+		const void* mapped_pixels_ptr = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(size_in_bytes), GL_MAP_READ_BIT);
+		if (mapped_pixels_ptr != nullptr) {
+			std::memcpy(pixels.data(), mapped_pixels_ptr, size_in_bytes);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+			queue_frame(std::move(pixels), pixel_buffer.size, pixel_buffer.frame_index);
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	}
+}
+
+void Toucan::FrameExporter::queue_frame(std::vector<uint8_t>&& pixels, const Vector2i& size, size_t frame_index) {
+	++number_of_queued_frames;
+	
+	if (encoder_thread.joinable()) {
+		{
+			std::lock_guard lock(mutex);
+			encoder_frames.push_back({std::move(pixels), size});
+		}
+		cv.notify_all();
+		return;
+	}
+	
+	thread_pool.submit([this, pixels = std::move(pixels), size, frame_index]() mutable {
+		const bool written = write_frame_file(pixels, size, frame_index);
+		finish_queued_frame(std::move(pixels), written);
+	});
+}
+
+bool Toucan::FrameExporter::write_frame_file(const std::vector<uint8_t>& pixels, const Vector2i& size, size_t frame_index) {
+	const std::string file_path = replace_all(settings.file_path, "{index}", get_padded_frame_index(frame_index));
+	
+	std::FILE* file_ptr = std::fopen(file_path.c_str(), "wb");
+	bool written = file_ptr != nullptr;
+	
+	if (written and settings.format == FrameExportFormat::PNG) {
+		const size_t row_size = 4*static_cast<size_t>(size.x());
+		std::vector<uint8_t> png;
+		encode_png(pixels.data() + row_size*static_cast<size_t>(size.y() - 1), size.x(), size.y(), -static_cast<ptrdiff_t>(row_size), png);
+		written = std::fwrite(png.data(), 1, png.size(), file_ptr) == png.size();
+	} else if (written) {
+		const std::string header = "P7\nWIDTH " + std::to_string(size.x()) + "\nHEIGHT " + std::to_string(size.y()) + "\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n";
+		written = std::fwrite(header.data(), 1, header.size(), file_ptr) == header.size() and write_rows_flipped(file_ptr, pixels, size);
+	}
+	
+	if (file_ptr != nullptr and std::fclose(file_ptr) != 0) {
+		written = false;
+	}
+	
+	if (not written) {
+		set_error("Toucan error! Could not write the exported frame '" + file_path + "'.");
+	}
+	return written;
+}
+
+bool Toucan::FrameExporter::write_encoder_frame(const EncoderFrame& frame) {
+	if (encoder_pipe_ptr == nullptr and not encoder_failed) {
+		encoder_frame_size = frame.size;
+		const std::string command = replace_all(replace_all(settings.encoder_command, "{width}", std::to_string(frame.size.x())), "{height}", std::to_string(frame.size.y()));
+		encoder_pipe_ptr = popen(command.c_str(), "we");
+		if (encoder_pipe_ptr == nullptr) {
+			set_error("Toucan error! Could not start the encoder command '" + command + "'.");
+			encoder_failed = true;
+		}
+	}
+	
+	if (encoder_failed or frame.size != encoder_frame_size) {
+		return false; // Dropped
+	}
+	
+	if (not write_rows_flipped(encoder_pipe_ptr, frame.pixels, frame.size)) {
+		set_error("Toucan error! Could not write to the encoder command. Did it exit early?");
+		encoder_failed = true;
+		return false;
+	}
+	return true;
+}
+
+void Toucan::FrameExporter::encoder_loop() {
+	// SIGPIPE is blocked on this thread, so an encoder command that exits early makes the writes fail, rather than ending the process.
+	sigset_t sigpipe_set;
+	sigemptyset(&sigpipe_set);
+	sigaddset(&sigpipe_set, SIGPIPE);
+	pthread_sigmask(SIG_BLOCK, &sigpipe_set, nullptr);
+	
+	while (true) {
+		EncoderFrame frame;
+		{
+			std::unique_lock lock(mutex);
+			cv.wait(lock, [this]() { return encoder_stop or not encoder_frames.empty(); });
+			if (encoder_frames.empty()) { break; }
+			
+			frame = std::move(encoder_frames.front());
+			encoder_frames.pop_front();
+		}
+		
+		const bool written = write_encoder_frame(frame);
+		finish_queued_frame(std::move(frame.pixels), written);
+	}
+	
+	// Waits for the encoder command to exit.
+	if (encoder_pipe_ptr != nullptr and pclose(encoder_pipe_ptr) != 0 and not encoder_failed) {
+		set_error("Toucan error! The encoder command '" + settings.encoder_command + "' failed.");
+	}
+	encoder_pipe_ptr = nullptr;
+	
+	// Discards the SIGPIPE raised by a failed write, before it is unblocked when the thread exits.
+	const timespec no_timeout = {};
+	while (sigtimedwait(&sigpipe_set, nullptr, &no_timeout) == SIGPIPE) { }
+}
+
+void Toucan::FrameExporter::finish_queued_frame(std::vector<uint8_t>&& pixels, bool written) {
+	{
+		std::lock_guard lock(mutex);
+		if (written) {
+			++number_of_written_frames;
+		}
+		if (free_pixels.size() < max_queued_frames) {
+			free_pixels.push_back(std::move(pixels));
+		}
+		--number_of_queued_frames;
+	}
+	cv.notify_all();
+}
+
+void Toucan::FrameExporter::set_error(const std::string& message) {
+	std::lock_guard lock(mutex);
+	if (error_message.empty()) {
+		error_message = message;
+	}
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include <Toucan/DataTypes.h>
+
+#include "thread_pool.h"
+
+namespace Toucan {
+
+// Exports the framebuffer of a figure. The render thread reads the framebuffer into a ring of pixel buffer objects, and only maps a buffer once
+// its fence has signaled, a few frames later, so it never waits for the GPU. The frames are then encoded and written to files on the thread pool,
+// or written to the encoder command by a thread of the exporter. A frame is dropped when all pixel buffers are in flight, or too many frames are
+// waiting to be written.
+class FrameExporter {
+public:
+	FrameExporter(const FrameExportSettings& settings, ThreadPool& thread_pool);
+	~FrameExporter(); // Waits until all frames are written, the render thread must have released the exporter.
+	
+	FrameExporter(const FrameExporter&) = delete;
+	FrameExporter& operator=(const FrameExporter&) = delete;
+	
+	// Called by the render thread, with the figure locked.
+	void mark_redrawn() { redrawn = true; }
+	void update(unsigned int framebuffer, const Vector2i& framebuffer_size); // Once per window frame.
+	void release(); // Waits for the frames in flight on the GPU and deletes the pixel buffers. Called when the window closes.
+	
+	// Called by the thread that started the export.
+	void request_stop() { stop_requested = true; }
+	// Waits until the render thread has released the exporter, either after a stop request or after the last frame, and all frames are written.
+	// Returns the number of frames written. Throws if a frame could not be written.
+	size_t finish();
+
+private:
+	struct PixelBuffer {
+		GLuint pixel_buffer = 0;
+		GLsync fence = nullptr;
+		size_t capacity = 0;
+		Vector2i size = Vector2i::Zero();
+		size_t frame_index = 0;
+	};
+	
+	struct EncoderFrame {
+		std::vector<uint8_t> pixels;
+		Vector2i size;
+	};
+	
+	void read_framebuffer(unsigned int framebuffer, const Vector2i& framebuffer_size);
+	void collect_pixel_buffers(bool wait); // Hands the frames that have arrived in the pixel buffers over for writing.
+	void queue_frame(std::vector<uint8_t>&& pixels, const Vector2i& size, size_t frame_index);
+	bool write_frame_file(const std::vector<uint8_t>& pixels, const Vector2i& size, size_t frame_index);
+	bool write_encoder_frame(const EncoderFrame& frame);
+	void encoder_loop();
+	void finish_queued_frame(std::vector<uint8_t>&& pixels, bool written);
+	void set_error(const std::string& message);
+	
+	const FrameExportSettings settings;
+	ThreadPool& thread_pool;
+	
+	// Only used by the render thread.
+	std::array<PixelBuffer, 3> pixel_buffers;
+	size_t oldest_pixel_buffer_index = 0;
+	size_t number_of_pending_pixel_buffers = 0; // Read into, but not yet mapped.
+	size_t number_of_read_frames = 0;
+	bool redrawn = false;
+	
+	std::atomic_bool stop_requested = false;
+	std::atomic_size_t number_of_queued_frames = 0; // Waiting to be encoded or written.
+	
+	std::mutex mutex; // Guards the members below.
+	bool released = false;
+	bool finished = false;
+	size_t number_of_written_frames = 0;
+	std::string error_message; // Of the first frame that could not be written.
+	std::vector<std::vector<uint8_t>> free_pixels; // Reused, to avoid reallocating a frame of pixels for every frame.
+	std::deque<EncoderFrame> encoder_frames;
+	bool encoder_stop = false;
+	std::condition_variable cv;
+	
+	// Only used by the encoder thread.
+	std::FILE* encoder_pipe_ptr = nullptr;
+	Vector2i encoder_frame_size = Vector2i::Zero();
+	bool encoder_failed = false;
+	
+	std::thread encoder_thread; // Only started if the settings have an encoder command.
+};
+
+} // namespace Toucan
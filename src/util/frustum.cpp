@@ -0,0 +1,74 @@
+#include "frustum.h"
+
+#include <cmath>
+
+Toucan::Frustum Toucan::extract_frustum(const Matrix4f& model_to_clip_matrix) {
+	const Matrix4f& m = model_to_clip_matrix;
+	
+	// Gribb-Hartmann plane extraction, -w <= x,y,z <= w (OpenGL clip space).
+	Frustum frustum;
+	for (int axis = 0; axis < 3; ++axis) {
+		for (int side = 0; side < 2; ++side) {
+			const float sign = side == 0 ? 1.0f : -1.0f;
+			Vector4f plane(
+					m(3, 0) + sign*m(axis, 0),
+					m(3, 1) + sign*m(axis, 1),
+					m(3, 2) + sign*m(axis, 2),
+					m(3, 3) + sign*m(axis, 3)
+			);
+			
+			// Normalize so the plane distance is metric, needed for the sphere test.
+			const float normal_length = std::sqrt(plane.x()*plane.x() + plane.y()*plane.y() + plane.z()*plane.z());
+			if (normal_length > 0.0f) {
+				plane = (1.0f / normal_length) * plane;
+			}
+			
+			frustum.planes[2*axis + side] = plane;
+		}
+	}
+	
+	return frustum;
+}
+
+bool Toucan::frustum_intersects_box(const Frustum& frustum, const BoundingBox3D& box) {
+	if (box.is_empty()) { return false; }
+	
+	for (const auto& plane : frustum.planes) {
+		// Test the corner of the box furthest along the plane normal. If it is outside, the whole box is outside.
+		const float x = plane.x() >= 0.0f ? box.max.x() : box.min.x();
+		const float y = plane.y() >= 0.0f ? box.max.y() : box.min.y();
+		const float z = plane.z() >= 0.0f ? box.max.z() : box.min.z();
+		
+		if (plane.x()*x + plane.y()*y + plane.z()*z + plane(3) < 0.0f) {
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+bool Toucan::frustum_intersects_sphere(const Frustum& frustum, const Vector3f& center, float radius) {
+	for (const auto& plane : frustum.planes) {
+		if (plane.x()*center.x() + plane.y()*center.y() + plane.z()*center.z() + plane(3) < -radius) {
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+Toucan::BoundingBox3D Toucan::compute_bounding_box(const Point3D* points_ptr, int number_of_points) {
+	BoundingBox3D box;
+	for (int point_index = 0; point_index < number_of_points; ++point_index) {
+		box.extend(points_ptr[point_index].position);
+	}
+	return box;
+}
+
+Toucan::BoundingBox3D Toucan::compute_bounding_box(const LineVertex3D* line_vertices_ptr, int number_of_line_vertices) {
+	BoundingBox3D box;
+	for (int vertex_index = 0; vertex_index < number_of_line_vertices; ++vertex_index) {
+		box.extend(line_vertices_ptr[vertex_index].position);
+	}
+	return box;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+
+#include <Toucan/LinAlg.h>
+#include <Toucan/DataTypes.h>
+
+namespace Toucan {
+
+struct BoundingBox3D {
+	Vector3f min = Vector3f::Ones() * std::numeric_limits<float>::max();
+	Vector3f max = Vector3f::Ones() * std::numeric_limits<float>::lowest();
+	
+	[[nodiscard]] inline bool is_empty() const { return min.x() > max.x() or min.y() > max.y() or min.z() > max.z(); }
+	
+	inline void extend(const Vector3f& point) {
+		min.x() = std::min(min.x(), point.x()); max.x() = std::max(max.x(), point.x());
+		min.y() = std::min(min.y(), point.y()); max.y() = std::max(max.y(), point.y());
+		min.z() = std::min(min.z(), point.z()); max.z() = std::max(max.z(), point.z());
+	}
+	
+	inline void extend(const BoundingBox3D& box) {
+		if (box.is_empty()) { return; }
+		extend(box.min);
+		extend(box.max);
+	}
+};
+
+// Six clip planes (left, right, bottom, top, near, far) in the space of the matrix they were extracted from.
+// A point p is inside a plane when dot(plane.xyz, p) + plane.w >= 0.
+struct Frustum {
+	Vector4f planes[6];
+};
+
+// Extract the frustum planes from a combined `projection * view * model` matrix, so the planes end up in model space.
+Frustum extract_frustum(const Matrix4f& model_to_clip_matrix);
+
+bool frustum_intersects_box(const Frustum& frustum, const BoundingBox3D& box);
+bool frustum_intersects_sphere(const Frustum& frustum, const Vector3f& center, float radius);
+
+BoundingBox3D compute_bounding_box(const Point3D* points_ptr, int number_of_points);
+BoundingBox3D compute_bounding_box(const LineVertex3D* line_vertices_ptr, int number_of_line_vertices);
+
+} // namespace Toucan
@@ -0,0 +1,200 @@
+#include "line_decimation.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+
+Toucan::LinePlotDecimation* Toucan::create_line_plot_decimation(Vector2f* points_ptr, int number_of_points, ThreadPool& thread_pool) {
+	auto* decimation_ptr = new LinePlotDecimation();
+	decimation_ptr->points_ptr = points_ptr;
+	decimation_ptr->number_of_points = number_of_points;
+	decimation_ptr->pyramid_future = thread_pool.submit([decimation_ptr]() {
+		decimation_ptr->pyramid = build_min_max_pyramid(decimation_ptr->points_ptr, decimation_ptr->number_of_points, decimation_ptr->cancel_pyramid_build);
+	});
+	return decimation_ptr;
+}
+
+void Toucan::destroy_line_plot_decimation(LinePlotDecimation* decimation_ptr) {
+	decimation_ptr->cancel_pyramid_build = true;
+	if (decimation_ptr->pyramid_future.valid()) {
+		decimation_ptr->pyramid_future.wait();
+	}
+	
+	if (decimation_ptr->future.valid()) {
+		decimation_ptr->future.wait();
+	}
+	
+	std::free(decimation_ptr->points_ptr);
+	delete decimation_ptr;
+}
+
+bool Toucan::is_sorted_by_x(const Vector2f* points_ptr, int number_of_points) {
+	return std::is_sorted(points_ptr, points_ptr + number_of_points, [](const Vector2f& lhs, const Vector2f& rhs) { return lhs.x() < rhs.x(); });
+}
+
+std::vector<Toucan::Vector2f> Toucan::compute_m4_decimation(const Vector2f* points_ptr, int number_of_points, float x_min, float x_max, int number_of_columns) {
+	std::vector<Vector2f> decimated_points;
+	if (number_of_points == 0 or number_of_columns <= 0 or not (x_min < x_max)) { return decimated_points; }
+	
+	const auto compare_x = [](const Vector2f& point, float x) { return point.x() < x; };
+	
+	// Include the closest sample on each side of the range so the line continues out of the view.
+	int begin = static_cast<int>(std::lower_bound(points_ptr, points_ptr + number_of_points, x_min, compare_x) - points_ptr);
+	int end = static_cast<int>(std::lower_bound(points_ptr + begin, points_ptr + number_of_points, x_max, compare_x) - points_ptr);
+	begin = std::max(begin - 1, 0);
+	end = std::min(end + 1, number_of_points);
+	
+	decimated_points.reserve(std::min(end - begin, 4*number_of_columns + 2));
+	
+	const float columns_per_unit = static_cast<float>(number_of_columns) / (x_max - x_min);
+	
+	int point_index = begin;
+	while (point_index < end) {
+		const int column = static_cast<int>(std::floor((points_ptr[point_index].x() - x_min) * columns_per_unit));
+		
+		int first_index = point_index;
+		int min_index = point_index;
+		int max_index = point_index;
+		int last_index = point_index;
+		
+		for (++point_index; point_index < end; ++point_index) {
+			if (static_cast<int>(std::floor((points_ptr[point_index].x() - x_min) * columns_per_unit)) != column) { break; }
+			
+			if (points_ptr[point_index].y() < points_ptr[min_index].y()) { min_index = point_index; }
+			if (points_ptr[point_index].y() > points_ptr[max_index].y()) { max_index = point_index; }
+			last_index = point_index;
+		}
+		
+		// Emit in sample order so the line strip visits the samples in the same order as the full line.
+		int column_indices[4] = { first_index, std::min(min_index, max_index), std::max(min_index, max_index), last_index };
+		for (int i = 0; i < 4; ++i) {
+			if (i > 0 and column_indices[i] == column_indices[i - 1]) { continue; }
+			decimated_points.emplace_back(points_ptr[column_indices[i]]);
+		}
+	}
+	
+	return decimated_points;
+}
+
+namespace {
+
+inline Toucan::MinMaxBlock merge_blocks(const Toucan::Vector2f* points_ptr, const Toucan::MinMaxBlock& lhs, const Toucan::MinMaxBlock& rhs) {
+	return {
+			points_ptr[rhs.min_index].y() < points_ptr[lhs.min_index].y() ? rhs.min_index : lhs.min_index,
+			points_ptr[rhs.max_index].y() > points_ptr[lhs.max_index].y() ? rhs.max_index : lhs.max_index
+	};
+}
+
+inline void extend_block(const Toucan::Vector2f* points_ptr, Toucan::MinMaxBlock& block, int point_index) {
+	if (points_ptr[point_index].y() < points_ptr[block.min_index].y()) { block.min_index = point_index; }
+	if (points_ptr[point_index].y() > points_ptr[block.max_index].y()) { block.max_index = point_index; }
+}
+
+} // namespace
+
+Toucan::MinMaxPyramid Toucan::build_min_max_pyramid(const Vector2f* points_ptr, int number_of_points, const std::atomic_bool& cancel_build) {
+	MinMaxPyramid pyramid;
+	
+	const int number_of_leaf_blocks = number_of_points / min_max_pyramid_leaf_size; // Only whole blocks, the remainder is scanned when queried.
+	if (number_of_leaf_blocks == 0) { return pyramid; }
+	
+	auto& leaf_level = pyramid.levels.emplace_back(number_of_leaf_blocks);
+	for (int block_index = 0; block_index < number_of_leaf_blocks; ++block_index) {
+		const int first_index = block_index * min_max_pyramid_leaf_size;
+		MinMaxBlock block = {first_index, first_index};
+		for (int point_index = first_index + 1; point_index < first_index + min_max_pyramid_leaf_size; ++point_index) {
+			extend_block(points_ptr, block, point_index);
+		}
+		leaf_level[block_index] = block;
+	}
+	
+	while (pyramid.levels.back().size() > 1) {
+		if (cancel_build) { return MinMaxPyramid(); }
+		
+		const auto& lower_level = pyramid.levels.back();
+		std::vector<MinMaxBlock> level(lower_level.size() / 2);
+		for (size_t block_index = 0; block_index < level.size(); ++block_index) {
+			level[block_index] = merge_blocks(points_ptr, lower_level[2*block_index], lower_level[2*block_index + 1]);
+		}
+		pyramid.levels.emplace_back(std::move(level));
+	}
+	
+	return pyramid;
+}
+
+Toucan::MinMaxBlock Toucan::query_min_max_pyramid(const Vector2f* points_ptr, const MinMaxPyramid& pyramid, int begin, int end) {
+	assert(begin < end);
+	MinMaxBlock result = {begin, begin};
+	
+	const int number_of_leaf_blocks = pyramid.levels.empty() ? 0 : static_cast<int>(pyramid.levels.front().size());
+	int block_begin = (begin + min_max_pyramid_leaf_size - 1) / min_max_pyramid_leaf_size;
+	int block_end = std::min(end / min_max_pyramid_leaf_size, number_of_leaf_blocks);
+	
+	if (block_begin >= block_end) { // No whole block inside the range
+		for (int point_index = begin + 1; point_index < end; ++point_index) {
+			extend_block(points_ptr, result, point_index);
+		}
+		return result;
+	}
+	
+	// Scan the partial blocks at each end
+	for (int point_index = begin + 1; point_index < block_begin * min_max_pyramid_leaf_size; ++point_index) {
+		extend_block(points_ptr, result, point_index);
+	}
+	for (int point_index = block_end * min_max_pyramid_leaf_size; point_index < end; ++point_index) {
+		extend_block(points_ptr, result, point_index);
+	}
+	
+	// Cover the whole blocks with as few pyramid blocks as possible, going up one level at a time.
+	for (size_t level_index = 0; level_index < pyramid.levels.size() and block_begin < block_end; ++level_index) {
+		const auto& level = pyramid.levels[level_index];
+		
+		if (block_begin % 2 == 1) { result = merge_blocks(points_ptr, result, level[block_begin]); ++block_begin; }
+		if (block_end % 2 == 1) { --block_end; result = merge_blocks(points_ptr, result, level[block_end]); }
+		
+		block_begin /= 2;
+		block_end /= 2;
+	}
+	
+	return result;
+}
+
+std::vector<Toucan::Vector2f> Toucan::compute_m4_decimation(const Vector2f* points_ptr, int number_of_points, const MinMaxPyramid& pyramid, float x_min, float x_max, int number_of_columns) {
+	std::vector<Vector2f> decimated_points;
+	if (number_of_points == 0 or number_of_columns <= 0 or not (x_min < x_max)) { return decimated_points; }
+	
+	const auto compare_x = [](const Vector2f& point, float x) { return point.x() < x; };
+	const Vector2f* points_end_ptr = points_ptr + number_of_points;
+	
+	decimated_points.reserve(4*number_of_columns + 2);
+	
+	// The closest sample before the range, so the line continues out of the view.
+	const int range_begin = static_cast<int>(std::lower_bound(points_ptr, points_end_ptr, x_min, compare_x) - points_ptr);
+	if (range_begin > 0) { decimated_points.emplace_back(points_ptr[range_begin - 1]); }
+	
+	const float column_width = (x_max - x_min) / static_cast<float>(number_of_columns);
+	
+	int column_begin = range_begin;
+	for (int column = 0; column < number_of_columns and column_begin < number_of_points; ++column) {
+		const float column_x_max = column + 1 == number_of_columns ? x_max : x_min + static_cast<float>(column + 1) * column_width;
+		const int column_end = static_cast<int>(std::lower_bound(points_ptr + column_begin, points_end_ptr, column_x_max, compare_x) - points_ptr);
+		if (column_end == column_begin) { continue; }
+		
+		const MinMaxBlock min_max = query_min_max_pyramid(points_ptr, pyramid, column_begin, column_end);
+		
+		// Emit in sample order so the line strip visits the samples in the same order as the full line.
+		const int column_indices[4] = { column_begin, std::min(min_max.min_index, min_max.max_index), std::max(min_max.min_index, min_max.max_index), column_end - 1 };
+		for (int i = 0; i < 4; ++i) {
+			if (i > 0 and column_indices[i] == column_indices[i - 1]) { continue; }
+			decimated_points.emplace_back(points_ptr[column_indices[i]]);
+		}
+		
+		column_begin = column_end;
+	}
+	
+	// The closest sample after the range
+	if (column_begin < number_of_points) { decimated_points.emplace_back(points_ptr[column_begin]); }
+	
+	return decimated_points;
+}
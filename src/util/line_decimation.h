@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vector>
+#include <future>
+#include <atomic>
+
+#include <Toucan/LinAlg.h>
+
+#include "thread_pool.h"
+
+namespace Toucan {
+
+constexpr int min_max_pyramid_leaf_size = 16;
+
+struct MinMaxBlock {
+	int min_index;
+	int max_index;
+};
+
+// Min and max sample of aligned blocks of points. Level 0 has blocks of `min_max_pyramid_leaf_size` points, and each level above halves the number of blocks.
+struct MinMaxPyramid {
+	std::vector<std::vector<MinMaxBlock>> levels;
+};
+
+struct LinePlotDecimation {
+	Vector2f* points_ptr = nullptr; // Full resolution points sorted by x. Owned by the decimation.
+	int number_of_points = 0;
+	
+	// Data range and column count of the decimated vertices currently on the device.
+	bool has_result = false;
+	float x_min = 0.0f;
+	float x_max = 0.0f;
+	int number_of_columns = 0;
+	int number_of_vertices = 0;
+	
+	// Decimation currently being computed in the background.
+	std::future<std::vector<Vector2f>> future;
+	float requested_x_min = 0.0f;
+	float requested_x_max = 0.0f;
+	int requested_number_of_columns = 0;
+	
+	// Built once in the background. Once ready, decimations are cheap enough to compute directly for every view change.
+	MinMaxPyramid pyramid;
+	std::future<void> pyramid_future;
+	std::atomic_bool cancel_pyramid_build = false;
+	bool pyramid_ready = false;
+};
+
+// Takes ownership of `points_ptr`, which must be allocated with `std::malloc` and sorted by x. Starts building the min/max pyramid on the thread pool.
+LinePlotDecimation* create_line_plot_decimation(Vector2f* points_ptr, int number_of_points, ThreadPool& thread_pool);
+
+// Waits for any decimation in progress, and frees the decimation.
+void destroy_line_plot_decimation(LinePlotDecimation* decimation_ptr);
+
+bool is_sorted_by_x(const Vector2f* points_ptr, int number_of_points);
+
+// M4 aggregation: split [x_min, x_max] into equally wide columns, and keep only the first, last, min and max sample of each column.
+// A line strip through the result rasterizes the same as the full line when each column is at most one pixel wide.
+std::vector<Vector2f> compute_m4_decimation(const Vector2f* points_ptr, int number_of_points, float x_min, float x_max, int number_of_columns);
+
+// Same result as above, but looks up the min and max of each column in the pyramid. O(number_of_columns * log(number_of_points)).
+std::vector<Vector2f> compute_m4_decimation(const Vector2f* points_ptr, int number_of_points, const MinMaxPyramid& pyramid, float x_min, float x_max, int number_of_columns);
+
+MinMaxPyramid build_min_max_pyramid(const Vector2f* points_ptr, int number_of_points, const std::atomic_bool& cancel_build);
+
+// Min and max sample in [begin, end).
+MinMaxBlock query_min_max_pyramid(const Vector2f* points_ptr, const MinMaxPyramid& pyramid, int begin, int end);
+
+} // namespace Toucan
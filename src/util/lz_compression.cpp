@@ -0,0 +1,154 @@
+#include "lz_compression.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+constexpr size_t minimum_match_length = 4;
+constexpr size_t last_literals_length = 5; // The block format ends with at least this many literals.
+constexpr size_t match_start_margin = 12; // Matches start at least this many bytes before the end.
+constexpr size_t max_match_offset = 65535;
+
+constexpr unsigned int hash_bits = 13;
+constexpr unsigned int skip_shift = 6; // Positions are skipped faster the longer no match has been found.
+
+uint32_t read_uint32(const uint8_t* ptr) {
+	uint32_t value;
+	std::memcpy(&value, ptr, sizeof(value));
+	return value;
+}
+
+uint32_t get_hash(uint32_t sequence) {
+	return (sequence*2654435761u) >> (32u - hash_bits);
+}
+
+void write_length(uint8_t*& destination_ptr, size_t length) {
+	while (length >= 255) {
+		*destination_ptr++ = 255;
+		length -= 255;
+	}
+	*destination_ptr++ = static_cast<uint8_t>(length);
+}
+
+bool read_length(const uint8_t*& source_ptr, const uint8_t* source_end_ptr, size_t& length) {
+	uint8_t value;
+	do {
+		if (source_ptr == source_end_ptr) { return false; }
+		value = *source_ptr++;
+		length += value;
+	} while (value == 255);
+	return true;
+}
+
+void write_sequence(uint8_t*& destination_ptr, const uint8_t* literals_ptr, size_t literal_length, size_t match_offset, size_t match_length) {
+	uint8_t* token_ptr = destination_ptr++;
+	*token_ptr = static_cast<uint8_t>(std::min<size_t>(literal_length, 15) << 4u);
+	if (literal_length >= 15) { write_length(destination_ptr, literal_length - 15); }
+	
+	if (literal_length > 0) { std::memcpy(destination_ptr, literals_ptr, literal_length); }
+	destination_ptr += literal_length;
+	
+	if (match_length == 0) { return; } // The last sequence only has literals.
+	
+	*destination_ptr++ = static_cast<uint8_t>(match_offset & 0xFFu);
+	*destination_ptr++ = static_cast<uint8_t>(match_offset >> 8u);
+	
+	match_length -= minimum_match_length;
+	*token_ptr |= static_cast<uint8_t>(std::min<size_t>(match_length, 15));
+	if (match_length >= 15) { write_length(destination_ptr, match_length - 15); }
+}
+
+} // namespace
+
+size_t Toucan::lz_compress(const uint8_t* source_ptr, size_t size, uint8_t* destination_ptr) {
+	assert(size <= std::numeric_limits<uint32_t>::max());
+	
+	uint8_t* write_ptr = destination_ptr;
+	const uint8_t* anchor_ptr = source_ptr; // Start of the literals not yet written.
+	const uint8_t* const end_ptr = source_ptr + size;
+	
+	if (size > match_start_margin) {
+		uint32_t hash_table[1u << hash_bits] = {}; // Last position of each hashed four byte sequence.
+		const uint8_t* const match_start_limit_ptr = end_ptr - match_start_margin;
+		const uint8_t* const match_end_limit_ptr = end_ptr - last_literals_length;
+		
+		const uint8_t* read_ptr = source_ptr;
+		while (read_ptr < match_start_limit_ptr) {
+			const uint32_t sequence = read_uint32(read_ptr);
+			const uint32_t hash = get_hash(sequence);
+			const uint8_t* match_ptr = source_ptr + hash_table[hash];
+			hash_table[hash] = static_cast<uint32_t>(read_ptr - source_ptr);
+			
+			if (match_ptr >= read_ptr or static_cast<size_t>(read_ptr - match_ptr) > max_match_offset or read_uint32(match_ptr) != sequence) {
+				read_ptr += 1 + (static_cast<size_t>(read_ptr - anchor_ptr) >> skip_shift);
+				continue;
+			}
+			
+			// Extend the match backwards into the literals, and forwards as far as the format allows.
+			while (read_ptr > anchor_ptr and match_ptr > source_ptr and read_ptr[-1] == match_ptr[-1]) {
+				--read_ptr;
+				--match_ptr;
+			}
+			
+			size_t match_length = minimum_match_length;
+			while (read_ptr + match_length < match_end_limit_ptr and read_ptr[match_length] == match_ptr[match_length]) {
+				++match_length;
+			}
+			
+			write_sequence(write_ptr, anchor_ptr, static_cast<size_t>(read_ptr - anchor_ptr), static_cast<size_t>(read_ptr - match_ptr), match_length);
+			read_ptr += match_length;
+			anchor_ptr = read_ptr;
+		}
+	}
+	
+	write_sequence(write_ptr, anchor_ptr, static_cast<size_t>(end_ptr - anchor_ptr), 0, 0);
+	
+	return static_cast<size_t>(write_ptr - destination_ptr);
+}
+
+bool Toucan::lz_decompress(const uint8_t* source_ptr, size_t compressed_size, uint8_t* destination_ptr, size_t decompressed_size) {
+	const uint8_t* read_ptr = source_ptr;
+	const uint8_t* const read_end_ptr = source_ptr + compressed_size;
+	uint8_t* write_ptr = destination_ptr;
+	uint8_t* const write_end_ptr = destination_ptr + decompressed_size;
+	
+	while (read_ptr != read_end_ptr) {
+		const uint8_t token = *read_ptr++;
+		
+		size_t literal_length = token >> 4u;
+		if (literal_length == 15 and not read_length(read_ptr, read_end_ptr, literal_length)) { return false; }
+		if (literal_length > static_cast<size_t>(read_end_ptr - read_ptr) or literal_length > static_cast<size_t>(write_end_ptr - write_ptr)) { return false; }
+		
+		if (literal_length > 0) { std::memcpy(write_ptr, read_ptr, literal_length); }
+		read_ptr += literal_length;
+		write_ptr += literal_length;
+		
+		if (read_ptr == read_end_ptr) { break; } // The last sequence only has literals.
+		
+		if (read_end_ptr - read_ptr < 2) { return false; }
+		const size_t match_offset = read_ptr[0] | (static_cast<size_t>(read_ptr[1]) << 8u);
+		read_ptr += 2;
+		if (match_offset == 0 or match_offset > static_cast<size_t>(write_ptr - destination_ptr)) { return false; }
+		
+		size_t match_length = token & 0x0Fu;
+		if (match_length == 15 and not read_length(read_ptr, read_end_ptr, match_length)) { return false; }
+		match_length += minimum_match_length;
+		if (match_length > static_cast<size_t>(write_end_ptr - write_ptr)) { return false; }
+		
+		// Overlapping matches repeat the bytes just written, so they are copied one byte at a time.
+		const uint8_t* match_ptr = write_ptr - match_offset;
+		if (match_offset >= match_length) {
+			std::memcpy(write_ptr, match_ptr, match_length);
+			write_ptr += match_length;
+		} else {
+			for (size_t index = 0; index < match_length; ++index) {
+				*write_ptr++ = match_ptr[index];
+			}
+		}
+	}
+	
+	return write_ptr == write_end_ptr;
+}
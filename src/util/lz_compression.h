@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Toucan {
+
+// Fast LZ77 compression in the LZ4 block format: a sequence of literal runs and matches of at least four bytes, at most 65535 bytes back.
+// Favors speed over ratio, data that does not compress is passed over quickly.
+
+constexpr size_t get_lz_compress_bound(size_t size) { return size + size/255 + 16; }
+
+// Compresses `size` bytes into `destination_ptr`, which must hold `get_lz_compress_bound(size)` bytes. Returns the compressed size.
+size_t lz_compress(const uint8_t* source_ptr, size_t size, uint8_t* destination_ptr);
+
+// Decompresses into exactly `decompressed_size` bytes. Returns false if the compressed data is corrupt, without reading or writing out of bounds.
+bool lz_decompress(const uint8_t* source_ptr, size_t compressed_size, uint8_t* destination_ptr, size_t decompressed_size);
+
+} // namespace Toucan
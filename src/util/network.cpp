@@ -0,0 +1,678 @@
+#include "network.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <Toucan/Toucan.h>
+
+#include "lz_compression.h"
+
+namespace {
+
+constexpr int points_grain_size = 16384;
+constexpr int poll_interval_ms = 100; // How often the sender thread checks if it should stop.
+
+uint32_t quantize_position(float value, float position_precision) {
+	// Clamped to the largest floats that fit in an int32_t.
+	const float scaled = std::round(value/position_precision);
+	const float clamped = std::isnan(scaled) ? 0.0f : std::clamp(scaled, -2147483520.0f, 2147483520.0f);
+	return static_cast<uint32_t>(static_cast<int32_t>(clamped));
+}
+
+uint32_t quantize_color(float value) {
+	const float clamped = value > 0.0f ? (value < 1.0f ? value : 1.0f) : 0.0f; // NaN becomes 0.
+	return static_cast<uint32_t>(std::lround(clamped*255.0f));
+}
+
+uint32_t get_channel_mask(size_t channel_size) {
+	return channel_size == 4 ? 0xFFFFFFFFu : (1u << (8u*channel_size)) - 1u;
+}
+
+void quantize_points(const Toucan::Buffer<Toucan::Point3D>& points_buffer, float position_precision, Toucan::NetworkQuantizedPoints& quantized_points, Toucan::ThreadPool& thread_pool) {
+	for (auto& channel : quantized_points.channels) {
+		channel.resize(points_buffer.number_of_elements);
+	}
+	
+	thread_pool.parallel_for(0, static_cast<int>(points_buffer.number_of_elements), points_grain_size, [&](int range_begin, int range_end) {
+		for (int point_index = range_begin; point_index < range_end; ++point_index) {
+			const Toucan::Point3D& point = points_buffer.data_ptr[point_index];
+			uint32_t size_bits;
+			std::memcpy(&size_bits, &point.size, sizeof(size_bits));
+			
+			quantized_points.channels[0][point_index] = quantize_position(point.position.x(), position_precision);
+			quantized_points.channels[1][point_index] = quantize_position(point.position.y(), position_precision);
+			quantized_points.channels[2][point_index] = quantize_position(point.position.z(), position_precision);
+			quantized_points.channels[3][point_index] = quantize_color(point.color.r);
+			quantized_points.channels[4][point_index] = quantize_color(point.color.g);
+			quantized_points.channels[5][point_index] = quantize_color(point.color.b);
+			quantized_points.channels[6][point_index] = size_bits;
+			quantized_points.channels[7][point_index] = static_cast<uint32_t>(point.shape);
+		}
+	});
+}
+
+// Compares the position differences of a sample of the points. Points that barely move favor the previous frame, scans that are shown from a
+// moving sensor favor the previous point.
+bool is_temporal_delta_smaller(const Toucan::NetworkQuantizedPoints& quantized_points, const Toucan::NetworkQuantizedPoints& previous_points) {
+	const size_t number_of_points = quantized_points.channels[0].size();
+	const size_t sample_step = std::max<size_t>(1, number_of_points/1024);
+	
+	uint64_t temporal_cost = 0;
+	uint64_t spatial_cost = 0;
+	for (size_t point_index = 0; point_index < number_of_points; point_index += sample_step) {
+		for (size_t channel_index = 0; channel_index < 3; ++channel_index) {
+			const auto& channel = quantized_points.channels[channel_index];
+			temporal_cost += Toucan::encode_difference(channel[point_index], previous_points.channels[channel_index][point_index], 4);
+			spatial_cost += Toucan::encode_difference(channel[point_index], point_index > 0 ? channel[point_index - 1] : 0, 4);
+		}
+	}
+	
+	return temporal_cost <= spatial_cost;
+}
+
+std::string get_element_key(const std::string& figure_name, const std::string& element_name) {
+	return figure_name + '\0' + element_name;
+}
+
+[[noreturn]] void throw_corrupt_stream() {
+	throw std::runtime_error("Toucan error! The network stream is corrupt.");
+}
+
+} // namespace
+
+uint32_t Toucan::encode_difference(uint32_t value, uint32_t reference, size_t channel_size) {
+	const uint32_t mask = get_channel_mask(channel_size);
+	const uint32_t difference = (value - reference) & mask;
+	const uint32_t sign = difference >> (8u*channel_size - 1u);
+	return ((difference << 1u) ^ (0u - sign)) & mask;
+}
+
+uint32_t Toucan::decode_difference(uint32_t encoded_difference, uint32_t reference, size_t channel_size) {
+	return (reference + ((encoded_difference >> 1u) ^ (0u - (encoded_difference & 1u)))) & get_channel_mask(channel_size);
+}
+
+void Toucan::write_point_planes(const NetworkQuantizedPoints& quantized_points, const NetworkQuantizedPoints* previous_points_ptr, uint8_t* planes_ptr, ThreadPool& thread_pool) {
+	const size_t number_of_points = quantized_points.channels[0].size();
+	
+	thread_pool.parallel_for(0, static_cast<int>(number_of_points), points_grain_size, [&](int range_begin, int range_end) {
+		uint8_t* channel_planes_ptr = planes_ptr;
+		for (size_t channel_index = 0; channel_index < NetworkQuantizedPoints::number_of_channels; ++channel_index) {
+			const size_t channel_size = NetworkQuantizedPoints::channel_sizes[channel_index];
+			const auto& channel = quantized_points.channels[channel_index];
+			
+			for (int point_index = range_begin; point_index < range_end; ++point_index) {
+				const uint32_t reference = previous_points_ptr != nullptr ? previous_points_ptr->channels[channel_index][point_index] : (point_index > 0 ? channel[point_index - 1] : 0);
+				const uint32_t encoded_difference = encode_difference(channel[point_index], reference, channel_size);
+				for (size_t byte_index = 0; byte_index < channel_size; ++byte_index) {
+					channel_planes_ptr[byte_index*number_of_points + point_index] = static_cast<uint8_t>(encoded_difference >> (8u*byte_index));
+				}
+			}
+			
+			channel_planes_ptr += channel_size*number_of_points;
+		}
+	});
+}
+
+void Toucan::read_point_planes(const uint8_t* planes_ptr, size_t number_of_points, NetworkDeltaMode delta_mode, NetworkQuantizedPoints& quantized_points) {
+	for (size_t channel_index = 0; channel_index < NetworkQuantizedPoints::number_of_channels; ++channel_index) {
+		const size_t channel_size = NetworkQuantizedPoints::channel_sizes[channel_index];
+		auto& channel = quantized_points.channels[channel_index];
+		channel.resize(number_of_points);
+		
+		for (size_t point_index = 0; point_index < number_of_points; ++point_index) {
+			uint32_t encoded_difference = 0;
+			for (size_t byte_index = 0; byte_index < channel_size; ++byte_index) {
+				encoded_difference |= static_cast<uint32_t>(planes_ptr[byte_index*number_of_points + point_index]) << (8u*byte_index);
+			}
+			
+			const uint32_t reference = delta_mode == NetworkDeltaMode::Temporal ? channel[point_index] : (point_index > 0 ? channel[point_index - 1] : 0);
+			channel[point_index] = decode_difference(encoded_difference, reference, channel_size);
+		}
+		
+		planes_ptr += channel_size*number_of_points;
+	}
+}
+
+Toucan::NetworkWriter::NetworkWriter(uint16_t port, float position_precision, ThreadPool& thread_pool) :
+position_precision{position_precision}, thread_pool{thread_pool} {
+	if (not (position_precision > 0.0f)) {
+		throw std::runtime_error("Toucan error! 'ToucanSettings::network_position_precision' must be positive.");
+	}
+	
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_ANY);
+	address.sin_port = htons(port);
+	const int reuse_address = 1;
+	
+	listen_socket = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (listen_socket == -1 or setsockopt(listen_socket, SOL_SOCKET, SO_REUSEADDR, &reuse_address, sizeof(reuse_address)) != 0 or
+	    bind(listen_socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 or listen(listen_socket, 1) != 0) {
+		if (listen_socket != -1) { close(listen_socket); }
+		throw std::runtime_error("Toucan error! Could not listen on TCP port " + std::to_string(port) + ".");
+	}
+	
+	sender_thread = std::thread(&NetworkWriter::sender_loop, this);
+}
+
+Toucan::NetworkWriter::~NetworkWriter() {
+	{
+		std::lock_guard lock(mutex);
+		stop = true;
+	}
+	sender_cv.notify_one();
+	sender_thread.join();
+	
+	close(listen_socket);
+}
+
+void Toucan::NetworkWriter::write(CaptureRecordType type, std::initializer_list<CaptureField> fields) {
+	CaptureRecordHeader record_header = {};
+	record_header.type = static_cast<uint16_t>(type);
+	record_header.payload_size = get_capture_payload_size(fields);
+	
+	const CaptureContainerCall container_call = get_capture_container_call(record_header.type);
+	
+	std::lock_guard lock(mutex);
+	
+	if (active_containers == 0) { // Between frames
+		writing_frame = viewer_connected.load(std::memory_order_relaxed);
+	}
+	
+	if (writing_frame) {
+		const size_t offset = current_frame.size();
+		current_frame.resize(offset + sizeof(CaptureRecordHeader) + record_header.payload_size);
+		write_capture_record(current_frame.data() + offset, record_header, fields);
+	}
+	
+	if (container_call.begin) {
+		active_containers |= container_call.container_bit;
+	} else if (container_call.end) {
+		active_containers &= ~container_call.container_bit;
+	}
+	
+	if (container_call.end and active_containers == 0 and writing_frame) {
+		// The queue limit only applies while other frames are queued, so a frame larger than the limit is still sent once the queue is empty.
+		const bool queue_full = not queued_frames.empty() and number_of_queued_bytes + current_frame.size() > network_max_queued_bytes;
+		if (current_frame.size() <= network_max_frame_size and not queue_full) {
+			number_of_queued_bytes += current_frame.size();
+			queued_frames.push_back(std::move(current_frame));
+			sender_cv.notify_one();
+			
+			current_frame.clear();
+			if (not free_frames.empty()) {
+				current_frame = std::move(free_frames.back());
+				free_frames.pop_back();
+			}
+		} else {
+			++number_of_dropped_frames;
+			current_frame.clear();
+		}
+		writing_frame = false;
+	}
+}
+
+void Toucan::NetworkWriter::sender_loop() {
+	while (not stop) {
+		if (viewer_socket == -1) {
+			accept_viewer();
+			continue;
+		}
+		
+		std::vector<uint8_t> frame;
+		{
+			std::unique_lock lock(mutex);
+			sender_cv.wait_for(lock, std::chrono::milliseconds(poll_interval_ms), [this]() { return stop or not queued_frames.empty(); });
+			if (stop) { break; }
+			if (queued_frames.empty()) {
+				lock.unlock();
+				if (is_viewer_disconnected()) { disconnect_viewer(); }
+				continue;
+			}
+			
+			frame = std::move(queued_frames.front());
+			queued_frames.pop_front();
+			number_of_queued_bytes -= frame.size();
+		}
+		
+		encode_frame(frame);
+		compress_frame();
+		if (send_all(send_buffer.data(), send_buffer.size())) {
+			number_of_recorded_bytes += frame.size();
+			number_of_sent_bytes += send_buffer.size();
+		} else {
+			disconnect_viewer();
+		}
+		
+		frame.clear();
+		std::lock_guard lock(mutex);
+		if (free_frames.size() < 2) {
+			free_frames.push_back(std::move(frame));
+		}
+	}
+	
+	if (viewer_socket != -1) {
+		close(viewer_socket);
+	}
+}
+
+void Toucan::NetworkWriter::accept_viewer() {
+	pollfd poll_descriptor = {listen_socket, POLLIN, 0};
+	if (poll(&poll_descriptor, 1, poll_interval_ms) <= 0) {
+		return;
+	}
+	
+	viewer_socket = accept4(listen_socket, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+	if (viewer_socket == -1) {
+		return;
+	}
+	
+	// Frames are sent whole, so there is nothing to gain from delaying the last segment of a frame.
+	const int no_delay = 1;
+	setsockopt(viewer_socket, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+	
+	NetworkHello hello = {};
+	std::memcpy(hello.magic, network_magic, sizeof(network_magic));
+	hello.version = network_version;
+	hello.record_header_size = sizeof(CaptureRecordHeader);
+	if (not send_all(reinterpret_cast<const uint8_t*>(&hello), sizeof(hello))) {
+		disconnect_viewer();
+		return;
+	}
+	
+	// The new viewer has not seen any points, the first frame sends them as they are.
+	sent_points.clear();
+	viewer_connected = true;
+}
+
+bool Toucan::NetworkWriter::is_viewer_disconnected() const {
+	// The viewer never sends anything, so the socket only becomes readable when the viewer has closed it.
+	pollfd poll_descriptor = {viewer_socket, POLLIN, 0};
+	if (poll(&poll_descriptor, 1, 0) <= 0) {
+		return false;
+	}
+	
+	uint8_t byte;
+	return recv(viewer_socket, &byte, sizeof(byte), MSG_DONTWAIT | MSG_PEEK) <= 0;
+}
+
+void Toucan::NetworkWriter::disconnect_viewer() {
+	close(viewer_socket);
+	viewer_socket = -1;
+	viewer_connected = false;
+	
+	std::lock_guard lock(mutex);
+	number_of_dropped_frames += queued_frames.size();
+	queued_frames.clear();
+	number_of_queued_bytes = 0;
+}
+
+void Toucan::NetworkWriter::encode_frame(const std::vector<uint8_t>& frame) {
+	encoded_frame.clear();
+	
+	std::string figure_3d_name;
+	size_t offset = 0;
+	while (offset < frame.size()) {
+		const uint8_t* record_ptr = frame.data() + offset;
+		CaptureRecordHeader record_header;
+		std::memcpy(&record_header, record_ptr, sizeof(record_header));
+		const size_t record_size = sizeof(CaptureRecordHeader) + record_header.payload_size;
+		
+		if (record_header.type == static_cast<uint16_t>(CaptureRecordType::BeginFigure3D)) {
+			figure_3d_name = CaptureRecordReader(record_ptr + sizeof(CaptureRecordHeader), record_header.payload_size).read_string();
+		}
+		
+		if (record_header.type == static_cast<uint16_t>(CaptureRecordType::ShowPoints3D)) {
+			encode_points(record_ptr, figure_3d_name);
+		} else {
+			encoded_frame.insert(encoded_frame.end(), record_ptr, record_ptr + record_size);
+		}
+		
+		offset += record_size;
+	}
+}
+
+void Toucan::NetworkWriter::encode_points(const uint8_t* record_ptr, const std::string& figure_name) {
+	CaptureRecordHeader record_header;
+	std::memcpy(&record_header, record_ptr, sizeof(record_header));
+	CaptureRecordReader reader(record_ptr + sizeof(CaptureRecordHeader), record_header.payload_size);
+	const auto name = reader.read_string();
+	const auto points_buffer = reader.read_buffer<Point3D>();
+	const auto settings = reader.read_value<ShowPoints3DSettings>();
+	const uint64_t number_of_points = points_buffer.number_of_elements;
+	
+	quantize_points(points_buffer, position_precision, quantized_points, thread_pool);
+	
+	NetworkQuantizedPoints& previous_points = sent_points[get_element_key(figure_name, name)];
+	const bool temporal = number_of_points > 0 and previous_points.channels[0].size() == number_of_points and is_temporal_delta_smaller(quantized_points, previous_points);
+	const NetworkDeltaMode delta_mode = temporal ? NetworkDeltaMode::Temporal : NetworkDeltaMode::Spatial;
+	
+	point_planes.resize(number_of_points*NetworkQuantizedPoints::point_size);
+	write_point_planes(quantized_points, temporal ? &previous_points : nullptr, point_planes.data(), thread_pool);
+	
+	const std::initializer_list<CaptureField> fields = {name, settings, position_precision, delta_mode, number_of_points, CaptureField(point_planes.data(), point_planes.size())};
+	CaptureRecordHeader quantized_record_header = {};
+	quantized_record_header.type = network_quantized_points_3d_record_type;
+	quantized_record_header.timestamp_ns = record_header.timestamp_ns;
+	quantized_record_header.payload_size = get_capture_payload_size(fields);
+	
+	const size_t offset = encoded_frame.size();
+	encoded_frame.resize(offset + sizeof(CaptureRecordHeader) + quantized_record_header.payload_size);
+	write_capture_record(encoded_frame.data() + offset, quantized_record_header, fields);
+	
+	// The points just sent are the reference for the next frame, the old reference is reused for the next element.
+	std::swap(previous_points, quantized_points);
+}
+
+void Toucan::NetworkWriter::compress_frame() {
+	const size_t decoded_size = encoded_frame.size();
+	const size_t number_of_blocks = (decoded_size + network_block_size - 1)/network_block_size;
+	compressed_blocks.resize(number_of_blocks);
+	
+	thread_pool.parallel_for(0, static_cast<int>(number_of_blocks), 1, [this, decoded_size](int range_begin, int range_end) {
+		for (int block_index = range_begin; block_index < range_end; ++block_index) {
+			const uint8_t* block_ptr = encoded_frame.data() + block_index*network_block_size;
+			const size_t block_size = std::min(network_block_size, decoded_size - block_index*network_block_size);
+			
+			auto& compressed_block = compressed_blocks[block_index];
+			compressed_block.resize(get_lz_compress_bound(block_size));
+			size_t compressed_size = lz_compress(block_ptr, block_size, compressed_block.data());
+			if (compressed_size >= block_size) {
+				std::memcpy(compressed_block.data(), block_ptr, block_size);
+				compressed_size = block_size;
+			}
+			compressed_block.resize(compressed_size);
+		}
+	});
+	
+	NetworkFrameHeader frame_header = {};
+	frame_header.decoded_size = decoded_size;
+	frame_header.number_of_blocks = number_of_blocks;
+	
+	send_buffer.clear();
+	const auto* frame_header_ptr = reinterpret_cast<const uint8_t*>(&frame_header);
+	send_buffer.insert(send_buffer.end(), frame_header_ptr, frame_header_ptr + sizeof(frame_header));
+	for (size_t block_index = 0; block_index < number_of_blocks; ++block_index) {
+		NetworkBlockHeader block_header = {};
+		block_header.encoded_size = static_cast<uint32_t>(compressed_blocks[block_index].size());
+		block_header.decoded_size = static_cast<uint32_t>(std::min(network_block_size, decoded_size - block_index*network_block_size));
+		const auto* block_header_ptr = reinterpret_cast<const uint8_t*>(&block_header);
+		send_buffer.insert(send_buffer.end(), block_header_ptr, block_header_ptr + sizeof(block_header));
+	}
+	for (const auto& compressed_block : compressed_blocks) {
+		send_buffer.insert(send_buffer.end(), compressed_block.begin(), compressed_block.end());
+	}
+}
+
+bool Toucan::NetworkWriter::send_all(const uint8_t* data_ptr, size_t size) {
+	while (size > 0) {
+		const ssize_t sent_size = send(viewer_socket, data_ptr, size, MSG_NOSIGNAL);
+		if (sent_size > 0) {
+			data_ptr += sent_size;
+			size -= static_cast<size_t>(sent_size);
+		} else if (sent_size == -1 and (errno == EAGAIN or errno == EWOULDBLOCK or errno == EINTR)) {
+			// The socket does not block, so a viewer that stops reading does not keep the sender from stopping.
+			pollfd poll_descriptor = {viewer_socket, POLLOUT, 0};
+			poll(&poll_descriptor, 1, poll_interval_ms);
+			if (stop) { return false; }
+		} else {
+			return false;
+		}
+	}
+	return true;
+}
+
+Toucan::NetworkReader::NetworkReader(const std::string& host, uint16_t port) {
+	addrinfo hints = {};
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	addrinfo* addresses_ptr = nullptr;
+	if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses_ptr) == 0) {
+		for (const addrinfo* address_ptr = addresses_ptr; address_ptr != nullptr and producer_socket == -1; address_ptr = address_ptr->ai_next) {
+			producer_socket = socket(address_ptr->ai_family, address_ptr->ai_socktype | SOCK_CLOEXEC, address_ptr->ai_protocol);
+			if (producer_socket != -1 and connect(producer_socket, address_ptr->ai_addr, address_ptr->ai_addrlen) != 0) {
+				disconnect();
+			}
+		}
+		freeaddrinfo(addresses_ptr);
+	}
+	
+	const std::string address = host + ":" + std::to_string(port);
+	if (producer_socket == -1) {
+		throw std::runtime_error("Toucan error! Could not connect to '" + address + "'. Was Toucan initialized with 'ToucanSettings::network_port' set to " + std::to_string(port) + "?");
+	}
+	
+	NetworkHello hello = {};
+	if (not receive_all(&hello, sizeof(hello)) or std::memcmp(hello.magic, network_magic, sizeof(network_magic)) != 0 or
+	    hello.version != network_version or hello.record_header_size != sizeof(CaptureRecordHeader)) {
+		disconnect();
+		throw std::runtime_error("Toucan error! The producer at '" + address + "' is not a compatible version of Toucan.");
+	}
+}
+
+Toucan::NetworkReader::~NetworkReader() {
+	disconnect();
+}
+
+bool Toucan::NetworkReader::replay_next_frame(std::chrono::milliseconds timeout) {
+	if (producer_socket == -1) {
+		std::this_thread::sleep_for(timeout);
+		return false;
+	}
+	
+	pollfd poll_descriptor = {producer_socket, POLLIN, 0};
+	if (poll(&poll_descriptor, 1, static_cast<int>(timeout.count())) <= 0) {
+		return false;
+	}
+	
+	// Frames are sent whole, once the first byte has arrived the rest of the frame follows.
+	NetworkFrameHeader frame_header = {};
+	if (not receive_all(&frame_header, sizeof(frame_header))) {
+		disconnect();
+		return false;
+	}
+	
+	if (frame_header.decoded_size > network_max_frame_size or frame_header.number_of_blocks != (frame_header.decoded_size + network_block_size - 1)/network_block_size) {
+		throw_corrupt_stream();
+	}
+	
+	block_headers.resize(frame_header.number_of_blocks);
+	if (not receive_all(block_headers.data(), block_headers.size()*sizeof(NetworkBlockHeader))) {
+		disconnect();
+		return false;
+	}
+	
+	// The frame grows with the blocks as they are received, so a corrupt frame header can not make the viewer allocate the largest frame.
+	frame.clear();
+	for (size_t block_index = 0; block_index < block_headers.size(); ++block_index) {
+		const NetworkBlockHeader& block_header = block_headers[block_index];
+		const size_t block_size = std::min(network_block_size, static_cast<size_t>(frame_header.decoded_size) - block_index*network_block_size);
+		if (block_header.decoded_size != block_size or block_header.encoded_size > get_lz_compress_bound(block_size)) {
+			throw_corrupt_stream();
+		}
+		
+		frame.resize(frame.size() + block_size);
+		uint8_t* block_ptr = frame.data() + block_index*network_block_size;
+		if (block_header.encoded_size == block_header.decoded_size) {
+			if (not receive_all(block_ptr, block_size)) {
+				disconnect();
+				return false;
+			}
+		} else {
+			compressed_block.resize(block_header.encoded_size);
+			if (not receive_all(compressed_block.data(), compressed_block.size())) {
+				disconnect();
+				return false;
+			}
+			if (not lz_decompress(compressed_block.data(), compressed_block.size(), block_ptr, block_size)) {
+				throw_corrupt_stream();
+			}
+		}
+	}
+	
+	validate_frame();
+	replay_frame();
+	return true;
+}
+
+bool Toucan::NetworkReader::receive_all(void* data_ptr, size_t size) {
+	auto* write_ptr = static_cast<uint8_t*>(data_ptr);
+	while (size > 0) {
+		const ssize_t received_size = recv(producer_socket, write_ptr, size, 0);
+		if (received_size > 0) {
+			write_ptr += received_size;
+			size -= static_cast<size_t>(received_size);
+		} else if (received_size == 0 or errno != EINTR) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void Toucan::NetworkReader::disconnect() {
+	if (producer_socket != -1) {
+		close(producer_socket);
+		producer_socket = -1;
+	}
+}
+
+void Toucan::NetworkReader::end_active_containers() {
+	if ((active_containers & capture_figure_2d_bit) != 0) { EndFigure2D(); }
+	if ((active_containers & capture_figure_3d_bit) != 0) { EndFigure3D(); }
+	if ((active_containers & capture_input_window_bit) != 0) { EndInputWindow(); }
+	active_containers = 0;
+}
+
+void Toucan::NetworkReader::validate_frame() const {
+	std::unordered_map<std::string, uint64_t> frame_numbers_of_points; // Of the elements already shown in this frame, by figure and element name.
+	std::string figure_3d_name;
+	uint8_t frame_containers = 0;
+	size_t offset = 0;
+	while (offset < frame.size()) {
+		const uint8_t* record_ptr = frame.data() + offset;
+		CaptureRecordHeader record_header;
+		if (frame.size() - offset < sizeof(record_header)) { throw_corrupt_stream(); }
+		std::memcpy(&record_header, record_ptr, sizeof(record_header));
+		if (record_header.payload_size > frame.size() - offset - sizeof(record_header)) { throw_corrupt_stream(); }
+		
+		const CaptureContainerCall container_call = get_capture_container_call(record_header.type);
+		if ((container_call.begin and (frame_containers & container_call.container_bit) != 0) or
+		    (container_call.end and (frame_containers & container_call.container_bit) == 0)) {
+			throw_corrupt_stream();
+		}
+		if (container_call.begin) {
+			frame_containers |= container_call.container_bit;
+		} else if (container_call.end) {
+			frame_containers &= ~container_call.container_bit;
+		}
+		
+		if (record_header.type == static_cast<uint16_t>(CaptureRecordType::BeginFigure3D)) {
+			figure_3d_name = CaptureRecordReader(record_ptr + sizeof(CaptureRecordHeader), record_header.payload_size).read_string();
+		}
+		
+		if (record_header.type == network_quantized_points_3d_record_type) {
+			CaptureRecordReader reader(record_ptr + sizeof(CaptureRecordHeader), record_header.payload_size);
+			const auto name = reader.read_string();
+			reader.read_value<ShowPoints3DSettings>();
+			reader.read_value<float>();
+			const auto delta_mode = reader.read_value<NetworkDeltaMode>();
+			const auto number_of_points = reader.read_value<uint64_t>();
+			const auto planes_buffer = reader.read_buffer<uint8_t>();
+			
+			const std::string element_key = get_element_key(figure_3d_name, name);
+			uint64_t number_of_previous_points = 0;
+			if (const auto frame_it = frame_numbers_of_points.find(element_key); frame_it != frame_numbers_of_points.end()) {
+				number_of_previous_points = frame_it->second;
+			} else if (const auto received_it = received_points.find(element_key); received_it != received_points.end()) {
+				number_of_previous_points = received_it->second.channels[0].size();
+			}
+			
+			if (number_of_points > planes_buffer.number_of_elements/NetworkQuantizedPoints::point_size or
+			    planes_buffer.number_of_elements != number_of_points*NetworkQuantizedPoints::point_size or
+			    (delta_mode != NetworkDeltaMode::Spatial and delta_mode != NetworkDeltaMode::Temporal) or
+			    (delta_mode == NetworkDeltaMode::Temporal and number_of_previous_points != number_of_points)) {
+				throw_corrupt_stream();
+			}
+			frame_numbers_of_points[element_key] = number_of_points;
+		}
+		
+		offset += sizeof(CaptureRecordHeader) + record_header.payload_size;
+	}
+	
+	if (frame_containers != 0) { throw_corrupt_stream(); }
+}
+
+void Toucan::NetworkReader::replay_frame() {
+	std::string figure_3d_name;
+	size_t offset = 0;
+	while (offset < frame.size()) {
+		const uint8_t* record_ptr = frame.data() + offset;
+		CaptureRecordHeader record_header;
+		std::memcpy(&record_header, record_ptr, sizeof(record_header));
+		
+		if (record_header.type == static_cast<uint16_t>(CaptureRecordType::BeginFigure3D)) {
+			figure_3d_name = CaptureRecordReader(record_ptr + sizeof(CaptureRecordHeader), record_header.payload_size).read_string();
+		}
+		
+		// The Show* functions copy the data, so the frame buffer can be reused as soon as they return.
+		if (record_header.type == network_quantized_points_3d_record_type) {
+			replay_quantized_points(record_ptr, figure_3d_name);
+		} else {
+			replay_capture_record(record_ptr);
+		}
+		
+		const CaptureContainerCall container_call = get_capture_container_call(record_header.type);
+		if (container_call.begin) {
+			active_containers |= container_call.container_bit;
+		} else if (container_call.end) {
+			active_containers &= ~container_call.container_bit;
+		}
+		
+		offset += sizeof(CaptureRecordHeader) + record_header.payload_size;
+	}
+}
+
+void Toucan::NetworkReader::replay_quantized_points(const uint8_t* record_ptr, const std::string& figure_name) {
+	CaptureRecordHeader record_header;
+	std::memcpy(&record_header, record_ptr, sizeof(record_header));
+	CaptureRecordReader reader(record_ptr + sizeof(CaptureRecordHeader), record_header.payload_size);
+	const auto name = reader.read_string();
+	const auto settings = reader.read_value<ShowPoints3DSettings>();
+	const auto position_precision = reader.read_value<float>();
+	const auto delta_mode = reader.read_value<NetworkDeltaMode>();
+	const auto number_of_points = reader.read_value<uint64_t>();
+	const auto planes_buffer = reader.read_buffer<uint8_t>();
+	
+	// The number of points and the delta mode were checked by `validate_frame`.
+	NetworkQuantizedPoints& element_points = received_points[get_element_key(figure_name, name)];
+	read_point_planes(planes_buffer.data_ptr, number_of_points, delta_mode, element_points);
+	
+	points.resize(number_of_points);
+	for (size_t point_index = 0; point_index < number_of_points; ++point_index) {
+		Point3D& point = points[point_index];
+		point.position = Vector3f(
+				static_cast<float>(static_cast<int32_t>(element_points.channels[0][point_index]))*position_precision,
+				static_cast<float>(static_cast<int32_t>(element_points.channels[1][point_index]))*position_precision,
+				static_cast<float>(static_cast<int32_t>(element_points.channels[2][point_index]))*position_precision
+		);
+		point.color = Color(
+				static_cast<float>(element_points.channels[3][point_index])/255.0f,
+				static_cast<float>(element_points.channels[4][point_index])/255.0f,
+				static_cast<float>(element_points.channels[5][point_index])/255.0f
+		);
+		std::memcpy(&point.size, &element_points.channels[6][point_index], sizeof(point.size));
+		point.shape = static_cast<PointShape>(element_points.channels[7][point_index]);
+	}
+	
+	ShowPoints3D(name, Buffer<Point3D>(points.data(), points.size()), settings);
+}
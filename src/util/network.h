@@ -0,0 +1,171 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <Toucan/DataTypes.h>
+
+#include "capture.h"
+#include "thread_pool.h"
+
+namespace Toucan {
+
+// Calls are streamed from the producer to a viewer over TCP, a whole frame at a time, as records in the format of capture files.
+// Before sending, `ShowPoints3D` records are replaced by quantized points: positions rounded to a multiple of the position precision, 8 bit colors.
+// The quantized values are stored as the difference to the same element in the previous frame, or to the previous point of the element when that
+// is smaller, split into byte planes so the compression finds the runs of small differences. The frame is then compressed in blocks on the thread
+// pool. The producer never waits for the viewer: frames are dropped while no viewer is connected, and when the connection falls behind.
+//
+// The stream starts with a NetworkHello. Each frame is a NetworkFrameHeader, `number_of_blocks` NetworkBlockHeaders, and the blocks.
+
+constexpr char network_magic[8] = {'T', 'O', 'U', 'C', 'A', 'N', 'N', 'W'};
+constexpr uint32_t network_version = 1;
+constexpr uint16_t network_quantized_points_3d_record_type = 0x8000; // Replaces `CaptureRecordType::ShowPoints3D` in the stream.
+constexpr size_t network_block_size = size_t(256) << 10u; // Blocks are compressed independently, in parallel.
+constexpr size_t network_max_queued_bytes = size_t(64) << 20u; // Frames are dropped above this, unless the queue is empty.
+constexpr size_t network_max_frame_size = size_t(1) << 32u;
+
+struct NetworkHello {
+	char magic[8];
+	uint32_t version;
+	uint32_t record_header_size;
+};
+
+struct NetworkFrameHeader {
+	uint64_t decoded_size; // Total size of the records in the frame.
+	uint64_t number_of_blocks;
+};
+
+struct NetworkBlockHeader {
+	uint32_t encoded_size; // The block is stored uncompressed if this is equal to `decoded_size`.
+	uint32_t decoded_size; // `network_block_size`, except for the last block.
+};
+
+// The last points sent for an element, both ends keep them to resolve the differences to the previous frame.
+// Each point has one value per channel: the quantized x, y and z, the red, green and blue color, the bits of the size, and the shape.
+struct NetworkQuantizedPoints {
+	static constexpr size_t number_of_channels = 8;
+	static constexpr size_t channel_sizes[number_of_channels] = {4, 4, 4, 1, 1, 1, 4, 1}; // In bytes, on the wire.
+	static constexpr size_t point_size = 20; // Sum of the channel sizes.
+	
+	std::vector<uint32_t> channels[number_of_channels];
+};
+
+enum class NetworkDeltaMode : uint32_t {
+	Spatial = 0, // Differences to the previous point of the element.
+	Temporal = 1 // Differences to the same point in the previous frame.
+};
+
+// Differences are zigzag encoded in `channel_size` bytes, so small negative differences have as many leading zero bytes as small positive ones.
+uint32_t encode_difference(uint32_t value, uint32_t reference, size_t channel_size);
+uint32_t decode_difference(uint32_t encoded_difference, uint32_t reference, size_t channel_size);
+
+// Writes the differences to `previous_points_ptr`, or to the previous point if it is null, as one byte plane per byte of each channel.
+// `planes_ptr` must hold `NetworkQuantizedPoints::point_size` bytes per point.
+void write_point_planes(const NetworkQuantizedPoints& quantized_points, const NetworkQuantizedPoints* previous_points_ptr, uint8_t* planes_ptr, ThreadPool& thread_pool);
+// The inverse of `write_point_planes`. The differences are resolved in place, so `quantized_points` holds the previous points if `delta_mode` is temporal.
+void read_point_planes(const uint8_t* planes_ptr, size_t number_of_points, NetworkDeltaMode delta_mode, NetworkQuantizedPoints& quantized_points);
+
+// The producer side. Listens for a viewer, and sends it the frames of the calling threads.
+class NetworkWriter {
+public:
+	// Listens on `port` on all interfaces, for one viewer at a time. Throws if the port can not be used.
+	NetworkWriter(uint16_t port, float position_precision, ThreadPool& thread_pool);
+	~NetworkWriter();
+	
+	NetworkWriter(const NetworkWriter&) = delete;
+	NetworkWriter& operator=(const NetworkWriter&) = delete;
+	
+	void write(CaptureRecordType type, std::initializer_list<CaptureField> fields);
+	
+	[[nodiscard]] uint64_t get_number_of_dropped_frames() const { return number_of_dropped_frames; }
+	[[nodiscard]] uint64_t get_number_of_recorded_bytes() const { return number_of_recorded_bytes; } // Of the frames sent, before encoding.
+	[[nodiscard]] uint64_t get_number_of_sent_bytes() const { return number_of_sent_bytes; }
+
+private:
+	void sender_loop();
+	void accept_viewer();
+	[[nodiscard]] bool is_viewer_disconnected() const;
+	void disconnect_viewer();
+	void encode_frame(const std::vector<uint8_t>& frame); // Into `encoded_frame`, replacing the points with quantized points.
+	void encode_points(const uint8_t* record_ptr, const std::string& figure_name);
+	void compress_frame(); // Into `send_buffer`.
+	bool send_all(const uint8_t* data_ptr, size_t size);
+	
+	float position_precision;
+	ThreadPool& thread_pool;
+	int listen_socket = -1;
+	
+	std::atomic_bool viewer_connected = false;
+	std::atomic_bool stop = false;
+	std::atomic_uint64_t number_of_dropped_frames = 0;
+	std::atomic_uint64_t number_of_recorded_bytes = 0;
+	std::atomic_uint64_t number_of_sent_bytes = 0;
+	
+	std::mutex mutex; // Guards the members below.
+	std::vector<uint8_t> current_frame;
+	uint8_t active_containers = 0; // Bit per kind of figure and input window, see `capture.h`.
+	bool writing_frame = false; // A viewer was connected when the current frame started.
+	std::deque<std::vector<uint8_t>> queued_frames;
+	size_t number_of_queued_bytes = 0;
+	std::vector<std::vector<uint8_t>> free_frames; // Sent frames, reused to avoid reallocating.
+	std::condition_variable sender_cv;
+	
+	// Only used by the sender thread.
+	int viewer_socket = -1;
+	std::unordered_map<std::string, NetworkQuantizedPoints> sent_points; // By figure and element name.
+	NetworkQuantizedPoints quantized_points;
+	std::vector<uint8_t> point_planes;
+	std::vector<uint8_t> encoded_frame;
+	std::vector<std::vector<uint8_t>> compressed_blocks;
+	std::vector<uint8_t> send_buffer;
+	
+	std::thread sender_thread;
+};
+
+// The viewer side. Receives the frames of a producer, and replays them through the API of the viewer process.
+class NetworkReader {
+public:
+	// Connects to the producer, `host` is a host name or address. Throws if there is no producer listening.
+	NetworkReader(const std::string& host, uint16_t port);
+	~NetworkReader();
+	
+	NetworkReader(const NetworkReader&) = delete;
+	NetworkReader& operator=(const NetworkReader&) = delete;
+	
+	// Waits up to `timeout` for the next frame and replays it. Returns false if no frame arrived, or the producer has disconnected.
+	// Throws if the frame is corrupt, which is detected before any of its records are replayed.
+	bool replay_next_frame(std::chrono::milliseconds timeout);
+	
+	// Ends any figure or input window left active by a frame that threw while it was replayed, so Toucan can be destroyed.
+	void end_active_containers();
+	
+	[[nodiscard]] bool is_connected() const { return producer_socket != -1; }
+
+private:
+	bool receive_all(void* data_ptr, size_t size);
+	void disconnect();
+	void validate_frame() const; // Checks the record sizes, the nesting of the containers, and the quantized points.
+	void replay_frame();
+	void replay_quantized_points(const uint8_t* record_ptr, const std::string& figure_name);
+	
+	int producer_socket = -1;
+	uint8_t active_containers = 0;
+	
+	std::vector<NetworkBlockHeader> block_headers;
+	std::vector<uint8_t> compressed_block;
+	std::vector<uint8_t> frame;
+	std::unordered_map<std::string, NetworkQuantizedPoints> received_points; // By figure and element name.
+	std::vector<Point3D> points;
+};
+
+} // namespace Toucan
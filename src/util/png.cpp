@@ -0,0 +1,213 @@
+#include "png.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace {
+
+constexpr size_t minimum_match_length = 3;
+constexpr size_t maximum_match_length = 258;
+constexpr size_t maximum_match_distance = 32768;
+constexpr unsigned int hash_bits = 15;
+
+constexpr uint16_t length_bases[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr uint8_t length_extra_bits[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr uint16_t distance_bases[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+constexpr uint8_t distance_extra_bits[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+// Writes the bits of a deflate stream, least significant bit first.
+class BitWriter {
+public:
+	explicit BitWriter(std::vector<uint8_t>& output) :
+	output{output} { }
+	
+	void write_bits(uint32_t value, unsigned int number_of_bits) {
+		bit_buffer |= static_cast<uint64_t>(value) << bit_count;
+		bit_count += number_of_bits;
+		while (bit_count >= 8) {
+			output.push_back(static_cast<uint8_t>(bit_buffer));
+			bit_buffer >>= 8u;
+			bit_count -= 8;
+		}
+	}
+	
+	// Huffman codes are stored most significant bit first.
+	void write_code(uint32_t code, unsigned int length) {
+		uint32_t reversed_code = 0;
+		for (unsigned int bit_index = 0; bit_index < length; ++bit_index) {
+			reversed_code |= ((code >> bit_index) & 1u) << (length - 1 - bit_index);
+		}
+		write_bits(reversed_code, length);
+	}
+	
+	void flush() {
+		if (bit_count > 0) {
+			output.push_back(static_cast<uint8_t>(bit_buffer));
+		}
+		bit_buffer = 0;
+		bit_count = 0;
+	}
+
+private:
+	std::vector<uint8_t>& output;
+	uint64_t bit_buffer = 0;
+	unsigned int bit_count = 0;
+};
+
+// A symbol of the fixed literal/length code.
+void write_fixed_symbol(BitWriter& writer, unsigned int symbol) {
+	if (symbol < 144) {
+		writer.write_code(0x30u + symbol, 8);
+	} else if (symbol < 256) {
+		writer.write_code(0x190u + (symbol - 144), 9);
+	} else if (symbol < 280) {
+		writer.write_code(symbol - 256, 7);
+	} else {
+		writer.write_code(0xC0u + (symbol - 280), 8);
+	}
+}
+
+void write_fixed_match(BitWriter& writer, size_t length, size_t distance) {
+	unsigned int length_index = 28;
+	while (length_bases[length_index] > length) { --length_index; }
+	write_fixed_symbol(writer, 257 + length_index);
+	writer.write_bits(static_cast<uint32_t>(length - length_bases[length_index]), length_extra_bits[length_index]);
+	
+	unsigned int distance_index = 29;
+	while (distance_bases[distance_index] > distance) { --distance_index; }
+	writer.write_code(distance_index, 5);
+	writer.write_bits(static_cast<uint32_t>(distance - distance_bases[distance_index]), distance_extra_bits[distance_index]);
+}
+
+// A single deflate block with the fixed Huffman codes. Each position is only matched against the last position with the same three bytes.
+void deflate_fixed(const uint8_t* data_ptr, size_t size, std::vector<uint8_t>& output) {
+	BitWriter writer(output);
+	writer.write_bits(1, 1); // Final block
+	writer.write_bits(1, 2); // Fixed Huffman codes
+	
+	std::vector<int64_t> last_positions(size_t(1) << hash_bits, -1);
+	
+	size_t position = 0;
+	while (position + minimum_match_length <= size) {
+		const uint32_t sequence = data_ptr[position] | (static_cast<uint32_t>(data_ptr[position + 1]) << 8u) | (static_cast<uint32_t>(data_ptr[position + 2]) << 16u);
+		const uint32_t hash = (sequence*2654435761u) >> (32u - hash_bits);
+		const int64_t match_position = last_positions[hash];
+		last_positions[hash] = static_cast<int64_t>(position);
+		
+		if (match_position >= 0 and position - static_cast<size_t>(match_position) <= maximum_match_distance and
+		    std::memcmp(data_ptr + match_position, data_ptr + position, minimum_match_length) == 0) {
+			const size_t maximum_length = std::min(maximum_match_length, size - position);
+			size_t length = minimum_match_length;
+			while (length < maximum_length and data_ptr[match_position + static_cast<int64_t>(length)] == data_ptr[position + length]) {
+				++length;
+			}
+			
+			write_fixed_match(writer, length, position - static_cast<size_t>(match_position));
+			position += length;
+		} else {
+			write_fixed_symbol(writer, data_ptr[position]);
+			++position;
+		}
+	}
+	
+	for (; position < size; ++position) {
+		write_fixed_symbol(writer, data_ptr[position]);
+	}
+	
+	write_fixed_symbol(writer, 256); // End of block
+	writer.flush();
+}
+
+uint32_t compute_adler32(const uint8_t* data_ptr, size_t size) {
+	constexpr uint32_t modulus = 65521;
+	constexpr size_t maximum_run = 5552; // The sums can not overflow before this many bytes.
+	
+	uint32_t a = 1;
+	uint32_t b = 0;
+	while (size > 0) {
+		const size_t run = std::min(size, maximum_run);
+		for (size_t index = 0; index < run; ++index) {
+			a += data_ptr[index];
+			b += a;
+		}
+		a %= modulus;
+		b %= modulus;
+		data_ptr += run;
+		size -= run;
+	}
+	return (b << 16u) | a;
+}
+
+uint32_t compute_crc32(const uint8_t* data_ptr, size_t size) {
+	static const std::array<uint32_t, 256> table = []() {
+		std::array<uint32_t, 256> crc_table = {};
+		for (uint32_t index = 0; index < 256; ++index) {
+			uint32_t value = index;
+			for (int bit_index = 0; bit_index < 8; ++bit_index) {
+				value = (value & 1u) != 0 ? 0xEDB88320u ^ (value >> 1u) : value >> 1u;
+			}
+			crc_table[index] = value;
+		}
+		return crc_table;
+	}();
+	
+	uint32_t crc = 0xFFFFFFFFu;
+	for (size_t index = 0; index < size; ++index) {
+		crc = table[(crc ^ data_ptr[index]) & 0xFFu] ^ (crc >> 8u);
+	}
+	return crc ^ 0xFFFFFFFFu;
+}
+
+void write_big_endian(std::vector<uint8_t>& output, uint32_t value) {
+	output.push_back(static_cast<uint8_t>(value >> 24u));
+	output.push_back(static_cast<uint8_t>(value >> 16u));
+	output.push_back(static_cast<uint8_t>(value >> 8u));
+	output.push_back(static_cast<uint8_t>(value));
+}
+
+void write_chunk(std::vector<uint8_t>& png, const char* type, const uint8_t* data_ptr, size_t size) {
+	write_big_endian(png, static_cast<uint32_t>(size));
+	const size_t type_offset = png.size();
+	png.insert(png.end(), type, type + 4);
+	png.insert(png.end(), data_ptr, data_ptr + size);
+	write_big_endian(png, compute_crc32(png.data() + type_offset, 4 + size));
+}
+
+} // namespace
+
+void Toucan::encode_png(const uint8_t* first_row_ptr, int width, int height, ptrdiff_t row_stride, std::vector<uint8_t>& png) {
+	constexpr uint8_t up_filter = 2;
+	const size_t row_size = 4*static_cast<size_t>(width);
+	
+	// Each row is prefixed by its filter type, the Up filter stores the difference to the row above.
+	std::vector<uint8_t> filtered_rows((1 + row_size)*static_cast<size_t>(height));
+	for (int row_index = 0; row_index < height; ++row_index) {
+		const uint8_t* row_ptr = first_row_ptr + row_index*row_stride;
+		uint8_t* filtered_row_ptr = filtered_rows.data() + (1 + row_size)*static_cast<size_t>(row_index);
+		filtered_row_ptr[0] = up_filter;
+		if (row_index == 0) {
+			std::memcpy(filtered_row_ptr + 1, row_ptr, row_size);
+		} else {
+			const uint8_t* above_row_ptr = row_ptr - row_stride;
+			for (size_t byte_index = 0; byte_index < row_size; ++byte_index) {
+				filtered_row_ptr[1 + byte_index] = static_cast<uint8_t>(row_ptr[byte_index] - above_row_ptr[byte_index]);
+			}
+		}
+	}
+	
+	std::vector<uint8_t> zlib_stream = {0x78, 0x01}; // Deflate with a 32 KiB window, fastest compression.
+	deflate_fixed(filtered_rows.data(), filtered_rows.size(), zlib_stream);
+	write_big_endian(zlib_stream, compute_adler32(filtered_rows.data(), filtered_rows.size()));
+	
+	std::vector<uint8_t> header;
+	write_big_endian(header, static_cast<uint32_t>(width));
+	write_big_endian(header, static_cast<uint32_t>(height));
+	header.insert(header.end(), {8, 6, 0, 0, 0}); // 8 bits per channel, RGBA, deflate, adaptive filtering, no interlacing
+	
+	constexpr uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+	png.assign(signature, signature + sizeof(signature));
+	write_chunk(png, "IHDR", header.data(), header.size());
+	write_chunk(png, "IDAT", zlib_stream.data(), zlib_stream.size());
+	write_chunk(png, "IEND", nullptr, 0);
+}
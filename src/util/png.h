@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Toucan {
+
+// Encodes 8 bit RGBA pixels as a PNG file. Rows are filtered with the Up filter and compressed with LZ77 and the fixed Huffman codes of deflate,
+// which is fast and compresses the flat backgrounds and repeated rows of rendered figures well.
+// `row_stride` is the distance in bytes from one row to the next, negative to flip the image, e.g. for OpenGL framebuffers.
+void encode_png(const uint8_t* first_row_ptr, int width, int height, ptrdiff_t row_stride, std::vector<uint8_t>& png);
+
+} // namespace Toucan
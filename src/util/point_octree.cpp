@@ -0,0 +1,199 @@
+#include "point_octree.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <queue>
+
+namespace {
+
+constexpr int octree_node_sample_size = 8192;
+constexpr int octree_leaf_capacity = 4*octree_node_sample_size;
+constexpr int octree_max_depth = 21;
+
+// Subtrees below this depth are built in parallel.
+constexpr int octree_parallel_depth = 2;
+
+// Nodes are refined until the points are at most this many pixels apart on screen.
+constexpr float octree_target_pixel_spacing = 1.5f;
+
+Toucan::BoundingBox3D get_octant(const Toucan::BoundingBox3D& cell, const Toucan::Vector3f& center, int octant) {
+	Toucan::BoundingBox3D child;
+	child.min = Toucan::Vector3f((octant & 4) ? center.x() : cell.min.x(), (octant & 2) ? center.y() : cell.min.y(), (octant & 1) ? center.z() : cell.min.z());
+	child.max = Toucan::Vector3f((octant & 4) ? cell.max.x() : center.x(), (octant & 2) ? cell.max.y() : center.y(), (octant & 1) ? cell.max.z() : center.z());
+	return child;
+}
+
+// Builds the subtree for the points in [begin, end) inside `cell`. Returns the nodes of the subtree with the subtree root first, child indices are local to the returned vector.
+std::vector<Toucan::PointOctreeNode> build_subtree(Toucan::Point3D* points_ptr, int begin, int end, const Toucan::BoundingBox3D& cell, int depth, const std::atomic_bool& cancel_build, Toucan::ThreadPool& thread_pool) {
+	std::vector<Toucan::PointOctreeNode> nodes;
+	if (cancel_build) { return nodes; }
+	
+	const int number_of_points = end - begin;
+	const float cell_size = std::max({cell.max.x() - cell.min.x(), cell.max.y() - cell.min.y(), cell.max.z() - cell.min.z()});
+	
+	Toucan::PointOctreeNode node = {};
+	node.bounds = cell;
+	node.first_point = begin;
+	std::fill(std::begin(node.children), std::end(node.children), -1);
+	
+	if (number_of_points <= octree_leaf_capacity or depth >= octree_max_depth) {
+		node.number_of_points = number_of_points;
+		node.spacing = cell_size / std::sqrt(static_cast<float>(std::max(number_of_points, 1)));
+		nodes.emplace_back(node);
+		return nodes;
+	}
+	
+	// Move an evenly strided sample of the points to the front of the range. These are the points drawn for this node.
+	const int stride = number_of_points / octree_node_sample_size;
+	for (int sample_index = 0; sample_index < octree_node_sample_size; ++sample_index) {
+		std::swap(points_ptr[begin + sample_index], points_ptr[begin + sample_index*stride]);
+	}
+	node.number_of_points = octree_node_sample_size;
+	node.spacing = cell_size / std::sqrt(static_cast<float>(octree_node_sample_size));
+	nodes.emplace_back(node);
+	
+	// Partition the remaining points into octants. Octant index bits are (x >= center.x, y >= center.y, z >= center.z).
+	const Toucan::Vector3f center = 0.5f*(cell.min + cell.max);
+	Toucan::Point3D* octant_bounds[9];
+	octant_bounds[0] = points_ptr + begin + octree_node_sample_size;
+	octant_bounds[8] = points_ptr + end;
+	octant_bounds[4] = std::partition(octant_bounds[0], octant_bounds[8], [&center](const Toucan::Point3D& p) { return p.position.x() < center.x(); });
+	for (int x_half = 0; x_half < 2; ++x_half) {
+		const int i = 4*x_half;
+		octant_bounds[i + 2] = std::partition(octant_bounds[i], octant_bounds[i + 4], [&center](const Toucan::Point3D& p) { return p.position.y() < center.y(); });
+		for (int y_half = 0; y_half < 2; ++y_half) {
+			const int j = i + 2*y_half;
+			octant_bounds[j + 1] = std::partition(octant_bounds[j], octant_bounds[j + 2], [&center](const Toucan::Point3D& p) { return p.position.z() < center.z(); });
+		}
+	}
+	
+	std::vector<Toucan::PointOctreeNode> child_subtrees[8];
+	const auto build_child_subtrees = [&](int octant_begin, int octant_end) {
+		for (int octant = octant_begin; octant < octant_end; ++octant) {
+			const int child_begin = static_cast<int>(octant_bounds[octant] - points_ptr);
+			const int child_end = static_cast<int>(octant_bounds[octant + 1] - points_ptr);
+			if (child_begin == child_end) { continue; }
+			child_subtrees[octant] = build_subtree(points_ptr, child_begin, child_end, get_octant(cell, center, octant), depth + 1, cancel_build, thread_pool);
+		}
+	};
+	if (depth < octree_parallel_depth) {
+		thread_pool.parallel_for(0, 8, 1, build_child_subtrees);
+	} else {
+		build_child_subtrees(0, 8);
+	}
+	
+	// Append the child subtrees, offsetting their local child indices.
+	for (int octant = 0; octant < 8; ++octant) {
+		if (child_subtrees[octant].empty()) { continue; }
+		
+		const int offset = static_cast<int>(nodes.size());
+		nodes[0].children[octant] = offset;
+		for (auto child_node : child_subtrees[octant]) {
+			for (int& child_index : child_node.children) {
+				if (child_index >= 0) { child_index += offset; }
+			}
+			nodes.emplace_back(child_node);
+		}
+	}
+	
+	return nodes;
+}
+
+void build_point_octree(Toucan::PointOctree* octree_ptr, Toucan::ThreadPool& thread_pool) {
+	const Toucan::BoundingBox3D bounds = Toucan::compute_bounding_box(octree_ptr->points_ptr, octree_ptr->number_of_points);
+	if (bounds.is_empty()) {
+		octree_ptr->build_finished = true;
+		return;
+	}
+	
+	// Use a cube as the root cell so the octants stay cubic.
+	const float size = std::max({bounds.max.x() - bounds.min.x(), bounds.max.y() - bounds.min.y(), bounds.max.z() - bounds.min.z(), 1e-6f});
+	Toucan::BoundingBox3D root_cell;
+	root_cell.min = bounds.min;
+	root_cell.max = bounds.min + size*Toucan::Vector3f::Ones();
+	
+	std::vector<Toucan::PointOctreeNode> nodes = build_subtree(octree_ptr->points_ptr, 0, octree_ptr->number_of_points, root_cell, 0, octree_ptr->cancel_build, thread_pool);
+	if (octree_ptr->cancel_build) { return; }
+	
+	octree_ptr->nodes = std::move(nodes);
+	octree_ptr->build_finished = true;
+}
+
+} // namespace
+
+Toucan::PointOctree* Toucan::create_point_octree(Point3D* points_ptr, int number_of_points, ThreadPool& thread_pool) {
+	auto* octree_ptr = new PointOctree();
+	octree_ptr->points_ptr = points_ptr;
+	octree_ptr->number_of_points = number_of_points;
+	octree_ptr->build_future = thread_pool.submit([octree_ptr, &thread_pool]() { build_point_octree(octree_ptr, thread_pool); });
+	return octree_ptr;
+}
+
+void Toucan::destroy_point_octree(PointOctree* octree_ptr) {
+	octree_ptr->cancel_build = true;
+	if (octree_ptr->build_future.valid()) {
+		octree_ptr->build_future.wait();
+	}
+	
+	std::free(octree_ptr->points_ptr);
+	delete octree_ptr;
+}
+
+void Toucan::select_point_octree_nodes(PointOctree& octree, const Matrix4f& model_to_camera_matrix, const Matrix4f& projection_matrix, const Vector2i& framebuffer_size, int point_budget) {
+	octree.selected_firsts.clear();
+	octree.selected_counts.clear();
+	
+	if (octree.nodes.empty()) { return; }
+	
+	const Frustum frustum = extract_frustum(projection_matrix * model_to_camera_matrix);
+	const float focal_length_pixels = 0.5f * projection_matrix(0, 0) * static_cast<float>(framebuffer_size.x());
+	
+	// Projected spacing between the points of a node, in pixels.
+	const auto get_projected_spacing = [&](const PointOctreeNode& node) {
+		const Vector3f center = 0.5f*(node.bounds.min + node.bounds.max);
+		const Vector4f center_camera = model_to_camera_matrix * Vector4f(center.x(), center.y(), center.z(), 1.0f);
+		const Vector4f corner_camera = model_to_camera_matrix * Vector4f(node.bounds.max.x(), node.bounds.max.y(), node.bounds.max.z(), 1.0f);
+		const Vector3f center_to_corner(corner_camera.x() - center_camera.x(), corner_camera.y() - center_camera.y(), corner_camera.z() - center_camera.z());
+		
+		const float camera_scale = center_to_corner.norm() / (0.5f*(node.bounds.max + (-node.bounds.min)).norm());
+		const float distance = Vector3f(center_camera.x(), center_camera.y(), center_camera.z()).norm() - center_to_corner.norm();
+		
+		return focal_length_pixels * camera_scale * node.spacing / std::max(distance, 1e-3f);
+	};
+	
+	using NodeEntry = std::pair<float, int>; // (projected spacing, node index)
+	std::priority_queue<NodeEntry> node_queue;
+	
+	if (frustum_intersects_box(frustum, octree.nodes[0].bounds)) {
+		node_queue.emplace(get_projected_spacing(octree.nodes[0]), 0);
+	}
+	
+	int number_of_selected_points = 0;
+	while (not node_queue.empty()) {
+		const auto [projected_spacing, node_index] = node_queue.top();
+		node_queue.pop();
+		
+		const PointOctreeNode& node = octree.nodes[node_index];
+		if (number_of_selected_points + node.number_of_points > point_budget) { break; }
+		
+		// Merge with the previous range if they are adjacent, to reduce the number of draw ranges.
+		if (not octree.selected_firsts.empty() and octree.selected_firsts.back() + octree.selected_counts.back() == node.first_point) {
+			octree.selected_counts.back() += node.number_of_points;
+		} else {
+			octree.selected_firsts.emplace_back(node.first_point);
+			octree.selected_counts.emplace_back(node.number_of_points);
+		}
+		number_of_selected_points += node.number_of_points;
+		
+		if (projected_spacing <= octree_target_pixel_spacing) { continue; } // Dense enough, no need to refine.
+		
+		for (const int child_index : node.children) {
+			if (child_index < 0) { continue; }
+			const PointOctreeNode& child_node = octree.nodes[child_index];
+			if (frustum_intersects_box(frustum, child_node.bounds)) {
+				node_queue.emplace(get_projected_spacing(child_node), child_index);
+			}
+		}
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <future>
+
+#include <Toucan/LinAlg.h>
+#include <Toucan/DataTypes.h>
+
+#include "frustum.h"
+#include "thread_pool.h"
+
+namespace Toucan {
+
+struct PointOctreeNode {
+	BoundingBox3D bounds;
+	float spacing; // Approximate distance between neighbouring points in the node's own sample.
+	
+	// The node's own points are stored contiguously in the reordered point array, so each node can be drawn with a single range.
+	int first_point;
+	int number_of_points;
+	
+	int children[8]; // -1 if there is no child
+};
+
+struct PointOctree {
+	std::vector<PointOctreeNode> nodes;
+	
+	Point3D* points_ptr = nullptr; // Reordered points. Owned by the octree until they are uploaded to the device.
+	int number_of_points = 0;
+	
+	std::future<void> build_future;
+	std::atomic_bool cancel_build = false;
+	std::atomic_bool build_finished = false;
+	
+	bool uploaded = false;
+	
+	// Ranges selected for drawing by `select_point_octree_nodes`. Kept here to reuse the allocations between frames.
+	std::vector<int> selected_firsts;
+	std::vector<int> selected_counts;
+};
+
+// Starts building an octree on the thread pool. The octree takes ownership of `points_ptr`, which must be allocated with `std::malloc`.
+PointOctree* create_point_octree(Point3D* points_ptr, int number_of_points, ThreadPool& thread_pool);
+
+// Cancels any build in progress, waits for it to stop, and frees the octree.
+void destroy_point_octree(PointOctree* octree_ptr);
+
+// Select the nodes to draw, starting with the nodes with the largest projected point spacing, until all visible nodes are dense enough on screen or the point budget is spent.
+void select_point_octree_nodes(PointOctree& octree, const Matrix4f& model_to_camera_matrix, const Matrix4f& projection_matrix, const Vector2i& framebuffer_size, int point_budget);
+
+} // namespace Toucan
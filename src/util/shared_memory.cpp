@@ -0,0 +1,226 @@
+#include "shared_memory.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <Toucan/Toucan.h>
+
+namespace {
+
+// Enough for the End* calls of all three kinds of containers, even if each of them has to skip the end of the ring.
+constexpr size_t end_calls_reserved_size = 3*2*sizeof(Toucan::CaptureRecordHeader);
+
+constexpr size_t minimum_ring_size = size_t(1) << 20u;
+
+} // namespace
+
+Toucan::SharedMemoryWriter::SharedMemoryWriter(const std::string& name, size_t ring_size) :
+name{name} {
+	ring_size = std::max(get_capture_padded_size(ring_size), minimum_ring_size);
+	mapping_size = sizeof(SharedMemoryHeader) + ring_size;
+	
+	shm_unlink(name.c_str()); // Left behind by a producer that did not exit cleanly.
+	const int file_descriptor = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+	if (file_descriptor == -1) {
+		throw std::runtime_error("Toucan error! Could not create the shared memory object '" + name + "'.");
+	}
+	
+	void* mapping = MAP_FAILED;
+	if (ftruncate(file_descriptor, static_cast<off_t>(mapping_size)) == 0) {
+		mapping = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, file_descriptor, 0);
+	}
+	close(file_descriptor); // The mapping keeps the object open.
+	if (mapping == MAP_FAILED) {
+		shm_unlink(name.c_str());
+		throw std::runtime_error("Toucan error! Could not map the shared memory object '" + name + "'.");
+	}
+	
+	header_ptr = new (mapping) SharedMemoryHeader{};
+	ring_ptr = static_cast<uint8_t*>(mapping) + sizeof(SharedMemoryHeader);
+	start_time = std::chrono::steady_clock::now();
+	
+	header_ptr->version = shared_memory_version;
+	header_ptr->record_header_size = sizeof(CaptureRecordHeader);
+	header_ptr->ring_size = ring_size;
+	header_ptr->write_position = 0;
+	header_ptr->read_position = 0;
+	header_ptr->viewer_state = SharedMemoryViewerState::None;
+	
+	std::atomic_thread_fence(std::memory_order_release);
+	std::memcpy(header_ptr->magic, shared_memory_magic, sizeof(shared_memory_magic));
+}
+
+Toucan::SharedMemoryWriter::~SharedMemoryWriter() {
+	munmap(header_ptr, mapping_size);
+	shm_unlink(name.c_str());
+}
+
+void Toucan::SharedMemoryWriter::write(CaptureRecordType type, std::initializer_list<CaptureField> fields, bool droppable) {
+	CaptureRecordHeader record_header = {};
+	record_header.type = static_cast<uint16_t>(type);
+	record_header.payload_size = get_capture_payload_size(fields);
+	
+	const CaptureContainerCall container_call = get_capture_container_call(record_header.type);
+	
+	std::lock_guard lock(mutex);
+	
+	if (active_containers == 0) { // Between frames
+		dropping_frame = false;
+		
+		// Start where the producer is, the viewer has not read anything yet.
+		if (header_ptr->viewer_state.load(std::memory_order_acquire) == SharedMemoryViewerState::AttachRequested) {
+			header_ptr->read_position.store(header_ptr->write_position.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			header_ptr->viewer_state.store(SharedMemoryViewerState::Attached, std::memory_order_release);
+		}
+	}
+	
+	bool written = false;
+	if (header_ptr->viewer_state.load(std::memory_order_acquire) == SharedMemoryViewerState::Attached) {
+		record_header.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time).count();
+		
+		if (not dropping_frame) {
+			// Only End* calls may use the reserved space, so the viewer never has a figure left active.
+			written = try_write_record(record_header, fields, container_call.end ? 0 : end_calls_reserved_size);
+			if (not written) {
+				++number_of_dropped_records;
+				dropping_frame = not droppable;
+			}
+		} else if (container_call.end and (written_containers & container_call.container_bit) != 0) {
+			written = try_write_record(record_header, fields, 0);
+		} else {
+			++number_of_dropped_records;
+		}
+	}
+	
+	if (container_call.begin) {
+		active_containers |= container_call.container_bit;
+		written_containers = written ? (written_containers | container_call.container_bit) : (written_containers & ~container_call.container_bit);
+	} else if (container_call.end) {
+		active_containers &= ~container_call.container_bit;
+		written_containers &= ~container_call.container_bit;
+	}
+}
+
+bool Toucan::SharedMemoryWriter::try_write_record(const CaptureRecordHeader& record_header, std::initializer_list<CaptureField> fields, size_t reserved_size) {
+	const size_t ring_size = header_ptr->ring_size;
+	const size_t record_size = sizeof(CaptureRecordHeader) + record_header.payload_size;
+	
+	const uint64_t write_position = header_ptr->write_position.load(std::memory_order_relaxed);
+	const uint64_t read_position = header_ptr->read_position.load(std::memory_order_acquire);
+	const size_t free_size = ring_size - static_cast<size_t>(write_position - read_position);
+	
+	// Records do not wrap around, the end of the ring is skipped if the record does not fit.
+	const size_t offset = static_cast<size_t>(write_position % ring_size);
+	const size_t skipped_size = ring_size - offset < record_size ? ring_size - offset : 0;
+	
+	if (skipped_size + record_size + reserved_size > free_size) {
+		return false;
+	}
+	
+	if (skipped_size >= sizeof(CaptureRecordHeader)) {
+		CaptureRecordHeader wrap_record_header = {};
+		wrap_record_header.type = shared_memory_wrap_record_type;
+		std::memcpy(ring_ptr + offset, &wrap_record_header, sizeof(wrap_record_header));
+	}
+	
+	write_capture_record(ring_ptr + (offset + skipped_size) % ring_size, record_header, fields);
+	header_ptr->write_position.store(write_position + skipped_size + record_size, std::memory_order_release);
+	return true;
+}
+
+Toucan::SharedMemoryReader::SharedMemoryReader(const std::string& name) {
+	const int file_descriptor = shm_open(name.c_str(), O_RDWR, 0);
+	if (file_descriptor == -1) {
+		throw std::runtime_error("Toucan error! Could not open the shared memory object '" + name + "'. Was Toucan initialized with 'ToucanSettings::shared_memory_name' set to it?");
+	}
+	
+	struct stat file_stat = {};
+	void* mapping = MAP_FAILED;
+	if (fstat(file_descriptor, &file_stat) == 0 and static_cast<size_t>(file_stat.st_size) >= sizeof(SharedMemoryHeader)) {
+		mapping_size = static_cast<size_t>(file_stat.st_size);
+		mapping = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, file_descriptor, 0);
+	}
+	close(file_descriptor);
+	if (mapping == MAP_FAILED) {
+		throw std::runtime_error("Toucan error! Could not map the shared memory object '" + name + "'.");
+	}
+	
+	header_ptr = static_cast<SharedMemoryHeader*>(mapping);
+	ring_ptr = static_cast<uint8_t*>(mapping) + sizeof(SharedMemoryHeader);
+	
+	const bool valid_header = std::memcmp(header_ptr->magic, shared_memory_magic, sizeof(shared_memory_magic)) == 0;
+	std::atomic_thread_fence(std::memory_order_acquire);
+	if (not valid_header or header_ptr->version != shared_memory_version or header_ptr->record_header_size != sizeof(CaptureRecordHeader) or
+	    sizeof(SharedMemoryHeader) + header_ptr->ring_size > mapping_size) {
+		munmap(mapping, mapping_size);
+		throw std::runtime_error("Toucan error! The shared memory object '" + name + "' was not created by a compatible version of Toucan.");
+	}
+	
+	header_ptr->viewer_state.store(SharedMemoryViewerState::AttachRequested, std::memory_order_release);
+}
+
+Toucan::SharedMemoryReader::~SharedMemoryReader() {
+	header_ptr->viewer_state.store(SharedMemoryViewerState::WindowClosed, std::memory_order_release);
+	munmap(header_ptr, mapping_size);
+}
+
+size_t Toucan::SharedMemoryReader::replay_written_records() {
+	if (header_ptr->viewer_state.load(std::memory_order_acquire) != SharedMemoryViewerState::Attached) {
+		return 0;
+	}
+	
+	const size_t ring_size = header_ptr->ring_size;
+	uint64_t read_position = header_ptr->read_position.load(std::memory_order_relaxed);
+	const uint64_t write_position = header_ptr->write_position.load(std::memory_order_acquire);
+	
+	size_t number_of_records = 0;
+	while (read_position < write_position) {
+		const size_t offset = static_cast<size_t>(read_position % ring_size);
+		const size_t remaining_size = ring_size - offset;
+		
+		CaptureRecordHeader record_header = {};
+		if (remaining_size >= sizeof(CaptureRecordHeader)) {
+			std::memcpy(&record_header, ring_ptr + offset, sizeof(record_header));
+		}
+		
+		if (remaining_size < sizeof(CaptureRecordHeader) or record_header.type == shared_memory_wrap_record_type) {
+			read_position += remaining_size;
+			continue;
+		}
+		
+		if (record_header.payload_size > remaining_size - sizeof(CaptureRecordHeader)) {
+			throw std::runtime_error("Toucan error! The shared memory ring is corrupt.");
+		}
+		
+		// The Show* functions copy the data, so the record can be overwritten as soon as they return.
+		replay_capture_record(ring_ptr + offset);
+		
+		const CaptureContainerCall container_call = get_capture_container_call(record_header.type);
+		if (container_call.begin) {
+			active_containers |= container_call.container_bit;
+		} else if (container_call.end) {
+			active_containers &= ~container_call.container_bit;
+		}
+		
+		read_position += sizeof(CaptureRecordHeader) + record_header.payload_size;
+		header_ptr->read_position.store(read_position, std::memory_order_release);
+		++number_of_records;
+	}
+	
+	header_ptr->read_position.store(read_position, std::memory_order_release);
+	return number_of_records;
+}
+
+void Toucan::SharedMemoryReader::end_active_containers() {
+	if ((active_containers & capture_figure_2d_bit) != 0) { EndFigure2D(); }
+	if ((active_containers & capture_figure_3d_bit) != 0) { EndFigure3D(); }
+	if ((active_containers & capture_input_window_bit) != 0) { EndInputWindow(); }
+	active_containers = 0;
+}
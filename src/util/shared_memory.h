@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+
+#include "capture.h"
+
+namespace Toucan {
+
+// Calls are passed from the producer process to a viewer process through a ring buffer in a POSIX shared memory object, as records in the format
+// of capture files. Records never wrap around the end of the ring, the viewer replays them with pointers into the mapping. The producer never waits
+// for the viewer: a call that does not fit is dropped, and the rest of the frame is dropped with it if the call changes the structure of a figure.
+// The viewer starts reading at a frame boundary, so it never sees a partial frame.
+
+constexpr char shared_memory_magic[8] = {'T', 'O', 'U', 'C', 'A', 'N', 'S', 'M'};
+constexpr uint32_t shared_memory_version = 1;
+constexpr uint16_t shared_memory_wrap_record_type = 0; // The rest of the ring is unused, the next record is at the start of the ring.
+
+enum class SharedMemoryViewerState : uint32_t {
+	None, // Records are not written.
+	AttachRequested, // Set by the viewer, the producer starts writing at the next frame boundary.
+	Attached,
+	WindowClosed // Set by the viewer when its window is closed, `IsWindowOpen` returns false in the producer.
+};
+
+struct SharedMemoryHeader {
+	char magic[8]; // Written last by the producer.
+	uint32_t version;
+	uint32_t record_header_size;
+	uint64_t ring_size; // The ring follows the header.
+	
+	// Positions count the bytes written since the producer started, the offset in the ring is the position modulo the ring size.
+	alignas(64) std::atomic_uint64_t write_position; // Only written by the producer.
+	alignas(64) std::atomic_uint64_t read_position; // Only written by the viewer, except when attaching.
+	alignas(64) std::atomic<SharedMemoryViewerState> viewer_state;
+};
+
+static_assert(std::atomic_uint64_t::is_always_lock_free and std::atomic<SharedMemoryViewerState>::is_always_lock_free, "Atomics in shared memory must be lock free.");
+static_assert(sizeof(SharedMemoryHeader) % capture_alignment == 0);
+
+// The producer side. Creates the shared memory object, and removes it when destroyed.
+class SharedMemoryWriter {
+public:
+	// Throws if the shared memory object can not be created.
+	SharedMemoryWriter(const std::string& name, size_t ring_size);
+	~SharedMemoryWriter();
+	
+	SharedMemoryWriter(const SharedMemoryWriter&) = delete;
+	SharedMemoryWriter& operator=(const SharedMemoryWriter&) = delete;
+	
+	// `droppable` calls are dropped on their own when the ring is full, other calls drop the rest of the frame.
+	void write(CaptureRecordType type, std::initializer_list<CaptureField> fields, bool droppable);
+	
+	[[nodiscard]] bool is_viewer_window_open() const { return header_ptr->viewer_state.load(std::memory_order_acquire) != SharedMemoryViewerState::WindowClosed; }
+	[[nodiscard]] uint64_t get_number_of_dropped_records() const { return number_of_dropped_records; }
+
+private:
+	// Writes the record if it fits, leaving `reserved_size` bytes free.
+	bool try_write_record(const CaptureRecordHeader& record_header, std::initializer_list<CaptureField> fields, size_t reserved_size);
+	
+	std::string name;
+	SharedMemoryHeader* header_ptr = nullptr;
+	uint8_t* ring_ptr = nullptr;
+	size_t mapping_size = 0;
+	std::chrono::steady_clock::time_point start_time;
+	
+	std::atomic_uint64_t number_of_dropped_records = 0;
+	
+	std::mutex mutex; // Guards the members below.
+	uint8_t active_containers = 0; // Bit per kind of figure and input window, see `capture.h`.
+	uint8_t written_containers = 0; // Active containers whose Begin* call was written.
+	bool dropping_frame = false;
+};
+
+// The viewer side. Replays the records written by the producer through the API of the viewer process.
+class SharedMemoryReader {
+public:
+	// Throws if there is no producer with that name.
+	explicit SharedMemoryReader(const std::string& name);
+	~SharedMemoryReader(); // Tells the producer the window was closed.
+	
+	SharedMemoryReader(const SharedMemoryReader&) = delete;
+	SharedMemoryReader& operator=(const SharedMemoryReader&) = delete;
+	
+	// Replays the records written since the last call, and returns the number of records replayed.
+	size_t replay_written_records();
+	
+	// Ends any figure or input window left active by the last replayed records, so Toucan can be destroyed.
+	void end_active_containers();
+
+private:
+	SharedMemoryHeader* header_ptr = nullptr;
+	uint8_t* ring_ptr = nullptr;
+	size_t mapping_size = 0;
+	
+	uint8_t active_containers = 0;
+};
+
+} // namespace Toucan
@@ -0,0 +1,120 @@
+#include "text_3d.h"
+
+#include <algorithm>
+#include <cmath>
+
+void Toucan::layout_text_3d_labels(const Text3DLabel* labels_ptr, int number_of_labels, const GlyphAtlas& glyph_atlas, Text3DLayout& layout) {
+	layout.glyph_instances.clear();
+	layout.label_first_glyphs.clear();
+	layout.label_half_sizes.clear();
+	
+	const float half_font_size = 0.5f * glyph_atlas.font_size;
+	
+	for (int label_index = 0; label_index < number_of_labels; ++label_index) {
+		const Text3DLabel& label = labels_ptr[label_index];
+		layout.label_first_glyphs.emplace_back(static_cast<int>(layout.glyph_instances.size()));
+		
+		float label_width = 0.0f;
+		for (int character_index = 0; character_index < text_3d_label_capacity and label.text[character_index] != '\0'; ++character_index) {
+			const auto character = static_cast<unsigned char>(label.text[character_index]);
+			if (character < glyph_atlas.glyphs.size()) {
+				label_width += glyph_atlas.glyphs[character].advance;
+			}
+		}
+		
+		// Center the label on its position, and flip y to point up.
+		float pen_x = std::round(-0.5f * label_width);
+		for (int character_index = 0; character_index < text_3d_label_capacity and label.text[character_index] != '\0'; ++character_index) {
+			const auto character = static_cast<unsigned char>(label.text[character_index]);
+			if (character >= glyph_atlas.glyphs.size()) { continue; }
+			
+			const Glyph& glyph = glyph_atlas.glyphs[character];
+			if (glyph.position_max.x() > glyph.position_min.x() and glyph.position_max.y() > glyph.position_min.y()) { // Whitespace has no quad
+				GlyphInstance& glyph_instance = layout.glyph_instances.emplace_back();
+				glyph_instance.anchor = label.position;
+				glyph_instance.color = label.color;
+				glyph_instance.offset_min = Vector2f(pen_x + glyph.position_min.x(), half_font_size - glyph.position_max.y());
+				glyph_instance.offset_max = Vector2f(pen_x + glyph.position_max.x(), half_font_size - glyph.position_min.y());
+				glyph_instance.uv_min = Vector2f(glyph.uv_min.x(), glyph.uv_max.y());
+				glyph_instance.uv_max = Vector2f(glyph.uv_max.x(), glyph.uv_min.y());
+			}
+			pen_x += glyph.advance;
+		}
+		
+		layout.label_half_sizes.emplace_back(0.5f * label_width, half_font_size);
+	}
+	layout.label_first_glyphs.emplace_back(static_cast<int>(layout.glyph_instances.size()));
+	
+	layout.glyph_visibility.assign(layout.glyph_instances.size(), 1);
+}
+
+void Toucan::hide_overlapping_text_3d_labels(const Text3DLabel* labels_ptr, Text3DLayout& layout, const Matrix4f& model_to_clip_matrix, const Vector2i& framebuffer_size, float pixels_per_font_pixel) {
+	const int number_of_labels = static_cast<int>(layout.label_half_sizes.size());
+	if (number_of_labels == 0) { return; }
+	
+	const Vector2f framebuffer_size_f(static_cast<float>(framebuffer_size.x()), static_cast<float>(framebuffer_size.y()));
+	
+	// Project the labels, and draw the labels closest to the camera first.
+	layout.label_draw_order.clear();
+	layout.visible_label_rectangles.assign(static_cast<size_t>(number_of_labels), Rectangle());
+	for (int label_index = 0; label_index < number_of_labels; ++label_index) {
+		const Vector3f& position = labels_ptr[label_index].position;
+		const Vector4f clip_position = model_to_clip_matrix * Vector4f(position.x(), position.y(), position.z(), 1.0f);
+		if (clip_position(3) <= 0.0f) { continue; } // Behind the camera
+		
+		const Vector2f center(
+				(0.5f * clip_position(0) / clip_position(3) + 0.5f) * framebuffer_size_f.x(),
+				(0.5f * clip_position(1) / clip_position(3) + 0.5f) * framebuffer_size_f.y()
+		);
+		const Vector2f half_size = pixels_per_font_pixel * layout.label_half_sizes[label_index];
+		const Rectangle rectangle(center + (-half_size), center + half_size);
+		
+		if (rectangle.max.x() < 0.0f or rectangle.min.x() > framebuffer_size_f.x() or rectangle.max.y() < 0.0f or rectangle.min.y() > framebuffer_size_f.y()) { continue; }
+		
+		layout.visible_label_rectangles[label_index] = rectangle;
+		layout.label_draw_order.emplace_back(clip_position(3), label_index);
+	}
+	std::sort(layout.label_draw_order.begin(), layout.label_draw_order.end());
+	
+	// Accepted labels are added to a uniform grid with cells the height of a label, so each label is only tested against its neighbours. All labels are one line high.
+	const float cell_size = std::max(2.0f * pixels_per_font_pixel * layout.label_half_sizes[0].y(), 4.0f);
+	const int number_of_cells_x = static_cast<int>(std::ceil(framebuffer_size_f.x() / cell_size));
+	const int number_of_cells_y = static_cast<int>(std::ceil(framebuffer_size_f.y() / cell_size));
+	layout.grid_cells.resize(static_cast<size_t>(number_of_cells_x * number_of_cells_y));
+	for (auto& grid_cell : layout.grid_cells) {
+		grid_cell.clear();
+	}
+	
+	std::fill(layout.glyph_visibility.begin(), layout.glyph_visibility.end(), 0);
+	
+	for (const auto& [distance, label_index] : layout.label_draw_order) {
+		const Rectangle& rectangle = layout.visible_label_rectangles[label_index];
+		const int cell_x_begin = std::clamp(static_cast<int>(rectangle.min.x() / cell_size), 0, number_of_cells_x - 1);
+		const int cell_x_end = std::clamp(static_cast<int>(rectangle.max.x() / cell_size), 0, number_of_cells_x - 1) + 1;
+		const int cell_y_begin = std::clamp(static_cast<int>(rectangle.min.y() / cell_size), 0, number_of_cells_y - 1);
+		const int cell_y_end = std::clamp(static_cast<int>(rectangle.max.y() / cell_size), 0, number_of_cells_y - 1) + 1;
+		
+		bool overlaps = false;
+		for (int cell_y = cell_y_begin; cell_y < cell_y_end and not overlaps; ++cell_y) {
+			for (int cell_x = cell_x_begin; cell_x < cell_x_end and not overlaps; ++cell_x) {
+				for (const int other_label_index : layout.grid_cells[static_cast<size_t>(cell_y * number_of_cells_x + cell_x)]) {
+					const Rectangle& other_rectangle = layout.visible_label_rectangles[other_label_index];
+					if (rectangle.min.x() < other_rectangle.max.x() and other_rectangle.min.x() < rectangle.max.x() and
+					    rectangle.min.y() < other_rectangle.max.y() and other_rectangle.min.y() < rectangle.max.y()) {
+						overlaps = true;
+						break;
+					}
+				}
+			}
+		}
+		if (overlaps) { continue; }
+		
+		for (int cell_y = cell_y_begin; cell_y < cell_y_end; ++cell_y) {
+			for (int cell_x = cell_x_begin; cell_x < cell_x_end; ++cell_x) {
+				layout.grid_cells[static_cast<size_t>(cell_y * number_of_cells_x + cell_x)].emplace_back(label_index);
+			}
+		}
+		
+		std::fill(layout.glyph_visibility.begin() + layout.label_first_glyphs[label_index], layout.glyph_visibility.begin() + layout.label_first_glyphs[label_index + 1], 1);
+	}
+}
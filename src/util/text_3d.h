@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+#include <Toucan/LinAlg.h>
+#include <Toucan/DataTypes.h>
+
+namespace Toucan {
+
+struct Glyph {
+	// Quad of the glyph relative to the pen position at the top of the line, in font pixels with y pointing down.
+	Vector2f position_min;
+	Vector2f position_max;
+	
+	Vector2f uv_min;
+	Vector2f uv_max;
+	
+	float advance;
+};
+
+// Glyphs of the ASCII characters, indexed by character.
+struct GlyphAtlas {
+	std::array<Glyph, 128> glyphs;
+	float font_size; // Height of a line, in font pixels.
+	
+	unsigned int texture; // Glyph coverage in the red channel.
+};
+
+// Per instance vertex data, each glyph is drawn as a quad facing the camera.
+struct GlyphInstance {
+	Vector3f anchor; // Position of the label
+	Color color;
+	
+	// Corners of the quad relative to the projected anchor, in font pixels with y pointing up.
+	Vector2f offset_min;
+	Vector2f offset_max;
+	
+	Vector2f uv_min;
+	Vector2f uv_max;
+};
+
+struct Text3DLayout {
+	std::vector<GlyphInstance> glyph_instances;
+	std::vector<int> label_first_glyphs; // The glyphs of label i are [label_first_glyphs[i], label_first_glyphs[i + 1]).
+	std::vector<Vector2f> label_half_sizes; // In font pixels
+	
+	// Written by `hide_overlapping_text_3d_labels`, one value per glyph instance.
+	std::vector<uint8_t> glyph_visibility;
+	
+	// Kept here to reuse the allocations between frames.
+	std::vector<std::pair<float, int>> label_draw_order;
+	std::vector<Rectangle> visible_label_rectangles;
+	std::vector<std::vector<int>> grid_cells;
+};
+
+// Labels are centered on their position.
+void layout_text_3d_labels(const Text3DLabel* labels_ptr, int number_of_labels, const GlyphAtlas& glyph_atlas, Text3DLayout& layout);
+
+// Hides labels that overlap on screen with a label closer to the camera, and labels outside of the view.
+void hide_overlapping_text_3d_labels(const Text3DLabel* labels_ptr, Text3DLayout& layout, const Matrix4f& model_to_clip_matrix, const Vector2i& framebuffer_size, float pixels_per_font_pixel);
+
+} // namespace Toucan
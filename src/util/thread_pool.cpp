@@ -0,0 +1,160 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace {
+
+// Identifies the worker, if any, running on the current thread, so tasks submitted from inside a task go to the worker's own queue.
+thread_local const Toucan::ThreadPool* current_pool_ptr = nullptr;
+thread_local unsigned int current_worker_index = 0;
+
+struct ParallelForState {
+	std::function<void(int, int)> body;
+	int begin;
+	int end;
+	int grain_size;
+	int number_of_ranges;
+	
+	std::atomic_int next_range = 0;
+	std::atomic_int number_of_finished_ranges = 0;
+	
+	std::mutex finished_mutex;
+	std::condition_variable finished_cv;
+};
+
+// Processes ranges until there are none left to claim.
+void run_parallel_for_ranges(ParallelForState& state) {
+	for (int range_index = state.next_range++; range_index < state.number_of_ranges; range_index = state.next_range++) {
+		const int range_begin = state.begin + range_index*state.grain_size;
+		const int range_end = std::min(range_begin + state.grain_size, state.end);
+		state.body(range_begin, range_end);
+		
+		if (++state.number_of_finished_ranges == state.number_of_ranges) {
+			std::lock_guard lock(state.finished_mutex);
+			state.finished_cv.notify_all();
+		}
+	}
+}
+
+} // namespace
+
+Toucan::ThreadPool::ThreadPool(unsigned int number_of_threads) {
+	if (number_of_threads == 0) {
+		number_of_threads = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+	}
+	
+	queues.reserve(number_of_threads);
+	for (unsigned int worker_index = 0; worker_index < number_of_threads; ++worker_index) {
+		queues.emplace_back(std::make_unique<TaskQueue>());
+	}
+	
+	workers.reserve(number_of_threads);
+	for (unsigned int worker_index = 0; worker_index < number_of_threads; ++worker_index) {
+		workers.emplace_back(&ThreadPool::worker_loop, this, worker_index);
+	}
+}
+
+Toucan::ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard lock(sleep_mutex);
+		stop = true;
+	}
+	sleep_cv.notify_all();
+	
+	for (auto& worker : workers) {
+		worker.join();
+	}
+}
+
+void Toucan::ThreadPool::parallel_for(int begin, int end, int grain_size, const std::function<void(int, int)>& body) {
+	assert(grain_size > 0);
+	if (begin >= end) { return; }
+	
+	const int number_of_ranges = (end - begin + grain_size - 1) / grain_size;
+	if (number_of_ranges == 1 or workers.empty()) {
+		body(begin, end);
+		return;
+	}
+	
+	// Helper tasks may start after this call has returned, so the state is shared with them.
+	auto state_ptr = std::make_shared<ParallelForState>();
+	state_ptr->body = body;
+	state_ptr->begin = begin;
+	state_ptr->end = end;
+	state_ptr->grain_size = grain_size;
+	state_ptr->number_of_ranges = number_of_ranges;
+	
+	const int number_of_helpers = std::min(number_of_ranges - 1, static_cast<int>(workers.size()));
+	for (int helper_index = 0; helper_index < number_of_helpers; ++helper_index) {
+		push_task([state_ptr]() { run_parallel_for_ranges(*state_ptr); });
+	}
+	
+	run_parallel_for_ranges(*state_ptr);
+	
+	// Wait for the ranges claimed by other threads. They are already running, so this can not deadlock.
+	std::unique_lock lock(state_ptr->finished_mutex);
+	state_ptr->finished_cv.wait(lock, [&state_ptr]() { return state_ptr->number_of_finished_ranges == state_ptr->number_of_ranges; });
+}
+
+void Toucan::ThreadPool::push_task(std::function<void()> task) {
+	assert(not workers.empty());
+	
+	const unsigned int queue_index = (current_pool_ptr == this) ? current_worker_index : next_queue_index++ % static_cast<unsigned int>(queues.size());
+	{
+		std::lock_guard lock(queues[queue_index]->mutex);
+		queues[queue_index]->tasks.emplace_back(std::move(task));
+	}
+	
+	// Increment under the sleep mutex so a worker can not miss the wake up between checking for tasks and going to sleep.
+	{
+		std::lock_guard lock(sleep_mutex);
+		++number_of_queued_tasks;
+	}
+	sleep_cv.notify_one();
+}
+
+bool Toucan::ThreadPool::pop_task(unsigned int worker_index, std::function<void()>& task) {
+	{ // Newest task from the worker's own queue, it is most likely to still be in cache.
+		TaskQueue& own_queue = *queues[worker_index];
+		std::lock_guard lock(own_queue.mutex);
+		if (not own_queue.tasks.empty()) {
+			task = std::move(own_queue.tasks.back());
+			own_queue.tasks.pop_back();
+			--number_of_queued_tasks;
+			return true;
+		}
+	}
+	
+	const auto number_of_queues = static_cast<unsigned int>(queues.size());
+	for (unsigned int offset = 1; offset < number_of_queues; ++offset) { // Steal the oldest task from another queue.
+		TaskQueue& other_queue = *queues[(worker_index + offset) % number_of_queues];
+		std::lock_guard lock(other_queue.mutex);
+		if (not other_queue.tasks.empty()) {
+			task = std::move(other_queue.tasks.front());
+			other_queue.tasks.pop_front();
+			--number_of_queued_tasks;
+			return true;
+		}
+	}
+	
+	return false;
+}
+
+void Toucan::ThreadPool::worker_loop(unsigned int worker_index) {
+	current_pool_ptr = this;
+	current_worker_index = worker_index;
+	
+	std::function<void()> task;
+	while (true) {
+		if (pop_task(worker_index, task)) {
+			task();
+			task = nullptr;
+			continue;
+		}
+		
+		std::unique_lock lock(sleep_mutex);
+		sleep_cv.wait(lock, [this]() { return stop or number_of_queued_tasks > 0; });
+		if (stop and number_of_queued_tasks == 0) { return; }
+	}
+}
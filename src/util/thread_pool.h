@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Toucan {
+
+// Work-stealing thread pool for CPU preprocessing off the render thread.
+// Each worker has its own task queue. Workers take the newest task from their own queue and steal the oldest task from the other queues when it is empty.
+class ThreadPool {
+public:
+	// Zero threads means one less than the number of hardware threads, leaving a core for the render thread.
+	explicit ThreadPool(unsigned int number_of_threads = 0);
+	~ThreadPool();
+	
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+	
+	template<typename Function>
+	std::future<std::invoke_result_t<std::decay_t<Function>>> submit(Function&& function) {
+		using ResultType = std::invoke_result_t<std::decay_t<Function>>;
+		auto task_ptr = std::make_shared<std::packaged_task<ResultType()>>(std::forward<Function>(function));
+		std::future<ResultType> future = task_ptr->get_future();
+		push_task([task_ptr]() { (*task_ptr)(); });
+		return future;
+	}
+	
+	// Calls `body(range_begin, range_end)` for ranges of at most `grain_size` indices covering [begin, end), and returns when all ranges are done.
+	// The calling thread processes ranges as well, so this is safe to call from inside a task.
+	void parallel_for(int begin, int end, int grain_size, const std::function<void(int, int)>& body);
+	
+	[[nodiscard]] unsigned int get_number_of_threads() const { return static_cast<unsigned int>(workers.size()); }
+
+private:
+	struct TaskQueue {
+		std::mutex mutex;
+		std::deque<std::function<void()>> tasks;
+	};
+	
+	void push_task(std::function<void()> task);
+	bool pop_task(unsigned int worker_index, std::function<void()>& task);
+	void worker_loop(unsigned int worker_index);
+	
+	std::vector<std::unique_ptr<TaskQueue>> queues;
+	std::vector<std::thread> workers;
+	
+	std::atomic_uint next_queue_index = 0;
+	std::atomic_int number_of_queued_tasks = 0;
+	std::atomic_bool stop = false;
+	
+	std::mutex sleep_mutex;
+	std::condition_variable sleep_cv;
+};
+
+} // namespace Toucan
@@ -1,8 +1,10 @@
 #include "tick_number.h"
 
+#include <algorithm>
 #include <cassert>
+#include <charconv>
 #include <cmath>
-#include <string>
+#include <iterator>
 
 struct TickInfo {
 	int start_index;
@@ -38,82 +40,84 @@ TickInfo compute_tick_info(float from_value, float to_value, int max_number_of_t
 }
 constexpr int switch_to_scientific_magnitude = 5;
 
-std::string tick_to_string(int index, int multiplier, int exponent) {
+int format_tick_label(int index, int multiplier, int exponent, char* buffer) {
+	char digits[16];
+	const auto [digits_end, error] = std::to_chars(std::begin(digits), std::end(digits), std::abs(index * multiplier));
+	assert(error == std::errc());
+	const int number_of_digits = static_cast<int>(digits_end - digits);
 	
-	int base_value = std::abs(index * multiplier);
-	
-	std::string value_string;
-	value_string.reserve(32); // TODO(Matias): reserve size based on number of digits
-	value_string = std::to_string(base_value);
+	char* label_end = buffer;
+	if (index < 0) {
+		*label_end++ = '-';
+	}
 	
 	if (std::abs(exponent) >= switch_to_scientific_magnitude) { // Scientific notation
-		const auto num_of_digits = value_string.size();
-		
-		if (num_of_digits > 1) {
-			value_string.insert(value_string.cbegin() + 1, '.');
-		}
-		else {
-			std::string append_str = ".0";
-			value_string.insert(value_string.cend(), append_str.cbegin(), append_str.cend());
+		*label_end++ = digits[0];
+		*label_end++ = '.';
+		if (number_of_digits > 1) {
+			label_end = std::copy(digits + 1, digits_end, label_end);
+		} else {
+			*label_end++ = '0';
 		}
 		
-		if (exponent > 0) {
-			std::string exponent_string = std::to_string(static_cast<size_t>(exponent) + num_of_digits - 1);
-			value_string.insert(value_string.cend(), 'e');
-			value_string.insert(value_string.cend(), '+');
-			value_string.insert(value_string.cend(), exponent_string.cbegin(), exponent_string.cend());
+		const int scientific_exponent = exponent + number_of_digits - 1;
+		*label_end++ = 'e';
+		if (scientific_exponent > 0) {
+			*label_end++ = '+';
 		}
-		else {
-			std::string exponent_string = std::to_string(static_cast<size_t>(exponent) + num_of_digits - 1);
-			value_string.insert(value_string.cend(), 'e');
-			value_string.insert(value_string.cend(), exponent_string.cbegin(), exponent_string.cend());
+		label_end = std::to_chars(label_end, buffer + tick_label_capacity - 1, scientific_exponent).ptr;
+	}
+	else if (exponent > 0) { // Normal notation with trailing zeros
+		label_end = std::copy(digits, digits_end, label_end);
+		if (index != 0) {
+			label_end = std::fill_n(label_end, exponent, '0');
 		}
+	}
+	else if (exponent < 0) { // Normal notation with a decimal point, padded with zeros so there is a digit before the point
+		char padded_digits[tick_label_capacity];
+		char* padded_digits_end = std::fill_n(padded_digits, std::max(1 - exponent - number_of_digits, 0), '0');
+		padded_digits_end = std::copy(digits, digits_end, padded_digits_end);
 		
+		char* const point_position = padded_digits_end + exponent;
+		label_end = std::copy(padded_digits, point_position, label_end);
+		*label_end++ = '.';
+		label_end = std::copy(point_position, padded_digits_end, label_end);
 	}
-	else { // Normal notation
-		if (exponent > 0) {
-			if (index != 0) {
-				std::string following_zeros(static_cast<size_t>(exponent), '0');
-				value_string.insert(value_string.cend(), following_zeros.cbegin(), following_zeros.cend());
-			}
-		}
-		else if (exponent < 0) {
-			// TODO: Could be faster by precomputing number of zeros needed and inserting all at once
-			// using the "iterator insert( const_iterator pos, size_type count, CharT ch );" overload
-			while (value_string.cend() + exponent <= value_string.cbegin()) {
-				value_string.insert(value_string.cbegin(), '0');
-			}
-			
-			value_string.insert(value_string.cend() + exponent, '.');
-		}
+	else {
+		label_end = std::copy(digits, digits_end, label_end);
 	}
 	
-	if (index < 0) {
-		value_string.insert(value_string.cbegin(), '-');
-	}
+	assert(label_end < buffer + tick_label_capacity);
+	*label_end = '\0';
 	
-	return value_string;
+	return static_cast<int>(label_end - buffer);
 }
 
-
-std::pair<std::vector<float>, std::vector<std::string>> get_axis_ticks(float from_value, float to_value, int max_number_of_ticks) {
+void update_axis_ticks(AxisTicks& axis_ticks, float from_value, float to_value, float from_position, float to_position, int max_number_of_ticks) {
+	if (from_value == axis_ticks.from_value and to_value == axis_ticks.to_value and
+	    from_position == axis_ticks.from_position and to_position == axis_ticks.to_position and
+	    max_number_of_ticks == axis_ticks.max_number_of_ticks) {
+		return;
+	}
 	
-	const auto tick_info = compute_tick_info(from_value, to_value, max_number_of_ticks);
+	axis_ticks.from_value = from_value;
+	axis_ticks.to_value = to_value;
+	axis_ticks.from_position = from_position;
+	axis_ticks.to_position = to_position;
+	axis_ticks.max_number_of_ticks = max_number_of_ticks;
 	
-	const auto number_of_ticks = static_cast<size_t>(tick_info.end_index - tick_info.start_index);
+	const auto tick_info = compute_tick_info(from_value, to_value, max_number_of_ticks);
+	const double magnitude = std::pow(10.0, tick_info.exponent);
 	
-	std::vector<float> values;
-	values.reserve(number_of_ticks);
-	std::vector<std::string> value_strings;
-	value_strings.reserve(number_of_ticks);
+	const float value_width = to_value - from_value;
+	const float position_width = to_position - from_position;
 	
+	// Reuses the allocation from the previous update.
+	axis_ticks.ticks.clear();
 	for (int index = tick_info.start_index; index <= tick_info.end_index; ++index) {
-		float value = index * tick_info.multiplier * std::pow(10.0, tick_info.exponent);
-		std::string value_string = tick_to_string(index, tick_info.multiplier, tick_info.exponent);
-		
-		values.emplace_back(value);
-		value_strings.emplace_back(std::move(value_string));
+		AxisTick& tick = axis_ticks.ticks.emplace_back();
+		tick.value = static_cast<float>(index * tick_info.multiplier * magnitude);
+		tick.position = position_width*((tick.value - from_value)/value_width) + from_position;
+		format_tick_label(index, tick_info.multiplier, tick_info.exponent, tick.label);
 	}
-	
-	return {values, value_strings};
 }
@@ -1,7 +1,28 @@
 #pragma once
 
 #include <vector>
-#include <utility>
-#include <string>
 
-std::pair<std::vector<float>, std::vector<std::string>> get_axis_ticks(float from_value, float to_value, int max_number_of_ticks);
+constexpr int tick_label_capacity = 32;
+
+struct AxisTick {
+	float value;
+	float position; // In pixels
+	char label[tick_label_capacity]; // Null terminated
+};
+
+// The ticks of one axis. Kept between frames and only recomputed when the axis range or its size on screen changes.
+struct AxisTicks {
+	float from_value = 0.0f;
+	float to_value = 0.0f;
+	float from_position = 0.0f;
+	float to_position = 0.0f;
+	int max_number_of_ticks = 0;
+	
+	std::vector<AxisTick> ticks;
+};
+
+// Writes the label of the tick with value `index * multiplier * 10^exponent` to `buffer`, which must hold `tick_label_capacity` characters. Returns the label length.
+int format_tick_label(int index, int multiplier, int exponent, char* buffer);
+
+// Updates the ticks for the values [from_value, to_value] drawn over the pixels [from_position, to_position]. Does nothing if the ticks are already up to date.
+void update_axis_ticks(AxisTicks& axis_ticks, float from_value, float to_value, float from_position, float to_position, int max_number_of_ticks);
@@ -0,0 +1,143 @@
+#include "tiled_image.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cassert>
+#include <type_traits>
+
+namespace {
+
+// Rows are downsampled in parallel in groups of this many rows.
+constexpr int downsample_grain_size = 64;
+
+template<typename ChannelType, int NumberOfChannels>
+void downsample_rows(const Toucan::TiledImageLevel& source, Toucan::TiledImageLevel& destination, int row_begin, int row_end) {
+	using SumType = std::conditional_t<std::is_floating_point_v<ChannelType>, double, std::conditional_t<std::is_signed_v<ChannelType>, int64_t, uint64_t>>;
+	
+	const auto* source_ptr = reinterpret_cast<const ChannelType*>(source.pixels_ptr);
+	auto* destination_ptr = reinterpret_cast<ChannelType*>(destination.pixels_ptr);
+	
+	for (int y = row_begin; y < row_end; ++y) {
+		const size_t source_row_0 = static_cast<size_t>(2*y) * source.width;
+		const size_t source_row_1 = static_cast<size_t>(std::min(2*y + 1, source.height - 1)) * source.width;
+		
+		for (int x = 0; x < destination.width; ++x) {
+			const size_t source_column_0 = 2*x;
+			const size_t source_column_1 = std::min(2*x + 1, source.width - 1);
+			
+			for (int channel = 0; channel < NumberOfChannels; ++channel) {
+				const SumType sum =
+						static_cast<SumType>(source_ptr[(source_row_0 + source_column_0)*NumberOfChannels + channel]) +
+						static_cast<SumType>(source_ptr[(source_row_0 + source_column_1)*NumberOfChannels + channel]) +
+						static_cast<SumType>(source_ptr[(source_row_1 + source_column_0)*NumberOfChannels + channel]) +
+						static_cast<SumType>(source_ptr[(source_row_1 + source_column_1)*NumberOfChannels + channel]);
+				
+				ChannelType value;
+				if constexpr (std::is_floating_point_v<ChannelType>) {
+					value = static_cast<ChannelType>(sum / 4);
+				} else if constexpr (std::is_signed_v<ChannelType>) {
+					value = static_cast<ChannelType>((sum + (sum >= 0 ? 2 : -2)) / 4);
+				} else {
+					value = static_cast<ChannelType>((sum + 2) / 4);
+				}
+				destination_ptr[(static_cast<size_t>(y)*destination.width + x)*NumberOfChannels + channel] = value;
+			}
+		}
+	}
+}
+
+template<typename ChannelType, int NumberOfChannels>
+void downsample_level(const Toucan::TiledImageLevel& source, Toucan::TiledImageLevel& destination, Toucan::ThreadPool& thread_pool) {
+	thread_pool.parallel_for(0, destination.height, downsample_grain_size, [&](int row_begin, int row_end) {
+		downsample_rows<ChannelType, NumberOfChannels>(source, destination, row_begin, row_end);
+	});
+}
+
+Toucan::TiledImageLevel make_level(int width, int height, int tile_size) {
+	Toucan::TiledImageLevel level;
+	level.width = width;
+	level.height = height;
+	level.number_of_tiles_x = (width + tile_size - 1) / tile_size;
+	level.number_of_tiles_y = (height + tile_size - 1) / tile_size;
+	return level;
+}
+
+void build_tiled_image_levels(Toucan::TiledImage* tiled_image_ptr, Toucan::ThreadPool& thread_pool) {
+	const size_t bytes_per_pixel = Toucan::get_bytes_per_pixel(tiled_image_ptr->format);
+	
+	for (size_t level_index = 1; level_index < tiled_image_ptr->levels.size(); ++level_index) {
+		if (tiled_image_ptr->cancel_build) { return; }
+		
+		Toucan::TiledImageLevel& level = tiled_image_ptr->levels[level_index];
+		level.pixels_ptr = std::malloc(bytes_per_pixel * level.width * level.height);
+		Toucan::downsample_tiled_image_level(tiled_image_ptr->levels[level_index - 1], level, tiled_image_ptr->format, thread_pool);
+		
+		tiled_image_ptr->number_of_levels_ready = static_cast<int>(level_index) + 1;
+	}
+}
+
+} // namespace
+
+Toucan::TiledImage* Toucan::create_tiled_image(void* pixels_ptr, int width, int height, ImageFormat format, int tile_size, ThreadPool& thread_pool) {
+	assert(width > 0 and height > 0 and tile_size > 0);
+	
+	auto* tiled_image_ptr = new TiledImage();
+	tiled_image_ptr->format = format;
+	tiled_image_ptr->tile_size = tile_size;
+	
+	tiled_image_ptr->levels.emplace_back(make_level(width, height, tile_size));
+	tiled_image_ptr->levels.front().pixels_ptr = pixels_ptr;
+	while (tiled_image_ptr->levels.back().width > tile_size or tiled_image_ptr->levels.back().height > tile_size) {
+		const TiledImageLevel& previous_level = tiled_image_ptr->levels.back();
+		tiled_image_ptr->levels.emplace_back(make_level((previous_level.width + 1) / 2, (previous_level.height + 1) / 2, tile_size));
+	}
+	tiled_image_ptr->number_of_levels_ready = 1;
+	
+	if (tiled_image_ptr->levels.size() > 1) {
+		tiled_image_ptr->build_future = thread_pool.submit([tiled_image_ptr, &thread_pool]() { build_tiled_image_levels(tiled_image_ptr, thread_pool); });
+	}
+	
+	return tiled_image_ptr;
+}
+
+void Toucan::destroy_tiled_image(TiledImage* tiled_image_ptr) {
+	assert(tiled_image_ptr->resident_tiles.empty());
+	
+	tiled_image_ptr->cancel_build = true;
+	if (tiled_image_ptr->build_future.valid()) {
+		tiled_image_ptr->build_future.wait();
+	}
+	
+	for (auto& level : tiled_image_ptr->levels) {
+		std::free(level.pixels_ptr);
+	}
+	delete tiled_image_ptr;
+}
+
+void Toucan::downsample_tiled_image_level(const TiledImageLevel& source, TiledImageLevel& destination, ImageFormat format, ThreadPool& thread_pool) {
+	assert(destination.width == (source.width + 1) / 2 and destination.height == (source.height + 1) / 2);
+	
+	switch (format) {
+		case ImageFormat::GRAY_U8: { downsample_level<uint8_t, 1>(source, destination, thread_pool); } break;
+		case ImageFormat::GRAY_U16: { downsample_level<uint16_t, 1>(source, destination, thread_pool); } break;
+		case ImageFormat::GRAY_S16: { downsample_level<int16_t, 1>(source, destination, thread_pool); } break;
+		case ImageFormat::RG_U8: { downsample_level<uint8_t, 2>(source, destination, thread_pool); } break;
+		case ImageFormat::RG_U16: { downsample_level<uint16_t, 2>(source, destination, thread_pool); } break;
+		case ImageFormat::RG_U32: { downsample_level<uint32_t, 2>(source, destination, thread_pool); } break;
+		case ImageFormat::RG_F32: { downsample_level<float, 2>(source, destination, thread_pool); } break;
+		case ImageFormat::RGB_U8:
+		case ImageFormat::BGR_U8: { downsample_level<uint8_t, 3>(source, destination, thread_pool); } break;
+		case ImageFormat::RGB_U16:
+		case ImageFormat::BGR_U16: { downsample_level<uint16_t, 3>(source, destination, thread_pool); } break;
+		case ImageFormat::RGB_U32:
+		case ImageFormat::BGR_U32: { downsample_level<uint32_t, 3>(source, destination, thread_pool); } break;
+		case ImageFormat::RGB_F32:
+		case ImageFormat::BGR_F32: { downsample_level<float, 3>(source, destination, thread_pool); } break;
+		case ImageFormat::NV12:
+		case ImageFormat::YUYV:
+		case ImageFormat::BAYER_RGGB_U8:
+		case ImageFormat::BAYER_BGGR_U8:
+		case ImageFormat::BAYER_GRBG_U8:
+		case ImageFormat::BAYER_GBRG_U8: { assert(false); } break; // Rejected by ShowTiledImage2D
+	}
+}
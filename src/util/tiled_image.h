@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <future>
+#include <unordered_map>
+#include <cstdint>
+
+#include <Toucan/DataTypes.h>
+
+#include "thread_pool.h"
+
+namespace Toucan {
+
+struct TiledImageLevel {
+	void* pixels_ptr = nullptr;
+	int width = 0;
+	int height = 0;
+	int number_of_tiles_x = 0;
+	int number_of_tiles_y = 0;
+};
+
+struct TiledImageTile {
+	unsigned int texture = 0;
+	size_t size_in_bytes = 0;
+	uint64_t last_used_frame = 0;
+};
+
+// An image split into square tiles, with a mip pyramid of box filtered levels. Each level halves the size of the previous, down to a level that fits in a single tile.
+struct TiledImage {
+	ImageFormat format = ImageFormat::GRAY_U8;
+	int tile_size = 0;
+	
+	// All levels are allocated up front. Level 0 is the original image, the other levels are only valid once `number_of_levels_ready` is larger than their index.
+	std::vector<TiledImageLevel> levels;
+	std::atomic_int number_of_levels_ready = 0;
+	std::atomic_bool cancel_build = false;
+	std::future<void> build_future;
+	
+	// Tiles currently uploaded to the device, by `get_tiled_image_tile_key`. Only touched by the render thread.
+	std::unordered_map<uint64_t, TiledImageTile> resident_tiles;
+	size_t resident_size_in_bytes = 0;
+	uint64_t frame_index = 0;
+	int number_of_levels_drawn = 0; // Value of `number_of_levels_ready` when the image was last drawn.
+	bool has_missing_tiles = false; // Tiles in view that were not uploaded last frame, drawn with a coarser level in the meantime.
+};
+
+// Takes ownership of `pixels_ptr`, which must be allocated with `std::malloc`, and builds the coarser levels on the thread pool.
+TiledImage* create_tiled_image(void* pixels_ptr, int width, int height, ImageFormat format, int tile_size, ThreadPool& thread_pool);
+
+// Cancels any build in progress and frees the levels. The tile textures must already have been deleted.
+void destroy_tiled_image(TiledImage* tiled_image_ptr);
+
+inline uint64_t get_tiled_image_tile_key(int level, int tile_x, int tile_y) {
+	return (static_cast<uint64_t>(level) << 48u) | (static_cast<uint64_t>(tile_y) << 24u) | static_cast<uint64_t>(tile_x);
+}
+
+// Downsamples `source` into `destination` with a 2x2 box filter, clamping at the right and bottom edges. `destination` must be allocated with half the size, rounded up.
+void downsample_tiled_image_level(const TiledImageLevel& source, TiledImageLevel& destination, ImageFormat format, ThreadPool& thread_pool);
+
+} // namespace Toucan
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Shared by the benchmark targets. Results are printed to stdout as JSON, so they can be collected and compared between runs.
+
+using BenchmarkClock = std::chrono::steady_clock;
+
+inline double milliseconds_since(BenchmarkClock::time_point start) {
+	return std::chrono::duration<double, std::milli>(BenchmarkClock::now() - start).count();
+}
+
+inline double microseconds_since(BenchmarkClock::time_point start) {
+	return std::chrono::duration<double, std::micro>(BenchmarkClock::now() - start).count();
+}
+
+struct BenchmarkResult {
+	std::string name;
+	std::vector<std::pair<std::string, std::string>> parameters;
+	std::vector<std::pair<std::string, double>> metrics;
+};
+
+struct LatencySummary {
+	double mean = 0.0;
+	double p50 = 0.0;
+	double p99 = 0.0;
+	double p999 = 0.0;
+	double max = 0.0;
+};
+
+// Sorts the samples.
+inline LatencySummary summarize_latencies(std::vector<double>& samples) {
+	LatencySummary summary;
+	if (samples.empty()) { return summary; }
+	
+	std::sort(samples.begin(), samples.end());
+	const auto percentile = [&samples](double fraction) {
+		const auto index = static_cast<size_t>(fraction*static_cast<double>(samples.size() - 1) + 0.5);
+		return samples[index];
+	};
+	
+	double sum = 0.0;
+	for (const double sample : samples) { sum += sample; }
+	
+	summary.mean = sum / static_cast<double>(samples.size());
+	summary.p50 = percentile(0.5);
+	summary.p99 = percentile(0.99);
+	summary.p999 = percentile(0.999);
+	summary.max = samples.back();
+	return summary;
+}
+
+inline void add_latency_metrics(BenchmarkResult& result, const LatencySummary& summary, const std::string& unit) {
+	result.metrics.emplace_back("mean_" + unit, summary.mean);
+	result.metrics.emplace_back("p50_" + unit, summary.p50);
+	result.metrics.emplace_back("p99_" + unit, summary.p99);
+	result.metrics.emplace_back("p999_" + unit, summary.p999);
+	result.metrics.emplace_back("max_" + unit, summary.max);
+}
+
+inline void print_benchmark_results(const char* benchmark_name, const std::vector<BenchmarkResult>& results) {
+	std::printf("{\n\t\"benchmark\": \"%s\",\n\t\"results\": [\n", benchmark_name);
+	for (size_t result_index = 0; result_index < results.size(); ++result_index) {
+		const BenchmarkResult& result = results[result_index];
+		std::printf("\t\t{\"name\": \"%s\"", result.name.c_str());
+		
+		std::printf(", \"parameters\": {");
+		for (size_t parameter_index = 0; parameter_index < result.parameters.size(); ++parameter_index) {
+			std::printf("%s\"%s\": \"%s\"", parameter_index > 0 ? ", " : "", result.parameters[parameter_index].first.c_str(), result.parameters[parameter_index].second.c_str());
+		}
+		
+		std::printf("}, \"metrics\": {");
+		for (size_t metric_index = 0; metric_index < result.metrics.size(); ++metric_index) {
+			std::printf("%s\"%s\": %.6g", metric_index > 0 ? ", " : "", result.metrics[metric_index].first.c_str(), result.metrics[metric_index].second);
+		}
+		
+		std::printf("}}%s\n", result_index + 1 < results.size() ? "," : "");
+	}
+	std::printf("\t]\n}\n");
+	std::fflush(stdout);
+}
@@ -0,0 +1,285 @@
+// Measures the producer side cost of the Show* functions, i.e. the time spent in the calling thread copying data and waiting on figure locks,
+// for first calls that create an element and for steady state calls that replace its data.
+//
+// Runs headless on a software renderer, e.g:
+//     LIBGL_ALWAYS_SOFTWARE=1 xvfb-run -a ./Toucan_ingestion_benchmark [--max-elements=10000000] [--capture-file=capture.bin]
+//
+// With `--capture-file` all calls are also recorded, to measure the cost of recording.
+
+#include <Toucan/Toucan.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark_common.h"
+
+namespace {
+
+constexpr int thread_counts[] = {1, 4};
+
+// Calls per measurement, so every size copies roughly the same amount of data.
+constexpr size_t elements_per_measurement = 20'000'000;
+constexpr size_t min_calls = 5;
+constexpr size_t max_calls = 2000;
+
+// First calls create elements that stay in the figure, so they are sampled sparingly for large sizes.
+constexpr size_t elements_per_first_call_measurement = 2'000'000;
+constexpr size_t max_first_calls = 20;
+
+// Submits `number_of_elements` elements of the element named `element_name`, including beginning and ending the figure.
+using ShowFunction = std::function<void(const std::string& element_name, size_t number_of_elements)>;
+
+struct IngestionCase {
+	std::string name;
+	size_t element_size;
+	std::function<void(size_t max_number_of_elements)> allocate_data;
+	std::function<void()> free_data;
+	ShowFunction show;
+};
+
+std::vector<Toucan::Point3D> points_3d;
+std::vector<Toucan::LineVertex3D> line_vertices_3d;
+std::vector<Toucan::Primitive3D> primitives_3d;
+std::vector<Toucan::Vector2f> line_plot_2d;
+std::vector<Toucan::Point2D> points_2d;
+std::vector<uint8_t> image_2d;
+
+float get_pseudo_random(size_t index) {
+	return static_cast<float>((index * 2654435761u) % 65536u) / 65536.0f;
+}
+
+std::vector<IngestionCase> create_ingestion_cases() {
+	std::vector<IngestionCase> ingestion_cases;
+	
+	ingestion_cases.push_back({
+		"ShowPoints3D", sizeof(Toucan::Point3D),
+		[](size_t max_number_of_elements) {
+			points_3d.resize(max_number_of_elements);
+			for (size_t i = 0; i < max_number_of_elements; ++i) {
+				points_3d[i] = Toucan::Point3D(Toucan::Vector3f(get_pseudo_random(3*i), get_pseudo_random(3*i + 1), get_pseudo_random(3*i + 2)), Toucan::Color::White(), 2.0f, Toucan::PointShape::Square);
+			}
+		},
+		[]() { points_3d = {}; },
+		[](const std::string& element_name, size_t number_of_elements) {
+			Toucan::BeginFigure3D("Ingestion 3D");
+			Toucan::ShowPoints3D(element_name, Toucan::Buffer<Toucan::Point3D>(points_3d.data(), number_of_elements));
+			Toucan::EndFigure3D();
+		}
+	});
+	
+	ingestion_cases.push_back({
+		"ShowLines3D", sizeof(Toucan::LineVertex3D),
+		[](size_t max_number_of_elements) {
+			line_vertices_3d.resize(max_number_of_elements);
+			for (size_t i = 0; i < max_number_of_elements; ++i) {
+				line_vertices_3d[i] = Toucan::LineVertex3D(Toucan::Vector3f(get_pseudo_random(3*i), get_pseudo_random(3*i + 1), get_pseudo_random(3*i + 2)), Toucan::Color::Green());
+			}
+		},
+		[]() { line_vertices_3d = {}; },
+		[](const std::string& element_name, size_t number_of_elements) {
+			Toucan::BeginFigure3D("Ingestion 3D");
+			Toucan::ShowLines3D(element_name, Toucan::Buffer<Toucan::LineVertex3D>(line_vertices_3d.data(), number_of_elements));
+			Toucan::EndFigure3D();
+		}
+	});
+	
+	ingestion_cases.push_back({
+		"ShowPrimitives3D", sizeof(Toucan::Primitive3D),
+		[](size_t max_number_of_elements) {
+			primitives_3d.resize(max_number_of_elements);
+			for (size_t i = 0; i < max_number_of_elements; ++i) {
+				const Toucan::Vector3f position(get_pseudo_random(3*i), get_pseudo_random(3*i + 1), get_pseudo_random(3*i + 2));
+				primitives_3d[i] = Toucan::Primitive3D(static_cast<Toucan::PrimitiveType>(i % 3), Toucan::ScaledTransform3Df(Toucan::Quaternionf::Identity(), position, 0.01f*Toucan::Vector3f::Ones()), Toucan::Color::Blue());
+			}
+		},
+		[]() { primitives_3d = {}; },
+		[](const std::string& element_name, size_t number_of_elements) {
+			Toucan::BeginFigure3D("Ingestion 3D");
+			Toucan::ShowPrimitives3D(element_name, Toucan::Buffer<Toucan::Primitive3D>(primitives_3d.data(), number_of_elements));
+			Toucan::EndFigure3D();
+		}
+	});
+	
+	ingestion_cases.push_back({
+		"ShowLinePlot2D", sizeof(Toucan::Vector2f),
+		[](size_t max_number_of_elements) {
+			line_plot_2d.resize(max_number_of_elements);
+			for (size_t i = 0; i < max_number_of_elements; ++i) {
+				line_plot_2d[i] = Toucan::Vector2f(static_cast<float>(i), get_pseudo_random(i));
+			}
+		},
+		[]() { line_plot_2d = {}; },
+		[](const std::string& element_name, size_t number_of_elements) {
+			Toucan::BeginFigure2D("Ingestion 2D");
+			Toucan::ShowLinePlot2D(element_name, Toucan::Buffer<Toucan::Vector2f>(line_plot_2d.data(), number_of_elements));
+			Toucan::EndFigure2D();
+		}
+	});
+	
+	ingestion_cases.push_back({
+		"ShowPoints2D", sizeof(Toucan::Point2D),
+		[](size_t max_number_of_elements) {
+			points_2d.resize(max_number_of_elements);
+			for (size_t i = 0; i < max_number_of_elements; ++i) {
+				points_2d[i] = Toucan::Point2D(Toucan::Vector2f(get_pseudo_random(2*i), get_pseudo_random(2*i + 1)), Toucan::Color::White(), 2.0f, Toucan::PointShape::Square);
+			}
+		},
+		[]() { points_2d = {}; },
+		[](const std::string& element_name, size_t number_of_elements) {
+			Toucan::BeginFigure2D("Ingestion 2D");
+			Toucan::ShowPoints2D(element_name, Toucan::Buffer<Toucan::Point2D>(points_2d.data(), number_of_elements));
+			Toucan::EndFigure2D();
+		}
+	});
+	
+	// Elements are RGB pixels. The image is as close to square as possible.
+	ingestion_cases.push_back({
+		"ShowImage2D", 3*sizeof(uint8_t),
+		[](size_t max_number_of_elements) {
+			image_2d.resize(3*max_number_of_elements);
+			for (size_t i = 0; i < image_2d.size(); ++i) {
+				image_2d[i] = static_cast<uint8_t>(i * 2654435761u >> 24u);
+			}
+		},
+		[]() { image_2d = {}; },
+		[](const std::string& element_name, size_t number_of_elements) {
+			const int width = std::max(1, static_cast<int>(std::sqrt(static_cast<double>(number_of_elements))));
+			const int height = static_cast<int>(number_of_elements / static_cast<size_t>(width));
+			Toucan::BeginFigure2D("Ingestion 2D");
+			Toucan::ShowImage2D(element_name, Toucan::Image2D(image_2d.data(), width, height, Toucan::ImageFormat::RGB_U8), 0);
+			Toucan::EndFigure2D();
+		}
+	});
+	
+	return ingestion_cases;
+}
+
+BenchmarkResult create_result(const IngestionCase& ingestion_case, size_t number_of_elements, int number_of_threads, const char* phase, size_t number_of_calls, double duration_seconds, std::vector<double>& latencies_us) {
+	BenchmarkResult result;
+	result.name = ingestion_case.name;
+	result.parameters = {{"elements", std::to_string(number_of_elements)}, {"threads", std::to_string(number_of_threads)}, {"phase", phase}};
+	
+	const double bytes_per_call = static_cast<double>(number_of_elements*ingestion_case.element_size);
+	result.metrics.emplace_back("calls", static_cast<double>(number_of_calls));
+	result.metrics.emplace_back("calls_per_second", static_cast<double>(number_of_calls) / duration_seconds);
+	result.metrics.emplace_back("bytes_per_second", bytes_per_call*static_cast<double>(number_of_calls) / duration_seconds);
+	add_latency_metrics(result, summarize_latencies(latencies_us), "us");
+	return result;
+}
+
+// Each call creates a new element.
+BenchmarkResult measure_first_calls(const IngestionCase& ingestion_case, size_t number_of_elements, std::vector<std::string>& element_names) {
+	const size_t number_of_calls = std::clamp<size_t>(elements_per_first_call_measurement / number_of_elements, 1, max_first_calls);
+	
+	std::vector<double> latencies_us;
+	const auto start = BenchmarkClock::now();
+	for (size_t call_index = 0; call_index < number_of_calls; ++call_index) {
+		element_names.emplace_back(ingestion_case.name + " first " + std::to_string(number_of_elements) + " " + std::to_string(call_index));
+		
+		const auto call_start = BenchmarkClock::now();
+		ingestion_case.show(element_names.back(), number_of_elements);
+		latencies_us.emplace_back(microseconds_since(call_start));
+	}
+	const double duration_seconds = milliseconds_since(start) / 1000.0;
+	
+	return create_result(ingestion_case, number_of_elements, 1, "first", number_of_calls, duration_seconds, latencies_us);
+}
+
+// Each thread replaces the data of an element of its own. Figures can only be built by one thread at the time, so the producers share a lock as any
+// multithreaded user of Toucan has to, and the measured latency includes waiting for the lock.
+BenchmarkResult measure_steady_state_calls(const IngestionCase& ingestion_case, size_t number_of_elements, int number_of_threads, std::vector<std::string>& element_names) {
+	const size_t number_of_calls_per_thread = std::clamp<size_t>(elements_per_measurement / number_of_elements, min_calls, max_calls) / static_cast<size_t>(number_of_threads) + 1;
+	
+	std::mutex producer_mutex;
+	std::vector<std::vector<double>> thread_latencies_us(static_cast<size_t>(number_of_threads));
+	
+	const size_t first_element_name_index = element_names.size();
+	for (int thread_index = 0; thread_index < number_of_threads; ++thread_index) {
+		element_names.emplace_back(ingestion_case.name + " steady " + std::to_string(thread_index));
+		ingestion_case.show(element_names.back(), number_of_elements); // Create the element before measuring.
+	}
+	
+	const auto produce = [&](int thread_index) {
+		const std::string& element_name = element_names[first_element_name_index + static_cast<size_t>(thread_index)];
+		auto& latencies_us = thread_latencies_us[static_cast<size_t>(thread_index)];
+		latencies_us.reserve(number_of_calls_per_thread);
+		
+		for (size_t call_index = 0; call_index < number_of_calls_per_thread; ++call_index) {
+			const auto call_start = BenchmarkClock::now();
+			std::lock_guard lock(producer_mutex);
+			ingestion_case.show(element_name, number_of_elements);
+			latencies_us.emplace_back(microseconds_since(call_start));
+		}
+	};
+	
+	const auto start = BenchmarkClock::now();
+	std::vector<std::thread> producer_threads;
+	for (int thread_index = 0; thread_index < number_of_threads; ++thread_index) {
+		producer_threads.emplace_back(produce, thread_index);
+	}
+	for (auto& producer_thread : producer_threads) {
+		producer_thread.join();
+	}
+	const double duration_seconds = milliseconds_since(start) / 1000.0;
+	
+	std::vector<double> latencies_us;
+	for (const auto& thread_latencies : thread_latencies_us) {
+		latencies_us.insert(latencies_us.end(), thread_latencies.begin(), thread_latencies.end());
+	}
+	
+	return create_result(ingestion_case, number_of_elements, number_of_threads, "steady", latencies_us.size(), duration_seconds, latencies_us);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+	size_t max_number_of_elements = 10'000'000;
+	Toucan::ToucanSettings settings;
+	for (int argument_index = 1; argument_index < argc; ++argument_index) {
+		constexpr const char* max_elements_option = "--max-elements=";
+		if (std::strncmp(argv[argument_index], max_elements_option, std::strlen(max_elements_option)) == 0) {
+			max_number_of_elements = std::strtoull(argv[argument_index] + std::strlen(max_elements_option), nullptr, 10);
+		}
+		
+		constexpr const char* capture_file_option = "--capture-file=";
+		if (std::strncmp(argv[argument_index], capture_file_option, std::strlen(capture_file_option)) == 0) {
+			settings.capture_file_path = argv[argument_index] + std::strlen(capture_file_option);
+		}
+	}
+	
+	Toucan::Initialize(settings);
+	
+	std::vector<BenchmarkResult> results;
+	for (const IngestionCase& ingestion_case : create_ingestion_cases()) {
+		ingestion_case.allocate_data(max_number_of_elements);
+		
+		for (size_t number_of_elements = 1000; number_of_elements <= max_number_of_elements; number_of_elements *= 10) {
+			std::vector<std::string> element_names;
+			
+			results.emplace_back(measure_first_calls(ingestion_case, number_of_elements, element_names));
+			for (const int number_of_threads : thread_counts) {
+				results.emplace_back(measure_steady_state_calls(ingestion_case, number_of_elements, number_of_threads, element_names));
+			}
+			
+			// Elements can not be removed, so shrink them to keep the render thread from slowing down the following measurements.
+			for (const std::string& element_name : element_names) {
+				ingestion_case.show(element_name, 1);
+			}
+		}
+		
+		ingestion_case.free_data();
+	}
+	
+	Toucan::Destroy();
+	
+	print_benchmark_results("ingestion", results);
+	return 0;
+}
@@ -0,0 +1,246 @@
+// Micro-benchmarks of the LinAlg types, reporting the time per operation in nanoseconds for float and double. The inputs of each case are small
+// enough to stay in the L1 cache, so the arithmetic is measured rather than the memory bandwidth. The SIMD instruction set the LinAlg kernels
+// of the library use is reported with every result, so runs with different compiler flags can be compared.
+//
+//     ./Toucan_linalg_benchmark [--filter=quaternion]
+
+#include <Toucan/LinAlg.h>
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmark_common.h"
+
+namespace {
+
+constexpr size_t number_of_inputs = 256;
+constexpr double measurement_duration_ms = 100.0;
+constexpr int number_of_measurements = 5;
+
+// Keeps the compiler from removing computations whose results are never used.
+template<typename T>
+inline void do_not_optimize(const T& value) {
+	asm volatile("" : : "g"(&value) : "memory");
+}
+
+// Only cases with names containing the filter are measured.
+std::string benchmark_filter;
+
+// Calls `operation(input_index)` over all inputs until the measurement duration has passed. The fastest of the measurements is reported, since
+// the slower ones were interrupted by something else.
+template<typename Operation>
+void add_operation_result(std::vector<BenchmarkResult>& results, const std::string& name, std::vector<std::pair<std::string, std::string>> parameters, const Operation& operation) {
+	if (name.find(benchmark_filter) == std::string::npos) { return; }
+	
+	double best_ns_per_operation = 0.0;
+	for (int measurement_index = 0; measurement_index < number_of_measurements; ++measurement_index) {
+		size_t number_of_operations = 0;
+		const BenchmarkClock::time_point start = BenchmarkClock::now();
+		do {
+			for (size_t input_index = 0; input_index < number_of_inputs; ++input_index) {
+				operation(input_index);
+			}
+			number_of_operations += number_of_inputs;
+		} while (milliseconds_since(start) < measurement_duration_ms);
+		
+		const double ns_per_operation = 1e6*milliseconds_since(start) / static_cast<double>(number_of_operations);
+		if (measurement_index == 0 or ns_per_operation < best_ns_per_operation) {
+			best_ns_per_operation = ns_per_operation;
+		}
+	}
+	
+	BenchmarkResult result;
+	result.name = name;
+	result.parameters = std::move(parameters);
+	result.parameters.emplace_back("simd", Toucan::simd::get_instruction_set());
+	result.metrics.emplace_back("ns_per_op", best_ns_per_operation);
+	results.emplace_back(std::move(result));
+}
+
+template<typename scalar_t>
+struct RandomInputs {
+	explicit RandomInputs(unsigned int seed) : random_engine(seed) { }
+	
+	scalar_t scalar() { return distribution(random_engine); }
+	
+	template<int rows, int columns>
+	Toucan::Matrix<scalar_t, rows, columns> matrix() {
+		Toucan::Matrix<scalar_t, rows, columns> matrix;
+		for (int row_index = 0; row_index < rows; ++row_index) {
+			for (int column_index = 0; column_index < columns; ++column_index) {
+				matrix(row_index, column_index) = scalar();
+			}
+		}
+		return matrix;
+	}
+	
+	Toucan::Vector3<scalar_t> vector_3d() { return matrix<3, 1>(); }
+	
+	Toucan::Quaternion<scalar_t> quaternion() {
+		return Toucan::Quaternion<scalar_t>(Toucan::Vector3<scalar_t>(scalar(), scalar(), scalar()).normalized(), scalar());
+	}
+	
+	Toucan::RigidTransform2D<scalar_t> rigid_transform_2d() { return Toucan::RigidTransform2D<scalar_t>(scalar(), matrix<2, 1>()); }
+	Toucan::RigidTransform3D<scalar_t> rigid_transform_3d() { return Toucan::RigidTransform3D<scalar_t>(quaternion(), vector_3d()); }
+	Toucan::ScaledTransform3D<scalar_t> scaled_transform_3d() { return Toucan::ScaledTransform3D<scalar_t>(quaternion(), vector_3d(), vector_3d()); }
+	
+	template<typename T>
+	std::vector<T> generate(T (RandomInputs::*generator)()) {
+		std::vector<T> values;
+		values.reserve(number_of_inputs);
+		for (size_t input_index = 0; input_index < number_of_inputs; ++input_index) {
+			values.emplace_back((this->*generator)());
+		}
+		return values;
+	}
+	
+	std::mt19937 random_engine;
+	std::uniform_real_distribution<scalar_t> distribution{scalar_t(0.5), scalar_t(2)};
+};
+
+// The model matrix of each Primitive3D in `draw_element_3d`, with the full product chain computed for every primitive, and with the parts that
+// are the same for all primitives computed once.
+template<typename scalar_t>
+void add_primitive_model_matrix_results(std::vector<BenchmarkResult>& results, const std::string& scalar_type) {
+	RandomInputs<scalar_t> random_inputs(42);
+	
+	const Toucan::Matrix4<scalar_t> model_to_world_matrix = Toucan::RigidTransform3D<scalar_t>(random_inputs.quaternion(), Toucan::Vector3<scalar_t>::Ones()).transformation_matrix();
+	const Toucan::Matrix4<scalar_t> orientation_and_handedness_matrix(
+			scalar_t(0), scalar_t(1), scalar_t(0), scalar_t(0),
+			scalar_t(0), scalar_t(0), scalar_t(1), scalar_t(0),
+			scalar_t(1), scalar_t(0), scalar_t(0), scalar_t(0),
+			scalar_t(0), scalar_t(0), scalar_t(0), scalar_t(1)
+	);
+	
+	std::vector<Toucan::ScaledTransform3D<scalar_t>> scaled_transforms;
+	for (size_t input_index = 0; input_index < number_of_inputs; ++input_index) {
+		scaled_transforms.emplace_back(random_inputs.scaled_transform_3d());
+	}
+	
+	add_operation_result(results, "primitive_model_matrix", {{"scalar", scalar_type}, {"variant", "full_chain"}}, [&](size_t input_index) {
+		const Toucan::Matrix4<scalar_t> model_matrix = model_to_world_matrix * orientation_and_handedness_matrix * scaled_transforms[input_index].transformation_matrix() * orientation_and_handedness_matrix.transpose();
+		do_not_optimize(model_matrix);
+	});
+	
+	const Toucan::Matrix4<scalar_t> data_to_world_matrix = model_to_world_matrix * orientation_and_handedness_matrix;
+	const Toucan::Matrix4<scalar_t> orientation_and_handedness_matrix_inverse = orientation_and_handedness_matrix.transpose();
+	add_operation_result(results, "primitive_model_matrix", {{"scalar", scalar_type}, {"variant", "hoisted"}}, [&](size_t input_index) {
+		const Toucan::Matrix4<scalar_t> model_matrix = data_to_world_matrix * scaled_transforms[input_index].transformation_matrix() * orientation_and_handedness_matrix_inverse;
+		do_not_optimize(model_matrix);
+	});
+}
+
+template<typename scalar_t, int rows, int common, int columns>
+void add_matrix_product_result(std::vector<BenchmarkResult>& results, const std::string& scalar_type) {
+	RandomInputs<scalar_t> random_inputs(42);
+	const auto lhs = random_inputs.generate(&RandomInputs<scalar_t>::template matrix<rows, common>);
+	const auto rhs = random_inputs.generate(&RandomInputs<scalar_t>::template matrix<common, columns>);
+	
+	const std::string lhs_size = std::to_string(rows) + "x" + std::to_string(common);
+	const std::string rhs_size = std::to_string(common) + "x" + std::to_string(columns);
+	add_operation_result(results, "matrix_product", {{"scalar", scalar_type}, {"lhs", lhs_size}, {"rhs", rhs_size}}, [&](size_t input_index) {
+		const Toucan::Matrix<scalar_t, rows, columns> product = lhs[input_index] * rhs[input_index];
+		do_not_optimize(product);
+	});
+}
+
+template<typename scalar_t>
+void add_linalg_results(std::vector<BenchmarkResult>& results, const std::string& scalar_type) {
+	RandomInputs<scalar_t> random_inputs(42);
+	
+	add_matrix_product_result<scalar_t, 2, 2, 2>(results, scalar_type);
+	add_matrix_product_result<scalar_t, 3, 3, 3>(results, scalar_type);
+	add_matrix_product_result<scalar_t, 4, 4, 4>(results, scalar_type);
+	add_matrix_product_result<scalar_t, 2, 2, 1>(results, scalar_type);
+	add_matrix_product_result<scalar_t, 3, 3, 1>(results, scalar_type);
+	add_matrix_product_result<scalar_t, 4, 4, 1>(results, scalar_type);
+	
+	const auto vectors = random_inputs.generate(&RandomInputs<scalar_t>::vector_3d);
+	const auto quaternions = random_inputs.generate(&RandomInputs<scalar_t>::quaternion);
+	const auto other_quaternions = random_inputs.generate(&RandomInputs<scalar_t>::quaternion);
+	const auto rigid_transforms_2d = random_inputs.generate(&RandomInputs<scalar_t>::rigid_transform_2d);
+	const auto rigid_transforms_3d = random_inputs.generate(&RandomInputs<scalar_t>::rigid_transform_3d);
+	const auto other_rigid_transforms_3d = random_inputs.generate(&RandomInputs<scalar_t>::rigid_transform_3d);
+	const auto scaled_transforms_3d = random_inputs.generate(&RandomInputs<scalar_t>::scaled_transform_3d);
+	
+	add_operation_result(results, "vector_3d_normalized", {{"scalar", scalar_type}}, [&](size_t input_index) {
+		do_not_optimize(vectors[input_index].normalized());
+	});
+	
+	add_operation_result(results, "quaternion_normalized", {{"scalar", scalar_type}}, [&](size_t input_index) {
+		do_not_optimize(quaternions[input_index].normalized());
+	});
+	
+	add_operation_result(results, "quaternion_multiply", {{"scalar", scalar_type}}, [&](size_t input_index) {
+		do_not_optimize(quaternions[input_index] * other_quaternions[input_index]);
+	});
+	
+	add_operation_result(results, "quaternion_rotate", {{"scalar", scalar_type}}, [&](size_t input_index) {
+		do_not_optimize(quaternions[input_index] * vectors[input_index]);
+	});
+	
+	add_operation_result(results, "quaternion_rotation_matrix", {{"scalar", scalar_type}}, [&](size_t input_index) {
+		do_not_optimize(quaternions[input_index].rotation_matrix());
+	});
+	
+	add_operation_result(results, "rigid_transform_2d_inverse", {{"scalar", scalar_type}}, [&](size_t input_index) {
+		do_not_optimize(rigid_transforms_2d[input_index].inverse());
+	});
+	
+	add_operation_result(results, "rigid_transform_3d_compose", {{"scalar", scalar_type}}, [&](size_t input_index) {
+		do_not_optimize(rigid_transforms_3d[input_index] * other_rigid_transforms_3d[input_index]);
+	});
+	
+	add_operation_result(results, "rigid_transform_3d_inverse", {{"scalar", scalar_type}}, [&](size_t input_index) {
+		do_not_optimize(rigid_transforms_3d[input_index].inverse());
+	});
+	
+	add_operation_result(results, "rigid_transform_3d_transform_point", {{"scalar", scalar_type}}, [&](size_t input_index) {
+		do_not_optimize(rigid_transforms_3d[input_index] * vectors[input_index]);
+	});
+	
+	add_operation_result(results, "rigid_transform_3d_transformation_matrix", {{"scalar", scalar_type}}, [&](size_t input_index) {
+		do_not_optimize(rigid_transforms_3d[input_index].transformation_matrix());
+	});
+	
+	add_operation_result(results, "scaled_transform_3d_transformation_matrix", {{"scalar", scalar_type}}, [&](size_t input_index) {
+		do_not_optimize(scaled_transforms_3d[input_index].transformation_matrix());
+	});
+	
+	add_operation_result(results, "scaled_transform_3d_transformation_matrix_inverse", {{"scalar", scalar_type}}, [&](size_t input_index) {
+		do_not_optimize(scaled_transforms_3d[input_index].transformation_matrix_inverse());
+	});
+	
+	// All inputs are transformed with one call on the first input index, so the time is reported per point, to compare with
+	// `rigid_transform_3d_transform_point`.
+	std::vector<Toucan::Vector3<scalar_t>> transformed_vectors(number_of_inputs);
+	add_operation_result(results, "rigid_transform_3d_transform_points", {{"scalar", scalar_type}}, [&](size_t input_index) {
+		if (input_index != 0) { return; }
+		Toucan::transform_points(rigid_transforms_3d.front(), vectors.data(), number_of_inputs, transformed_vectors.data());
+		do_not_optimize(transformed_vectors.front());
+	});
+	
+	add_primitive_model_matrix_results<scalar_t>(results, scalar_type);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+	for (int argument_index = 1; argument_index < argc; ++argument_index) {
+		constexpr const char* filter_option = "--filter=";
+		if (std::strncmp(argv[argument_index], filter_option, std::strlen(filter_option)) == 0) {
+			benchmark_filter = argv[argument_index] + std::strlen(filter_option);
+		}
+	}
+	
+	std::vector<BenchmarkResult> results;
+	
+	add_linalg_results<float>(results, "float");
+	add_linalg_results<double>(results, "double");
+	
+	print_benchmark_results("linalg", results);
+	return 0;
+}
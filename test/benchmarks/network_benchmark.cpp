@@ -0,0 +1,236 @@
+// Measures the bandwidth of streaming a point cloud to a remote viewer over localhost, as the percentage of the raw `Point3D` bytes sent per
+// frame, for point clouds that are static, jitter, translate, are rescanned by a moving sensor, or are uniformly random.
+// The producer is initialized with `ToucanSettings::network_port`, so no window is opened. The viewer side only reads and counts the frames.
+//
+//     ./Toucan_network_benchmark [--points=100000] [--port=7790]
+
+#include <Toucan/Toucan.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "util/network.h"
+
+#include "benchmark_common.h"
+
+namespace {
+
+constexpr int frames_per_case = 10;
+constexpr int frame_timeout_ms = 2000;
+constexpr int max_connection_frames = 50; // Frames shown before the viewer is connected are dropped by the producer.
+
+// Connects to the producer like a viewer, but only counts the bytes of the frames it receives.
+class FrameCounter {
+public:
+	explicit FrameCounter(uint16_t port) {
+		sockaddr_in address = {};
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		address.sin_port = htons(port);
+		
+		viewer_socket = socket(AF_INET, SOCK_STREAM, 0);
+		Toucan::NetworkHello hello = {};
+		if (viewer_socket == -1 or connect(viewer_socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 or
+		    not receive_all(&hello, sizeof(hello)) or std::memcmp(hello.magic, Toucan::network_magic, sizeof(Toucan::network_magic)) != 0) {
+			throw std::runtime_error("Could not connect to the producer on port " + std::to_string(port) + ".");
+		}
+	}
+	
+	~FrameCounter() {
+		if (viewer_socket != -1) { close(viewer_socket); }
+	}
+	
+	FrameCounter(const FrameCounter&) = delete;
+	FrameCounter& operator=(const FrameCounter&) = delete;
+	
+	// Waits for the next frame. Returns false if no frame arrived before the timeout. `quantized_size` is the size of the frame before compression.
+	bool receive_frame(size_t& sent_size, size_t& quantized_size) {
+		pollfd poll_descriptor = {viewer_socket, POLLIN, 0};
+		if (poll(&poll_descriptor, 1, frame_timeout_ms) <= 0) {
+			return false;
+		}
+		
+		Toucan::NetworkFrameHeader frame_header = {};
+		if (not receive_all(&frame_header, sizeof(frame_header))) { throw std::runtime_error("The producer disconnected."); }
+		
+		std::vector<Toucan::NetworkBlockHeader> block_headers(frame_header.number_of_blocks);
+		if (not receive_all(block_headers.data(), block_headers.size()*sizeof(Toucan::NetworkBlockHeader))) { throw std::runtime_error("The producer disconnected."); }
+		
+		size_t encoded_size = 0;
+		for (const auto& block_header : block_headers) { encoded_size += block_header.encoded_size; }
+		blocks.resize(encoded_size);
+		if (not receive_all(blocks.data(), blocks.size())) { throw std::runtime_error("The producer disconnected."); }
+		
+		sent_size = sizeof(frame_header) + block_headers.size()*sizeof(Toucan::NetworkBlockHeader) + encoded_size;
+		quantized_size = frame_header.decoded_size;
+		return true;
+	}
+
+private:
+	bool receive_all(void* data_ptr, size_t size) {
+		auto* bytes_ptr = static_cast<uint8_t*>(data_ptr);
+		while (size > 0) {
+			const ssize_t received_size = recv(viewer_socket, bytes_ptr, size, 0);
+			if (received_size <= 0) { return false; }
+			bytes_ptr += received_size;
+			size -= static_cast<size_t>(received_size);
+		}
+		return true;
+	}
+	
+	int viewer_socket = -1;
+	std::vector<uint8_t> blocks;
+};
+
+void show_points(const std::vector<Toucan::Point3D>& points) {
+	Toucan::BeginFigure3D("Network benchmark");
+	Toucan::ShowPoints3D("Points", points);
+	Toucan::EndFigure3D();
+}
+
+// An organized scan of a wavy surface, as seen by a sensor that has moved `offset`.
+void scan_surface(std::vector<Toucan::Point3D>& points, float offset) {
+	constexpr size_t scan_width = 400;
+	for (size_t point_index = 0; point_index < points.size(); ++point_index) {
+		const float u = static_cast<float>(point_index % scan_width)*0.01f;
+		const float v = static_cast<float>(point_index / scan_width)*0.01f;
+		points[point_index] = Toucan::Point3D(Toucan::Vector3f(u, v, std::sin(u + offset)*std::cos(v)), Toucan::Color(u/4.0f, v/2.5f, 0.5f), 4.0f, Toucan::PointShape::Circle);
+	}
+}
+
+struct NetworkCase {
+	std::string name;
+	std::function<void(std::vector<Toucan::Point3D>& points, int frame_index)> update_points;
+};
+
+std::vector<NetworkCase> create_network_cases(std::mt19937& generator) {
+	std::vector<NetworkCase> network_cases;
+	
+	network_cases.push_back({"static", [](std::vector<Toucan::Point3D>&, int) { }});
+	
+	network_cases.push_back({"jitter", [](std::vector<Toucan::Point3D>& points, int) {
+		for (size_t point_index = 0; point_index < points.size(); point_index += 100) {
+			points[point_index].position.z() += 0.01f; // One percent of the points move.
+		}
+	}});
+	
+	network_cases.push_back({"translate", [](std::vector<Toucan::Point3D>& points, int) {
+		for (auto& point : points) { point.position.x() += 0.0123f; }
+	}});
+	
+	network_cases.push_back({"moving_scan", [](std::vector<Toucan::Point3D>& points, int frame_index) {
+		scan_surface(points, 0.1f*static_cast<float>(frame_index));
+	}});
+	
+	network_cases.push_back({"random", [&generator](std::vector<Toucan::Point3D>& points, int) {
+		std::uniform_real_distribution<float> position_distribution(-10.0f, 10.0f);
+		std::uniform_real_distribution<float> color_distribution(0.0f, 1.0f);
+		for (auto& point : points) {
+			point = Toucan::Point3D(
+					Toucan::Vector3f(position_distribution(generator), position_distribution(generator), position_distribution(generator)),
+					Toucan::Color(color_distribution(generator), color_distribution(generator), color_distribution(generator)),
+					4.0f, Toucan::PointShape::Circle);
+		}
+	}});
+	
+	return network_cases;
+}
+
+BenchmarkResult measure_network_case(const NetworkCase& network_case, std::vector<Toucan::Point3D>& points, FrameCounter& frame_counter) {
+	// Every case starts from the same scan, which the viewer has already received.
+	scan_surface(points, 0.0f);
+	size_t sent_size = 0;
+	size_t quantized_size = 0;
+	show_points(points);
+	if (not frame_counter.receive_frame(sent_size, quantized_size)) { throw std::runtime_error("A frame was dropped."); }
+	
+	size_t total_sent_size = 0;
+	size_t total_quantized_size = 0;
+	double total_latency_ms = 0.0;
+	for (int frame_index = 1; frame_index <= frames_per_case; ++frame_index) {
+		network_case.update_points(points, frame_index);
+		
+		const auto start = BenchmarkClock::now();
+		show_points(points);
+		if (not frame_counter.receive_frame(sent_size, quantized_size)) { throw std::runtime_error("A frame was dropped."); }
+		total_latency_ms += milliseconds_since(start);
+		total_sent_size += sent_size;
+		total_quantized_size += quantized_size;
+	}
+	
+	const double raw_size = static_cast<double>(points.size()*sizeof(Toucan::Point3D));
+	const double sent_size_per_frame = static_cast<double>(total_sent_size)/frames_per_case;
+	
+	BenchmarkResult result;
+	result.name = "network";
+	result.parameters.emplace_back("case", network_case.name);
+	result.parameters.emplace_back("points", std::to_string(points.size()));
+	result.metrics.emplace_back("raw_bytes_per_frame", raw_size);
+	result.metrics.emplace_back("quantized_bytes_per_frame", static_cast<double>(total_quantized_size)/frames_per_case);
+	result.metrics.emplace_back("sent_bytes_per_frame", sent_size_per_frame);
+	result.metrics.emplace_back("sent_percent_of_raw", 100.0*sent_size_per_frame/raw_size);
+	result.metrics.emplace_back("mean_latency_ms", total_latency_ms/frames_per_case);
+	return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+	size_t number_of_points = 100'000;
+	uint16_t port = 7790;
+	for (int argument_index = 1; argument_index < argc; ++argument_index) {
+		constexpr const char* points_option = "--points=";
+		if (std::strncmp(argv[argument_index], points_option, std::strlen(points_option)) == 0) {
+			number_of_points = std::strtoull(argv[argument_index] + std::strlen(points_option), nullptr, 10);
+		}
+		
+		constexpr const char* port_option = "--port=";
+		if (std::strncmp(argv[argument_index], port_option, std::strlen(port_option)) == 0) {
+			port = static_cast<uint16_t>(std::strtoul(argv[argument_index] + std::strlen(port_option), nullptr, 10));
+		}
+	}
+	
+	Toucan::ToucanSettings settings;
+	settings.network_port = port;
+	Toucan::Initialize(settings);
+	
+	std::vector<BenchmarkResult> results;
+	{
+		FrameCounter frame_counter(port);
+		
+		std::vector<Toucan::Point3D> points(number_of_points);
+		scan_surface(points, 0.0f);
+		
+		// The producer only starts a frame once it has accepted the viewer.
+		size_t sent_size = 0;
+		size_t quantized_size = 0;
+		bool connected = false;
+		for (int frame_index = 0; frame_index < max_connection_frames and not connected; ++frame_index) {
+			show_points(points);
+			connected = frame_counter.receive_frame(sent_size, quantized_size);
+		}
+		if (not connected) { throw std::runtime_error("The producer did not send any frames."); }
+		
+		std::mt19937 generator(1);
+		for (const NetworkCase& network_case : create_network_cases(generator)) {
+			results.emplace_back(measure_network_case(network_case, points, frame_counter));
+		}
+	}
+	
+	Toucan::Destroy();
+	
+	print_benchmark_results("network", results);
+	return 0;
+}
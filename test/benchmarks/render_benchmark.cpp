@@ -0,0 +1,262 @@
+// Measures the frame rate of the render thread for a large Figure3D and Figure2D, both while the view changes every frame, so the figure is redrawn
+// every frame, and while the view is static, so the figure framebuffer is reused. The frame rate is not limited, and vsync is assumed to be off.
+//
+// The view is moved through hooks in the render loop, so the library must be configured with -DBUILD_BENCHMARK_HOOKS=ON.
+//
+// Runs headless on a software renderer, e.g:
+//     LIBGL_ALWAYS_SOFTWARE=1 vblank_mode=0 xvfb-run -a ./Toucan_render_benchmark [--points=1000000] [--primitives=10000] [--line-strips=100]
+//         [--line-strip-length=10000] [--line-plots=4] [--line-plot-length=1000000] [--image-size=2048] [--duration=5]
+
+#include <Toucan/Toucan.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "internal.h"
+
+#include "benchmark_common.h"
+
+#ifndef TOUCAN_BENCHMARK_HOOKS
+#error "Toucan_render_benchmark needs a library built with BUILD_BENCHMARK_HOOKS."
+#endif
+
+extern Toucan::ToucanContext* toucan_context_ptr;
+
+namespace {
+
+constexpr const char* figure_3d_name = "Render benchmark 3D";
+constexpr const char* figure_2d_name = "Render benchmark 2D";
+
+constexpr int warm_up_frames = 10;
+
+struct RenderBenchmarkSettings {
+	size_t number_of_points = 1'000'000;
+	size_t number_of_primitives = 10'000;
+	size_t number_of_line_strips = 100;
+	size_t line_strip_length = 10'000;
+	size_t number_of_line_plots = 4;
+	size_t line_plot_length = 1'000'000;
+	int image_size = 2048;
+	double duration_seconds = 5.0;
+};
+
+float get_pseudo_random(size_t index) {
+	return static_cast<float>((index * 2654435761u) % 65536u) / 65536.0f;
+}
+
+void wait_for_frames(uint64_t number_of_frames) {
+	const uint64_t target_number_of_frames = toucan_context_ptr->number_of_presented_frames + number_of_frames;
+	while (toucan_context_ptr->number_of_presented_frames < target_number_of_frames) {
+		std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+}
+
+template <typename Figure>
+Figure& find_figure(std::list<Figure>& figures, const std::string& name) {
+	for (auto& figure : figures) {
+		if (figure.name == name) { return figure; }
+	}
+	std::abort();
+}
+
+// Frame times are taken from when the presented frame count changes, polled at a much higher rate than the frame rate.
+std::vector<double> sample_frame_times_ms(double duration_seconds, const std::function<void(double progress)>& update) {
+	std::vector<double> frame_times_ms;
+	
+	wait_for_frames(1);
+	uint64_t last_number_of_frames = toucan_context_ptr->number_of_presented_frames;
+	auto last_frame_time = BenchmarkClock::now();
+	const auto start = last_frame_time;
+	
+	double elapsed_seconds = 0.0;
+	while (elapsed_seconds < duration_seconds) {
+		update(elapsed_seconds / duration_seconds);
+		
+		const uint64_t number_of_frames = toucan_context_ptr->number_of_presented_frames;
+		if (number_of_frames != last_number_of_frames) {
+			const auto frame_time = BenchmarkClock::now();
+			const double frame_time_ms = std::chrono::duration<double, std::milli>(frame_time - last_frame_time).count() / static_cast<double>(number_of_frames - last_number_of_frames);
+			frame_times_ms.insert(frame_times_ms.end(), number_of_frames - last_number_of_frames, frame_time_ms);
+			
+			last_number_of_frames = number_of_frames;
+			last_frame_time = frame_time;
+		} else {
+			std::this_thread::sleep_for(std::chrono::microseconds(50));
+		}
+		
+		elapsed_seconds = milliseconds_since(start) / 1000.0;
+	}
+	
+	return frame_times_ms;
+}
+
+BenchmarkResult create_result(const std::string& name, const std::vector<std::pair<std::string, std::string>>& parameters, const Toucan::Vector2i& framebuffer_size, std::vector<double>& frame_times_ms) {
+	BenchmarkResult result;
+	result.name = name;
+	result.parameters = parameters;
+	result.parameters.emplace_back("framebuffer_size", std::to_string(framebuffer_size.x()) + "x" + std::to_string(framebuffer_size.y()));
+	
+	double total_time_ms = 0.0;
+	for (const double frame_time_ms : frame_times_ms) { total_time_ms += frame_time_ms; }
+	
+	result.metrics.emplace_back("frames", static_cast<double>(frame_times_ms.size()));
+	result.metrics.emplace_back("frames_per_second", 1000.0*static_cast<double>(frame_times_ms.size()) / total_time_ms);
+	add_latency_metrics(result, summarize_latencies(frame_times_ms), "frame_ms");
+	return result;
+}
+
+void benchmark_figure_3d(const RenderBenchmarkSettings& settings, std::vector<BenchmarkResult>& results) {
+	std::vector<Toucan::Point3D> points(settings.number_of_points);
+	for (size_t i = 0; i < points.size(); ++i) {
+		const Toucan::Vector3f position(get_pseudo_random(3*i), get_pseudo_random(3*i + 1), get_pseudo_random(3*i + 2));
+		points[i] = Toucan::Point3D(position, Toucan::Color(position.x(), position.y(), position.z()), 2.0f, Toucan::PointShape::Square);
+	}
+	
+	std::vector<Toucan::Primitive3D> primitives(settings.number_of_primitives);
+	for (size_t i = 0; i < primitives.size(); ++i) {
+		const Toucan::Vector3f position(get_pseudo_random(3*i + 7), get_pseudo_random(3*i + 8), get_pseudo_random(3*i + 9));
+		primitives[i] = Toucan::Primitive3D(static_cast<Toucan::PrimitiveType>(i % 3), Toucan::ScaledTransform3Df(Toucan::Quaternionf::Identity(), position, 0.005f*Toucan::Vector3f::Ones()), Toucan::Color::Blue());
+	}
+	
+	std::vector<Toucan::LineVertex3D> line_strip(settings.line_strip_length);
+	
+	Toucan::BeginFigure3D(figure_3d_name);
+	Toucan::ShowPoints3D("Points", points);
+	Toucan::ShowPrimitives3D("Primitives", primitives);
+	for (size_t strip_index = 0; strip_index < settings.number_of_line_strips; ++strip_index) {
+		const float height = static_cast<float>(strip_index) / static_cast<float>(settings.number_of_line_strips);
+		for (size_t vertex_index = 0; vertex_index < line_strip.size(); ++vertex_index) {
+			const float angle = 6.2831853f * static_cast<float>(vertex_index) / static_cast<float>(line_strip.size());
+			line_strip[vertex_index] = Toucan::LineVertex3D(Toucan::Vector3f(0.5f + 0.5f*std::cos(angle), 0.5f + 0.5f*std::sin(angle), height), Toucan::Color::Green());
+		}
+		Toucan::ShowLines3D("Line strip " + std::to_string(strip_index), line_strip);
+	}
+	Toucan::EndFigure3D();
+	
+	wait_for_frames(warm_up_frames);
+	
+	const std::vector<std::pair<std::string, std::string>> parameters = {
+			{"points", std::to_string(settings.number_of_points)},
+			{"primitives", std::to_string(settings.number_of_primitives)},
+			{"line_strips", std::to_string(settings.number_of_line_strips)},
+			{"line_strip_length", std::to_string(settings.line_strip_length)}
+	};
+	
+	Toucan::Figure3D& figure_3d = find_figure(toucan_context_ptr->figures_3d, figure_3d_name);
+	const auto set_orbit_per_frame = [&figure_3d](const Toucan::Vector2f& orbit_per_frame) {
+		std::lock_guard lock(figure_3d.mutex);
+		figure_3d.orbit_per_frame = orbit_per_frame;
+	};
+	const auto get_framebuffer_size = [&figure_3d]() {
+		std::lock_guard lock(figure_3d.mutex);
+		return figure_3d.framebuffer_size;
+	};
+	
+	set_orbit_per_frame(Toucan::Vector2f(0.01f, 0.0f));
+	wait_for_frames(warm_up_frames);
+	std::vector<double> orbiting_frame_times_ms = sample_frame_times_ms(settings.duration_seconds, [](double) { });
+	results.emplace_back(create_result("figure_3d_orbiting", parameters, get_framebuffer_size(), orbiting_frame_times_ms));
+	
+	set_orbit_per_frame(Toucan::Vector2f::Zero());
+	wait_for_frames(warm_up_frames);
+	std::vector<double> static_frame_times_ms = sample_frame_times_ms(settings.duration_seconds, [](double) { });
+	results.emplace_back(create_result("figure_3d_static", parameters, get_framebuffer_size(), static_frame_times_ms));
+}
+
+void benchmark_figure_2d(const RenderBenchmarkSettings& settings, std::vector<BenchmarkResult>& results) {
+	std::vector<Toucan::Vector2f> line_plot(settings.line_plot_length);
+	
+	const size_t number_of_pixels = static_cast<size_t>(settings.image_size)*static_cast<size_t>(settings.image_size);
+	std::vector<uint8_t> image(3*number_of_pixels);
+	for (size_t i = 0; i < image.size(); ++i) {
+		image[i] = static_cast<uint8_t>(i * 2654435761u >> 24u);
+	}
+	
+	Toucan::BeginFigure2D(figure_2d_name);
+	Toucan::ShowImage2D("Image", Toucan::Image2D(image.data(), settings.image_size, settings.image_size, Toucan::ImageFormat::RGB_U8), 0);
+	for (size_t plot_index = 0; plot_index < settings.number_of_line_plots; ++plot_index) {
+		for (size_t value_index = 0; value_index < line_plot.size(); ++value_index) {
+			const float x = static_cast<float>(settings.image_size) * static_cast<float>(value_index) / static_cast<float>(line_plot.size());
+			const float y = static_cast<float>(settings.image_size) * (static_cast<float>(plot_index) + get_pseudo_random(value_index + plot_index)) / static_cast<float>(settings.number_of_line_plots);
+			line_plot[value_index] = Toucan::Vector2f(x, y);
+		}
+		Toucan::ShowLinePlot2D("Line plot " + std::to_string(plot_index), line_plot, 1);
+	}
+	Toucan::EndFigure2D();
+	
+	wait_for_frames(warm_up_frames);
+	
+	const std::vector<std::pair<std::string, std::string>> parameters = {
+			{"line_plots", std::to_string(settings.number_of_line_plots)},
+			{"line_plot_length", std::to_string(settings.line_plot_length)},
+			{"image_size", std::to_string(settings.image_size)}
+	};
+	
+	Toucan::Figure2D& figure_2d = find_figure(toucan_context_ptr->figures_2d, figure_2d_name);
+	const auto set_pan_per_frame = [&figure_2d](const Toucan::Vector2f& pan_per_frame) {
+		std::lock_guard lock(figure_2d.mutex);
+		figure_2d.pan_per_frame = pan_per_frame;
+	};
+	const auto get_framebuffer_size = [&figure_2d]() {
+		std::lock_guard lock(figure_2d.mutex);
+		return figure_2d.framebuffer_size;
+	};
+	
+	// Pan back and forth, so the data stays in view.
+	const auto pan_back_and_forth = [&set_pan_per_frame](double progress) {
+		set_pan_per_frame(Toucan::Vector2f(std::fmod(progress, 0.2) < 0.1 ? 0.001f : -0.001f, 0.0f));
+	};
+	wait_for_frames(warm_up_frames);
+	std::vector<double> panning_frame_times_ms = sample_frame_times_ms(settings.duration_seconds, pan_back_and_forth);
+	results.emplace_back(create_result("figure_2d_panning", parameters, get_framebuffer_size(), panning_frame_times_ms));
+	
+	set_pan_per_frame(Toucan::Vector2f::Zero());
+	wait_for_frames(warm_up_frames);
+	std::vector<double> static_frame_times_ms = sample_frame_times_ms(settings.duration_seconds, [](double) { });
+	results.emplace_back(create_result("figure_2d_static", parameters, get_framebuffer_size(), static_frame_times_ms));
+}
+
+bool parse_option(const char* argument, const char* option, size_t& value) {
+	if (std::strncmp(argument, option, std::strlen(option)) != 0) { return false; }
+	value = std::strtoull(argument + std::strlen(option), nullptr, 10);
+	return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+	RenderBenchmarkSettings settings;
+	for (int argument_index = 1; argument_index < argc; ++argument_index) {
+		const char* argument = argv[argument_index];
+		size_t value = 0;
+		if (parse_option(argument, "--points=", settings.number_of_points)) { continue; }
+		if (parse_option(argument, "--primitives=", settings.number_of_primitives)) { continue; }
+		if (parse_option(argument, "--line-strips=", settings.number_of_line_strips)) { continue; }
+		if (parse_option(argument, "--line-strip-length=", settings.line_strip_length)) { continue; }
+		if (parse_option(argument, "--line-plots=", settings.number_of_line_plots)) { continue; }
+		if (parse_option(argument, "--line-plot-length=", settings.line_plot_length)) { continue; }
+		if (parse_option(argument, "--image-size=", value)) { settings.image_size = static_cast<int>(value); continue; }
+		if (parse_option(argument, "--duration=", value)) { settings.duration_seconds = static_cast<double>(value); continue; }
+	}
+	
+	Toucan::ToucanSettings toucan_settings;
+	toucan_settings.max_frames_per_second = 100'000.0f;
+	Toucan::Initialize(toucan_settings);
+	
+	std::vector<BenchmarkResult> results;
+	benchmark_figure_3d(settings, results);
+	benchmark_figure_2d(settings, results);
+	
+	Toucan::Destroy();
+	
+	print_benchmark_results("render", results);
+	return 0;
+}
@@ -0,0 +1,128 @@
+// Measures how long it takes from `Toucan::Initialize` until the window is ready and the first figure is on screen,
+// and how long the render assets take to create.
+//
+// Runs headless on a software renderer, e.g:
+//     LIBGL_ALWAYS_SOFTWARE=1 xvfb-run -a ./Toucan_startup_benchmark
+
+#include <Toucan/Toucan.h>
+
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "internal.h"
+#include "asset.h"
+#include "gl/geometry.h"
+#include "gl/shader.h"
+
+#include "benchmark_common.h"
+
+extern Toucan::ToucanContext* toucan_context_ptr;
+
+namespace {
+
+using Measurements = std::vector<std::pair<std::string, double>>;
+
+void wait_for_presented_frames(uint64_t number_of_frames) {
+	while (toucan_context_ptr->number_of_presented_frames < number_of_frames) {
+		std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+}
+
+double time_asset(const std::function<void()>& create_asset) {
+	const auto start = BenchmarkClock::now();
+	create_asset();
+	glFinish();
+	return milliseconds_since(start);
+}
+
+// Asset creation is measured in a context of its own, as the render thread owns the context of the Toucan window.
+void measure_asset_creation(Measurements& measurements) {
+	if (glfwInit() != GLFW_TRUE) { throw std::runtime_error("Unable to initialize GLFW."); }
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	
+	GLFWwindow* window_ptr = glfwCreateWindow(64, 64, "Toucan startup benchmark", nullptr, nullptr);
+	if (window_ptr == nullptr) { throw std::runtime_error("Unable to create GLFW window."); }
+	glfwMakeContextCurrent(window_ptr);
+	if (not gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress))) { throw std::runtime_error("Unable to load OpenGL."); }
+	
+	measurements.emplace_back("generate_axis", time_asset([]() { generate_axis(); }));
+	measurements.emplace_back("generate_quad", time_asset([]() { generate_quad(); }));
+	measurements.emplace_back("generate_sphere", time_asset([]() { generate_sphere(); }));
+	measurements.emplace_back("generate_cube", time_asset([]() { generate_cube(); }));
+	measurements.emplace_back("generate_cylinder", time_asset([]() { generate_cylinder(); }));
+	
+	// Drivers may cache compiled shaders themselves, so only the first compilation of each program is comparable between runs.
+	AssetContext lazy_context = {};
+	measurements.emplace_back("lineplot_2d_shader", time_asset([&]() { get_lineplot_2d_shader(&lazy_context); }));
+	measurements.emplace_back("point_2d_shader", time_asset([&]() { get_point_2d_shader(&lazy_context); }));
+	measurements.emplace_back("image_2d_shader", time_asset([&]() { get_image_2d_shader(&lazy_context); }));
+	measurements.emplace_back("image_2d_uint_shader", time_asset([&]() { get_image_2d_uint_shader(&lazy_context); }));
+	measurements.emplace_back("point_3d_shader", time_asset([&]() { get_point_3d_shader(&lazy_context); }));
+	measurements.emplace_back("depth_image_3d_shader", time_asset([&]() { get_depth_image_3d_shader(&lazy_context); }));
+	measurements.emplace_back("line_3d_shader", time_asset([&]() { get_line_3d_shader(&lazy_context); }));
+	measurements.emplace_back("mesh_3d_shader", time_asset([&]() { get_mesh_3d_shader(&lazy_context); }));
+	measurements.emplace_back("text_3d_shader", time_asset([&]() { get_text_3d_shader(&lazy_context); }));
+	
+	AssetContext warm_up_context = {};
+	measurements.emplace_back("warm_up_shader_programs", time_asset([&]() { warm_up_shader_programs(&warm_up_context); }));
+	
+	glfwDestroyWindow(window_ptr);
+	glfwTerminate();
+}
+
+void measure_first_frame(Measurements& measurements) {
+	Toucan::ToucanSettings settings;
+	settings.max_frames_per_second = 1000.0f;
+	
+	const auto start = BenchmarkClock::now();
+	Toucan::Initialize(settings);
+	measurements.emplace_back("initialize", milliseconds_since(start));
+	
+	wait_for_presented_frames(1);
+	measurements.emplace_back("first_frame", milliseconds_since(start));
+	
+	std::vector<Toucan::Point3D> points;
+	for (int point_index = 0; point_index < 1000; ++point_index) {
+		const float t = static_cast<float>(point_index) / 1000.0f;
+		points.emplace_back(Toucan::Vector3f(t, t*t, 1.0f - t), Toucan::Color::White(), 4.0f, Toucan::PointShape::Circle);
+	}
+	
+	Toucan::BeginFigure3D("Startup benchmark");
+	Toucan::ShowAxis3D("Axis");
+	Toucan::ShowPoints3D("Points", points);
+	Toucan::ShowPrimitives3D("Sphere", Toucan::Primitive3D(Toucan::PrimitiveType::Sphere, Toucan::ScaledTransform3Df(), Toucan::Color::Red()));
+	Toucan::EndFigure3D();
+	
+	// A frame that started after `EndFigure3D` returned draws the figure.
+	const uint64_t number_of_started_frames = toucan_context_ptr->number_of_started_frames;
+	measurements.emplace_back("end_figure_3d", milliseconds_since(start));
+	
+	wait_for_presented_frames(number_of_started_frames + 1);
+	measurements.emplace_back("first_figure_3d_frame", milliseconds_since(start));
+	
+	Toucan::Destroy();
+}
+
+} // namespace
+
+int main() {
+	Measurements measurements;
+	measure_asset_creation(measurements);
+	measure_first_frame(measurements);
+	
+	std::vector<BenchmarkResult> results;
+	for (const auto& [name, milliseconds] : measurements) {
+		results.push_back({name, {}, {{"time_ms", milliseconds}}});
+	}
+	print_benchmark_results("startup", results);
+	
+	return 0;
+}
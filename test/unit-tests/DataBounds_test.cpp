@@ -0,0 +1,67 @@
+#include <catch2/catch.hpp>
+
+#include "util/data_bounds.h"
+
+#include <limits>
+#include <vector>
+
+namespace {
+
+constexpr float nan_value = std::numeric_limits<float>::quiet_NaN();
+
+bool is_rectangle(const Toucan::Rectangle& rectangle, float min_x, float min_y, float max_x, float max_y) {
+	return rectangle.min.x() == min_x and rectangle.min.y() == min_y and rectangle.max.x() == max_x and rectangle.max.y() == max_y;
+}
+
+} // namespace
+
+TEST_CASE("Data bounds", "[data_bounds]") {
+	
+	SECTION("Vector2f") {
+		std::vector<Toucan::Vector2f> points;
+		for (int point_index = 0; point_index < 37; ++point_index) {
+			points.emplace_back(static_cast<float>(point_index % 7) - 3.0f, static_cast<float>(point_index) * 0.5f);
+		}
+		REQUIRE(is_rectangle(Toucan::compute_data_bounds(points.data(), static_cast<int>(points.size())), -3.0f, 0.0f, 3.0f, 18.0f));
+	}
+	
+	SECTION("Point2D") {
+		std::vector<Toucan::Point2D> points(37);
+		for (int point_index = 0; point_index < 37; ++point_index) {
+			points[static_cast<size_t>(point_index)].position = Toucan::Vector2f(static_cast<float>(point_index % 7) - 3.0f, static_cast<float>(point_index) * 0.5f);
+		}
+		REQUIRE(is_rectangle(Toucan::compute_data_bounds(points.data(), static_cast<int>(points.size())), -3.0f, 0.0f, 3.0f, 18.0f));
+	}
+	
+	SECTION("No points") {
+		REQUIRE(is_rectangle(Toucan::compute_data_bounds(static_cast<const Toucan::Vector2f*>(nullptr), 0), 0.0f, 0.0f, 0.0f, 0.0f));
+	}
+}
+
+// A SIMD block of only NaN points leaves its lanes at +/- infinity, which must not widen the bounds.
+TEST_CASE("Data bounds ignore blocks of only NaN points", "[data_bounds]") {
+	
+	SECTION("Vector2f") {
+		for (int number_of_nan_points : {4, 8, 16}) {
+			std::vector<Toucan::Vector2f> points(static_cast<size_t>(number_of_nan_points), Toucan::Vector2f(nan_value, nan_value));
+			points.emplace_back(1.0f, 2.0f);
+			points.emplace_back(-1.0f, 0.5f);
+			REQUIRE(is_rectangle(Toucan::compute_data_bounds(points.data(), static_cast<int>(points.size())), -1.0f, 0.5f, 1.0f, 2.0f));
+		}
+	}
+	
+	SECTION("Point2D") {
+		std::vector<Toucan::Point2D> points(4);
+		for (auto& point : points) {
+			point.position = Toucan::Vector2f(nan_value, nan_value);
+		}
+		points.emplace_back(Toucan::Vector2f(1.0f, 2.0f), Toucan::Color::White(), 8.0f, Toucan::PointShape::Circle);
+		points.emplace_back(Toucan::Vector2f(-1.0f, 0.5f), Toucan::Color::White(), 8.0f, Toucan::PointShape::Circle);
+		REQUIRE(is_rectangle(Toucan::compute_data_bounds(points.data(), static_cast<int>(points.size())), -1.0f, 0.5f, 1.0f, 2.0f));
+	}
+	
+	SECTION("Only NaN points") {
+		const std::vector<Toucan::Vector2f> points(8, Toucan::Vector2f(nan_value, nan_value));
+		REQUIRE(is_rectangle(Toucan::compute_data_bounds(points.data(), static_cast<int>(points.size())), 0.0f, 0.0f, 0.0f, 0.0f));
+	}
+}
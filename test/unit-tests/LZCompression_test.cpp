@@ -0,0 +1,123 @@
+#include <catch2/catch.hpp>
+
+#include "util/lz_compression.h"
+
+#include <random>
+#include <vector>
+
+namespace {
+
+std::vector<uint8_t> compress(const std::vector<uint8_t>& data) {
+	std::vector<uint8_t> compressed(Toucan::get_lz_compress_bound(data.size()));
+	compressed.resize(Toucan::lz_compress(data.data(), data.size(), compressed.data()));
+	return compressed;
+}
+
+bool decompress(const std::vector<uint8_t>& compressed, size_t decompressed_size, std::vector<uint8_t>& data) {
+	data.assign(decompressed_size, 0);
+	return Toucan::lz_decompress(compressed.data(), compressed.size(), data.data(), data.size());
+}
+
+std::vector<uint8_t> get_random_bytes(size_t size, unsigned int seed) {
+	std::mt19937 generator(seed);
+	std::uniform_int_distribution<int> distribution(0, 255);
+	std::vector<uint8_t> data(size);
+	for (auto& byte : data) { byte = static_cast<uint8_t>(distribution(generator)); }
+	return data;
+}
+
+// Runs of a few distinct bytes, with matches both near and far back.
+std::vector<uint8_t> get_compressible_bytes(size_t size, unsigned int seed) {
+	std::mt19937 generator(seed);
+	std::uniform_int_distribution<int> run_length_distribution(1, 300);
+	std::uniform_int_distribution<int> value_distribution(0, 3);
+	std::vector<uint8_t> data;
+	while (data.size() < size) {
+		data.insert(data.end(), static_cast<size_t>(run_length_distribution(generator)), static_cast<uint8_t>(value_distribution(generator)));
+	}
+	data.resize(size);
+	return data;
+}
+
+} // namespace
+
+TEST_CASE("LZ compression round trip", "[lz_compression]") {
+	std::vector<uint8_t> decompressed;
+	
+	SECTION("Empty and single byte") {
+		for (size_t size = 0; size <= 1; ++size) {
+			const std::vector<uint8_t> data(size, 42);
+			const std::vector<uint8_t> compressed = compress(data);
+			REQUIRE(compressed.size() <= Toucan::get_lz_compress_bound(data.size()));
+			REQUIRE(decompress(compressed, data.size(), decompressed));
+			REQUIRE(decompressed == data);
+		}
+	}
+	
+	SECTION("Sizes around the end of stream margins") {
+		for (size_t size = 2; size <= 64; ++size) {
+			const std::vector<uint8_t> data = get_compressible_bytes(size, static_cast<unsigned int>(size));
+			REQUIRE(decompress(compress(data), data.size(), decompressed));
+			REQUIRE(decompressed == data);
+		}
+	}
+	
+	SECTION("Compressible") {
+		const std::vector<uint8_t> data = get_compressible_bytes(size_t(1) << 20u, 1);
+		const std::vector<uint8_t> compressed = compress(data);
+		REQUIRE(compressed.size() < data.size()/10);
+		REQUIRE(decompress(compressed, data.size(), decompressed));
+		REQUIRE(decompressed == data);
+	}
+	
+	SECTION("Long literal runs and matches") {
+		std::vector<uint8_t> data = get_random_bytes(100000, 2);
+		data.insert(data.end(), 100000, 7); // A match longer than the 15 + 255 of one length byte.
+		const std::vector<uint8_t> tail = get_random_bytes(70000, 3); // Repeated beyond the largest match offset.
+		data.insert(data.end(), tail.begin(), tail.end());
+		data.insert(data.end(), tail.begin(), tail.end());
+		REQUIRE(decompress(compress(data), data.size(), decompressed));
+		REQUIRE(decompressed == data);
+	}
+	
+	SECTION("Incompressible") {
+		const std::vector<uint8_t> data = get_random_bytes(size_t(1) << 20u, 4);
+		const std::vector<uint8_t> compressed = compress(data);
+		REQUIRE(compressed.size() <= Toucan::get_lz_compress_bound(data.size()));
+		REQUIRE(decompress(compressed, data.size(), decompressed));
+		REQUIRE(decompressed == data);
+	}
+}
+
+TEST_CASE("LZ decompression rejects corrupt data", "[lz_compression]") {
+	const std::vector<uint8_t> data = get_compressible_bytes(10000, 5);
+	const std::vector<uint8_t> compressed = compress(data);
+	std::vector<uint8_t> decompressed;
+	
+	SECTION("Wrong decompressed size") {
+		REQUIRE_FALSE(decompress(compressed, data.size() - 1, decompressed));
+		REQUIRE_FALSE(decompress(compressed, data.size() + 1, decompressed));
+	}
+	
+	SECTION("Truncated") {
+		for (size_t size : {compressed.size() - 1, compressed.size()/2, size_t(1)}) {
+			const std::vector<uint8_t> truncated(compressed.begin(), compressed.begin() + static_cast<ptrdiff_t>(size));
+			REQUIRE_FALSE(decompress(truncated, data.size(), decompressed));
+		}
+	}
+	
+	SECTION("Match offsets outside of the output") {
+		// One literal, then a match of four bytes at the offset.
+		REQUIRE_FALSE(decompress({0x10, 'a', 0x00, 0x00, 0x00}, 5, decompressed)); // Offset 0
+		REQUIRE_FALSE(decompress({0x10, 'a', 0x02, 0x00, 0x00}, 5, decompressed)); // Before the start of the output
+		REQUIRE(decompress({0x10, 'a', 0x01, 0x00, 0x00}, 5, decompressed));
+		REQUIRE(decompressed == std::vector<uint8_t>(5, 'a'));
+	}
+	
+	SECTION("Lengths past the end of the data") {
+		REQUIRE_FALSE(decompress({0xF0}, 20, decompressed)); // Missing literal length byte
+		REQUIRE_FALSE(decompress({0x30, 'a', 'b'}, 3, decompressed)); // Three literals, two present
+		REQUIRE_FALSE(decompress({0x1F, 'a', 0x01, 0x00}, 300, decompressed)); // Missing match length byte
+		REQUIRE_FALSE(decompress({0x1F, 'a', 0x01, 0x00, 0xFF, 0x00}, 100, decompressed)); // Match longer than the output
+	}
+}
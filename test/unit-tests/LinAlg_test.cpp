@@ -4,6 +4,8 @@
 
 #include <iostream>
 #include <cmath>
+#include <random>
+#include <vector>
 
 #include <Eigen/Core>
 #include <Eigen/Geometry>
@@ -684,3 +686,238 @@ TEMPLATE_TEST_CASE("Scaled Transform 3D inverse", "", float, double) {
 	REQUIRE(identity_2(3, 3) == Approx(1));
 	
 }
+
+// The float operators use SIMD kernels when available. They are compared to the generic double implementation, and to the generic float implementation
+// through constant evaluation where the operator allows it.
+TEST_CASE("Matrix4f SIMD kernels", "[matrix][simd]") {
+	std::mt19937 random_engine(42);
+	std::uniform_real_distribution<float> distribution(-10.0f, 10.0f);
+	
+	constexpr double eps = 1e-5;
+	constexpr int number_of_iterations = 100;
+	
+	const auto random_matrix = [&]() {
+		Toucan::Matrix4f matrix;
+		for (int row_index = 0; row_index < 4; ++row_index) {
+			for (int column_index = 0; column_index < 4; ++column_index) {
+				matrix(row_index, column_index) = distribution(random_engine);
+			}
+		}
+		return matrix;
+	};
+	
+	const auto to_double = [](const Toucan::Matrix4f& matrix) {
+		Toucan::Matrix4d matrix_double;
+		for (int row_index = 0; row_index < 4; ++row_index) {
+			for (int column_index = 0; column_index < 4; ++column_index) {
+				matrix_double(row_index, column_index) = matrix(row_index, column_index);
+			}
+		}
+		return matrix_double;
+	};
+	
+	SECTION("Matrix-Matrix product") {
+		for (int iteration = 0; iteration < number_of_iterations; ++iteration) {
+			const Toucan::Matrix4f lhs = random_matrix();
+			const Toucan::Matrix4f rhs = random_matrix();
+			
+			const Toucan::Matrix4f product = lhs * rhs;
+			const Toucan::Matrix4d product_double = to_double(lhs) * to_double(rhs);
+			for (int row_index = 0; row_index < 4; ++row_index) {
+				for (int column_index = 0; column_index < 4; ++column_index) {
+					REQUIRE(product(row_index, column_index) == Approx(product_double(row_index, column_index)).epsilon(eps).margin(eps));
+				}
+			}
+		}
+	}
+	
+	SECTION("Matrix-Vector product") {
+		for (int iteration = 0; iteration < number_of_iterations; ++iteration) {
+			const Toucan::Matrix4f matrix = random_matrix();
+			const Toucan::Vector4f v(distribution(random_engine), distribution(random_engine), distribution(random_engine), distribution(random_engine));
+			
+			const Toucan::Vector4f product = matrix * v;
+			const Toucan::Vector4d product_double = to_double(matrix) * Toucan::Vector4d(v(0), v(1), v(2), v(3));
+			for (int row_index = 0; row_index < 4; ++row_index) {
+				REQUIRE(product(row_index) == Approx(product_double(row_index)).epsilon(eps).margin(eps));
+			}
+		}
+	}
+}
+
+TEST_CASE("Quaternionf SIMD kernels", "[quaternion][simd]") {
+	std::mt19937 random_engine(42);
+	std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+	
+	constexpr double eps = 1e-5;
+	constexpr int number_of_iterations = 100;
+	
+	const auto random_quaternion = [&]() {
+		Toucan::Quaternionf q(distribution(random_engine), distribution(random_engine), distribution(random_engine), distribution(random_engine));
+		q.normalize();
+		return q;
+	};
+	const auto random_vector = [&]() {
+		return Toucan::Vector3f(distribution(random_engine), distribution(random_engine), distribution(random_engine));
+	};
+	const auto to_double = [](const Toucan::Quaternionf& q) { return Toucan::Quaterniond(q.w, q.x, q.y, q.z); };
+	const auto to_double_vector = [](const Toucan::Vector3f& v) { return Toucan::Vector3d(v.x(), v.y(), v.z()); };
+	
+	SECTION("Quaternion-Quaternion composition, constant evaluated") {
+		constexpr Toucan::Quaternionf q1(0.6038293f, 0.4041198f, 0.2020603f, 0.6566956f);
+		constexpr Toucan::Quaternionf q2(0.4216791f, -0.7779157f, 0.4618878f, 0.0607746f);
+		constexpr Toucan::Quaternionf q_1_2_constant = q1*q2;
+		
+		const Toucan::Quaternionf q1_runtime = q1;
+		const Toucan::Quaternionf q2_runtime = q2;
+		const Toucan::Quaternionf q_1_2 = q1_runtime*q2_runtime;
+		
+		REQUIRE(q_1_2.w == q_1_2_constant.w);
+		REQUIRE(q_1_2.x == q_1_2_constant.x);
+		REQUIRE(q_1_2.y == q_1_2_constant.y);
+		REQUIRE(q_1_2.z == q_1_2_constant.z);
+	}
+	
+	SECTION("Quaternion-Quaternion composition") {
+		for (int iteration = 0; iteration < number_of_iterations; ++iteration) {
+			const Toucan::Quaternionf q1 = random_quaternion();
+			const Toucan::Quaternionf q2 = random_quaternion();
+			
+			const Toucan::Quaternionf q_1_2 = q1*q2;
+			const Toucan::Quaterniond q_1_2_double = to_double(q1)*to_double(q2);
+			REQUIRE(q_1_2.w == Approx(q_1_2_double.w).epsilon(eps).margin(eps));
+			REQUIRE(q_1_2.x == Approx(q_1_2_double.x).epsilon(eps).margin(eps));
+			REQUIRE(q_1_2.y == Approx(q_1_2_double.y).epsilon(eps).margin(eps));
+			REQUIRE(q_1_2.z == Approx(q_1_2_double.z).epsilon(eps).margin(eps));
+		}
+	}
+	
+	SECTION("Quaternion-Point composition") {
+		for (int iteration = 0; iteration < number_of_iterations; ++iteration) {
+			const Toucan::Quaternionf q = random_quaternion();
+			const Toucan::Vector3f p = random_vector();
+			
+			const Toucan::Vector3f rotated = q*p;
+			const Toucan::Vector3d rotated_double = to_double(q)*to_double_vector(p);
+			REQUIRE(rotated.x() == Approx(rotated_double.x()).epsilon(eps).margin(eps));
+			REQUIRE(rotated.y() == Approx(rotated_double.y()).epsilon(eps).margin(eps));
+			REQUIRE(rotated.z() == Approx(rotated_double.z()).epsilon(eps).margin(eps));
+		}
+	}
+	
+	SECTION("Rigid Transform composition") {
+		for (int iteration = 0; iteration < number_of_iterations; ++iteration) {
+			const Toucan::RigidTransform3Df t1(random_quaternion(), random_vector());
+			const Toucan::RigidTransform3Df t2(random_quaternion(), random_vector());
+			
+			const Toucan::RigidTransform3Df t_1_2 = t1 * t2;
+			const Toucan::RigidTransform3Dd t_1_2_double =
+					Toucan::RigidTransform3Dd(to_double(t1.orientation), to_double_vector(t1.translation)) *
+					Toucan::RigidTransform3Dd(to_double(t2.orientation), to_double_vector(t2.translation));
+			REQUIRE(t_1_2.orientation.w == Approx(t_1_2_double.orientation.w).epsilon(eps).margin(eps));
+			REQUIRE(t_1_2.orientation.x == Approx(t_1_2_double.orientation.x).epsilon(eps).margin(eps));
+			REQUIRE(t_1_2.orientation.y == Approx(t_1_2_double.orientation.y).epsilon(eps).margin(eps));
+			REQUIRE(t_1_2.orientation.z == Approx(t_1_2_double.orientation.z).epsilon(eps).margin(eps));
+			REQUIRE(t_1_2.translation.x() == Approx(t_1_2_double.translation.x()).epsilon(eps).margin(eps));
+			REQUIRE(t_1_2.translation.y() == Approx(t_1_2_double.translation.y()).epsilon(eps).margin(eps));
+			REQUIRE(t_1_2.translation.z() == Approx(t_1_2_double.translation.z()).epsilon(eps).margin(eps));
+		}
+	}
+}
+
+TEMPLATE_TEST_CASE("Batch point transforms", "[transform]", float, double) {
+	std::mt19937 random_engine(42);
+	std::uniform_real_distribution<TestType> distribution(-10, 10);
+	
+	constexpr double eps = 1e-5;
+	constexpr size_t number_of_points = 23; // Not a multiple of the SIMD block size, so the remaining points are also tested.
+	
+	Toucan::Quaternion<TestType> orientation(distribution(random_engine), distribution(random_engine), distribution(random_engine), distribution(random_engine));
+	orientation.normalize();
+	const Toucan::Vector3<TestType> translation_3d(distribution(random_engine), distribution(random_engine), distribution(random_engine));
+	const Toucan::Vector3<TestType> scale_3d(2, -0.5, 3);
+	const TestType rotation = distribution(random_engine);
+	const Toucan::Vector2<TestType> translation_2d(distribution(random_engine), distribution(random_engine));
+	const Toucan::Vector2<TestType> scale_2d(-2, 0.5);
+	
+	std::vector<Toucan::Vector3<TestType>> points_3d(number_of_points);
+	std::vector<Toucan::Vector2<TestType>> points_2d(number_of_points);
+	for (size_t point_index = 0; point_index < number_of_points; ++point_index) {
+		points_3d[point_index] = Toucan::Vector3<TestType>(distribution(random_engine), distribution(random_engine), distribution(random_engine));
+		points_2d[point_index] = Toucan::Vector2<TestType>(distribution(random_engine), distribution(random_engine));
+	}
+	
+	const auto require_equal_3d = [&](const std::vector<Toucan::Vector3<TestType>>& result, const auto& transform) {
+		for (size_t point_index = 0; point_index < number_of_points; ++point_index) {
+			const Toucan::Vector3<TestType> expected = transform * points_3d[point_index];
+			REQUIRE(result[point_index].x() == Approx(expected.x()).epsilon(eps).margin(eps));
+			REQUIRE(result[point_index].y() == Approx(expected.y()).epsilon(eps).margin(eps));
+			REQUIRE(result[point_index].z() == Approx(expected.z()).epsilon(eps).margin(eps));
+		}
+	};
+	
+	const auto require_equal_2d = [&](const std::vector<Toucan::Vector2<TestType>>& result, const auto& transform) {
+		for (size_t point_index = 0; point_index < number_of_points; ++point_index) {
+			const Toucan::Vector2<TestType> expected = transform * points_2d[point_index];
+			REQUIRE(result[point_index].x() == Approx(expected.x()).epsilon(eps).margin(eps));
+			REQUIRE(result[point_index].y() == Approx(expected.y()).epsilon(eps).margin(eps));
+		}
+	};
+	
+	SECTION("Rigid Transform 3D") {
+		const Toucan::RigidTransform3D<TestType> rigid_transform(orientation, translation_3d);
+		std::vector<Toucan::Vector3<TestType>> result(number_of_points);
+		Toucan::transform_points(rigid_transform, points_3d.data(), number_of_points, result.data());
+		require_equal_3d(result, rigid_transform);
+	}
+	
+	SECTION("Scaled Transform 3D") {
+		const Toucan::ScaledTransform3D<TestType> scaled_transform(orientation, translation_3d, scale_3d);
+		std::vector<Toucan::Vector3<TestType>> result(number_of_points);
+		Toucan::transform_points(scaled_transform, points_3d.data(), number_of_points, result.data());
+		require_equal_3d(result, scaled_transform);
+	}
+	
+	SECTION("Rigid Transform 2D") {
+		const Toucan::RigidTransform2D<TestType> rigid_transform(rotation, translation_2d);
+		std::vector<Toucan::Vector2<TestType>> result(number_of_points);
+		Toucan::transform_points(rigid_transform, points_2d.data(), number_of_points, result.data());
+		require_equal_2d(result, rigid_transform);
+	}
+	
+	SECTION("Scaled Transform 2D") {
+		const Toucan::ScaledTransform2D<TestType> scaled_transform(rotation, translation_2d, scale_2d);
+		std::vector<Toucan::Vector2<TestType>> result(number_of_points);
+		Toucan::transform_points(scaled_transform, points_2d.data(), number_of_points, result.data());
+		require_equal_2d(result, scaled_transform);
+	}
+	
+	SECTION("In place") {
+		const Toucan::RigidTransform3D<TestType> rigid_transform(orientation, translation_3d);
+		std::vector<Toucan::Vector3<TestType>> result = points_3d;
+		Toucan::transform_points(rigid_transform, result.data(), number_of_points, result.data());
+		require_equal_3d(result, rigid_transform);
+	}
+	
+	SECTION("Strided") {
+		struct Point {
+			Toucan::Vector3<TestType> position;
+			int id;
+		};
+		
+		std::vector<Point> strided_points(number_of_points);
+		for (size_t point_index = 0; point_index < number_of_points; ++point_index) {
+			strided_points[point_index] = {points_3d[point_index], static_cast<int>(point_index)};
+		}
+		
+		const Toucan::ScaledTransform3D<TestType> scaled_transform(orientation, translation_3d, scale_3d);
+		Toucan::transform_points(scaled_transform, &strided_points.front().position, number_of_points, &strided_points.front().position, sizeof(Point));
+		
+		std::vector<Toucan::Vector3<TestType>> result(number_of_points);
+		for (size_t point_index = 0; point_index < number_of_points; ++point_index) {
+			REQUIRE(strided_points[point_index].id == static_cast<int>(point_index));
+			result[point_index] = strided_points[point_index].position;
+		}
+		require_equal_3d(result, scaled_transform);
+	}
+}
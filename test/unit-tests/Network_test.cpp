@@ -0,0 +1,88 @@
+#include <catch2/catch.hpp>
+
+#include "util/network.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+Toucan::NetworkQuantizedPoints get_random_points(size_t number_of_points, unsigned int seed) {
+	std::mt19937 generator(seed);
+	Toucan::NetworkQuantizedPoints points;
+	for (size_t channel_index = 0; channel_index < Toucan::NetworkQuantizedPoints::number_of_channels; ++channel_index) {
+		const size_t channel_size = Toucan::NetworkQuantizedPoints::channel_sizes[channel_index];
+		const uint32_t channel_mask = channel_size == 4 ? 0xFFFFFFFFu : (1u << (8u*channel_size)) - 1u;
+		points.channels[channel_index].resize(number_of_points);
+		for (auto& value : points.channels[channel_index]) { value = static_cast<uint32_t>(generator()) & channel_mask; }
+	}
+	return points;
+}
+
+bool is_equal(const Toucan::NetworkQuantizedPoints& lhs, const Toucan::NetworkQuantizedPoints& rhs) {
+	for (size_t channel_index = 0; channel_index < Toucan::NetworkQuantizedPoints::number_of_channels; ++channel_index) {
+		if (lhs.channels[channel_index] != rhs.channels[channel_index]) { return false; }
+	}
+	return true;
+}
+
+} // namespace
+
+TEST_CASE("Network difference coding", "[network]") {
+	
+	SECTION("Small differences have leading zero bytes") {
+		REQUIRE(Toucan::encode_difference(100, 100, 4) == 0);
+		REQUIRE(Toucan::encode_difference(101, 100, 4) == 2);
+		REQUIRE(Toucan::encode_difference(99, 100, 4) == 1);
+		REQUIRE(Toucan::encode_difference(0, 1, 1) == 1);
+		REQUIRE(Toucan::encode_difference(255, 0, 1) == 1); // Wraps around in the channel size.
+	}
+	
+	SECTION("Round trip") {
+		const uint32_t values[] = {0u, 1u, 2u, 127u, 128u, 255u, 256u, 0x7FFFFFFFu, 0x80000000u, 0xFFFFFFFEu, 0xFFFFFFFFu};
+		for (const size_t channel_size : {size_t(1), size_t(4)}) {
+			const uint32_t channel_mask = channel_size == 4 ? 0xFFFFFFFFu : 0xFFu;
+			for (const uint32_t value : values) {
+				for (const uint32_t reference : values) {
+					const uint32_t encoded_difference = Toucan::encode_difference(value & channel_mask, reference & channel_mask, channel_size);
+					REQUIRE(encoded_difference <= channel_mask);
+					REQUIRE(Toucan::decode_difference(encoded_difference, reference & channel_mask, channel_size) == (value & channel_mask));
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE("Network point planes round trip", "[network]") {
+	Toucan::ThreadPool thread_pool(2);
+	
+	for (const size_t number_of_points : {size_t(0), size_t(1), size_t(100000)}) {
+		const Toucan::NetworkQuantizedPoints points = get_random_points(number_of_points, 1);
+		std::vector<uint8_t> planes(number_of_points*Toucan::NetworkQuantizedPoints::point_size);
+		
+		SECTION("Spatial, " + std::to_string(number_of_points) + " points") {
+			Toucan::write_point_planes(points, nullptr, planes.data(), thread_pool);
+			
+			Toucan::NetworkQuantizedPoints read_points;
+			Toucan::read_point_planes(planes.data(), number_of_points, Toucan::NetworkDeltaMode::Spatial, read_points);
+			REQUIRE(is_equal(read_points, points));
+		}
+		
+		SECTION("Temporal, " + std::to_string(number_of_points) + " points") {
+			const Toucan::NetworkQuantizedPoints previous_points = get_random_points(number_of_points, 2);
+			Toucan::write_point_planes(points, &previous_points, planes.data(), thread_pool);
+			
+			Toucan::NetworkQuantizedPoints read_points = previous_points;
+			Toucan::read_point_planes(planes.data(), number_of_points, Toucan::NetworkDeltaMode::Temporal, read_points);
+			REQUIRE(is_equal(read_points, points));
+		}
+	}
+	
+	SECTION("Unchanged points are all zero") {
+		const Toucan::NetworkQuantizedPoints points = get_random_points(1000, 3);
+		std::vector<uint8_t> planes(1000*Toucan::NetworkQuantizedPoints::point_size, 0xFF);
+		Toucan::write_point_planes(points, &points, planes.data(), thread_pool);
+		REQUIRE(planes == std::vector<uint8_t>(planes.size(), 0));
+	}
+}
@@ -0,0 +1,258 @@
+#include <catch2/catch.hpp>
+
+#include "util/png.h"
+
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// A reference decoder, independent of the encoder. It only supports what the encoder writes: RGBA PNG files with one IDAT chunk, and deflate
+// streams of stored or fixed Huffman blocks. Throws on anything else.
+
+constexpr uint16_t length_bases[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr uint8_t length_extra_bits[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr uint16_t distance_bases[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+constexpr uint8_t distance_extra_bits[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+class BitReader {
+public:
+	BitReader(const uint8_t* data_ptr, size_t size) :
+	data_ptr{data_ptr}, size{size} { }
+	
+	uint32_t read_bits(unsigned int number_of_bits) {
+		uint32_t value = 0;
+		for (unsigned int bit_index = 0; bit_index < number_of_bits; ++bit_index) {
+			if (bit_position/8 >= size) { throw std::runtime_error("Deflate stream ended early."); }
+			value |= static_cast<uint32_t>((data_ptr[bit_position/8] >> (bit_position % 8)) & 1u) << bit_index;
+			++bit_position;
+		}
+		return value;
+	}
+	
+	// Huffman codes are stored most significant bit first.
+	uint32_t read_code(unsigned int number_of_bits) {
+		uint32_t code = 0;
+		for (unsigned int bit_index = 0; bit_index < number_of_bits; ++bit_index) {
+			code = (code << 1u) | read_bits(1);
+		}
+		return code;
+	}
+	
+	void align_to_byte() { bit_position = (bit_position + 7)/8*8; }
+	[[nodiscard]] size_t get_byte_position() const { return bit_position/8; }
+
+private:
+	const uint8_t* data_ptr;
+	size_t size;
+	size_t bit_position = 0;
+};
+
+unsigned int read_fixed_symbol(BitReader& reader) {
+	uint32_t code = reader.read_code(7);
+	if (code <= 0x17u) { return 256 + code; }
+	code = (code << 1u) | reader.read_code(1);
+	if (code >= 0x30u and code <= 0xBFu) { return code - 0x30u; }
+	if (code >= 0xC0u and code <= 0xC7u) { return 280 + code - 0xC0u; }
+	code = (code << 1u) | reader.read_code(1);
+	return 144 + code - 0x190u;
+}
+
+// Returns the number of bytes read.
+size_t inflate(const uint8_t* data_ptr, size_t size, std::vector<uint8_t>& output) {
+	BitReader reader(data_ptr, size);
+	bool final_block = false;
+	while (not final_block) {
+		final_block = reader.read_bits(1) == 1;
+		const uint32_t block_type = reader.read_bits(2);
+		
+		if (block_type == 0) {
+			reader.align_to_byte();
+			const uint32_t length = reader.read_bits(16);
+			const uint32_t inverted_length = reader.read_bits(16);
+			if ((length ^ inverted_length) != 0xFFFFu) { throw std::runtime_error("Corrupt stored block."); }
+			for (uint32_t index = 0; index < length; ++index) { output.push_back(static_cast<uint8_t>(reader.read_bits(8))); }
+		} else if (block_type == 1) {
+			while (true) {
+				const unsigned int symbol = read_fixed_symbol(reader);
+				if (symbol < 256) {
+					output.push_back(static_cast<uint8_t>(symbol));
+					continue;
+				}
+				if (symbol == 256) { break; }
+				if (symbol > 285) { throw std::runtime_error("Invalid length symbol."); }
+				
+				const size_t length = length_bases[symbol - 257] + reader.read_bits(length_extra_bits[symbol - 257]);
+				const uint32_t distance_code = reader.read_code(5);
+				if (distance_code >= 30) { throw std::runtime_error("Invalid distance symbol."); }
+				const size_t distance = distance_bases[distance_code] + reader.read_bits(distance_extra_bits[distance_code]);
+				if (distance > output.size() or distance > 32768) { throw std::runtime_error("Distance before the start of the data."); }
+				for (size_t index = 0; index < length; ++index) { output.push_back(output[output.size() - distance]); }
+			}
+		} else {
+			throw std::runtime_error("Unsupported block type.");
+		}
+	}
+	reader.align_to_byte();
+	return reader.get_byte_position();
+}
+
+uint32_t compute_crc32(const uint8_t* data_ptr, size_t size) {
+	uint32_t crc = 0xFFFFFFFFu;
+	for (size_t index = 0; index < size; ++index) {
+		crc ^= data_ptr[index];
+		for (int bit_index = 0; bit_index < 8; ++bit_index) {
+			crc = (crc & 1u) != 0 ? 0xEDB88320u ^ (crc >> 1u) : crc >> 1u;
+		}
+	}
+	return crc ^ 0xFFFFFFFFu;
+}
+
+uint32_t compute_adler32(const std::vector<uint8_t>& data) {
+	uint32_t a = 1;
+	uint32_t b = 0;
+	for (const uint8_t byte : data) {
+		a = (a + byte) % 65521u;
+		b = (b + a) % 65521u;
+	}
+	return (b << 16u) | a;
+}
+
+uint32_t read_big_endian(const uint8_t* data_ptr) {
+	return (static_cast<uint32_t>(data_ptr[0]) << 24u) | (static_cast<uint32_t>(data_ptr[1]) << 16u) | (static_cast<uint32_t>(data_ptr[2]) << 8u) | data_ptr[3];
+}
+
+// Returns the RGBA pixels, top row first.
+std::vector<uint8_t> decode_png(const std::vector<uint8_t>& png, int& width, int& height) {
+	constexpr uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+	if (png.size() < sizeof(signature) or std::memcmp(png.data(), signature, sizeof(signature)) != 0) { throw std::runtime_error("Missing signature."); }
+	
+	std::vector<uint8_t> zlib_stream;
+	std::vector<std::string> chunk_types;
+	size_t position = sizeof(signature);
+	while (position < png.size()) {
+		if (png.size() - position < 12) { throw std::runtime_error("Truncated chunk."); }
+		const uint32_t chunk_size = read_big_endian(png.data() + position);
+		if (png.size() - position - 12 < chunk_size) { throw std::runtime_error("Truncated chunk."); }
+		const uint8_t* type_ptr = png.data() + position + 4;
+		const uint8_t* chunk_data_ptr = type_ptr + 4;
+		if (read_big_endian(chunk_data_ptr + chunk_size) != compute_crc32(type_ptr, 4 + chunk_size)) { throw std::runtime_error("Chunk CRC mismatch."); }
+		
+		chunk_types.emplace_back(reinterpret_cast<const char*>(type_ptr), 4);
+		if (chunk_types.back() == "IHDR") {
+			if (chunk_size != 13) { throw std::runtime_error("Invalid IHDR."); }
+			width = static_cast<int>(read_big_endian(chunk_data_ptr));
+			height = static_cast<int>(read_big_endian(chunk_data_ptr + 4));
+			const uint8_t expected_format[5] = {8, 6, 0, 0, 0}; // 8 bits per channel, RGBA, deflate, adaptive filtering, no interlacing
+			if (std::memcmp(chunk_data_ptr + 8, expected_format, sizeof(expected_format)) != 0) { throw std::runtime_error("Unexpected format."); }
+		} else if (chunk_types.back() == "IDAT") {
+			zlib_stream.insert(zlib_stream.end(), chunk_data_ptr, chunk_data_ptr + chunk_size);
+		}
+		position += 12 + chunk_size;
+	}
+	if (chunk_types != std::vector<std::string>{"IHDR", "IDAT", "IEND"}) { throw std::runtime_error("Unexpected chunks."); }
+	
+	if (zlib_stream.size() < 6 or (zlib_stream[0] & 0x0Fu) != 8 or (zlib_stream[0]*256u + zlib_stream[1]) % 31 != 0) { throw std::runtime_error("Invalid zlib header."); }
+	std::vector<uint8_t> filtered_rows;
+	const size_t deflate_size = inflate(zlib_stream.data() + 2, zlib_stream.size() - 2, filtered_rows);
+	if (2 + deflate_size + 4 != zlib_stream.size()) { throw std::runtime_error("Unexpected data after the deflate stream."); }
+	if (read_big_endian(zlib_stream.data() + 2 + deflate_size) != compute_adler32(filtered_rows)) { throw std::runtime_error("Adler-32 mismatch."); }
+	
+	const size_t row_size = 4*static_cast<size_t>(width);
+	if (filtered_rows.size() != (1 + row_size)*static_cast<size_t>(height)) { throw std::runtime_error("Unexpected image data size."); }
+	
+	std::vector<uint8_t> pixels(row_size*static_cast<size_t>(height));
+	for (size_t row_index = 0; row_index < static_cast<size_t>(height); ++row_index) {
+		const uint8_t* filtered_row_ptr = filtered_rows.data() + (1 + row_size)*row_index;
+		uint8_t* row_ptr = pixels.data() + row_size*row_index;
+		for (size_t byte_index = 0; byte_index < row_size; ++byte_index) {
+			const uint8_t above = row_index > 0 ? row_ptr[byte_index - row_size] : 0;
+			switch (filtered_row_ptr[0]) {
+				case 0: row_ptr[byte_index] = filtered_row_ptr[1 + byte_index]; break;
+				case 2: row_ptr[byte_index] = static_cast<uint8_t>(filtered_row_ptr[1 + byte_index] + above); break;
+				default: throw std::runtime_error("Unsupported filter.");
+			}
+		}
+	}
+	return pixels;
+}
+
+std::vector<uint8_t> get_random_pixels(int width, int height, unsigned int seed) {
+	std::mt19937 generator(seed);
+	std::uniform_int_distribution<int> distribution(0, 255);
+	std::vector<uint8_t> pixels(4*static_cast<size_t>(width)*static_cast<size_t>(height));
+	for (auto& byte : pixels) { byte = static_cast<uint8_t>(distribution(generator)); }
+	return pixels;
+}
+
+// A flat background with a few shapes and stripes, like a rendered figure.
+std::vector<uint8_t> get_figure_pixels(int width, int height) {
+	std::vector<uint8_t> pixels(4*static_cast<size_t>(width)*static_cast<size_t>(height));
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x) {
+			uint8_t* pixel_ptr = pixels.data() + 4*(static_cast<size_t>(y)*static_cast<size_t>(width) + static_cast<size_t>(x));
+			const bool in_circle = (x - width/2)*(x - width/2) + (y - height/3)*(y - height/3) < width*height/16;
+			pixel_ptr[0] = in_circle ? 255 : 51;
+			pixel_ptr[1] = static_cast<uint8_t>(in_circle ? x : 51);
+			pixel_ptr[2] = (x/50 + y/50) % 2 == 0 ? 51 : 60;
+			pixel_ptr[3] = 255;
+		}
+	}
+	return pixels;
+}
+
+} // namespace
+
+TEST_CASE("PNG encoding round trip", "[png]") {
+	const auto require_round_trip = [](const std::vector<uint8_t>& pixels, int width, int height) {
+		std::vector<uint8_t> png;
+		Toucan::encode_png(pixels.data(), width, height, 4*width, png);
+		
+		int decoded_width = 0;
+		int decoded_height = 0;
+		const std::vector<uint8_t> decoded_pixels = decode_png(png, decoded_width, decoded_height);
+		REQUIRE(decoded_width == width);
+		REQUIRE(decoded_height == height);
+		REQUIRE(decoded_pixels == pixels);
+		return png.size();
+	};
+	
+	SECTION("Single pixel") {
+		require_round_trip({10, 20, 30, 40}, 1, 1);
+	}
+	
+	SECTION("Rendered figure") {
+		const std::vector<uint8_t> pixels = get_figure_pixels(640, 360);
+		const size_t png_size = require_round_trip(pixels, 640, 360);
+		REQUIRE(png_size < pixels.size()/10);
+	}
+	
+	SECTION("Incompressible") {
+		for (const int width : {1, 3, 97}) {
+			require_round_trip(get_random_pixels(width, 61, static_cast<unsigned int>(width)), width, 61);
+		}
+	}
+	
+	SECTION("Flipped rows") {
+		constexpr int width = 50;
+		constexpr int height = 40;
+		const std::vector<uint8_t> pixels = get_random_pixels(width, height, 1);
+		
+		// Rows bottom first, as read from an OpenGL framebuffer.
+		std::vector<uint8_t> png;
+		Toucan::encode_png(pixels.data() + 4*width*(height - 1), width, height, -4*width, png);
+		
+		int decoded_width = 0;
+		int decoded_height = 0;
+		const std::vector<uint8_t> decoded_pixels = decode_png(png, decoded_width, decoded_height);
+		REQUIRE(decoded_width == width);
+		REQUIRE(decoded_height == height);
+		for (int row_index = 0; row_index < height; ++row_index) {
+			const size_t row_size = 4*width;
+			REQUIRE(std::memcmp(decoded_pixels.data() + row_size*static_cast<size_t>(row_index), pixels.data() + row_size*static_cast<size_t>(height - 1 - row_index), row_size) == 0);
+		}
+	}
+}
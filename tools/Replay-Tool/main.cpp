@@ -0,0 +1,83 @@
+// Replays a capture recorded with `ToucanSettings::capture_file_path`, e.g:
+//     toucan-replay capture.bin [--speed=1.0]
+//
+// A speed of 0 replays the frames as fast as possible. The replay can be paused, sped up and moved to any time from the "Capture replay" window.
+
+#include <Toucan/Toucan.h>
+#include <Toucan/Replay.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+int main(int argc, char* argv[]) {
+	std::string file_path;
+	float speed = 1.0f;
+	for (int argument_index = 1; argument_index < argc; ++argument_index) {
+		constexpr const char* speed_option = "--speed=";
+		if (std::strncmp(argv[argument_index], speed_option, std::strlen(speed_option)) == 0) {
+			speed = std::strtof(argv[argument_index] + std::strlen(speed_option), nullptr);
+		} else {
+			file_path = argv[argument_index];
+		}
+	}
+	
+	if (file_path.empty()) {
+		std::cerr << "Usage: " << argv[0] << " <capture file> [--speed=1.0]\n";
+		return 1;
+	}
+	
+	Toucan::CaptureReplay replay(file_path);
+	const float duration_seconds = static_cast<float>(replay.get_duration())*1e-9f;
+	
+	Toucan::Initialize();
+	
+	bool paused = false;
+	double replay_time_ns = 0.0;
+	auto last_time = std::chrono::steady_clock::now();
+	
+	while (Toucan::IsWindowOpen()) {
+		float time_seconds = static_cast<float>(replay_time_ns*1e-9);
+		bool time_changed = false;
+		
+		// Shown between frames of the replay, so it never overlaps an input window of the capture.
+		Toucan::BeginInputWindow("Capture replay");
+		{
+			time_changed = Toucan::ShowSliderFloat("Time [s]", time_seconds, {0.0f, duration_seconds});
+			Toucan::ShowSliderFloat("Speed", speed, {0.0f, 16.0f});
+			Toucan::ShowCheckbox("Paused", paused);
+		}
+		Toucan::EndInputWindow();
+		
+		const auto time = std::chrono::steady_clock::now();
+		const double elapsed_ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(time - last_time).count());
+		last_time = time;
+		
+		if (time_changed) {
+			replay_time_ns = static_cast<double>(time_seconds)*1e9;
+			replay.seek(static_cast<int64_t>(replay_time_ns));
+		} else if (not paused and speed <= 0.0f) {
+			replay.replay_next_frame();
+			replay_time_ns = static_cast<double>(replay.get_current_timestamp());
+		} else if (not paused) {
+			replay_time_ns = std::min(replay_time_ns + elapsed_ns*static_cast<double>(speed), static_cast<double>(replay.get_duration()));
+			replay.replay_until(static_cast<int64_t>(replay_time_ns));
+		}
+		
+		// Sleep until the next frame is due, but keep the replay window responsive.
+		if (paused or replay.is_at_end()) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(16));
+		} else if (speed > 0.0f) {
+			const double time_to_next_frame_ns = (static_cast<double>(replay.get_next_timestamp()) - replay_time_ns)/static_cast<double>(speed);
+			std::this_thread::sleep_for(std::chrono::nanoseconds(static_cast<int64_t>(std::clamp(time_to_next_frame_ns, 0.0, 16e6))));
+		}
+	}
+	
+	Toucan::Destroy();
+	
+	return 0;
+}
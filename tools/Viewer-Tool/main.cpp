@@ -0,0 +1,36 @@
+// Shows the calls of a process initialized with `ToucanSettings::shared_memory_name`, in a window of its own, e.g:
+//     toucan-viewer /toucan
+// or the calls streamed by a process initialized with `ToucanSettings::network_port`, e.g. on a robot:
+//     toucan-viewer robot.local:7700
+//
+// Start the viewer after the process it shows. Rendering in a separate process keeps driver stalls and slow frames out of that process.
+
+#include <Toucan/Toucan.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+int main(int argc, char* argv[]) {
+	if (argc != 2) {
+		std::cerr << "Usage: " << argv[0] << " <shared memory name> | <host>:<port>\n";
+		return 1;
+	}
+	
+	const std::string source = argv[1];
+	const size_t port_separator_index = source.rfind(':');
+	if (port_separator_index == std::string::npos) {
+		Toucan::RunSharedMemoryViewer(source);
+		return 0;
+	}
+	
+	const long port = std::strtol(source.c_str() + port_separator_index + 1, nullptr, 10);
+	if (port <= 0 or port > 65535) {
+		std::cerr << "Invalid port in '" << source << "'.\n";
+		return 1;
+	}
+	
+	Toucan::RunNetworkViewer(source.substr(0, port_separator_index), static_cast<uint16_t>(port));
+	
+	return 0;
+}